@@ -18,15 +18,8 @@ int main( int argc, char *argv[] )
     ais_state     ais;
     char          buf[256];
 
-    /* AIS message structures, only parse ones with positions */
-    aismsg_1  msg_1;
-    aismsg_2  msg_2;
-    aismsg_3  msg_3;
-    aismsg_4  msg_4;
-    aismsg_9  msg_9;
-    aismsg_15 msg_15;
-    aismsg_18 msg_18;
-    aismsg_19 msg_19;
+    /* Any AIS message */
+    aismsg_any msg;
     
     /* Position in DD.DDDDDD */
     double lat_dd = 0;
@@ -35,6 +28,7 @@ int main( int argc, char *argv[] )
 
     /* Clear out the structures */
     memset( &ais, 0, sizeof( ais_state ) );
+    memset( &msg, 0, sizeof( aismsg_any ) );
 
     /* Process incoming packets from stdin */
     while( !feof(stdin) )
@@ -43,93 +37,68 @@ int main( int argc, char *argv[] )
 
         if (assemble_vdm( &ais, buf ) == 0)
         {
-            /* Get the 6 bit message id */
-            ais.msgid = (unsigned char) get_6bit( &ais.six_state, 6 );
-            
-            /* process message with appropriate parser */
-            switch( ais.msgid ) {
-                case 1:
-                    if( parse_ais_1( &ais, &msg_1 ) == 0 )
-                    {
-                        userid = msg_1.userid;
-                        pos2ddd( msg_1.latitude, msg_1.longitude, &lat_dd, &long_ddd );
-                    }
-                    break;
-                            
-                case 2:
-                    if( parse_ais_2( &ais, &msg_2 ) == 0 )
-                    {
-                        userid = msg_2.userid;
-                        pos2ddd( msg_2.latitude, msg_2.longitude, &lat_dd, &long_ddd );
-                    }
-                    break;
-                            
-                case 3:
-                    if( parse_ais_3( &ais, &msg_3 ) == 0 )
-                    {
-                        userid = msg_3.userid;
-                        pos2ddd( msg_3.latitude, msg_3.longitude, &lat_dd, &long_ddd );
-                    }
-                    break;
-                            
-                case 4:
-                    if( parse_ais_4( &ais, &msg_4 ) == 0 )
-                    {
-                        userid = msg_4.userid;
-                        pos2ddd( msg_4.latitude, msg_4.longitude, &lat_dd, &long_ddd );
-                    }
-                    break;
-                            
-                case 9:
-                    if( parse_ais_9( &ais, &msg_9 ) == 0 )
-                    {
-                        userid = msg_9.userid;
-                        pos2ddd( msg_9.latitude, msg_9.longitude, &lat_dd, &long_ddd );
-                    }
-                    break;
-                
-                case 15:
-                    if( parse_ais_15( &ais, &msg_15 ) == 0 )
-                    {
-                        userid = msg_15.userid;
-                        if( msg_15.num_reqs > 0 )
+            /* Get the 6 bit message id and parse the message */
+            if( parse_ais_any( &ais, &msg ) == 0 )
+            {
+                /* Only use the ones with positions */
+                switch( msg.msgid ) {
+                    case 1:
+                        userid = msg.u.msg_1.userid;
+                        pos2ddd( msg.u.msg_1.latitude, msg.u.msg_1.longitude, &lat_dd, &long_ddd );
+                        break;
+
+                    case 2:
+                        userid = msg.u.msg_2.userid;
+                        pos2ddd( msg.u.msg_2.latitude, msg.u.msg_2.longitude, &lat_dd, &long_ddd );
+                        break;
+
+                    case 3:
+                        userid = msg.u.msg_3.userid;
+                        pos2ddd( msg.u.msg_3.latitude, msg.u.msg_3.longitude, &lat_dd, &long_ddd );
+                        break;
+
+                    case 4:
+                        userid = msg.u.msg_4.userid;
+                        pos2ddd( msg.u.msg_4.latitude, msg.u.msg_4.longitude, &lat_dd, &long_ddd );
+                        break;
+
+                    case 9:
+                        userid = msg.u.msg_9.userid;
+                        pos2ddd( msg.u.msg_9.latitude, msg.u.msg_9.longitude, &lat_dd, &long_ddd );
+                        break;
+
+                    case 15:
+                        userid = msg.u.msg_15.userid;
+                        if( msg.u.msg_15.num_reqs > 0 )
                         {
-                            printf("dest #1   : %ld\n", msg_15.destid1 );
-                            printf("msgid #1  : %d\n", msg_15.msgid1_1 );
-                            printf("offset #1 : %d\n", msg_15.offset1_1 );
+                            printf("dest #1   : %ld\n", msg.u.msg_15.destid1 );
+                            printf("msgid #1  : %d\n", msg.u.msg_15.msgid1_1 );
+                            printf("offset #1 : %d\n", msg.u.msg_15.offset1_1 );
                         }
-                        if( msg_15.num_reqs > 1 )
+                        if( msg.u.msg_15.num_reqs > 1 )
                         {
-                            printf("msgid #2  : %d\n", msg_15.msgid1_2 );
-                            printf("offset #2 : %d\n", msg_15.offset1_2 );
+                            printf("msgid #2  : %d\n", msg.u.msg_15.msgid1_2 );
+                            printf("offset #2 : %d\n", msg.u.msg_15.offset1_2 );
                         }
-                        if( msg_15.num_reqs > 2 )
+                        if( msg.u.msg_15.num_reqs > 2 )
                         {
-                            printf("dest #2     : %ld\n", msg_15.destid2 );
-                            printf("msgid #2.1  : %d\n", msg_15.msgid2_1 );
-                            printf("offset #2.1 : %d\n", msg_15.offset2_1 );
+                            printf("dest #2     : %ld\n", msg.u.msg_15.destid2 );
+                            printf("msgid #2.1  : %d\n", msg.u.msg_15.msgid2_1 );
+                            printf("offset #2.1 : %d\n", msg.u.msg_15.offset2_1 );
                         }
-                    }
-                    break;
-                    
-                    
-                case 18:
-                    if( parse_ais_18( &ais, &msg_18 ) == 0 )
-                    {
-                        userid = msg_18.userid;
-                        pos2ddd( msg_18.latitude, msg_18.longitude, &lat_dd, &long_ddd );
-                    }
-                    break;
-                    
+                        break;
+
+                    case 18:
+                        userid = msg.u.msg_18.userid;
+                        pos2ddd( msg.u.msg_18.latitude, msg.u.msg_18.longitude, &lat_dd, &long_ddd );
+                        break;
 
-                case 19:
-                    if( parse_ais_19( &ais, &msg_19 ) == 0 )
-                    {
-                        userid = msg_19.userid;
-                        pos2ddd( msg_19.latitude, msg_19.longitude, &lat_dd, &long_ddd );
-                    }
-                    break;                    
-            }  /* switch msgid */
+                    case 19:
+                        userid = msg.u.msg_19.userid;
+                        pos2ddd( msg.u.msg_19.latitude, msg.u.msg_19.longitude, &lat_dd, &long_ddd );
+                        break;
+                }  /* switch msgid */
+            }
             
             printf( "MESSAGE ID: %d\n", ais.msgid );
             printf( "USER ID   : %ld\n", userid );
@@ -31,10 +31,10 @@
 
     \param msg pointer to a aismsg_6 struct
 
-	\retval pointer to a sixbit struct
+	\retval pointer to a sixbit_view of the payload
 */
 /* ----------------------------------------------------------------------- */
-sixbit * __stdcall get_msg6_data( aismsg_6 *msg )
+sixbit_view * __stdcall get_msg6_data( aismsg_6 *msg )
 {
 	return &msg->data;
 }
@@ -45,10 +45,10 @@ sixbit * __stdcall get_msg6_data( aismsg_6 *msg )
 
     \param msg pointer to a aismsg_8 struct
 
-	\retval pointer to a sixbit struct
+	\retval pointer to a sixbit_view of the payload
 */
 /* ----------------------------------------------------------------------- */
-sixbit * __stdcall get_msg8_data( aismsg_8 *msg )
+sixbit_view * __stdcall get_msg8_data( aismsg_8 *msg )
 {
 	return &msg->data;
 }
@@ -59,10 +59,10 @@ sixbit * __stdcall get_msg8_data( aismsg_8 *msg )
 
     \param msg pointer to a aismsg_17 struct
 
-	\retval pointer to a sixbit struct
+	\retval pointer to a sixbit_view of the payload
 */
 /* ----------------------------------------------------------------------- */
-sixbit * __stdcall get_msg17_data( aismsg_17 *msg )
+sixbit_view * __stdcall get_msg17_data( aismsg_17 *msg )
 {
 	return &msg->data;
 }
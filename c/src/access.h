@@ -11,9 +11,9 @@
 	Prototypes for access.c
 
 */
-sixbit * __stdcall get_msg6_data( aismsg_6 *msg );
-sixbit * __stdcall get_msg8_data( aismsg_8 *msg );
-sixbit * __stdcall get_msg17_data( aismsg_17 *msg );
+sixbit_view * __stdcall get_msg6_data( aismsg_6 *msg );
+sixbit_view * __stdcall get_msg8_data( aismsg_8 *msg );
+sixbit_view * __stdcall get_msg17_data( aismsg_17 *msg );
 weather_report * __stdcall get_weather_report( seaway1_1 *msg, int idx );
 timetag * __stdcall get_weather_utc_time( weather_report *msg );
 wind_report * __stdcall get_wind_report( seaway1_2 *msg, int idx );
@@ -0,0 +1,715 @@
+/* -----------------------------------------------------------------------
+   Multithreaded decoding of NMEA archive files
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>
+   All rights Reserved
+   ----------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#include "portable.h"
+#include "nmea.h"
+#include "sixbit.h"
+#include "vdm_parse.h"
+#include "reassembly.h"
+#include "batch.h"
+#include "archive.h"
+
+/*! \file
+    \brief Multithreaded decoding of NMEA archive files
+    \author Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>, All Rights Reserved
+    \version 1.8
+
+    ais_decode_archive() maps a whole log file into memory and splits it
+    into chunks of about ais_archive.chunk_size bytes, each one ending at
+    the end of a line. The chunks are decoded by ais_archive.threads
+    threads at once, each with its own ais_state and reassembly table,
+    and every message is passed to the callback as an ais_record.
+
+    A multipart message may start at the end of one chunk and finish at
+    the start of the next. The thread decoding the second chunk sees the
+    later parts with no first part and keeps their offsets. Once both
+    chunks are done the reassembly table left over from the first chunk
+    is given those parts, which completes the message. These are counted
+    in ais_archive.stitched.
+
+    When ais_archive.ordered is set the messages of each chunk are held
+    until all of the chunks before it have been passed to the callback,
+    so they arrive in the same order as a single threaded decoder would
+    produce them, from one thread. Only a few chunks are held at once.
+    Otherwise the threads call the callback as they go and it must be
+    safe to call from several threads at once.
+
+    On Windows the file is read into memory and decoded by one thread.
+
+    Example:
+    \code
+    void __stdcall got_message( ais_record *record, void *data )
+    {
+        if( record->msg.msgid == 1 )
+            ...
+    }
+
+    ais_archive archive;
+
+    init_ais_archive( &archive, got_message, NULL );
+    archive.threads = 8;
+    archive.ordered = 1;
+    if( ais_decode_archive( &archive, "SAR.log" ) == 0 )
+        printf( "%lu messages\n", archive.records );
+    \endcode
+*/
+
+
+/** One piece of the file, decoded by one thread */
+typedef struct {
+    size_t          start;             /* Offset of the first line */
+    size_t          end;               /* Offset just past the last line */
+    reasm_table     *reasm;            /* Messages still incomplete at the end */
+    ais_record      *records;          /* Decoded messages, when ordered */
+    unsigned int    num_records;
+    unsigned int    max_records;
+    size_t          orphans[AIS_ARCHIVE_ORPHANS]; /* Parts with no first part */
+    unsigned int    num_orphans;
+    unsigned long   count;             /* Messages decoded */
+    unsigned long   errors;
+    int             done;
+} archive_chunk;
+
+
+/** Everything shared by the decoding threads */
+typedef struct {
+    ais_archive     *archive;
+    const char      *buf;
+    size_t          len;
+    archive_chunk   *chunk;
+    unsigned int    num_chunks;
+    unsigned int    next;              /* Next chunk to decode */
+    unsigned int    emitted;           /* Chunks passed to the callback, when ordered */
+    unsigned int    window;            /* Chunks that may be held at once */
+    int             failed;
+    ais_state       merge_state;       /* Used to stitch chunks together */
+    ais_record      merged[AIS_ARCHIVE_ORPHANS];
+    sixbit          merged_payload[AIS_ARCHIVE_ORPHANS];
+#ifndef _WIN32
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+#endif
+} archive_job;
+
+
+/* ----------------------------------------------------------------------- */
+/** Initialize an archive decoder
+
+    \param archive pointer to the archive decoder
+    \param callback function to call with each decoded message
+    \param data pointer passed to callback
+
+    returns:
+      - 0 if no error
+      - 1 if there was an error
+
+    It is set up to use 1 thread, #AIS_ARCHIVE_CHUNK byte chunks, to drop
+    incomplete messages after 64k of the file and to call the callback in
+    any order.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall init_ais_archive( ais_archive *archive, ais_archive_cb callback, void *data )
+{
+    if( !archive || !callback )
+        return 1;
+
+    memset( archive, 0, sizeof( ais_archive ) );
+    archive->threads = 1;
+    archive->chunk_size = AIS_ARCHIVE_CHUNK;
+    archive->timeout = 65536;
+    archive->callback = callback;
+    archive->data = data;
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Copy the line at offset and tokenize it
+   Returns the offset of the next line, rv is set to the nmea_tokenize()
+   result or -1 if the line is too long.
+*/
+/* ----------------------------------------------------------------------- */
+static size_t archive_line( archive_job *job, size_t offset, nmea_state *nmea, char *line, int *rv )
+{
+    const char *p;
+    const char *eol;
+    size_t     n;
+
+    p = job->buf + offset;
+    eol = memchr( p, '\n', job->len - offset );
+    n = eol ? (size_t) (eol - p) : job->len - offset;
+
+    if( n > MAX_NMEA_LENGTH - 1 )
+    {
+        nmea->num_fields = 0;
+        *rv = -1;
+    } else {
+        memcpy( line, p, n );
+        line[n] = 0;
+        *rv = nmea_tokenize( nmea, line );
+    }
+
+    return offset + n + (eol ? 1 : 0);
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* The binary payload of a record, NULL if it doesn't have one */
+/* ----------------------------------------------------------------------- */
+static sixbit_view *archive_data( ais_record *r )
+{
+    switch( r->msg.msgid )
+    {
+        case 6:
+            return &r->msg.u.msg_6.data;
+        case 8:
+            return &r->msg.u.msg_8.data;
+        case 17:
+            return &r->msg.u.msg_17.data;
+    }
+    return NULL;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Parse the message in state into r, returns 0 if it was parsed */
+/* ----------------------------------------------------------------------- */
+static int archive_record( ais_state *state, size_t offset, ais_record *r )
+{
+    r->msg.msgid = 0;
+    if( parse_ais_any( state, &r->msg ) != 0 )
+        return 1;
+
+    r->offset = offset;
+    r->channel = state->channel;
+    r->tag = state->tag;
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Room for one more record in a chunk, NULL if out of memory */
+/* ----------------------------------------------------------------------- */
+static ais_record *archive_next_record( archive_chunk *c )
+{
+    ais_record    *r;
+    unsigned int  n;
+
+    if( c->num_records == c->max_records )
+    {
+        n = c->max_records ? c->max_records * 2 : 1024;
+        r = realloc( c->records, n * sizeof( ais_record ) );
+        if( !r )
+            return NULL;
+        c->records = r;
+        c->max_records = n;
+    }
+
+    return &c->records[c->num_records];
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Decode one chunk of the file */
+/* ----------------------------------------------------------------------- */
+static void archive_decode_chunk( archive_job *job, archive_chunk *c )
+{
+    ais_archive   *archive;
+    ais_state     state;
+    nmea_state    nmea;
+    char          line[MAX_NMEA_LENGTH];
+    ais_record    record;
+    ais_record    *r;
+    sixbit_view   *data;
+    size_t        offset;
+    size_t        next;
+    unsigned long orphans;
+    int           rv;
+
+    archive = job->archive;
+    memset( &state, 0, sizeof( state ) );
+
+    c->reasm = malloc( sizeof( reasm_table ) );
+    if( !c->reasm )
+    {
+        job->failed = 1;
+        return;
+    }
+    init_reasm( c->reasm, archive->timeout );
+
+    for( offset = c->start; offset < c->end; offset = next )
+    {
+        next = archive_line( job, offset, &nmea, line, &rv );
+        if( rv < 0 )
+        {
+            c->errors++;
+            continue;
+        }
+        if( !is_vdm( &nmea ) )
+            continue;
+        if( rv != 0 )
+        {
+            c->errors++;
+            continue;
+        }
+
+        orphans = c->reasm->orphans;
+        rv = reasm_vdm_tokens( c->reasm, &state, &nmea, (unsigned long) offset );
+        if( rv == 1 )
+            continue;
+        if( rv != 0 )
+        {
+            /* Could be the rest of a message from the chunk before */
+            if( (c->reasm->orphans != orphans) && (c->start > 0) && (c->num_orphans < AIS_ARCHIVE_ORPHANS) )
+                c->orphans[c->num_orphans++] = offset;
+            else
+                c->errors++;
+            continue;
+        }
+
+        r = &record;
+        if( archive->ordered && !(r = archive_next_record( c )) )
+        {
+            job->failed = 1;
+            return;
+        }
+        if( archive_record( &state, offset, r ) )
+        {
+            c->errors++;
+            continue;
+        }
+        c->count++;
+
+        if( !archive->ordered )
+        {
+            archive->callback( r, archive->data );
+            continue;
+        }
+
+        /* Held records need their own copy of the binary payload */
+        data = archive_data( r );
+        if( data )
+        {
+            data->six = malloc( sizeof( sixbit ) );
+            if( !data->six )
+            {
+                job->failed = 1;
+                return;
+            }
+            *data->six = state.six_state;
+        }
+        c->num_records++;
+    }
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Finish the messages that started in chunk k-1 with the parts from the
+   start of chunk k, returns the number of records in job->merged
+*/
+/* ----------------------------------------------------------------------- */
+static unsigned int archive_stitch( archive_job *job, unsigned int k )
+{
+    archive_chunk *c;
+    nmea_state    nmea;
+    char          line[MAX_NMEA_LENGTH];
+    ais_record    *r;
+    sixbit_view   *data;
+    unsigned int  i;
+    unsigned int  n;
+    int           rv;
+
+    c = &job->chunk[k];
+    n = 0;
+    for( i = 0; i < c->num_orphans; i++ )
+    {
+        archive_line( job, c->orphans[i], &nmea, line, &rv );
+        rv = reasm_vdm_tokens( job->chunk[k-1].reasm, &job->merge_state, &nmea, (unsigned long) c->orphans[i] );
+        if( rv == 1 )
+            continue;
+
+        r = &job->merged[n];
+        if( (rv != 0) || archive_record( &job->merge_state, c->orphans[i], r ) )
+        {
+            c->errors++;
+            continue;
+        }
+
+        data = archive_data( r );
+        if( data )
+        {
+            job->merged_payload[n] = job->merge_state.six_state;
+            data->six = &job->merged_payload[n];
+        }
+        n++;
+    }
+
+    return n;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Stitch chunk k to the one before it and pass its messages to the
+   callback, in order if the archive is ordered. Chunk k must be done.
+*/
+/* ----------------------------------------------------------------------- */
+static void archive_finish_chunk( archive_job *job, unsigned int k )
+{
+    ais_archive   *archive;
+    archive_chunk *c;
+    sixbit_view   *data;
+    unsigned int  num_merged;
+    unsigned int  i;
+    unsigned int  j;
+
+    archive = job->archive;
+    c = &job->chunk[k];
+
+    num_merged = 0;
+    if( k > 0 )
+    {
+        num_merged = archive_stitch( job, k );
+        free( job->chunk[k-1].reasm );
+        job->chunk[k-1].reasm = NULL;
+    }
+    archive->stitched += num_merged;
+    archive->records += c->count + num_merged;
+    archive->errors += c->errors;
+
+    /* Both lists are in file order, merge them */
+    i = j = 0;
+    while( (i < num_merged) || (j < c->num_records) )
+    {
+        if( (j == c->num_records) || ((i < num_merged) && (job->merged[i].offset < c->records[j].offset)) )
+        {
+            archive->callback( &job->merged[i++], archive->data );
+        } else {
+            archive->callback( &c->records[j], archive->data );
+            data = archive_data( &c->records[j] );
+            if( data )
+                free( data->six );
+            j++;
+        }
+    }
+
+    free( c->records );
+    c->records = NULL;
+    c->num_records = 0;
+    c->max_records = 0;
+}
+
+
+#ifndef _WIN32
+/* ----------------------------------------------------------------------- */
+/* Decoding thread, takes the next chunk until there are none left */
+/* ----------------------------------------------------------------------- */
+static void *archive_worker( void *arg )
+{
+    archive_job   *job;
+    unsigned int  k;
+
+    job = (archive_job *) arg;
+    for( ;; )
+    {
+        pthread_mutex_lock( &job->lock );
+
+        /* Don't get too far ahead of the chunks being passed on */
+        while(    job->archive->ordered && !job->failed && (job->next < job->num_chunks)
+               && (job->next >= job->emitted + job->window) )
+        {
+            pthread_cond_wait( &job->cond, &job->lock );
+        }
+        if( job->failed || (job->next >= job->num_chunks) )
+        {
+            pthread_mutex_unlock( &job->lock );
+            break;
+        }
+        k = job->next++;
+        pthread_mutex_unlock( &job->lock );
+
+        archive_decode_chunk( job, &job->chunk[k] );
+
+        pthread_mutex_lock( &job->lock );
+        job->chunk[k].done = 1;
+        pthread_cond_broadcast( &job->cond );
+        pthread_mutex_unlock( &job->lock );
+    }
+
+    return NULL;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Decode the chunks using the archive's threads, returns 0 if no error */
+/* ----------------------------------------------------------------------- */
+static int archive_threads( archive_job *job )
+{
+    pthread_t     *threads;
+    unsigned int  num_threads;
+    unsigned int  i;
+    unsigned int  k;
+
+    num_threads = job->archive->threads;
+    if( num_threads > job->num_chunks )
+        num_threads = job->num_chunks;
+
+    threads = calloc( num_threads, sizeof( pthread_t ) );
+    if( !threads )
+        return 1;
+
+    pthread_mutex_init( &job->lock, NULL );
+    pthread_cond_init( &job->cond, NULL );
+    job->window = 2 * num_threads;
+
+    for( i = 0; i < num_threads; i++ )
+    {
+        if( pthread_create( &threads[i], NULL, archive_worker, job ) != 0 )
+        {
+            pthread_mutex_lock( &job->lock );
+            job->failed = 1;
+            pthread_cond_broadcast( &job->cond );
+            pthread_mutex_unlock( &job->lock );
+            break;
+        }
+    }
+    num_threads = i;
+
+    /* Pass each chunk on as soon as it and the ones before it are done */
+    if( job->archive->ordered )
+    {
+        for( k = 0; (k < job->num_chunks) && !job->failed; k++ )
+        {
+            pthread_mutex_lock( &job->lock );
+            while( !job->chunk[k].done && !job->failed )
+                pthread_cond_wait( &job->cond, &job->lock );
+            pthread_mutex_unlock( &job->lock );
+            if( job->failed )
+                break;
+
+            archive_finish_chunk( job, k );
+
+            pthread_mutex_lock( &job->lock );
+            job->emitted = k + 1;
+            pthread_cond_broadcast( &job->cond );
+            pthread_mutex_unlock( &job->lock );
+        }
+    }
+
+    for( i = 0; i < num_threads; i++ )
+        pthread_join( threads[i], NULL );
+
+    /* The callback has already been called for the rest */
+    if( !job->archive->ordered && !job->failed )
+    {
+        for( k = 0; k < job->num_chunks; k++ )
+            archive_finish_chunk( job, k );
+    }
+
+    pthread_cond_destroy( &job->cond );
+    pthread_mutex_destroy( &job->lock );
+    free( threads );
+
+    return job->failed;
+}
+#endif
+
+
+/* ----------------------------------------------------------------------- */
+/** Decode a buffer holding the contents of an archive
+
+    \param archive pointer to the archive decoder
+    \param buf pointer to the sentences, one per line
+    \param len number of bytes in buf
+
+    returns:
+      - 0 if no error
+      - 1 if there was an error with the parameters
+      - 2 if memory or a thread could not be had
+
+    This is what ais_decode_archive() uses once the file is mapped. The
+    counters in archive are added to.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall ais_decode_archive_mem( ais_archive *archive, const char *buf, size_t len )
+{
+    archive_job   *job;
+    const char    *eol;
+    size_t        chunk_size;
+    size_t        offset;
+    size_t        end;
+    unsigned int  k;
+    int           rv;
+
+    if( !archive || !archive->callback || (!buf && len) )
+        return 1;
+    if( len == 0 )
+        return 0;
+
+    job = calloc( 1, sizeof( archive_job ) );
+    if( !job )
+        return 2;
+    job->archive = archive;
+    job->buf = buf;
+    job->len = len;
+
+    /* Split it into chunks at the ends of lines */
+    chunk_size = archive->chunk_size;
+    if( chunk_size < AIS_ARCHIVE_MIN_CHUNK )
+        chunk_size = AIS_ARCHIVE_MIN_CHUNK;
+    job->chunk = calloc( len / chunk_size + 1, sizeof( archive_chunk ) );
+    if( !job->chunk )
+    {
+        free( job );
+        return 2;
+    }
+    for( offset = 0; offset < len; offset = end )
+    {
+        end = offset + chunk_size;
+        if( end >= len )
+        {
+            end = len;
+        } else {
+            eol = memchr( buf + end, '\n', len - end );
+            end = eol ? (size_t) (eol - buf) + 1 : len;
+        }
+        job->chunk[job->num_chunks].start = offset;
+        job->chunk[job->num_chunks].end = end;
+        job->num_chunks++;
+    }
+
+#ifndef _WIN32
+    if( archive->threads > 1 )
+    {
+        rv = archive_threads( job );
+    } else
+#endif
+    {
+        for( k = 0; (k < job->num_chunks) && !job->failed; k++ )
+        {
+            archive_decode_chunk( job, &job->chunk[k] );
+            if( !job->failed )
+                archive_finish_chunk( job, k );
+        }
+        rv = job->failed;
+    }
+
+    /* Clean up after a failure and the last chunk's incomplete messages */
+    for( k = 0; k < job->num_chunks; k++ )
+    {
+        if( job->chunk[k].records )
+        {
+            while( job->chunk[k].num_records-- )
+            {
+                if( archive_data( &job->chunk[k].records[job->chunk[k].num_records] ) )
+                    free( archive_data( &job->chunk[k].records[job->chunk[k].num_records] )->six );
+            }
+            free( job->chunk[k].records );
+        }
+        free( job->chunk[k].reasm );
+    }
+    free( job->chunk );
+    free( job );
+
+    return rv ? 2 : 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Decode a log file of AIVDM/AIVDO sentences
+
+    \param archive pointer to the archive decoder
+    \param filename name of the file to decode
+
+    returns:
+      - 0 if no error
+      - 1 if the file could not be opened or mapped
+      - 2 if memory or a thread could not be had
+
+    The callback is called for each message in the file, see
+    ais_decode_archive_mem(). The counters in archive are added to.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall ais_decode_archive( ais_archive *archive, const char *filename )
+{
+#ifndef _WIN32
+    struct stat   st;
+    void          *map;
+    int           fd;
+    int           rv;
+
+    if( !archive || !filename )
+        return 1;
+
+    fd = open( filename, O_RDONLY );
+    if( fd < 0 )
+        return 1;
+    if( fstat( fd, &st ) != 0 )
+    {
+        close( fd );
+        return 1;
+    }
+    if( st.st_size == 0 )
+    {
+        close( fd );
+        return 0;
+    }
+
+    map = mmap( NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    close( fd );
+    if( map == MAP_FAILED )
+        return 1;
+
+    rv = ais_decode_archive_mem( archive, (const char *) map, (size_t) st.st_size );
+    munmap( map, (size_t) st.st_size );
+
+    return rv;
+#else
+    FILE  *fp;
+    char  *buf;
+    long  len;
+    int   rv;
+
+    if( !archive || !filename )
+        return 1;
+
+    fp = fopen( filename, "rb" );
+    if( !fp )
+        return 1;
+    fseek( fp, 0, SEEK_END );
+    len = ftell( fp );
+    fseek( fp, 0, SEEK_SET );
+    if( len <= 0 )
+    {
+        fclose( fp );
+        return (len < 0) ? 1 : 0;
+    }
+
+    buf = malloc( len );
+    if( !buf )
+    {
+        fclose( fp );
+        return 2;
+    }
+    len = (long) fread( buf, 1, len, fp );
+    fclose( fp );
+
+    rv = ais_decode_archive_mem( archive, buf, (size_t) len );
+    free( buf );
+
+    return rv;
+#endif
+}
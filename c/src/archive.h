@@ -0,0 +1,56 @@
+/* -----------------------------------------------------------------------
+   Multithreaded decoding of NMEA archive files
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>
+   All rights Reserved
+   ----------------------------------------------------------------------- */
+
+/*! \file
+    \brief Header file for archive.c
+
+    Requires nmea.h, sixbit.h, vdm_parse.h, reassembly.h and batch.h to
+    be included first.
+*/
+
+/** Default number of bytes decoded by a thread at a time */
+#define AIS_ARCHIVE_CHUNK      (8 * 1024 * 1024)
+
+/** Smallest chunk, so that a multipart message never spans more than 2 */
+#define AIS_ARCHIVE_MIN_CHUNK  4096
+
+/** Number of parts at the start of a chunk that can be stitched to
+    messages started at the end of the chunk before it
+*/
+#define AIS_ARCHIVE_ORPHANS    64
+
+
+/** Called for each decoded message
+
+    record->offset is the offset in the file of the sentence that
+    completed the message. Unless the archive is ordered this is called
+    from more than one thread at the same time.
+*/
+typedef void (__stdcall *ais_archive_cb)( ais_record *record, void *data );
+
+
+/** Archive decoder settings and counters
+
+    Set up by init_ais_archive(), change the settings before calling
+    ais_decode_archive().
+*/
+typedef struct {
+    unsigned int    threads;           //!< Number of decoding threads
+    size_t          chunk_size;        //!< Bytes decoded by a thread at a time
+    unsigned long   timeout;           //!< Bytes an incomplete message is kept for, 0 = never dropped
+    unsigned char   ordered;           //!< 1 to call callback in file order, from one thread
+    ais_archive_cb  callback;          //!< Called with each decoded message
+    void            *data;             //!< Passed to callback
+    unsigned long   records;           //!< Messages decoded
+    unsigned long   stitched;          //!< Multipart messages put together across 2 chunks
+    unsigned long   errors;            //!< Sentences or messages that could not be decoded
+} ais_archive;
+
+
+/* Prototypes */
+int __stdcall init_ais_archive( ais_archive *archive, ais_archive_cb callback, void *data );
+int __stdcall ais_decode_archive( ais_archive *archive, const char *filename );
+int __stdcall ais_decode_archive_mem( ais_archive *archive, const char *buf, size_t len );
@@ -0,0 +1,217 @@
+/* -----------------------------------------------------------------------
+   Batch decoding of AIVDM/AIVDO sentences
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>
+   All rights Reserved
+   ----------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "portable.h"
+#include "nmea.h"
+#include "sixbit.h"
+#include "vdm_parse.h"
+#include "reassembly.h"
+#include "batch.h"
+
+/*! \file
+    \brief Batch decoding of AIVDM/AIVDO sentences
+    \author Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>, All Rights Reserved
+    \version 1.8
+
+    Instead of reading one line at a time and calling assemble_vdm() and
+    a parse_ais_N() function for each one, a whole buffer of sentences,
+    eg. a block read from a file or a socket, can be handed to
+    ais_decode_batch(). It walks the lines, puts multipart messages
+    together using a reasm_table and parses each completed message into
+    the next entry of an array of ais_record.
+
+    Everything needed between calls is held in an ais_batch, so a message
+    may be split across 2 buffers. Only whole lines are used, the caller
+    passes the unused end of the buffer in again with the next block.
+
+    The payload of messages 6, 8 and 17 is copied into the batch so that
+    the views in the records stay valid until the next call.
+
+    Example:
+    \code
+    static ais_batch batch;
+    ais_record       records[100];
+    char             buf[4096];
+    size_t           len, used;
+    int              i, n;
+
+    init_ais_batch( &batch, 100 );
+    len = 0;
+    while( (n = read( fd, buf + len, sizeof(buf) - len )) > 0 )
+    {
+        len += n;
+        do {
+            n = ais_decode_batch( &batch, buf, len, records, 100, &used );
+            for( i = 0; i < n; i++ )
+            {
+                if( records[i].msg.msgid == 1 )
+                    ...
+            }
+            memmove( buf, buf + used, len - used );
+            len -= used;
+        } while( n > 0 );
+    }
+    \endcode
+*/
+
+
+/* ----------------------------------------------------------------------- */
+/** Initialize a batch decoder
+
+    \param batch pointer to the batch state
+    \param timeout number of lines an incomplete multipart message is kept
+                   for, 0 to keep it until it is completed or pushed out
+
+    returns:
+      - 0 if no error
+      - 1 if there was an error
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall init_ais_batch( ais_batch *batch, unsigned long timeout )
+{
+    if( !batch )
+        return 1;
+
+    memset( batch, 0, sizeof( ais_batch ) );
+    init_reasm( &batch->reasm, timeout );
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Decode a buffer of AIVDM/AIVDO sentences
+
+    \param batch pointer to the batch state
+    \param buf pointer to the sentences, one per line
+    \param len number of bytes in buf
+    \param records array to fill with the decoded messages
+    \param max_records number of entries in records
+    \param consumed set to the number of bytes of buf that were used
+
+    returns:
+      - number of records filled in
+      - -1 if there was an error
+
+    Lines are read until records is full or there are no more complete
+    lines in buf, the last line must end with a '\\n' to be used. Bytes
+    after *consumed have not been looked at yet and should be passed in
+    again with the rest of their line. Lines that are not AIVDM/AIVDO
+    are skipped, ones that fail their checksum are counted in
+    batch->errors.
+
+    Each completed message is parsed with parse_ais_any() and its tag
+    block and channel are stored with it. The data of message 6, 8 and
+    17 records points into the batch, it is valid until the next call.
+    Message 24 parts are returned as separate records. Unsupported
+    messages and messages that fail to parse are counted in
+    batch->errors and not returned.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall ais_decode_batch( ais_batch *batch, const char *buf, size_t len, ais_record *records, unsigned int max_records, size_t *consumed )
+{
+    nmea_state     nmea;
+    char           line[MAX_NMEA_LENGTH];
+    const char     *p;
+    const char     *end;
+    const char     *eol;
+    ais_record     *r;
+    sixbit_view    *data;
+    unsigned int   count;
+    unsigned int   payloads;
+    size_t         n;
+
+    if( !batch || !buf || !records || !consumed )
+        return -1;
+
+    count = 0;
+    payloads = 0;
+    p = buf;
+    end = buf + len;
+    while( (p < end) && (count < max_records) && (payloads < AIS_BATCH_PAYLOADS) )
+    {
+        eol = memchr( p, '\n', end - p );
+        if( !eol )
+            break;
+
+        n = eol - p;
+        batch->lines++;
+        if( n >= MAX_NMEA_LENGTH )
+        {
+            batch->errors++;
+            p = eol + 1;
+            continue;
+        }
+        memcpy( line, p, n );
+        line[n] = 0;
+
+        /* Skip anything that isn't a VDM/VDO sentence */
+        if( nmea_tokenize( &nmea, line ) != 0 )
+        {
+            if( is_vdm( &nmea ) )
+                batch->errors++;
+            p = eol + 1;
+            continue;
+        }
+        if( !is_vdm( &nmea ) )
+        {
+            p = eol + 1;
+            continue;
+        }
+
+        switch( reasm_vdm_tokens( &batch->reasm, &batch->state, &nmea, batch->lines ) )
+        {
+            case 0:
+                break;
+
+            case 1:
+                p = eol + 1;
+                continue;
+
+            default:
+                batch->errors++;
+                p = eol + 1;
+                continue;
+        }
+
+        r = &records[count];
+        r->msg.msgid = 0;
+        if( parse_ais_any( &batch->state, &r->msg ) != 0 )
+        {
+            batch->errors++;
+            p = eol + 1;
+            continue;
+        }
+        r->offset = p - buf;
+        r->channel = batch->state.channel;
+        r->tag = batch->state.tag;
+
+        /* Binary payloads are moved out of the state before it is reused */
+        data = NULL;
+        if( r->msg.msgid == 6 )
+            data = &r->msg.u.msg_6.data;
+        else if( r->msg.msgid == 8 )
+            data = &r->msg.u.msg_8.data;
+        else if( r->msg.msgid == 17 )
+            data = &r->msg.u.msg_17.data;
+        if( data )
+        {
+            batch->payload[batch->payload_next] = batch->state.six_state;
+            data->six = &batch->payload[batch->payload_next];
+            batch->payload_next = (batch->payload_next + 1) % AIS_BATCH_PAYLOADS;
+            payloads++;
+        }
+
+        count++;
+        p = eol + 1;
+    }
+
+    *consumed = p - buf;
+
+    return (int) count;
+}
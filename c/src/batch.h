@@ -0,0 +1,44 @@
+/* -----------------------------------------------------------------------
+   Batch decoding of AIVDM/AIVDO sentences
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>
+   All rights Reserved
+   ----------------------------------------------------------------------- */
+
+/*! \file
+    \brief Header file for batch.c
+
+    Requires nmea.h, sixbit.h, vdm_parse.h and reassembly.h to be
+    included first.
+*/
+
+/** Number of message 6, 8 and 17 payloads that one batch can return */
+#define AIS_BATCH_PAYLOADS  64
+
+
+/** One decoded message
+*/
+typedef struct {
+    size_t         offset;             //!< Offset in buf of the sentence that completed the message
+    char           channel;            //!< AIS Channel character
+    nmea_tag       tag;                //!< Tag block metadata from all the parts
+    aismsg_any     msg;                //!< The message, msg.msgid says which one
+} ais_record;
+
+
+/** State kept between calls to ais_decode_batch()
+
+    This is large, allocate it statically or from the heap.
+*/
+typedef struct {
+    reasm_table    reasm;              //!< Multipart messages in progress
+    ais_state      state;              //!< Last message assembled
+    unsigned long  lines;              //!< Lines read, used as the time for reasm
+    unsigned long  errors;             //!< Lines or messages that could not be decoded
+    unsigned int   payload_next;       //!< Next entry of payload to use
+    sixbit         payload[AIS_BATCH_PAYLOADS]; //!< Binary payloads the record views point into
+} ais_batch;
+
+
+/* Prototypes */
+int __stdcall init_ais_batch( ais_batch *batch, unsigned long timeout );
+int __stdcall ais_decode_batch( ais_batch *batch, const char *buf, size_t len, ais_record *records, unsigned int max_records, size_t *consumed );
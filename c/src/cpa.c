@@ -0,0 +1,335 @@
+/* -----------------------------------------------------------------------
+   Closest point of approach alerts
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>
+   All rights Reserved
+   ----------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "portable.h"
+#include "nmea.h"
+#include "sixbit.h"
+#include "vdm_parse.h"
+#include "mmsi_index.h"
+#include "grid.h"
+#include "cpa.h"
+
+/*! \file
+    \brief Closest point of approach alerts
+    \author Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>, All Rights Reserved
+    \version 1.8
+
+    A cpa_engine finds the pairs of vessels that are going to pass close
+    to each other. Checking every pair of vessels is O(n^2), instead the
+    engine keeps the last reported positions in an ais_grid and when a
+    vessel reports only the vessels within cpa_engine.range of it are
+    checked against it. Nothing is done for the vessels that didn't
+    report.
+
+    The other vessel's position is dead reckoned from its last report to
+    the time of the new one, then the closest point of approach (CPA)
+    and the time until it (TCPA) are worked out with both vessels
+    keeping their speed and course, on a flat projection around the
+    reporting vessel. When the CPA is no more than cpa_limit nautical
+    miles and the TCPA is from 0 to tcpa_limit seconds away the callback
+    is called with a cpa_alert.
+
+    Times are in seconds, eg. from time() or the tag block c: field.
+    Vessels without a speed, or with a speed but no course, are kept in
+    the grid but are not checked.
+
+    Example:
+    \code
+    void __stdcall got_alert( cpa_alert *alert, void *data )
+    {
+        printf( "%09lu %09lu %0.2fnm in %0.0fs\n", alert->userid, alert->other,
+                alert->cpa, alert->tcpa );
+    }
+
+    cpa_engine engine;
+    aismsg_any msg;
+
+    init_cpa_engine( &engine, 20000, got_alert, NULL );
+    engine.cpa_limit = 0.25;
+    ...
+    if( parse_ais_any( &ais, &msg ) == 0 )
+        cpa_update_msg( &engine, &msg, time( NULL ) );
+    \endcode
+*/
+
+
+/** Radians in 1/10 degree */
+#define CPA_RADIANS   (3.14159265358979323846 / 1800.0)
+
+/** Radians in 1/10000 minute */
+#define CPA_LAT_RADIANS  (3.14159265358979323846 / (180.0 * 600000.0))
+
+
+/** The vessel that just reported, for cpa_check() */
+typedef struct {
+    cpa_engine      *engine;
+    grid_entry      *entry;
+    cpa_motion      *motion;
+    unsigned long   now;
+    double          coslat;
+} cpa_context;
+
+
+/* ----------------------------------------------------------------------- */
+/** Initialize a CPA engine
+
+    \param engine pointer to the engine
+    \param vessels number of vessels it must be able to hold
+    \param callback function to call with each alert
+    \param data pointer passed to callback
+
+    returns:
+      - 0 if no error
+      - 1 if there was an error with the parameters
+      - 2 if memory could not be allocated
+
+    It is set up to look 10 miles around each vessel, alert for a CPA of
+    half a mile within 20 minutes and to ignore vessels not heard from
+    for 10 minutes.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall init_cpa_engine( cpa_engine *engine, unsigned long vessels, cpa_cb callback, void *data )
+{
+    int rv;
+
+    if( !engine || !callback )
+        return 1;
+
+    memset( engine, 0, sizeof( cpa_engine ) );
+    rv = init_ais_grid( &engine->grid, vessels, AIS_GRID_CELL );
+    if( rv != 0 )
+        return rv;
+    engine->motion = calloc( vessels, sizeof( cpa_motion ) );
+    if( !engine->motion )
+    {
+        free_ais_grid( &engine->grid );
+        return 2;
+    }
+
+    engine->range = 100000;
+    engine->cpa_limit = 0.5;
+    engine->tcpa_limit = 1200.0;
+    engine->max_age = 600;
+    engine->callback = callback;
+    engine->data = data;
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Free the memory used by a CPA engine
+
+    \param engine pointer to the engine
+*/
+/* ----------------------------------------------------------------------- */
+void __stdcall free_cpa_engine( cpa_engine *engine )
+{
+    if( !engine )
+        return;
+
+    free_ais_grid( &engine->grid );
+    free( engine->motion );
+    engine->motion = NULL;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Check one nearby vessel against the one that just reported */
+/* ----------------------------------------------------------------------- */
+static void __stdcall cpa_check( grid_entry *entry, void *data )
+{
+    cpa_context *ctx;
+    cpa_engine  *engine;
+    cpa_motion  *other;
+    cpa_alert   alert;
+    double      dt;
+    double      dx, dy;
+    double      vx, vy;
+    double      v2;
+    double      tcpa;
+    double      cx, cy;
+    long        dlon;
+
+    ctx = (cpa_context *) data;
+    engine = ctx->engine;
+    if( entry == ctx->entry )
+        return;
+
+    other = &engine->motion[entry - engine->grid.entries];
+    if( !other->known )
+        return;
+    if( engine->max_age && (ctx->now > other->time) && (ctx->now - other->time > engine->max_age) )
+        return;
+    engine->pairs++;
+
+    /* Where the other vessel is now, relative to this one */
+    dt = (double) ctx->now - (double) other->time;
+    dlon = entry->longitude - ctx->entry->longitude;
+    if( dlon > AIS_GRID_LON_MAX )
+        dlon -= 2 * AIS_GRID_LON_MAX;
+    if( dlon < -AIS_GRID_LON_MAX )
+        dlon += 2 * AIS_GRID_LON_MAX;
+    dx = dlon / 10000.0 * ctx->coslat + other->vx * dt;
+    dy = (entry->latitude - ctx->entry->latitude) / 10000.0 + other->vy * dt;
+
+    /* Relative speed, and the time it brings them closest */
+    vx = other->vx - ctx->motion->vx;
+    vy = other->vy - ctx->motion->vy;
+    v2 = vx * vx + vy * vy;
+    tcpa = (v2 > 1e-12) ? -(dx * vx + dy * vy) / v2 : 0.0;
+    if( (tcpa < 0.0) || (tcpa > engine->tcpa_limit) )
+        return;
+
+    cx = dx + vx * tcpa;
+    cy = dy + vy * tcpa;
+    alert.cpa = sqrt( cx * cx + cy * cy );
+    if( alert.cpa > engine->cpa_limit )
+        return;
+
+    alert.userid = ctx->entry->userid;
+    alert.other = entry->userid;
+    alert.time = ctx->now;
+    alert.range = sqrt( dx * dx + dy * dy );
+    alert.tcpa = tcpa;
+    engine->alerts++;
+    engine->callback( &alert, engine->data );
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Update a vessel and check it against the vessels near it
+
+    \param engine pointer to the engine
+    \param userid MMSI of the vessel
+    \param latitude latitude in 1/10000 minute
+    \param longitude longitude in 1/10000 minute
+    \param sog speed over ground in 1/10 knot, 1023 = N/A
+    \param cog course over ground in 1/10 degree, 3600 = N/A
+    \param now time of the report in seconds
+
+    returns:
+      - 0 if no error
+      - 1 if the position is not available
+      - 2 if it is a new vessel and the engine is full
+
+    The callback is called for each alert before this returns.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall cpa_update( cpa_engine *engine, unsigned long userid, long latitude, long longitude,
+                          int sog, int cog, unsigned long now )
+{
+    cpa_context ctx;
+    cpa_motion  *motion;
+    double      speed;
+    int         rv;
+
+    if( !engine || !engine->motion )
+        return 1;
+
+    rv = grid_update( &engine->grid, userid, latitude, longitude );
+    if( rv != 0 )
+        return rv;
+    engine->updates++;
+
+    ctx.engine = engine;
+    ctx.entry = grid_find( &engine->grid, userid );
+    ctx.motion = motion = &engine->motion[ctx.entry - engine->grid.entries];
+    ctx.now = now;
+    ctx.coslat = cos( latitude * CPA_LAT_RADIANS );
+
+    motion->time = now;
+    motion->known = 1;
+    if( (sog >= 1023) || ((cog >= 3600) && (sog > 0)) )
+    {
+        motion->known = 0;
+        motion->vx = motion->vy = 0.0;
+        return 0;
+    }
+    speed = sog / 10.0 / 3600.0;
+    motion->vx = speed * sin( cog * CPA_RADIANS );
+    motion->vy = speed * cos( cog * CPA_RADIANS );
+
+    grid_radius( &engine->grid, latitude, longitude, engine->range, cpa_check, &ctx );
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Update a vessel from a parsed message
+
+    \param engine pointer to the engine
+    \param msg message from parse_ais_any()
+    \param now time of the report in seconds
+
+    Returns the same as cpa_update(), 1 if the message isn't a message 1,
+    2, 3, 18 or 19 position report.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall cpa_update_msg( cpa_engine *engine, aismsg_any *msg, unsigned long now )
+{
+    if( !msg )
+        return 1;
+
+    switch( msg->msgid )
+    {
+        case 1:
+            return cpa_update( engine, msg->u.msg_1.userid, msg->u.msg_1.latitude, msg->u.msg_1.longitude,
+                               msg->u.msg_1.sog, msg->u.msg_1.cog, now );
+        case 2:
+            return cpa_update( engine, msg->u.msg_2.userid, msg->u.msg_2.latitude, msg->u.msg_2.longitude,
+                               msg->u.msg_2.sog, msg->u.msg_2.cog, now );
+        case 3:
+            return cpa_update( engine, msg->u.msg_3.userid, msg->u.msg_3.latitude, msg->u.msg_3.longitude,
+                               msg->u.msg_3.sog, msg->u.msg_3.cog, now );
+        case 18:
+            return cpa_update( engine, msg->u.msg_18.userid, msg->u.msg_18.latitude, msg->u.msg_18.longitude,
+                               msg->u.msg_18.sog, msg->u.msg_18.cog, now );
+        case 19:
+            return cpa_update( engine, msg->u.msg_19.userid, msg->u.msg_19.latitude, msg->u.msg_19.longitude,
+                               msg->u.msg_19.sog, msg->u.msg_19.cog, now );
+    }
+
+    return 1;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Remove vessels that haven't reported
+
+    \param engine pointer to the engine
+    \param now current time in seconds
+    \param age time since the last report
+
+    Returns the number of vessels removed.
+*/
+/* ----------------------------------------------------------------------- */
+unsigned long __stdcall cpa_expire( cpa_engine *engine, unsigned long now, unsigned long age )
+{
+    grid_entry    *entry;
+    unsigned long i;
+    unsigned long n;
+
+    if( !engine || !engine->motion )
+        return 0;
+
+    n = 0;
+    for( i = 0; i < engine->grid.max; i++ )
+    {
+        entry = &engine->grid.entries[i];
+        if( entry->userid && (now > engine->motion[i].time) && (now - engine->motion[i].time > age) )
+        {
+            grid_remove( &engine->grid, entry->userid );
+            n++;
+        }
+    }
+
+    return n;
+}
@@ -0,0 +1,63 @@
+/* -----------------------------------------------------------------------
+   Closest point of approach alerts
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>
+   All rights Reserved
+   ----------------------------------------------------------------------- */
+
+/*! \file
+    \brief Header file for cpa.c
+
+    Requires nmea.h, sixbit.h, vdm_parse.h and grid.h to be included
+    first.
+*/
+
+/** A pair of vessels that will pass close to each other
+*/
+typedef struct {
+    unsigned long   userid;            //!< Vessel that just reported
+    unsigned long   other;             //!< Vessel it will pass close to
+    unsigned long   time;              //!< Time of the report
+    double          range;             //!< Distance between them now, in nautical miles
+    double          cpa;               //!< Closest point of approach, in nautical miles
+    double          tcpa;              //!< Time to the closest point of approach, in seconds
+} cpa_alert;
+
+
+/** Called for each pair under the engine's limits */
+typedef void (__stdcall *cpa_cb)( cpa_alert *alert, void *data );
+
+
+/** Motion of a vessel, kept alongside its grid entry
+*/
+typedef struct {
+    unsigned long   time;              //!< Time of the last report
+    double          vx;                //!< Speed east in nautical miles per second
+    double          vy;                //!< Speed north in nautical miles per second
+    unsigned char   known;             //!< 1 if the speed and course are available
+} cpa_motion;
+
+
+/** CPA/TCPA engine settings and state
+*/
+typedef struct {
+    ais_grid        grid;              //!< Last reported positions
+    cpa_motion      *motion;           //!< Indexed like grid.entries
+    long            range;             //!< Search radius in 1/10000 nautical mile
+    double          cpa_limit;         //!< Alert when the CPA is this close, in nautical miles
+    double          tcpa_limit;        //!< and it is no more than this many seconds away
+    unsigned long   max_age;           //!< Ignore vessels not heard from for this long, 0 = never
+    cpa_cb          callback;          //!< Called with each alert
+    void            *data;             //!< Passed to callback
+    unsigned long   updates;           //!< Reports used
+    unsigned long   pairs;             //!< Pairs checked
+    unsigned long   alerts;            //!< Alerts passed to callback
+} cpa_engine;
+
+
+/* Prototypes */
+int __stdcall init_cpa_engine( cpa_engine *engine, unsigned long vessels, cpa_cb callback, void *data );
+void __stdcall free_cpa_engine( cpa_engine *engine );
+int __stdcall cpa_update( cpa_engine *engine, unsigned long userid, long latitude, long longitude,
+                          int sog, int cog, unsigned long now );
+int __stdcall cpa_update_msg( cpa_engine *engine, aismsg_any *msg, unsigned long now );
+unsigned long __stdcall cpa_expire( cpa_engine *engine, unsigned long now, unsigned long age );
@@ -0,0 +1,305 @@
+/* -----------------------------------------------------------------------
+   Duplicate message suppression for merged receiver feeds
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>
+   All rights Reserved
+   ----------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "portable.h"
+#include "nmea.h"
+#include "sixbit.h"
+#include "vdm_parse.h"
+#include "dedupe.h"
+
+/*! \file
+    \brief Duplicate message suppression for merged receiver feeds
+    \author Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>, All Rights Reserved
+    \version 1.8
+
+    When the feeds of several shore stations are merged, the same
+    transmission is often heard by several of them. An ais_dedupe
+    remembers a 64-bit hash of each assembled payload for a short
+    window. Later copies of a message are found before any fields are
+    decoded, and they can be dropped.
+
+    The memory is fixed when the ais_dedupe is set up. The hashes are
+    kept in AIS_DEDUPE_GENERATIONS open addressed tables. Each table
+    holds the messages first seen during one span of window /
+    (AIS_DEDUPE_GENERATIONS - 1) seconds. When time moves into a new
+    span, the table of the oldest span is cleared and reused, so nothing
+    has to be expired one by one.
+
+    The station is taken from the tag block s: of the message. For each
+    station, the counters record how many messages it was the first to
+    pass on and how many copies it heard of messages passed on by
+    another station. heard[] also counts, for each pair of stations, the
+    copies heard by one of messages first passed on by the other. This
+    can be used to check the coverage of the stations.
+
+    Example:
+    \code
+    ais_state  ais;
+    ais_dedupe dedupe;
+
+    memset( &ais, 0, sizeof( ais_state ) );
+    init_ais_dedupe( &dedupe, 20000, AIS_DEDUPE_WINDOW );
+    ...
+    if( assemble_vdm_dedupe( &ais, &dedupe, buf, time( NULL ) ) == 0 )
+    {
+        parse the first copy of the message
+    }
+    \endcode
+*/
+
+
+/* ----------------------------------------------------------------------- */
+/* Hash of the de-armored payload, never 0 */
+/* ----------------------------------------------------------------------- */
+static sixbit_word dedupe_hash( sixbit *six )
+{
+    sixbit_word  h;
+    sixbit_word  w;
+    unsigned int i;
+    unsigned int n;
+
+    h = (sixbit_word) six->num_bits * (sixbit_word) 0x9E3779B97F4A7C15;
+    n = (six->num_bits + 63) / 64;
+    for( i = 0; i < n; i++ )
+    {
+        w = six->words[i];
+
+        /* Leave out the fill bits */
+        if( (i == n - 1) && (six->num_bits & 63) )
+            w &= ~(sixbit_word) 0 << (64 - (six->num_bits & 63));
+
+        h ^= w;
+        h *= (sixbit_word) 0xFF51AFD7ED558CCD;
+        h ^= h >> 32;
+    }
+    h ^= h >> 29;
+
+    return h ? h : 1;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Initialize duplicate suppression
+
+    \param dedupe pointer to the ais_dedupe
+    \param messages most different messages expected in a window
+    \param window seconds to look for copies of a message
+
+    returns:
+      - 0 if no error
+      - 1 if there was an error with the parameters
+      - 2 if memory could not be allocated
+
+    Each generation is sized to hold all of messages. When one fills up,
+    new messages are still passed on but they are not remembered.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall init_ais_dedupe( ais_dedupe *dedupe, unsigned long messages, unsigned long window )
+{
+    unsigned long size;
+
+    if( !dedupe || !messages || !window )
+        return 1;
+
+    memset( dedupe, 0, sizeof( ais_dedupe ) );
+
+    /* Keep each generation no more than 3/4 full */
+    size = 16;
+    while( size - size / 4 < messages )
+        size *= 2;
+
+    dedupe->slots = calloc( size * AIS_DEDUPE_GENERATIONS, sizeof( dedupe_slot ) );
+    dedupe->heard = calloc( AIS_DEDUPE_STATIONS * AIS_DEDUPE_STATIONS, sizeof( unsigned long ) );
+    if( !dedupe->slots || !dedupe->heard )
+    {
+        free_ais_dedupe( dedupe );
+        return 2;
+    }
+    dedupe->size = size;
+    dedupe->window = window;
+    dedupe->span = (window + AIS_DEDUPE_GENERATIONS - 2) / (AIS_DEDUPE_GENERATIONS - 1);
+    dedupe->num_stations = 1;
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Free the memory used by duplicate suppression
+
+    \param dedupe pointer to the ais_dedupe
+*/
+/* ----------------------------------------------------------------------- */
+void __stdcall free_ais_dedupe( ais_dedupe *dedupe )
+{
+    if( !dedupe )
+        return;
+
+    free( dedupe->slots );
+    free( dedupe->heard );
+    dedupe->slots = NULL;
+    dedupe->heard = NULL;
+    dedupe->size = 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Find the number of a station
+
+    \param dedupe pointer to the ais_dedupe
+    \param source tag block s: of the station
+
+    Returns the station's index in dedupe->station, adding it if it
+    hasn't been seen before. 0 is returned for no source, and for new
+    stations once AIS_DEDUPE_STATIONS - 1 have been added.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall ais_dedupe_station( ais_dedupe *dedupe, const char *source )
+{
+    const unsigned char *p;
+    unsigned long       h;
+    unsigned int        i;
+    unsigned int        s;
+
+    if( !dedupe || !source || !*source )
+        return 0;
+
+    h = 2166136261UL;
+    for( p = (const unsigned char *) source; *p; p++ )
+        h = ((h ^ *p) * 16777619UL) & 0xFFFFFFFFUL;
+
+    for( i = h & (AIS_DEDUPE_STATIONS * 2 - 1); (s = dedupe->index[i]) != 0; i = (i + 1) & (AIS_DEDUPE_STATIONS * 2 - 1) )
+    {
+        if( strcmp( dedupe->station[s].source, source ) == 0 )
+            return (int) s;
+    }
+
+    if( dedupe->num_stations >= AIS_DEDUPE_STATIONS )
+        return 0;
+
+    s = dedupe->num_stations++;
+    strncpy( dedupe->station[s].source, source, NMEA_TAG_SOURCE_LEN - 1 );
+    dedupe->index[i] = (unsigned char) s;
+
+    return (int) s;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Check if a message is a copy of one already seen
+
+    \param dedupe pointer to the ais_dedupe
+    \param state ais_state that assemble_vdm() just returned 0 for
+    \param now time of the message in seconds
+
+    returns:
+      - 1 if it is a copy of a message seen in the last window seconds
+      - 0 if it is the first copy, or there was an error with the parameters
+
+    now may be the time it was received or the tag block c: time. Times
+    older than the latest one seen are taken to be the latest one.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall ais_dedupe_check( ais_dedupe *dedupe, ais_state *state, unsigned long now )
+{
+    dedupe_slot   *table;
+    dedupe_slot   *slot;
+    sixbit_word   hash;
+    unsigned long epoch;
+    unsigned long mask;
+    unsigned long i;
+    unsigned int  station;
+    unsigned int  g;
+
+    if( !dedupe || !dedupe->slots || !state )
+        return 0;
+
+    station = 0;
+    if( state->tag.flags & NMEA_TAG_SOURCE )
+        station = (unsigned int) ais_dedupe_station( dedupe, state->tag.source );
+
+    if( now < dedupe->latest )
+        now = dedupe->latest;
+    dedupe->latest = now;
+    epoch = now / dedupe->span;
+    mask = dedupe->size - 1;
+    hash = dedupe_hash( &state->six_state );
+
+    /* Look in each generation still in the window */
+    for( g = 0; g < AIS_DEDUPE_GENERATIONS; g++ )
+    {
+        if( !dedupe->count[g] || (dedupe->epoch[g] + AIS_DEDUPE_GENERATIONS <= epoch) )
+            continue;
+
+        table = &dedupe->slots[g * dedupe->size];
+        for( i = (unsigned long) hash & mask; table[i].hash; i = (i + 1) & mask )
+        {
+            slot = &table[i];
+            if( (slot->hash != hash) || (now - slot->time > dedupe->window) )
+                continue;
+
+            dedupe->duplicates++;
+            dedupe->station[station].copies++;
+            dedupe->heard[slot->station * AIS_DEDUPE_STATIONS + station]++;
+            return 1;
+        }
+    }
+
+    /* First copy, clear out the oldest generation if time has moved on */
+    dedupe->unique++;
+    dedupe->station[station].first++;
+    g = epoch % AIS_DEDUPE_GENERATIONS;
+    table = &dedupe->slots[g * dedupe->size];
+    if( dedupe->epoch[g] != epoch )
+    {
+        if( dedupe->count[g] )
+            memset( table, 0, dedupe->size * sizeof( dedupe_slot ) );
+        dedupe->count[g] = 0;
+        dedupe->epoch[g] = epoch;
+    }
+    if( dedupe->count[g] >= dedupe->size - dedupe->size / 4 )
+    {
+        dedupe->full++;
+        return 0;
+    }
+
+    for( i = (unsigned long) hash & mask; table[i].hash; i = (i + 1) & mask )
+        ;
+    table[i].hash = hash;
+    table[i].time = now;
+    table[i].station = station;
+    dedupe->count[g]++;
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Assemble AIVDM/VDO sentences, dropping copies of complete messages
+
+    \param state pointer to ais_state
+    \param dedupe pointer to the ais_dedupe
+    \param str pointer to the NMEA 0183 sentence
+    \param now time of the sentence in seconds
+
+    Returns the same values as assemble_vdm() and
+        - 8 Copy of a message already seen
+
+    Pass NULL for dedupe to do no checking.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall assemble_vdm_dedupe( ais_state *state, ais_dedupe *dedupe, char *str, unsigned long now )
+{
+    int rv;
+
+    rv = assemble_vdm( state, str );
+    if( (rv == 0) && ais_dedupe_check( dedupe, state, now ) )
+        return 8;
+
+    return rv;
+}
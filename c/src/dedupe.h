@@ -0,0 +1,66 @@
+/* -----------------------------------------------------------------------
+   Duplicate message suppression for merged receiver feeds
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>
+   All rights Reserved
+   ----------------------------------------------------------------------- */
+
+/*! \file
+    \brief Header file for dedupe.c
+
+    Requires nmea.h, sixbit.h and vdm_parse.h to be included first.
+*/
+
+/** Default window in seconds that copies are looked for in */
+#define AIS_DEDUPE_WINDOW       10
+
+/** Number of time buckets, the oldest is cleared to make room */
+#define AIS_DEDUPE_GENERATIONS  4
+
+/** Most stations counted, station 0 is for no or too many stations */
+#define AIS_DEDUPE_STATIONS     64
+
+
+/** A message seen in the window, hash is 0 for an unused slot
+*/
+typedef struct {
+    sixbit_word     hash;              //!< Hash of the payload
+    unsigned long   time;              //!< When it was first seen
+    unsigned int    station;           //!< Station that heard it first
+} dedupe_slot;
+
+
+/** Counts for one receiving station
+*/
+typedef struct {
+    char            source[NMEA_TAG_SOURCE_LEN];   //!< Tag block s: of the station
+    unsigned long   first;             //!< Messages it was the first to pass on
+    unsigned long   copies;            //!< Messages it heard after another station
+} dedupe_station;
+
+
+/** Duplicate suppression state, its memory is fixed by init_ais_dedupe()
+*/
+typedef struct {
+    unsigned long   window;            //!< Seconds a copy is looked for
+    unsigned long   span;              //!< Seconds in each generation
+    dedupe_slot     *slots;            //!< AIS_DEDUPE_GENERATIONS * size slots
+    unsigned long   size;              //!< Slots in each generation, a power of 2
+    unsigned long   count[AIS_DEDUPE_GENERATIONS];  //!< Messages in each generation
+    unsigned long   epoch[AIS_DEDUPE_GENERATIONS];  //!< time / span of each generation
+    unsigned long   latest;            //!< Latest time seen
+    dedupe_station  station[AIS_DEDUPE_STATIONS];   //!< Counts by station
+    unsigned int    num_stations;      //!< Stations in station, including station 0
+    unsigned char   index[AIS_DEDUPE_STATIONS * 2]; //!< Hash of the station names
+    unsigned long   *heard;            //!< [first * AIS_DEDUPE_STATIONS + other] copies heard by other
+    unsigned long   unique;            //!< First copies passed on
+    unsigned long   duplicates;        //!< Copies found
+    unsigned long   full;              //!< Messages not remembered because a generation was full
+} ais_dedupe;
+
+
+/* Prototypes */
+int __stdcall init_ais_dedupe( ais_dedupe *dedupe, unsigned long messages, unsigned long window );
+void __stdcall free_ais_dedupe( ais_dedupe *dedupe );
+int __stdcall ais_dedupe_station( ais_dedupe *dedupe, const char *source );
+int __stdcall ais_dedupe_check( ais_dedupe *dedupe, ais_state *state, unsigned long now );
+int __stdcall assemble_vdm_dedupe( ais_state *state, ais_dedupe *dedupe, char *str, unsigned long now );
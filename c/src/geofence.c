@@ -0,0 +1,817 @@
+/* -----------------------------------------------------------------------
+   Geofence enter and exit events
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>
+   All rights Reserved
+   ----------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "portable.h"
+#include "nmea.h"
+#include "sixbit.h"
+#include "vdm_parse.h"
+#include "mmsi_index.h"
+#include "geofence.h"
+
+/*! \file
+    \brief Geofence enter and exit events
+    \author Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>, All Rights Reserved
+    \version 1.8
+
+    A geofence holds a set of polygons, eg. ports, anchorages and
+    restricted areas, and calls a callback when a vessel's reports move
+    it into or out of one of them.
+
+    Testing every report against every polygon is too slow when there
+    are hundreds of them, so once they have all been added
+    geofence_build() rasterizes them onto a grid of cell x cell squares.
+    Each cell is marked inside, outside or on the edge of each fence
+    that covers it. Only the cells with a mark are kept, in a hash. A
+    report's cell is looked up, inside marks are taken as they are and
+    the exact point in polygon test is only done for the edge marks.
+    Everything is done in the 1/10000 minute units of the messages, so
+    there is no need to call pos2ddd().
+
+    Fences must not cross the 180th meridian, split them into an east
+    and a west part with the same id.
+
+    Example:
+    \code
+    void __stdcall got_event( geofence_event *event, void *data )
+    {
+        printf( "%09lu %s %lu\n", event->userid,
+                (event->event == GEOFENCE_ENTER) ? "entered" : "left", event->id );
+    }
+
+    geofence       gf;
+    geofence_point harbor[4];
+    aismsg_any     msg;
+
+    init_geofence( &gf, 20000, GEOFENCE_CELL, got_event, NULL );
+    ... fill in harbor
+    geofence_add( &gf, 1, harbor, 4 );
+    geofence_build( &gf );
+    ...
+    if( parse_ais_any( &ais, &msg ) == 0 )
+        geofence_update_msg( &gf, &msg, time( NULL ) );
+    \endcode
+*/
+
+
+/** 180 degrees and 90 degrees in 1/10000 minute */
+#define GEOFENCE_LON_MAX    108000000L
+#define GEOFENCE_LAT_MAX    54000000L
+
+#ifdef _MSC_VER
+typedef __int64   geofence_int;
+#else
+typedef long long geofence_int;
+#endif
+
+
+/** Mark for one cell of one fence, sorted into cell order by geofence_build() */
+typedef struct {
+    long            cell_x;
+    long            cell_y;
+    unsigned long   mark;
+} geofence_raster;
+
+
+/* ----------------------------------------------------------------------- */
+/* Slot in the cell hash that a cell's probe starts at */
+/* ----------------------------------------------------------------------- */
+static unsigned long geofence_cell_home( geofence *gf, long cell_x, long cell_y )
+{
+    unsigned long h;
+
+    h = ((unsigned long) cell_x * 73856093UL) ^ ((unsigned long) cell_y * 19349663UL);
+    h ^= (h & 0xFFFFFFFFUL) >> 15;
+
+    return h & (gf->cell_size - 1);
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* The vessel hash */
+/* ----------------------------------------------------------------------- */
+static void geofence_vessel_index( geofence *gf, mmsi_index *index )
+{
+    init_mmsi_index( index, gf->vessels, sizeof( geofence_vessel ), sizeof( gf->vessels->userid ),
+                     gf->vessel_size );
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Column and row of the cell a position is in, positions are moved to
+   be 0 or more so the division rounds down
+*/
+/* ----------------------------------------------------------------------- */
+static long geofence_cell_x( geofence *gf, long longitude )
+{
+    return (longitude + GEOFENCE_LON_MAX) / gf->cell;
+}
+
+static long geofence_cell_y( geofence *gf, long latitude )
+{
+    return (latitude + GEOFENCE_LAT_MAX) / gf->cell;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Initialize a geofence
+
+    \param gf pointer to the geofence
+    \param vessels number of vessels it must be able to track
+    \param cell raster cell size in 1/10000 minute, 0 for GEOFENCE_CELL
+    \param callback function to call with each event
+    \param data pointer passed to callback
+
+    returns:
+      - 0 if no error
+      - 1 if there was an error with the parameters
+      - 2 if memory could not be allocated
+
+    The cell size is a trade off, smaller cells use more memory and
+    take longer to build but leave fewer reports needing the exact
+    test.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall init_geofence( geofence *gf, unsigned long vessels, long cell, geofence_cb callback, void *data )
+{
+    unsigned long size;
+
+    if( !gf || !vessels || (cell < 0) || !callback )
+        return 1;
+
+    memset( gf, 0, sizeof( geofence ) );
+    gf->cell = cell ? cell : GEOFENCE_CELL;
+    gf->callback = callback;
+    gf->data = data;
+
+    size = mmsi_index_size( vessels );
+    gf->vessels = calloc( size, sizeof( geofence_vessel ) );
+    if( !gf->vessels )
+        return 2;
+    gf->vessel_size = size;
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Free the raster */
+/* ----------------------------------------------------------------------- */
+static void geofence_free_raster( geofence *gf )
+{
+    free( gf->cells );
+    free( gf->marks );
+    gf->cells = NULL;
+    gf->marks = NULL;
+    gf->cell_size = 0;
+    gf->num_marks = 0;
+    gf->built = 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Free the memory used by a geofence
+
+    \param gf pointer to the geofence
+*/
+/* ----------------------------------------------------------------------- */
+void __stdcall free_geofence( geofence *gf )
+{
+    unsigned int i;
+
+    if( !gf )
+        return;
+
+    geofence_free_raster( gf );
+    for( i = 0; i < gf->num_fences; i++ )
+        free( gf->fences[i].points );
+    free( gf->fences );
+    free( gf->vessels );
+    gf->fences = NULL;
+    gf->num_fences = 0;
+    gf->max_fences = 0;
+    gf->vessels = NULL;
+    gf->vessel_size = 0;
+    gf->vessel_count = 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Add a fence
+
+    \param gf pointer to the geofence
+    \param id caller's ID for the fence, passed back in its events
+    \param points corners of the fence, in order around it
+    \param num_points number of corners, at least 3
+
+    returns:
+      - 0 if no error
+      - 1 if there was an error with the parameters
+      - 2 if memory could not be allocated
+
+    The points are copied. geofence_build() must be called after the
+    last fence has been added.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall geofence_add( geofence *gf, unsigned long id, geofence_point *points, unsigned int num_points )
+{
+    ais_fence    *fence;
+    unsigned int i;
+
+    if( !gf || !gf->vessels || !points || (num_points < 3) )
+        return 1;
+
+    for( i = 0; i < num_points; i++ )
+    {
+        if(    (points[i].latitude < -GEOFENCE_LAT_MAX) || (points[i].latitude > GEOFENCE_LAT_MAX)
+            || (points[i].longitude < -GEOFENCE_LON_MAX) || (points[i].longitude > GEOFENCE_LON_MAX) )
+            return 1;
+    }
+
+    if( gf->num_fences == gf->max_fences )
+    {
+        fence = realloc( gf->fences, (gf->max_fences ? gf->max_fences * 2 : 16) * sizeof( ais_fence ) );
+        if( !fence )
+            return 2;
+        gf->fences = fence;
+        gf->max_fences = gf->max_fences ? gf->max_fences * 2 : 16;
+    }
+
+    fence = &gf->fences[gf->num_fences];
+    fence->points = malloc( num_points * sizeof( geofence_point ) );
+    if( !fence->points )
+        return 2;
+    memcpy( fence->points, points, num_points * sizeof( geofence_point ) );
+    fence->id = id;
+    fence->num_points = num_points;
+
+    fence->lon_min = fence->lon_max = points[0].longitude;
+    fence->lat_min = fence->lat_max = points[0].latitude;
+    for( i = 1; i < num_points; i++ )
+    {
+        if( points[i].longitude < fence->lon_min )
+            fence->lon_min = points[i].longitude;
+        if( points[i].longitude > fence->lon_max )
+            fence->lon_max = points[i].longitude;
+        if( points[i].latitude < fence->lat_min )
+            fence->lat_min = points[i].latitude;
+        if( points[i].latitude > fence->lat_max )
+            fence->lat_max = points[i].latitude;
+    }
+
+    gf->num_fences++;
+    gf->built = 0;
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Exact point in polygon test, counting the edges crossed by a line
+   east from the point. Returns 1 if it is inside.
+*/
+/* ----------------------------------------------------------------------- */
+static int geofence_inside( ais_fence *fence, long latitude, long longitude )
+{
+    geofence_point *a;
+    geofence_point *b;
+    geofence_int   lhs, rhs;
+    unsigned int   i;
+    int            inside;
+
+    inside = 0;
+    b = &fence->points[fence->num_points - 1];
+    for( i = 0; i < fence->num_points; i++ )
+    {
+        a = &fence->points[i];
+        if( (a->latitude > latitude) != (b->latitude > latitude) )
+        {
+            /* Is the point west of where the edge crosses its latitude */
+            lhs = (geofence_int) (longitude - a->longitude) * (b->latitude - a->latitude);
+            rhs = (geofence_int) (b->longitude - a->longitude) * (latitude - a->latitude);
+            if( (b->latitude > a->latitude) ? (lhs < rhs) : (lhs > rhs) )
+                inside = !inside;
+        }
+        b = a;
+    }
+
+    return inside;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Mark the cells of a fence's bounding box that its edges pass through.
+   The cells are marked on the generous side, a point on the line
+   between two cells marks both.
+*/
+/* ----------------------------------------------------------------------- */
+static void geofence_edges( geofence *gf, ais_fence *fence, unsigned char *edge, long x0, long y0, long w )
+{
+    geofence_point *a;
+    geofence_point *b;
+    unsigned int   i;
+    long           west, east;
+    long           x;
+    long           y, y1, y2;
+    double         lon1, lon2;
+    double         lat1, lat2;
+    double         slope;
+    double         swap;
+
+    b = &fence->points[fence->num_points - 1];
+    for( i = 0; i < fence->num_points; i++ )
+    {
+        a = &fence->points[i];
+        west = (a->longitude < b->longitude) ? a->longitude : b->longitude;
+        east = (a->longitude < b->longitude) ? b->longitude : a->longitude;
+        slope = (west == east) ? 0.0
+              : (double) (b->latitude - a->latitude) / (double) (b->longitude - a->longitude);
+
+        /* The part of the edge in each column */
+        for( x = geofence_cell_x( gf, west ); x <= geofence_cell_x( gf, east ); x++ )
+        {
+            lon1 = (double) x * gf->cell - GEOFENCE_LON_MAX;
+            lon2 = lon1 + gf->cell;
+            if( lon1 < west )
+                lon1 = west;
+            if( lon2 > east )
+                lon2 = east;
+            lat1 = a->latitude + (lon1 - a->longitude) * slope;
+            lat2 = (west == east) ? b->latitude : a->latitude + (lon2 - a->longitude) * slope;
+            if( lat1 > lat2 )
+            {
+                swap = lat1;
+                lat1 = lat2;
+                lat2 = swap;
+            }
+
+            /* A unit either way covers rounding and the line between rows */
+            y1 = geofence_cell_y( gf, (long) lat1 - 1 );
+            y2 = geofence_cell_y( gf, (long) lat2 + 1 );
+            if( y1 < y0 )
+                y1 = y0;
+            if( y2 > geofence_cell_y( gf, fence->lat_max ) )
+                y2 = geofence_cell_y( gf, fence->lat_max );
+            for( y = y1; y <= y2; y++ )
+                edge[(y - y0) * w + (x - x0)] = 1;
+        }
+        b = a;
+    }
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Sort raster marks by cell */
+/* ----------------------------------------------------------------------- */
+static int geofence_raster_cmp( const void *a, const void *b )
+{
+    const geofence_raster *ra = (const geofence_raster *) a;
+    const geofence_raster *rb = (const geofence_raster *) b;
+
+    if( ra->cell_x != rb->cell_x )
+        return (ra->cell_x < rb->cell_x) ? -1 : 1;
+    if( ra->cell_y != rb->cell_y )
+        return (ra->cell_y < rb->cell_y) ? -1 : 1;
+    if( ra->mark != rb->mark )
+        return (ra->mark < rb->mark) ? -1 : 1;
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Rasterize the fences
+
+    \param gf pointer to the geofence
+
+    returns:
+      - 0 if no error
+      - 1 if there was an error with the parameters
+      - 2 if memory could not be allocated
+
+    Must be called after adding fences and before the next update.
+    Vessels keep the fences they are inside of, as long as fences are
+    only added and not replaced.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall geofence_build( geofence *gf )
+{
+    geofence_raster *raster;
+    geofence_raster *more;
+    geofence_cell   *cell;
+    ais_fence       *fence;
+    unsigned char   *edge;
+    unsigned long   num_raster;
+    unsigned long   max_raster;
+    unsigned long   num_cells;
+    unsigned long   size;
+    unsigned long   i, j;
+    unsigned int    f;
+    long            x0, y0, x1, y1;
+    long            x, y, w, h;
+    long            run;
+    int             inside;
+
+    if( !gf || !gf->vessels )
+        return 1;
+
+    geofence_free_raster( gf );
+
+    raster = NULL;
+    num_raster = 0;
+    max_raster = 0;
+    for( f = 0; f < gf->num_fences; f++ )
+    {
+        fence = &gf->fences[f];
+        x0 = geofence_cell_x( gf, fence->lon_min );
+        y0 = geofence_cell_y( gf, fence->lat_min );
+        x1 = geofence_cell_x( gf, fence->lon_max );
+        y1 = geofence_cell_y( gf, fence->lat_max );
+        w = x1 - x0 + 1;
+        h = y1 - y0 + 1;
+
+        edge = calloc( (size_t) w * h, 1 );
+        if( !edge )
+        {
+            free( raster );
+            return 2;
+        }
+        geofence_edges( gf, fence, edge, x0, y0, w );
+
+        if( num_raster + (unsigned long) w * h > max_raster )
+        {
+            while( num_raster + (unsigned long) w * h > max_raster )
+                max_raster = max_raster ? max_raster * 2 : 1024;
+            more = realloc( raster, max_raster * sizeof( geofence_raster ) );
+            if( !more )
+            {
+                free( edge );
+                free( raster );
+                return 2;
+            }
+            raster = more;
+        }
+
+        /* Cells between edge cells in a row are all in or all out,
+           test one of each run against the polygon
+        */
+        for( y = 0; y < h; y++ )
+        {
+            run = -1;
+            inside = 0;
+            for( x = 0; x < w; x++ )
+            {
+                if( edge[y * w + x] )
+                {
+                    run = -1;
+                    raster[num_raster].mark = f * 2UL + 1;
+                } else {
+                    if( run < 0 )
+                    {
+                        run = x;
+                        inside = geofence_inside( fence,
+                                    (y + y0) * gf->cell + gf->cell / 2 - GEOFENCE_LAT_MAX,
+                                    (x + x0) * gf->cell + gf->cell / 2 - GEOFENCE_LON_MAX );
+                    }
+                    if( !inside )
+                        continue;
+                    raster[num_raster].mark = f * 2UL;
+                }
+                raster[num_raster].cell_x = x + x0;
+                raster[num_raster].cell_y = y + y0;
+                num_raster++;
+            }
+        }
+        free( edge );
+    }
+
+    if( num_raster )
+        qsort( raster, num_raster, sizeof( geofence_raster ), geofence_raster_cmp );
+
+    /* Count the cells and size the hash to be no more than 3/4 full */
+    num_cells = 0;
+    for( i = 0; i < num_raster; i++ )
+    {
+        if( !i || (raster[i].cell_x != raster[i - 1].cell_x) || (raster[i].cell_y != raster[i - 1].cell_y) )
+            num_cells++;
+    }
+    size = 16;
+    while( size - size / 4 < num_cells )
+        size *= 2;
+
+    gf->cells = calloc( size, sizeof( geofence_cell ) );
+    gf->marks = malloc( (num_raster ? num_raster : 1) * sizeof( unsigned long ) );
+    if( !gf->cells || !gf->marks )
+    {
+        free( raster );
+        geofence_free_raster( gf );
+        return 2;
+    }
+    gf->cell_size = size;
+    gf->num_marks = num_raster;
+
+    cell = NULL;
+    for( i = 0; i < num_raster; i++ )
+    {
+        gf->marks[i] = raster[i].mark;
+        if( cell && (raster[i].cell_x == cell->cell_x) && (raster[i].cell_y == cell->cell_y) )
+        {
+            cell->count++;
+            continue;
+        }
+
+        for( j = geofence_cell_home( gf, raster[i].cell_x, raster[i].cell_y ); gf->cells[j].count;
+             j = (j + 1) & (gf->cell_size - 1) )
+            ;
+        cell = &gf->cells[j];
+        cell->cell_x = raster[i].cell_x;
+        cell->cell_y = raster[i].cell_y;
+        cell->first = i;
+        cell->count = 1;
+    }
+    free( raster );
+    gf->built = 1;
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Find the fences a position is inside of
+
+    \param gf pointer to the geofence
+    \param latitude latitude in 1/10000 minute
+    \param longitude longitude in 1/10000 minute
+    \param found where to put the index in gf->fences of each fence
+    \param max size of found
+
+    Returns the number of fences put in found.
+*/
+/* ----------------------------------------------------------------------- */
+unsigned int __stdcall geofence_find( geofence *gf, long latitude, long longitude,
+                                      unsigned int *found, unsigned int max )
+{
+    geofence_cell *cell;
+    unsigned long i;
+    unsigned long mark;
+    unsigned int  n;
+    long          cell_x;
+    long          cell_y;
+
+    if( !gf || !gf->built || !found )
+        return 0;
+    if(    (latitude < -GEOFENCE_LAT_MAX) || (latitude > GEOFENCE_LAT_MAX)
+        || (longitude < -GEOFENCE_LON_MAX) || (longitude > GEOFENCE_LON_MAX) )
+        return 0;
+
+    cell_x = geofence_cell_x( gf, longitude );
+    cell_y = geofence_cell_y( gf, latitude );
+    for( i = geofence_cell_home( gf, cell_x, cell_y ); gf->cells[i].count; i = (i + 1) & (gf->cell_size - 1) )
+    {
+        if( (gf->cells[i].cell_x == cell_x) && (gf->cells[i].cell_y == cell_y) )
+            break;
+    }
+    cell = &gf->cells[i];
+
+    n = 0;
+    for( i = 0; (i < cell->count) && (n < max); i++ )
+    {
+        mark = gf->marks[cell->first + i];
+        if( mark & 1 )
+        {
+            gf->exact++;
+            if( !geofence_inside( &gf->fences[mark / 2], latitude, longitude ) )
+                continue;
+        }
+        found[n++] = (unsigned int) (mark / 2);
+    }
+
+    return n;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Find a vessel, adding it if it isn't there
+   Returns NULL if it isn't there and the hash is full
+*/
+/* ----------------------------------------------------------------------- */
+static geofence_vessel *geofence_vessel_add( geofence *gf, unsigned long userid )
+{
+    mmsi_index      index;
+    geofence_vessel *v;
+    unsigned long   i;
+
+    geofence_vessel_index( gf, &index );
+    i = mmsi_index_slot( &index, userid );
+    if( gf->vessels[i].userid )
+        return &gf->vessels[i];
+
+    if( gf->vessel_count >= gf->vessel_size - gf->vessel_size / 4 )
+        return NULL;
+
+    v = &gf->vessels[i];
+    memset( v, 0, sizeof( geofence_vessel ) );
+    v->userid = userid;
+    gf->vessel_count++;
+
+    return v;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Pass one event to the callback */
+/* ----------------------------------------------------------------------- */
+static void geofence_event_cb( geofence *gf, unsigned long userid, unsigned int f, int type,
+                               long latitude, long longitude, unsigned long now )
+{
+    geofence_event event;
+
+    event.userid = userid;
+    event.id = gf->fences[f].id;
+    event.event = type;
+    event.time = now;
+    event.latitude = latitude;
+    event.longitude = longitude;
+    gf->events++;
+    gf->callback( &event, gf->data );
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Check a vessel's position against the fences
+
+    \param gf pointer to the geofence
+    \param userid MMSI of the vessel
+    \param latitude latitude in 1/10000 minute
+    \param longitude longitude in 1/10000 minute
+    \param now time of the report
+
+    returns:
+      - 0 if no error
+      - 1 if there was an error with the parameters, the position is
+        not available or geofence_build() hasn't been called
+      - 2 if it is a new vessel and there is no room for it
+
+    The callback is called with an exit for each fence the vessel has
+    left and then an enter for each fence it has entered, before this
+    returns. Reports without a position don't change anything.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall geofence_update( geofence *gf, unsigned long userid, long latitude, long longitude,
+                               unsigned long now )
+{
+    mmsi_index      index;
+    geofence_vessel *v;
+    unsigned int    found[GEOFENCE_INSIDE];
+    unsigned int    n;
+    unsigned int    i, j;
+    unsigned long   slot;
+
+    if( !gf || !gf->built || !userid )
+        return 1;
+
+    /* 91 and 181 degrees mean no position */
+    if(    (latitude < -GEOFENCE_LAT_MAX) || (latitude > GEOFENCE_LAT_MAX)
+        || (longitude < -GEOFENCE_LON_MAX) || (longitude > GEOFENCE_LON_MAX) )
+        return 1;
+
+    gf->updates++;
+    n = geofence_find( gf, latitude, longitude, found, GEOFENCE_INSIDE );
+
+    /* Vessels outside of every fence are only kept once they have been in one */
+    v = NULL;
+    if( n )
+    {
+        v = geofence_vessel_add( gf, userid );
+        if( !v )
+        {
+            gf->full++;
+            return 2;
+        }
+    } else {
+        geofence_vessel_index( gf, &index );
+        slot = mmsi_index_slot( &index, userid );
+        if( !gf->vessels[slot].userid )
+            return 0;
+        v = &gf->vessels[slot];
+    }
+    v->updated = now;
+
+    for( i = 0; i < v->count; i++ )
+    {
+        for( j = 0; (j < n) && (found[j] != v->inside[i]); j++ )
+            ;
+        if( j == n )
+            geofence_event_cb( gf, userid, v->inside[i], GEOFENCE_EXIT, latitude, longitude, now );
+    }
+    for( j = 0; j < n; j++ )
+    {
+        for( i = 0; (i < v->count) && (v->inside[i] != found[j]); i++ )
+            ;
+        if( i == v->count )
+            geofence_event_cb( gf, userid, found[j], GEOFENCE_ENTER, latitude, longitude, now );
+    }
+
+    memcpy( v->inside, found, n * sizeof( unsigned int ) );
+    v->count = n;
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Check a vessel's position from parse_ais_position()
+
+    \param gf pointer to the geofence
+    \param pos position report
+    \param now time of the report
+
+    Returns the same as geofence_update(), 1 if pos doesn't have the
+    MMSI and position.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall geofence_update_pos( geofence *gf, aismsg_pos *pos, unsigned long now )
+{
+    if( !pos || ((pos->fields & (AIS_FIELD_USERID | AIS_FIELD_POSITION)) != (AIS_FIELD_USERID | AIS_FIELD_POSITION)) )
+        return 1;
+
+    return geofence_update( gf, pos->userid, pos->latitude, pos->longitude, now );
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Check a vessel's position from a parsed message
+
+    \param gf pointer to the geofence
+    \param msg message from parse_ais_any()
+    \param now time of the report
+
+    Returns the same as geofence_update(), 1 if the message isn't a
+    message 1, 2, 3, 18, 19 or 27 position report.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall geofence_update_msg( geofence *gf, aismsg_any *msg, unsigned long now )
+{
+    if( !msg )
+        return 1;
+
+    switch( msg->msgid )
+    {
+        case 1:
+            return geofence_update( gf, msg->u.msg_1.userid, msg->u.msg_1.latitude, msg->u.msg_1.longitude, now );
+        case 2:
+            return geofence_update( gf, msg->u.msg_2.userid, msg->u.msg_2.latitude, msg->u.msg_2.longitude, now );
+        case 3:
+            return geofence_update( gf, msg->u.msg_3.userid, msg->u.msg_3.latitude, msg->u.msg_3.longitude, now );
+        case 18:
+            return geofence_update( gf, msg->u.msg_18.userid, msg->u.msg_18.latitude, msg->u.msg_18.longitude, now );
+        case 19:
+            return geofence_update( gf, msg->u.msg_19.userid, msg->u.msg_19.latitude, msg->u.msg_19.longitude, now );
+        case 27:
+            return geofence_update( gf, msg->u.msg_27.userid, msg->u.msg_27.latitude, msg->u.msg_27.longitude, now );
+    }
+
+    return 1;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Has a vessel not reported for longer than age */
+/* ----------------------------------------------------------------------- */
+static int __stdcall geofence_vessel_expired( void *slot, unsigned long now, unsigned long age )
+{
+    geofence_vessel *v = (geofence_vessel *) slot;
+
+    return (now > v->updated) && (now - v->updated > age);
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Forget vessels that haven't reported
+
+    \param gf pointer to the geofence
+    \param now current time
+    \param age time since the last report
+
+    Returns the number of vessels removed. Vessels updated after now are
+    kept. No exit events are sent for them, if they report again they
+    will get a new enter event.
+*/
+/* ----------------------------------------------------------------------- */
+unsigned long __stdcall geofence_expire( geofence *gf, unsigned long now, unsigned long age )
+{
+    mmsi_index    index;
+    unsigned long n;
+
+    if( !gf || !gf->vessels )
+        return 0;
+
+    geofence_vessel_index( gf, &index );
+    n = mmsi_index_expire( &index, now, age, geofence_vessel_expired );
+    gf->vessel_count -= n;
+
+    return n;
+}
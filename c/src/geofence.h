@@ -0,0 +1,116 @@
+/* -----------------------------------------------------------------------
+   Geofence enter and exit events
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>
+   All rights Reserved
+   ----------------------------------------------------------------------- */
+
+/*! \file
+    \brief Header file for geofence.c
+
+    Requires nmea.h, sixbit.h and vdm_parse.h to be included first.
+*/
+
+/** Default raster cell size, 0.6 minutes in 1/10000 minute */
+#define GEOFENCE_CELL       6000
+
+/** Most fences a vessel can be inside of at once */
+#define GEOFENCE_INSIDE     8
+
+/** geofence_event.event values */
+#define GEOFENCE_ENTER      1
+#define GEOFENCE_EXIT       2
+
+
+/** Corner of a fence
+*/
+typedef struct {
+    long            longitude;         //!< Longitude in 1/10000 minute
+    long            latitude;          //!< Latitude in 1/10000 minute
+} geofence_point;
+
+
+/** Polygon to watch
+*/
+typedef struct {
+    unsigned long   id;                //!< Caller's ID for the fence
+    geofence_point  *points;           //!< Corners, the last one joins the first
+    unsigned int    num_points;        //!< Number of corners
+    long            lon_min;           //!< Bounding box
+    long            lat_min;
+    long            lon_max;
+    long            lat_max;
+} ais_fence;
+
+
+/** A vessel entering or leaving a fence
+*/
+typedef struct {
+    unsigned long   userid;            //!< UserID / MMSI
+    unsigned long   id;                //!< ais_fence.id of the fence
+    int             event;             //!< GEOFENCE_ENTER or GEOFENCE_EXIT
+    unsigned long   time;              //!< Time of the report
+    long            longitude;         //!< Position reported, in 1/10000 minute
+    long            latitude;
+} geofence_event;
+
+
+/** Called for each enter and exit */
+typedef void (__stdcall *geofence_cb)( geofence_event *event, void *data );
+
+
+/** Raster cell that has fences in it, count is 0 for an unused cell
+*/
+typedef struct {
+    long            cell_x;            //!< Column of the cell
+    long            cell_y;            //!< Row of the cell
+    unsigned long   first;             //!< First of its marks
+    unsigned long   count;             //!< Number of marks
+} geofence_cell;
+
+
+/** Fences a vessel was inside of at its last report
+*/
+typedef struct {
+    unsigned long   userid;            //!< UserID / MMSI, 0 for an unused slot
+    unsigned long   updated;           //!< Time of the last report
+    unsigned int    count;             //!< Number of fences in inside
+    unsigned int    inside[GEOFENCE_INSIDE];   //!< Index of each fence in fences
+} geofence_vessel;
+
+
+/** Fences, their raster and the vessels' state
+*/
+typedef struct {
+    long            cell;              //!< Raster cell size in 1/10000 minute
+    ais_fence       *fences;           //!< num_fences fences
+    unsigned int    num_fences;
+    unsigned int    max_fences;        //!< Size of fences
+    int             built;             //!< 1 when the raster matches the fences
+    geofence_cell   *cells;            //!< Hash of the cells with fences in them
+    unsigned long   cell_size;         //!< A power of 2
+    unsigned long   *marks;            //!< Fence index * 2, + 1 if the cell is on its edge
+    unsigned long   num_marks;
+    geofence_vessel *vessels;          //!< Hash of the vessels' state
+    unsigned long   vessel_size;       //!< A power of 2
+    unsigned long   vessel_count;      //!< Vessels in vessels
+    geofence_cb     callback;          //!< Called with each event
+    void            *data;             //!< Passed to callback
+    unsigned long   updates;           //!< Reports checked
+    unsigned long   exact;             //!< Point in polygon tests done
+    unsigned long   events;            //!< Events passed to callback
+    unsigned long   full;              //!< Reports dropped because vessels was full
+} geofence;
+
+
+/* Prototypes */
+int __stdcall init_geofence( geofence *gf, unsigned long vessels, long cell, geofence_cb callback, void *data );
+void __stdcall free_geofence( geofence *gf );
+int __stdcall geofence_add( geofence *gf, unsigned long id, geofence_point *points, unsigned int num_points );
+int __stdcall geofence_build( geofence *gf );
+unsigned int __stdcall geofence_find( geofence *gf, long latitude, long longitude,
+                                      unsigned int *found, unsigned int max );
+int __stdcall geofence_update( geofence *gf, unsigned long userid, long latitude, long longitude,
+                               unsigned long now );
+int __stdcall geofence_update_pos( geofence *gf, aismsg_pos *pos, unsigned long now );
+int __stdcall geofence_update_msg( geofence *gf, aismsg_any *msg, unsigned long now );
+unsigned long __stdcall geofence_expire( geofence *gf, unsigned long now, unsigned long age );
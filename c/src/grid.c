@@ -0,0 +1,573 @@
+/* -----------------------------------------------------------------------
+   Spatial grid index of vessel positions
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>
+   All rights Reserved
+   ----------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "portable.h"
+#include "nmea.h"
+#include "sixbit.h"
+#include "vdm_parse.h"
+#include "mmsi_index.h"
+#include "grid.h"
+
+/*! \file
+    \brief Spatial grid index of vessel positions
+    \author Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>, All Rights Reserved
+    \version 1.8
+
+    An ais_grid answers "which vessels are in this box" without looking
+    at every vessel. The world is split into square cells of
+    ais_grid.cell by ais_grid.cell 1/10000 minutes, the units that
+    conv_pos() produces, so positions go straight from the parsed
+    message into the grid with no conversion to degrees.
+
+    Most of the cells are empty, so instead of an array of every cell
+    the cells are hashed into a power of 2 number of buckets. Each bucket
+    holds a doubly linked list of the vessels in the cells that hash to
+    it, so moving a vessel to another cell is a constant time unlink and
+    link. An mmsi_index finds a vessel's entry from its MMSI.
+
+    grid_bbox() visits only the buckets of the cells that overlap the
+    box, and grid_radius() the ones around a circle. A box may cross the
+    180 degree meridian, by passing a lon_min larger than lon_max.
+
+    Example:
+    \code
+    ais_grid   grid;
+    aismsg_pos pos;
+
+    init_ais_grid( &grid, 10000, AIS_GRID_CELL );
+    ...
+    if( parse_ais_position( &ais, AIS_FIELD_USERID | AIS_FIELD_POSITION, &pos ) == 0 )
+        grid_update_pos( &grid, &pos );
+    ...
+    n = grid_radius( &grid, lat, lon, 10 * 10000, got_vessel, NULL );
+    \endcode
+*/
+
+
+/** Radians in 1/10000 minute */
+#define GRID_RADIANS  (3.14159265358979323846 / (180.0 * 600000.0))
+
+
+/** Circle for grid_radius() to check positions against */
+typedef struct {
+    long    latitude;
+    long    longitude;
+    double  radius2;                   /* Radius squared */
+    double  coslat;                    /* Scale of longitude at latitude */
+} grid_circle;
+
+
+/* ----------------------------------------------------------------------- */
+/* Bucket of a cell */
+/* ----------------------------------------------------------------------- */
+static unsigned long grid_bucket( ais_grid *grid, long cell_x, long cell_y )
+{
+    unsigned long h;
+
+    h = ((unsigned long) cell_x * 73856093UL) ^ ((unsigned long) cell_y * 19349663UL);
+    h ^= (h & 0xFFFFFFFFUL) >> 15;
+
+    return h & (grid->num_buckets - 1);
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* The hash from MMSI to entry */
+/* ----------------------------------------------------------------------- */
+static void grid_index( ais_grid *grid, mmsi_index *index )
+{
+    init_mmsi_index( index, grid->index, sizeof( mmsi_entry ), sizeof( grid->index->userid ), grid->index_size );
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Column and row of the cell a position is in */
+/* ----------------------------------------------------------------------- */
+static long grid_cell_x( ais_grid *grid, long longitude )
+{
+    if( longitude < -AIS_GRID_LON_MAX )
+        longitude = -AIS_GRID_LON_MAX;
+    if( longitude > AIS_GRID_LON_MAX )
+        longitude = AIS_GRID_LON_MAX;
+
+    return (longitude + AIS_GRID_LON_MAX) / grid->cell;
+}
+
+static long grid_cell_y( ais_grid *grid, long latitude )
+{
+    if( latitude < -AIS_GRID_LAT_MAX )
+        latitude = -AIS_GRID_LAT_MAX;
+    if( latitude > AIS_GRID_LAT_MAX )
+        latitude = AIS_GRID_LAT_MAX;
+
+    return (latitude + AIS_GRID_LAT_MAX) / grid->cell;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Initialize a grid
+
+    \param grid pointer to the grid
+    \param vessels number of vessels it must be able to hold
+    \param cell size of a cell in 1/10000 minute, eg. #AIS_GRID_CELL
+
+    returns:
+      - 0 if no error
+      - 1 if there was an error with the parameters
+      - 2 if memory could not be allocated
+
+    Pick a cell size close to the size of the typical query.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall init_ais_grid( ais_grid *grid, unsigned long vessels, long cell )
+{
+    unsigned long i;
+
+    if( !grid || !vessels || (cell < 1000) )
+        return 1;
+
+    memset( grid, 0, sizeof( ais_grid ) );
+    grid->cell = cell;
+    grid->max = vessels;
+
+    grid->num_buckets = 16;
+    while( grid->num_buckets < vessels )
+        grid->num_buckets *= 2;
+    grid->index_size = mmsi_index_size( vessels );
+
+    grid->entries = malloc( vessels * sizeof( grid_entry ) );
+    grid->bucket = malloc( grid->num_buckets * sizeof( long ) );
+    grid->index = calloc( grid->index_size, sizeof( mmsi_entry ) );
+    if( !grid->entries || !grid->bucket || !grid->index )
+    {
+        free_ais_grid( grid );
+        return 2;
+    }
+
+    for( i = 0; i < vessels; i++ )
+    {
+        grid->entries[i].userid = 0;
+        grid->entries[i].next = (i + 1 < vessels) ? (long) (i + 1) : -1;
+    }
+    grid->free = 0;
+    for( i = 0; i < grid->num_buckets; i++ )
+        grid->bucket[i] = -1;
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Free the memory used by a grid
+
+    \param grid pointer to the grid
+*/
+/* ----------------------------------------------------------------------- */
+void __stdcall free_ais_grid( ais_grid *grid )
+{
+    if( !grid )
+        return;
+
+    free( grid->entries );
+    free( grid->bucket );
+    free( grid->index );
+    grid->entries = NULL;
+    grid->bucket = NULL;
+    grid->index = NULL;
+    grid->count = 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Slot in the MMSI index of a vessel, or of the empty slot it would go in */
+/* ----------------------------------------------------------------------- */
+static unsigned long grid_slot( ais_grid *grid, unsigned long userid )
+{
+    mmsi_index index;
+
+    grid_index( grid, &index );
+
+    return mmsi_index_slot( &index, userid );
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Find a vessel in the grid
+
+    \param grid pointer to the grid
+    \param userid MMSI of the vessel
+
+    Returns the vessel's entry or NULL if it isn't in the grid.
+*/
+/* ----------------------------------------------------------------------- */
+grid_entry * __stdcall grid_find( ais_grid *grid, unsigned long userid )
+{
+    unsigned long i;
+
+    if( !grid || !grid->entries || !userid )
+        return NULL;
+
+    i = grid_slot( grid, userid );
+
+    return grid->index[i].userid ? &grid->entries[grid->index[i].entry] : NULL;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Add an entry to the front of its cell's bucket */
+/* ----------------------------------------------------------------------- */
+static void grid_link( ais_grid *grid, long e )
+{
+    grid_entry    *entry;
+    unsigned long b;
+
+    entry = &grid->entries[e];
+    b = grid_bucket( grid, entry->cell_x, entry->cell_y );
+    entry->prev = -1;
+    entry->next = grid->bucket[b];
+    if( entry->next >= 0 )
+        grid->entries[entry->next].prev = e;
+    grid->bucket[b] = e;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Take an entry out of its cell's bucket */
+/* ----------------------------------------------------------------------- */
+static void grid_unlink( ais_grid *grid, long e )
+{
+    grid_entry *entry;
+
+    entry = &grid->entries[e];
+    if( entry->prev >= 0 )
+        grid->entries[entry->prev].next = entry->next;
+    else
+        grid->bucket[grid_bucket( grid, entry->cell_x, entry->cell_y )] = entry->next;
+    if( entry->next >= 0 )
+        grid->entries[entry->next].prev = entry->prev;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Remove a vessel from the grid
+
+    \param grid pointer to the grid
+    \param userid MMSI of the vessel
+
+    returns:
+      - 0 if it was removed
+      - 1 if it wasn't in the grid
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall grid_remove( ais_grid *grid, unsigned long userid )
+{
+    mmsi_index    index;
+    unsigned long i;
+    long          e;
+
+    if( !grid || !grid->entries || !userid )
+        return 1;
+
+    grid_index( grid, &index );
+    i = mmsi_index_slot( &index, userid );
+    if( !grid->index[i].userid )
+        return 1;
+    e = grid->index[i].entry;
+
+    grid_unlink( grid, e );
+    grid->entries[e].userid = 0;
+    grid->entries[e].next = grid->free;
+    grid->free = e;
+    grid->count--;
+
+    mmsi_index_remove( &index, i );
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Add or move a vessel
+
+    \param grid pointer to the grid
+    \param userid MMSI of the vessel
+    \param latitude latitude in 1/10000 minute, as from conv_pos()
+    \param longitude longitude in 1/10000 minute
+
+    returns:
+      - 0 if no error
+      - 1 if the position is not available, the vessel is removed
+      - 2 if it is a new vessel and the grid is full
+
+    Moving to another cell only relinks the vessel's entry.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall grid_update( ais_grid *grid, unsigned long userid, long latitude, long longitude )
+{
+    grid_entry    *entry;
+    unsigned long i;
+    long          e;
+    long          cell_x;
+    long          cell_y;
+
+    if( !grid || !grid->entries || !userid )
+        return 1;
+
+    /* 91 and 181 degrees mean no position */
+    if(    (latitude < -AIS_GRID_LAT_MAX) || (latitude > AIS_GRID_LAT_MAX)
+        || (longitude < -AIS_GRID_LON_MAX) || (longitude > AIS_GRID_LON_MAX) )
+    {
+        grid_remove( grid, userid );
+        return 1;
+    }
+
+    cell_x = grid_cell_x( grid, longitude );
+    cell_y = grid_cell_y( grid, latitude );
+
+    i = grid_slot( grid, userid );
+    if( grid->index[i].userid )
+    {
+        e = grid->index[i].entry;
+        entry = &grid->entries[e];
+        entry->latitude = latitude;
+        entry->longitude = longitude;
+        if( (entry->cell_x != cell_x) || (entry->cell_y != cell_y) )
+        {
+            grid_unlink( grid, e );
+            entry->cell_x = cell_x;
+            entry->cell_y = cell_y;
+            grid_link( grid, e );
+            grid->moves++;
+        }
+        return 0;
+    }
+
+    if( grid->free < 0 )
+    {
+        grid->full++;
+        return 2;
+    }
+    e = grid->free;
+    entry = &grid->entries[e];
+    grid->free = entry->next;
+
+    entry->userid = userid;
+    entry->latitude = latitude;
+    entry->longitude = longitude;
+    entry->cell_x = cell_x;
+    entry->cell_y = cell_y;
+    grid_link( grid, e );
+    grid->index[i].userid = userid;
+    grid->index[i].entry = e;
+    grid->count++;
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Add or move a vessel from a position report
+
+    \param grid pointer to the grid
+    \param pos result of parse_ais_position() with AIS_FIELD_USERID and
+               AIS_FIELD_POSITION
+
+    Returns the same as grid_update(), 1 if pos doesn't have the fields.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall grid_update_pos( ais_grid *grid, aismsg_pos *pos )
+{
+    if( !pos || ((pos->fields & (AIS_FIELD_USERID | AIS_FIELD_POSITION)) != (AIS_FIELD_USERID | AIS_FIELD_POSITION)) )
+        return 1;
+
+    return grid_update( grid, pos->userid, pos->latitude, pos->longitude );
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Is an entry inside the box, and the circle if there is one */
+/* ----------------------------------------------------------------------- */
+static int grid_inside( grid_entry *entry, long lat_min, long lon_min, long lat_max, long lon_max,
+                        grid_circle *circle )
+{
+    double dx;
+    double dy;
+    long   dlon;
+
+    if(    (entry->latitude < lat_min) || (entry->latitude > lat_max)
+        || (entry->longitude < lon_min) || (entry->longitude > lon_max) )
+        return 0;
+    if( !circle )
+        return 1;
+
+    dlon = entry->longitude - circle->longitude;
+    if( dlon > AIS_GRID_LON_MAX )
+        dlon -= 2 * AIS_GRID_LON_MAX;
+    if( dlon < -AIS_GRID_LON_MAX )
+        dlon += 2 * AIS_GRID_LON_MAX;
+    dx = (double) dlon * circle->coslat;
+    dy = (double) (entry->latitude - circle->latitude);
+
+    return (dx * dx + dy * dy <= circle->radius2);
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Visit the vessels in a box that doesn't cross 180 degrees */
+/* ----------------------------------------------------------------------- */
+static unsigned long grid_query( ais_grid *grid, long lat_min, long lon_min, long lat_max, long lon_max,
+                                 grid_circle *circle, grid_cb callback, void *data )
+{
+    grid_entry    *entry;
+    unsigned long n;
+    unsigned long b;
+    long          x1, x2, y1, y2;
+    long          x, y;
+    long          e;
+
+    x1 = grid_cell_x( grid, lon_min );
+    x2 = grid_cell_x( grid, lon_max );
+    y1 = grid_cell_y( grid, lat_min );
+    y2 = grid_cell_y( grid, lat_max );
+
+    n = 0;
+
+    /* A box bigger than the buckets, go through each bucket once */
+    if( (unsigned long) (x2 - x1 + 1) * (unsigned long) (y2 - y1 + 1) > grid->num_buckets )
+    {
+        for( b = 0; b < grid->num_buckets; b++ )
+        {
+            for( e = grid->bucket[b]; e >= 0; e = entry->next )
+            {
+                entry = &grid->entries[e];
+                if( grid_inside( entry, lat_min, lon_min, lat_max, lon_max, circle ) )
+                {
+                    if( callback )
+                        callback( entry, data );
+                    n++;
+                }
+            }
+        }
+        return n;
+    }
+
+    for( y = y1; y <= y2; y++ )
+    {
+        for( x = x1; x <= x2; x++ )
+        {
+            /* Other cells can share the bucket */
+            for( e = grid->bucket[grid_bucket( grid, x, y )]; e >= 0; e = entry->next )
+            {
+                entry = &grid->entries[e];
+                if(    (entry->cell_x == x) && (entry->cell_y == y)
+                    && grid_inside( entry, lat_min, lon_min, lat_max, lon_max, circle ) )
+                {
+                    if( callback )
+                        callback( entry, data );
+                    n++;
+                }
+            }
+        }
+    }
+
+    return n;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Find the vessels in a box
+
+    \param grid pointer to the grid
+    \param lat_min southern edge in 1/10000 minute
+    \param lon_min western edge in 1/10000 minute
+    \param lat_max northern edge in 1/10000 minute
+    \param lon_max eastern edge in 1/10000 minute
+    \param callback function to call with each vessel, or NULL
+    \param data pointer passed to callback
+
+    Returns the number of vessels in the box, edges included. When
+    lon_min is larger than lon_max the box crosses 180 degrees.
+*/
+/* ----------------------------------------------------------------------- */
+unsigned long __stdcall grid_bbox( ais_grid *grid, long lat_min, long lon_min, long lat_max, long lon_max,
+                                   grid_cb callback, void *data )
+{
+    if( !grid || !grid->entries || (lat_min > lat_max) )
+        return 0;
+
+    if( lon_min > lon_max )
+    {
+        return grid_query( grid, lat_min, lon_min, lat_max, AIS_GRID_LON_MAX, NULL, callback, data )
+             + grid_query( grid, lat_min, -AIS_GRID_LON_MAX, lat_max, lon_max, NULL, callback, data );
+    }
+
+    return grid_query( grid, lat_min, lon_min, lat_max, lon_max, NULL, callback, data );
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Find the vessels within a distance of a point
+
+    \param grid pointer to the grid
+    \param latitude latitude of the center in 1/10000 minute
+    \param longitude longitude of the center in 1/10000 minute
+    \param radius distance in 1/10000 nautical mile (1/10000 minute of latitude)
+    \param callback function to call with each vessel, or NULL
+    \param data pointer passed to callback
+
+    Returns the number of vessels found. Distances use a flat projection
+    around the center, which is good for radii up to a few hundred miles
+    away from the poles.
+*/
+/* ----------------------------------------------------------------------- */
+unsigned long __stdcall grid_radius( ais_grid *grid, long latitude, long longitude, long radius,
+                                     grid_cb callback, void *data )
+{
+    grid_circle   circle;
+    long          lat_min;
+    long          lat_max;
+    long          width;
+    double        edge;
+
+    if( !grid || !grid->entries || (radius < 0) )
+        return 0;
+
+    lat_min = latitude - radius;
+    lat_max = latitude + radius;
+    if( lat_min < -AIS_GRID_LAT_MAX )
+        lat_min = -AIS_GRID_LAT_MAX;
+    if( lat_max > AIS_GRID_LAT_MAX )
+        lat_max = AIS_GRID_LAT_MAX;
+
+    circle.latitude = latitude;
+    circle.longitude = longitude;
+    circle.radius2 = (double) radius * (double) radius;
+    circle.coslat = cos( latitude * GRID_RADIANS );
+
+    /* The box is widest at the edge nearest a pole */
+    edge = cos( ((lat_max > -lat_min) ? lat_max : -lat_min) * GRID_RADIANS );
+    if( (edge < 1e-6) || ((double) radius / edge >= (double) AIS_GRID_LON_MAX) )
+        return grid_query( grid, lat_min, -AIS_GRID_LON_MAX, lat_max, AIS_GRID_LON_MAX, &circle, callback, data );
+    width = (long) ((double) radius / edge) + 1;
+
+    if( longitude - width < -AIS_GRID_LON_MAX )
+    {
+        return grid_query( grid, lat_min, -AIS_GRID_LON_MAX, lat_max, longitude + width, &circle, callback, data )
+             + grid_query( grid, lat_min, longitude - width + 2 * AIS_GRID_LON_MAX, lat_max, AIS_GRID_LON_MAX,
+                           &circle, callback, data );
+    }
+    if( longitude + width > AIS_GRID_LON_MAX )
+    {
+        return grid_query( grid, lat_min, longitude - width, lat_max, AIS_GRID_LON_MAX, &circle, callback, data )
+             + grid_query( grid, lat_min, -AIS_GRID_LON_MAX, lat_max, longitude + width - 2 * AIS_GRID_LON_MAX,
+                           &circle, callback, data );
+    }
+
+    return grid_query( grid, lat_min, longitude - width, lat_max, longitude + width, &circle, callback, data );
+}
@@ -0,0 +1,66 @@
+/* -----------------------------------------------------------------------
+   Spatial grid index of vessel positions
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>
+   All rights Reserved
+   ----------------------------------------------------------------------- */
+
+/*! \file
+    \brief Header file for grid.c
+
+    Requires nmea.h, sixbit.h, vdm_parse.h and mmsi_index.h to be included
+    first.
+*/
+
+/** Default cell size, 6 minutes (0.1 degree) in 1/10000 minute */
+#define AIS_GRID_CELL       60000
+
+/** 180 degrees and 90 degrees in 1/10000 minute */
+#define AIS_GRID_LON_MAX    108000000L
+#define AIS_GRID_LAT_MAX    54000000L
+
+
+/** One vessel in the grid
+*/
+typedef struct {
+    unsigned long   userid;            //!< UserID / MMSI, 0 for an unused entry
+    long            longitude;         //!< Longitude in 1/10000 minute
+    long            latitude;          //!< Latitude in 1/10000 minute
+    long            cell_x;            //!< Column of the cell it is in
+    long            cell_y;            //!< Row of the cell it is in
+    long            next;              //!< Next entry in the bucket, or the free list, -1 at the end
+    long            prev;              //!< Previous entry in the bucket, -1 at the start
+} grid_entry;
+
+
+/** Called for each vessel found by a query */
+typedef void (__stdcall *grid_cb)( grid_entry *entry, void *data );
+
+
+/** Uniform lat/lon grid, the cells are hashed into buckets
+*/
+typedef struct {
+    long            cell;              //!< Cell size in 1/10000 minute
+    grid_entry      *entries;          //!< max entries
+    unsigned long   max;               //!< Most vessels it can hold
+    unsigned long   count;             //!< Vessels in the grid
+    long            free;              //!< First unused entry, -1 when full
+    long            *bucket;           //!< First entry in each bucket, -1 if empty
+    unsigned long   num_buckets;       //!< A power of 2
+    mmsi_entry      *index;            //!< MMSI to entry hash
+    unsigned long   index_size;        //!< A power of 2
+    unsigned long   moves;             //!< Updates that moved a vessel to another cell
+    unsigned long   full;              //!< New vessels dropped because it was full
+} ais_grid;
+
+
+/* Prototypes */
+int __stdcall init_ais_grid( ais_grid *grid, unsigned long vessels, long cell );
+void __stdcall free_ais_grid( ais_grid *grid );
+int __stdcall grid_update( ais_grid *grid, unsigned long userid, long latitude, long longitude );
+int __stdcall grid_update_pos( ais_grid *grid, aismsg_pos *pos );
+int __stdcall grid_remove( ais_grid *grid, unsigned long userid );
+grid_entry * __stdcall grid_find( ais_grid *grid, unsigned long userid );
+unsigned long __stdcall grid_bbox( ais_grid *grid, long lat_min, long lon_min, long lat_max, long lon_max,
+                                   grid_cb callback, void *data );
+unsigned long __stdcall grid_radius( ais_grid *grid, long latitude, long longitude, long radius,
+                                     grid_cb callback, void *data );
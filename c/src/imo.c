@@ -31,7 +31,7 @@
 	\code
 	ais_state state;
     aismsg_8  message;
-	sixbit imo;
+	sixbit_view imo;
 	int dac, fi;
 	imo1_11 msg1_11;
     unsigned int  result;
@@ -46,12 +46,11 @@
 	{
 	    result = parse_ais_8( &state, &message );
 
-		// Get the seaway info from the payload of the message 8
-		memset( &imo, 0, sizeof( imo ) );
-
-		// Copy the DAC and FI from the message 8 over to seaway
+		// Get the DAC and FI from the message 8
 		dac = message.app_id >> 6;
 		fi = message.app_id & 0x3F;
+
+		// The IMO info is in the payload of the message 8
 		imo = message.data;
 
 		// Is it a ...
@@ -75,12 +74,13 @@
     return
       - return 0 if there was no error
       - return 1 if there was an error
+      - return 2 if there was a length error
 
     This function parses a Meteorological and Hydrological message into
 	a imo1_11 structure
 */
 /* ----------------------------------------------------------------------- */
-int __stdcall parse_imo1_11( sixbit *state, imo1_11 *result )
+int __stdcall parse_imo1_11( sixbit_view *state, imo1_11 *result )
 {
     int length;
 
@@ -89,48 +89,48 @@ int __stdcall parse_imo1_11( sixbit *state, imo1_11 *result )
     if( !result )
         return 1;
 
-	length = sixbit_length(state);
+	length = sixbit_view_length(state);
     if( (length < 0) || (length > 1008) )
         return 2;
 
     /* Clear out the structure first */
     memset( result, 0, sizeof( imo1_11 ) );
 
-    result->latitude      = (long) get_6bit( state, 24 );
-    result->longitude     = (long) get_6bit( state, 25 );
-    result->timedate      = (unsigned int) get_6bit( state, 16 );
-	result->wind_avg      = (char) get_6bit( state, 7 );
-	result->wind_gust     = (char) get_6bit( state, 7 );
-	result->wind_dir      = (int) get_6bit( state, 9 );
-	result->gust_dir      = (int) get_6bit( state, 9 );
-	result->air_temp      = (int) get_6bit( state, 11 );
-	result->humidity      = (char) get_6bit( state, 7 );
-	result->dew_point     = (int) get_6bit( state, 10 );
-	result->pressure      = (int) get_6bit( state, 9 );
-	result->tendency      = (char) get_6bit( state, 2 );
-	result->visibility    = (unsigned char) get_6bit( state, 8 );
-	result->water_level   = (int) get_6bit( state, 9 );
-	result->water_trend   = (char) get_6bit( state, 2 );
-	result->surface_speed = (unsigned char) get_6bit( state, 8 );
-	result->surface_dir   = (int) get_6bit( state, 9 );
-	result->speed_2       = (unsigned char) get_6bit( state, 8 );
-	result->dir_2         = (int) get_6bit( state, 9 );
-	result->level_2       = (char) get_6bit( state, 5 );
-	result->speed_3       = (unsigned char) get_6bit( state, 8 );
-	result->dir_3         = (int) get_6bit( state, 9 );
-	result->level_3       = (char) get_6bit( state, 5 );
-	result->wave_height   = (unsigned char) get_6bit( state, 8 );
-	result->wave_period   = (char) get_6bit( state, 6 );
-	result->wave_dir     = (int) get_6bit( state, 9 );
-	result->swell_height  = (unsigned char) get_6bit( state, 8 );
-	result->swell_period  = (char) get_6bit( state, 6 );
-	result->swell_dir     = (int) get_6bit( state, 9 );
-	result->sea_state     = (char) get_6bit( state, 4 );
-	result->water_temp    = (int) get_6bit( state, 10 );
-	result->precip_type   = (char) get_6bit( state, 3 );
-	result->salanity      = (int) get_6bit( state, 9 );
-	result->ice           = (char) get_6bit( state, 2 );
-	result->spare         = (char) get_6bit( state, 6 );
+    result->latitude      = (long) sixbit_view_get( state, 24 );
+    result->longitude     = (long) sixbit_view_get( state, 25 );
+    result->timedate      = (unsigned int) sixbit_view_get( state, 16 );
+	result->wind_avg      = (char) sixbit_view_get( state, 7 );
+	result->wind_gust     = (char) sixbit_view_get( state, 7 );
+	result->wind_dir      = (int) sixbit_view_get( state, 9 );
+	result->gust_dir      = (int) sixbit_view_get( state, 9 );
+	result->air_temp      = (int) sixbit_view_get( state, 11 );
+	result->humidity      = (char) sixbit_view_get( state, 7 );
+	result->dew_point     = (int) sixbit_view_get( state, 10 );
+	result->pressure      = (int) sixbit_view_get( state, 9 );
+	result->tendency      = (char) sixbit_view_get( state, 2 );
+	result->visibility    = (unsigned char) sixbit_view_get( state, 8 );
+	result->water_level   = (int) sixbit_view_get( state, 9 );
+	result->water_trend   = (char) sixbit_view_get( state, 2 );
+	result->surface_speed = (unsigned char) sixbit_view_get( state, 8 );
+	result->surface_dir   = (int) sixbit_view_get( state, 9 );
+	result->speed_2       = (unsigned char) sixbit_view_get( state, 8 );
+	result->dir_2         = (int) sixbit_view_get( state, 9 );
+	result->level_2       = (char) sixbit_view_get( state, 5 );
+	result->speed_3       = (unsigned char) sixbit_view_get( state, 8 );
+	result->dir_3         = (int) sixbit_view_get( state, 9 );
+	result->level_3       = (char) sixbit_view_get( state, 5 );
+	result->wave_height   = (unsigned char) sixbit_view_get( state, 8 );
+	result->wave_period   = (char) sixbit_view_get( state, 6 );
+	result->wave_dir     = (int) sixbit_view_get( state, 9 );
+	result->swell_height  = (unsigned char) sixbit_view_get( state, 8 );
+	result->swell_period  = (char) sixbit_view_get( state, 6 );
+	result->swell_dir     = (int) sixbit_view_get( state, 9 );
+	result->sea_state     = (char) sixbit_view_get( state, 4 );
+	result->water_temp    = (int) sixbit_view_get( state, 10 );
+	result->precip_type   = (char) sixbit_view_get( state, 3 );
+	result->salanity      = (int) sixbit_view_get( state, 9 );
+	result->ice           = (char) sixbit_view_get( state, 2 );
+	result->spare         = (char) sixbit_view_get( state, 6 );
 
    	/* Convert the position to signed value */
 	result->longitude *= 10;
@@ -142,6 +142,10 @@ int __stdcall parse_imo1_11( sixbit *state, imo1_11 *result )
 	conv_sign( 0x0100, &result->water_level );
 	conv_sign( 0x0200, &result->water_temp );
 
+	/* The message was shorter than its fields */
+	if( state->overrun )
+		return 2;
+
 	return 0;
 }
 
@@ -155,12 +159,13 @@ int __stdcall parse_imo1_11( sixbit *state, imo1_11 *result )
     return
       - return 0 if there was no error
       - return 1 if there was an error
+      - return 2 if there was a length error
 
     This function parses a Meteorological and Hydrological message into
 	a imo1_12 structure
 */
 /* ----------------------------------------------------------------------- */
-int __stdcall parse_imo1_12( sixbit *state, imo1_12 *result )
+int __stdcall parse_imo1_12( sixbit_view *state, imo1_12 *result )
 {
     int length;
     int j;
@@ -170,7 +175,7 @@ int __stdcall parse_imo1_12( sixbit *state, imo1_12 *result )
     if( !result )
         return 1;
 
-	length = sixbit_length(state);
+	length = sixbit_view_length(state);
     if( (length < 0) || (length > 1008) )
         return 2;
 
@@ -180,7 +185,7 @@ int __stdcall parse_imo1_12( sixbit *state, imo1_12 *result )
     j = 0;
     while( j != 6 )
     {
-        result->last_port[j] = ais2ascii( (char) get_6bit( state, 6 ));
+        result->last_port[j] = ais2ascii( (char) sixbit_view_get( state, 6 ));
         j++;
     }
     result->last_port[j] = 0;
@@ -191,7 +196,7 @@ int __stdcall parse_imo1_12( sixbit *state, imo1_12 *result )
     j = 0;
     while( j != 6 )
     {
-        result->next_port[j] = ais2ascii( (char) get_6bit( state, 6 ));
+        result->next_port[j] = ais2ascii( (char) sixbit_view_get( state, 6 ));
         j++;
     }
     result->next_port[j] = 0;
@@ -202,7 +207,7 @@ int __stdcall parse_imo1_12( sixbit *state, imo1_12 *result )
     j = 0;
     while( j != 20 )
     {
-        result->good[j] = ais2ascii( (char) get_6bit( state, 6 ));
+        result->good[j] = ais2ascii( (char) sixbit_view_get( state, 6 ));
         j++;
     }
     result->good[j] = 0;
@@ -210,15 +215,19 @@ int __stdcall parse_imo1_12( sixbit *state, imo1_12 *result )
     j = 0;
     while( j != 5 )
     {
-        result->imd[j] = ais2ascii( (char) get_6bit( state, 6 ));
+        result->imd[j] = ais2ascii( (char) sixbit_view_get( state, 6 ));
         j++;
     }
     result->imd[j] = 0;
 
-    result->un_number = (int)  get_6bit( state, 13 );
-    result->quantity  = (int)  get_6bit( state, 10 );
-    result->units     = (char) get_6bit( state, 2 );
-    result->spare     = (char) get_6bit( state, 3 );
+    result->un_number = (int)  sixbit_view_get( state, 13 );
+    result->quantity  = (int)  sixbit_view_get( state, 10 );
+    result->units     = (char) sixbit_view_get( state, 2 );
+    result->spare     = (char) sixbit_view_get( state, 3 );
+
+	/* The message was shorter than its fields */
+	if( state->overrun )
+		return 2;
 
 	return 0;
 }
@@ -233,12 +242,13 @@ int __stdcall parse_imo1_12( sixbit *state, imo1_12 *result )
     return
       - return 0 if there was no error
       - return 1 if there was an error
+      - return 2 if there was a length error
 
     This function parses a Meteorological and Hydrological message into
 	a imo1_13 structure
 */
 /* ----------------------------------------------------------------------- */
-int __stdcall parse_imo1_13( sixbit *state, imo1_13 *result )
+int __stdcall parse_imo1_13( sixbit_view *state, imo1_13 *result )
 {
     int length;
     int j;
@@ -248,7 +258,7 @@ int __stdcall parse_imo1_13( sixbit *state, imo1_13 *result )
     if( !result )
         return 1;
 
-	length = sixbit_length(state);
+	length = sixbit_view_length(state);
     if( (length < 0) || (length > 1008) )
         return 2;
 
@@ -258,7 +268,7 @@ int __stdcall parse_imo1_13( sixbit *state, imo1_13 *result )
     j = 0;
     while( j != 20 )
     {
-        result->reason[j] = ais2ascii( (char) get_6bit( state, 6 ));
+        result->reason[j] = ais2ascii( (char) sixbit_view_get( state, 6 ));
         j++;
     }
     result->reason[j] = 0;
@@ -266,7 +276,7 @@ int __stdcall parse_imo1_13( sixbit *state, imo1_13 *result )
     j = 0;
     while( j != 20 )
     {
-        result->location_from[j] = ais2ascii( (char) get_6bit( state, 6 ));
+        result->location_from[j] = ais2ascii( (char) sixbit_view_get( state, 6 ));
         j++;
     }
     result->location_from[j] = 0;
@@ -274,22 +284,26 @@ int __stdcall parse_imo1_13( sixbit *state, imo1_13 *result )
     j = 0;
     while( j != 20 )
     {
-        result->location_to[j] = ais2ascii( (char) get_6bit( state, 6 ));
+        result->location_to[j] = ais2ascii( (char) sixbit_view_get( state, 6 ));
         j++;
     }
     result->location_to[j] = 0;
 
-    result->extension   = (int)  get_6bit( state, 10 );
-    result->units       = (char) get_6bit( state, 2 );
-    result->from_day    = (char) get_6bit( state, 5 );
-    result->from_month  = (char) get_6bit( state, 4 );
-    result->from_hour   = (char) get_6bit( state, 5 );
-    result->from_minute = (char) get_6bit( state, 6 );
-    result->to_day      = (char) get_6bit( state, 5 );
-    result->to_month    = (char) get_6bit( state, 4 );
-    result->to_hour     = (char) get_6bit( state, 5 );
-    result->to_minute   = (char) get_6bit( state, 6 );
-    result->spare       = (char) get_6bit( state, 4 );
+    result->extension   = (int)  sixbit_view_get( state, 10 );
+    result->units       = (char) sixbit_view_get( state, 2 );
+    result->from_day    = (char) sixbit_view_get( state, 5 );
+    result->from_month  = (char) sixbit_view_get( state, 4 );
+    result->from_hour   = (char) sixbit_view_get( state, 5 );
+    result->from_minute = (char) sixbit_view_get( state, 6 );
+    result->to_day      = (char) sixbit_view_get( state, 5 );
+    result->to_month    = (char) sixbit_view_get( state, 4 );
+    result->to_hour     = (char) sixbit_view_get( state, 5 );
+    result->to_minute   = (char) sixbit_view_get( state, 6 );
+    result->spare       = (char) sixbit_view_get( state, 4 );
+
+	/* The message was shorter than its fields */
+	if( state->overrun )
+		return 2;
 
 	return 0;
 }
@@ -304,12 +318,13 @@ int __stdcall parse_imo1_13( sixbit *state, imo1_13 *result )
     return
       - return 0 if there was no error
       - return 1 if there was an error
+      - return 2 if there was a length error
 
     This function parses a Meteorological and Hydrological message into
 	a imo1_14 structure
 */
 /* ----------------------------------------------------------------------- */
-int __stdcall parse_imo1_14( sixbit *state, imo1_14 *result )
+int __stdcall parse_imo1_14( sixbit_view *state, imo1_14 *result )
 {
     int length;
     int i;
@@ -319,7 +334,7 @@ int __stdcall parse_imo1_14( sixbit *state, imo1_14 *result )
     if( !result )
         return 1;
 
-	length = sixbit_length(state);
+	length = sixbit_view_length(state);
     if( (length < 0) || (length > 1008) )
         return 2;
 
@@ -328,19 +343,23 @@ int __stdcall parse_imo1_14( sixbit *state, imo1_14 *result )
 
     for( i=0; i<3; i++ )
     {
-	    result->windows[i].latitude      = (long) get_6bit( state, 27 );
-	    result->windows[i].longitude     = (long) get_6bit( state, 28 );
-	    result->windows[i].from_hour     = (char) get_6bit( state, 5 );
-	    result->windows[i].from_minute   = (char) get_6bit( state, 6 );
-	    result->windows[i].to_hour       = (char) get_6bit( state, 5 );
-	    result->windows[i].to_minute     = (char) get_6bit( state, 6 );
-	    result->windows[i].current_dir   = (int) get_6bit( state, 9 );
-	    result->windows[i].current_speed = (char) get_6bit( state, 7 );
+	    result->windows[i].latitude      = (long) sixbit_view_get( state, 27 );
+	    result->windows[i].longitude     = (long) sixbit_view_get( state, 28 );
+	    result->windows[i].from_hour     = (char) sixbit_view_get( state, 5 );
+	    result->windows[i].from_minute   = (char) sixbit_view_get( state, 6 );
+	    result->windows[i].to_hour       = (char) sixbit_view_get( state, 5 );
+	    result->windows[i].to_minute     = (char) sixbit_view_get( state, 6 );
+	    result->windows[i].current_dir   = (int) sixbit_view_get( state, 9 );
+	    result->windows[i].current_speed = (char) sixbit_view_get( state, 7 );
 
    		/* Convert the position to signed value */
    		conv_pos( &result->windows[i].latitude, &result->windows[i].longitude);
 	}
 
+	/* The message was shorter than its fields */
+	if( state->overrun )
+		return 2;
+
 	return 0;
 }
 
@@ -354,12 +373,13 @@ int __stdcall parse_imo1_14( sixbit *state, imo1_14 *result )
     return
       - return 0 if there was no error
       - return 1 if there was an error
+      - return 2 if there was a length error
 
     This function parses a Meteorological and Hydrological message into
 	a imo1_15 structure
 */
 /* ----------------------------------------------------------------------- */
-int __stdcall parse_imo1_15( sixbit *state, imo1_15 *result )
+int __stdcall parse_imo1_15( sixbit_view *state, imo1_15 *result )
 {
     int length;
 
@@ -368,15 +388,19 @@ int __stdcall parse_imo1_15( sixbit *state, imo1_15 *result )
     if( !result )
         return 1;
 
-	length = sixbit_length(state);
+	length = sixbit_view_length(state);
     if( (length < 0) || (length > 1008) )
         return 2;
 
     /* Clear out the structure first */
     memset( result, 0, sizeof( imo1_15 ) );
 
-    result->ais_draught = (int)  get_6bit( state, 11 );
-    result->spare       = (char) get_6bit( state, 5 );
+    result->ais_draught = (int)  sixbit_view_get( state, 11 );
+    result->spare       = (char) sixbit_view_get( state, 5 );
+
+	/* The message was shorter than its fields */
+	if( state->overrun )
+		return 2;
 
 	return 0;
 }
@@ -391,12 +415,13 @@ int __stdcall parse_imo1_15( sixbit *state, imo1_15 *result )
     return
       - return 0 if there was no error
       - return 1 if there was an error
+      - return 2 if there was a length error
 
     This function parses a Meteorological and Hydrological message into
 	a imo1_16 structure
 */
 /* ----------------------------------------------------------------------- */
-int __stdcall parse_imo1_16( sixbit *state, imo1_16 *result )
+int __stdcall parse_imo1_16( sixbit_view *state, imo1_16 *result )
 {
     int length;
 
@@ -405,15 +430,19 @@ int __stdcall parse_imo1_16( sixbit *state, imo1_16 *result )
     if( !result )
         return 1;
 
-	length = sixbit_length(state);
+	length = sixbit_view_length(state);
     if( (length < 0) || (length > 1008) )
         return 2;
 
     /* Clear out the structure first */
     memset( result, 0, sizeof( imo1_16 ) );
 
-    result->num_persons  = (int)  get_6bit( state, 13 );
-    result->spare        = (char) get_6bit( state, 3 );
+    result->num_persons  = (int)  sixbit_view_get( state, 13 );
+    result->spare        = (char) sixbit_view_get( state, 3 );
+
+	/* The message was shorter than its fields */
+	if( state->overrun )
+		return 2;
 
 	return 0;
 }
@@ -428,12 +457,13 @@ int __stdcall parse_imo1_16( sixbit *state, imo1_16 *result )
     return
       - return 0 if there was no error
       - return 1 if there was an error
+      - return 2 if there was a length error
 
     This function parses a Meteorological and Hydrological message into
 	a imo1_16 structure
 */
 /* ----------------------------------------------------------------------- */
-int __stdcall parse_imo1_17( sixbit *state, imo1_17 *result )
+int __stdcall parse_imo1_17( sixbit_view *state, imo1_17 *result )
 {
     int length;
     int i;
@@ -444,7 +474,7 @@ int __stdcall parse_imo1_17( sixbit *state, imo1_17 *result )
     if( !result )
         return 1;
 
-	length = sixbit_length(state);
+	length = sixbit_view_length(state);
     if( (length < 0) || (length > 1008) )
         return 2;
 
@@ -453,23 +483,23 @@ int __stdcall parse_imo1_17( sixbit *state, imo1_17 *result )
 
     for( i=0; i<4; i++ )
     {
-		result->targets[i].type = (char) get_6bit( state, 2 );
+		result->targets[i].type = (char) sixbit_view_get( state, 2 );
 
 		switch(result->targets[i].type)
 		{
 			case 0:	// MMSI
-				get_6bit( state, 12 );
-				result->targets[i].mmsi = (long) get_6bit( state, 30 );
+				sixbit_view_get( state, 12 );
+				result->targets[i].mmsi = (long) sixbit_view_get( state, 30 );
 				break;
 			case 1:	// IMO
-				get_6bit( state, 12 );
-				result->targets[i].imo = (long) get_6bit( state, 30 );
+				sixbit_view_get( state, 12 );
+				result->targets[i].imo = (long) sixbit_view_get( state, 30 );
 				break;
 			case 2:	// Callsign
 				j = 0;
 			    while( j != 7 )
 			    {
-			        result->targets[i].callsign[j] = ais2ascii( (char) get_6bit( state, 6 ));
+			        result->targets[i].callsign[j] = ais2ascii( (char) sixbit_view_get( state, 6 ));
 			        j++;
 			    }
 			    result->targets[i].callsign[j] = 0;
@@ -478,18 +508,18 @@ int __stdcall parse_imo1_17( sixbit *state, imo1_17 *result )
 				j = 0;
 			    while( j != 7 )
 			    {
-			        result->targets[i].other[j] = ais2ascii( (char) get_6bit( state, 6 ));
+			        result->targets[i].other[j] = ais2ascii( (char) sixbit_view_get( state, 6 ));
 			        j++;
 			    }
 			    result->targets[i].other[j] = 0;
 				break;
 		}
-		result->targets[i].spare = (char) get_6bit( state, 4 );
-		result->targets[i].latitude = (long) get_6bit( state, 24 );
-		result->targets[i].longitude = (long) get_6bit( state, 25 );
-		result->targets[i].cog = (int) get_6bit( state, 9 );
-		result->targets[i].timestamp = (char) get_6bit( state, 6 );
-		result->targets[i].sog = (char) get_6bit( state, 8 );
+		result->targets[i].spare = (char) sixbit_view_get( state, 4 );
+		result->targets[i].latitude = (long) sixbit_view_get( state, 24 );
+		result->targets[i].longitude = (long) sixbit_view_get( state, 25 );
+		result->targets[i].cog = (int) sixbit_view_get( state, 9 );
+		result->targets[i].timestamp = (char) sixbit_view_get( state, 6 );
+		result->targets[i].sog = (char) sixbit_view_get( state, 8 );
 
 		/* Convert the position to signed value */
 		result->targets[i].longitude *= 10;
@@ -498,6 +528,10 @@ int __stdcall parse_imo1_17( sixbit *state, imo1_17 *result )
 
 	}
 
+	/* The message was shorter than its fields */
+	if( state->overrun )
+		return 2;
+
 	return 0;
 }
 
@@ -159,11 +159,11 @@ typedef struct {
 } imo1_17;
 
 
-int __stdcall parse_imo1_11( sixbit *state, imo1_11 *result );
-int __stdcall parse_imo1_12( sixbit *state, imo1_12 *result );
-int __stdcall parse_imo1_13( sixbit *state, imo1_13 *result );
-int __stdcall parse_imo1_14( sixbit *state, imo1_14 *result );
-int __stdcall parse_imo1_15( sixbit *state, imo1_15 *result );
-int __stdcall parse_imo1_16( sixbit *state, imo1_16 *result );
-int __stdcall parse_imo1_17( sixbit *state, imo1_17 *result );
+int __stdcall parse_imo1_11( sixbit_view *state, imo1_11 *result );
+int __stdcall parse_imo1_12( sixbit_view *state, imo1_12 *result );
+int __stdcall parse_imo1_13( sixbit_view *state, imo1_13 *result );
+int __stdcall parse_imo1_14( sixbit_view *state, imo1_14 *result );
+int __stdcall parse_imo1_15( sixbit_view *state, imo1_15 *result );
+int __stdcall parse_imo1_16( sixbit_view *state, imo1_16 *result );
+int __stdcall parse_imo1_17( sixbit_view *state, imo1_17 *result );
 
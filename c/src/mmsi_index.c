@@ -0,0 +1,208 @@
+/* -----------------------------------------------------------------------
+   MMSI keyed open addressed hash
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>
+   All rights Reserved
+   ----------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "portable.h"
+#include "mmsi_index.h"
+
+/*! \file
+    \brief MMSI keyed open addressed hash
+    \author Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>, All Rights Reserved
+    \version 1.8
+
+    The vessel table, grid, track store, geofence, thinning and
+    simplification all keep a fixed size array of slots keyed by MMSI.
+    They share the hashing, linear probing and removal here, and keep
+    the slots and the count of vessels in them themselves.
+
+    A table is kept no more than 3/4 full so that a probe ends at an
+    empty slot. Removing a slot moves back the slots after it instead of
+    leaving a tombstone, so lookups never slow down as vessels come and
+    go.
+
+    Example:
+    \code
+    mmsi_index index;
+
+    init_mmsi_index( &index, table->slots, sizeof( ais_vessel ),
+                     sizeof( table->slots->userid ), table->size );
+    i = mmsi_index_slot( &index, userid );
+    if( table->slots[i].userid )
+        mmsi_index_remove( &index, i );
+    \endcode
+*/
+
+
+/* ----------------------------------------------------------------------- */
+/* MMSI in slot i, 0 if it is empty */
+/* ----------------------------------------------------------------------- */
+static unsigned long mmsi_key( mmsi_index *index, unsigned long i )
+{
+    const char *slot;
+
+    slot = (const char *) index->slots + i * index->slot_size;
+    if( index->key_size == sizeof( unsigned int ) )
+        return *(const unsigned int *) slot;
+
+    return *(const unsigned long *) slot;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Number of slots needed for a number of vessels
+
+    \param vessels number of vessels it must be able to hold
+
+    Returns a power of 2 from 16, with vessels no more than 3/4 of it.
+*/
+/* ----------------------------------------------------------------------- */
+unsigned long __stdcall mmsi_index_size( unsigned long vessels )
+{
+    unsigned long size;
+
+    size = 16;
+    while( size - size / 4 < vessels )
+        size *= 2;
+
+    return size;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Describe the slots of a hash
+
+    \param index pointer to the mmsi_index
+    \param slots first slot
+    \param slot_size bytes in a slot
+    \param key_size sizeof the MMSI at the start of each slot
+    \param size number of slots, from mmsi_index_size()
+*/
+/* ----------------------------------------------------------------------- */
+void __stdcall init_mmsi_index( mmsi_index *index, void *slots, size_t slot_size, size_t key_size,
+                                unsigned long size )
+{
+    index->slots = slots;
+    index->slot_size = slot_size;
+    index->key_size = key_size;
+    index->size = size;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Slot a vessel's probe starts at
+
+    \param index pointer to the mmsi_index
+    \param userid MMSI of the vessel
+*/
+/* ----------------------------------------------------------------------- */
+unsigned long __stdcall mmsi_index_home( mmsi_index *index, unsigned long userid )
+{
+    unsigned long h;
+
+    h = (userid & 0xFFFFFFFFUL) * 2654435761UL;
+    h ^= (h & 0xFFFFFFFFUL) >> 16;
+
+    return h & (index->size - 1);
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Find the slot of a vessel
+
+    \param index pointer to the mmsi_index
+    \param userid MMSI of the vessel, not 0
+
+    Returns the vessel's slot, or the empty slot it would go in if it
+    isn't there.
+*/
+/* ----------------------------------------------------------------------- */
+unsigned long __stdcall mmsi_index_slot( mmsi_index *index, unsigned long userid )
+{
+    unsigned long i;
+    unsigned long k;
+
+    for( i = mmsi_index_home( index, userid ); (k = mmsi_key( index, i )) != 0; i = (i + 1) & (index->size - 1) )
+    {
+        if( k == userid )
+            break;
+    }
+
+    return i;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Empty a slot
+
+    \param index pointer to the mmsi_index
+    \param i slot to empty
+
+    The slots after it that would no longer be found past the gap are
+    moved back, so a pointer to a slot is not good after this.
+*/
+/* ----------------------------------------------------------------------- */
+void __stdcall mmsi_index_remove( mmsi_index *index, unsigned long i )
+{
+    char          *slots;
+    unsigned long mask;
+    unsigned long j;
+    unsigned long k;
+    unsigned long key;
+
+    slots = (char *) index->slots;
+    mask = index->size - 1;
+    for( j = (i + 1) & mask; (key = mmsi_key( index, j )) != 0; j = (j + 1) & mask )
+    {
+        /* Leave it if its home is cyclically in (i, j] */
+        k = mmsi_index_home( index, key );
+        if( (i <= j) ? ((i < k) && (k <= j)) : ((i < k) || (k <= j)) )
+            continue;
+
+        memcpy( slots + i * index->slot_size, slots + j * index->slot_size, index->slot_size );
+        i = j;
+    }
+    memset( slots + i * index->slot_size, 0, index->key_size );
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Remove the slots that have expired
+
+    \param index pointer to the mmsi_index
+    \param now current time
+    \param age passed on to expired
+    \param expired called with each slot in use
+
+    Returns the number of slots removed, the caller takes them off its
+    count.
+*/
+/* ----------------------------------------------------------------------- */
+unsigned long __stdcall mmsi_index_expire( mmsi_index *index, unsigned long now, unsigned long age,
+                                           mmsi_expired_cb expired )
+{
+    char          *slots;
+    unsigned long i;
+    unsigned long n;
+
+    slots = (char *) index->slots;
+
+    /* A slot moved back into slot i is checked again */
+    n = 0;
+    i = 0;
+    while( i < index->size )
+    {
+        if( mmsi_key( index, i ) && expired( slots + i * index->slot_size, now, age ) )
+        {
+            mmsi_index_remove( index, i );
+            n++;
+        } else {
+            i++;
+        }
+    }
+
+    return n;
+}
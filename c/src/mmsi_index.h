@@ -0,0 +1,45 @@
+/* -----------------------------------------------------------------------
+   MMSI keyed open addressed hash
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>
+   All rights Reserved
+   ----------------------------------------------------------------------- */
+
+/*! \file
+    \brief Header file for mmsi_index.c
+*/
+
+
+/** Slots of an MMSI keyed hash
+
+    The slots belong to the table using the hash. Each one starts with
+    its MMSI as an unsigned int or unsigned long, 0 for an empty slot.
+    Fill it in with init_mmsi_index() before using it.
+*/
+typedef struct {
+    void            *slots;            //!< size slots of slot_size bytes
+    size_t          slot_size;         //!< Bytes in a slot
+    size_t          key_size;          //!< sizeof the MMSI at the start of a slot
+    unsigned long   size;              //!< Number of slots, a power of 2
+} mmsi_index;
+
+
+/** Slot of a hash from an MMSI to an entry in another array */
+typedef struct {
+    unsigned long   userid;            //!< UserID / MMSI, 0 for an empty slot
+    long            entry;             //!< Entry it is for
+} mmsi_entry;
+
+
+/** Called by mmsi_index_expire(), returns 1 to remove the slot */
+typedef int (__stdcall *mmsi_expired_cb)( void *slot, unsigned long now, unsigned long age );
+
+
+/* Prototypes */
+unsigned long __stdcall mmsi_index_size( unsigned long vessels );
+void __stdcall init_mmsi_index( mmsi_index *index, void *slots, size_t slot_size, size_t key_size,
+                                unsigned long size );
+unsigned long __stdcall mmsi_index_home( mmsi_index *index, unsigned long userid );
+unsigned long __stdcall mmsi_index_slot( mmsi_index *index, unsigned long userid );
+void __stdcall mmsi_index_remove( mmsi_index *index, unsigned long i );
+unsigned long __stdcall mmsi_index_expire( mmsi_index *index, unsigned long now, unsigned long age,
+                                           mmsi_expired_cb expired );
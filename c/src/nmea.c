@@ -10,6 +10,15 @@
 #include "portable.h"
 #include "nmea.h"
 
+#if !defined(NMEA_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) \
+    && (defined(__x86_64__) || defined(__i386__))
+#define NMEA_SIMD
+#include <immintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 /*! \file
     \brief NMEA 0183 Sentence Parser Module
     \author Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>, All Rights Reserved
@@ -22,6 +31,14 @@
     field, convert a field to an integer and copy a field to a destination
     buffer.
 
+    nmea_tokenize() does all of this at once, it records where each field
+    is in a nmea_state structure so that the fields can be used without
+    scanning the sentence again.
+
+    The checksum and the search for delimiters are done by nmea_xor() and
+    nmea_delim_mask(). On x86 CPUs they work on 16 (SSE2) or 32 (AVX2)
+    characters at a time, the best version is picked at runtime.
+
 */
 
 
@@ -343,3 +360,691 @@ unsigned int __stdcall check_nmea_checksum( char *buffer, unsigned char *checksu
 }
 
 
+
+
+/** Characters nmea_tokenize() scans at a time, a multiple of 32 */
+#define NMEA_SCAN_LEN   64
+
+/** Field delimiters and start of sentence characters */
+#define IS_DELIM(c) (((c) == ',') || ((c) == '*') || ((c) == '!') || ((c) == '$'))
+
+
+/* ----------------------------------------------------------------------- */
+/** Scalar XOR kernel
+*/
+/* ----------------------------------------------------------------------- */
+static unsigned char xor_scalar( const char *p, unsigned int len )
+{
+    unsigned char sum = 0;
+
+    while( len-- )
+        sum ^= *p++;
+
+    return sum;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Scalar delimiter kernel, sets the bits for ',' '*' '!' and '$'
+
+    The delimiter kernels also return the XOR of the span, so that
+    nmea_tokenize() gets the checksum from the same pass.
+*/
+/* ----------------------------------------------------------------------- */
+static unsigned char delim_scalar( const char *p, unsigned int len, unsigned int *mask )
+{
+    unsigned char sum = 0;
+    unsigned int  i;
+
+    for( i = 0; i < len; i++ )
+    {
+        sum ^= p[i];
+        if( IS_DELIM( p[i] ) )
+            mask[i >> 5] |= 1U << (i & 31);
+    }
+
+    return sum;
+}
+
+
+#ifdef NMEA_SIMD
+/* ----------------------------------------------------------------------- */
+/** SSE2 XOR kernel, len must be a multiple of 16
+
+    The blocks are XORed together and the 16 bytes that are left are
+    folded in half until there is one byte left.
+*/
+/* ----------------------------------------------------------------------- */
+__attribute__((target("sse2")))
+static unsigned char xor_sse2( const char *p, unsigned int len )
+{
+    __m128i       x = _mm_setzero_si128();
+    unsigned int  i;
+
+    for( i = 0; i < len; i += 16 )
+        x = _mm_xor_si128( x, _mm_loadu_si128( (const __m128i *) (p + i) ) );
+
+    x = _mm_xor_si128( x, _mm_srli_si128( x, 8 ) );
+    x = _mm_xor_si128( x, _mm_srli_si128( x, 4 ) );
+    x = _mm_xor_si128( x, _mm_srli_si128( x, 2 ) );
+    x = _mm_xor_si128( x, _mm_srli_si128( x, 1 ) );
+
+    return (unsigned char) _mm_cvtsi128_si32( x );
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** SSE2 delimiter kernel, len must be a multiple of 16
+*/
+/* ----------------------------------------------------------------------- */
+__attribute__((target("sse2")))
+static unsigned char delim_sse2( const char *p, unsigned int len, unsigned int *mask )
+{
+    const __m128i comma = _mm_set1_epi8( ',' );
+    const __m128i star  = _mm_set1_epi8( '*' );
+    const __m128i bang  = _mm_set1_epi8( '!' );
+    const __m128i cash  = _mm_set1_epi8( '$' );
+    __m128i       x = _mm_setzero_si128();
+    __m128i       c, d;
+    unsigned int  i;
+
+    for( i = 0; i < len; i += 16 )
+    {
+        c = _mm_loadu_si128( (const __m128i *) (p + i) );
+        x = _mm_xor_si128( x, c );
+        d = _mm_or_si128( _mm_or_si128( _mm_cmpeq_epi8( c, comma ), _mm_cmpeq_epi8( c, star ) ),
+                          _mm_or_si128( _mm_cmpeq_epi8( c, bang ), _mm_cmpeq_epi8( c, cash ) ) );
+        mask[i >> 5] |= (unsigned int) _mm_movemask_epi8( d ) << (i & 31);
+    }
+
+    x = _mm_xor_si128( x, _mm_srli_si128( x, 8 ) );
+    x = _mm_xor_si128( x, _mm_srli_si128( x, 4 ) );
+    x = _mm_xor_si128( x, _mm_srli_si128( x, 2 ) );
+    x = _mm_xor_si128( x, _mm_srli_si128( x, 1 ) );
+
+    return (unsigned char) _mm_cvtsi128_si32( x );
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** AVX2 XOR kernel, len must be a multiple of 32
+*/
+/* ----------------------------------------------------------------------- */
+__attribute__((target("avx2")))
+static unsigned char xor_avx2( const char *p, unsigned int len )
+{
+    __m256i       y = _mm256_setzero_si256();
+    __m128i       x;
+    unsigned int  i;
+
+    for( i = 0; i < len; i += 32 )
+        y = _mm256_xor_si256( y, _mm256_loadu_si256( (const __m256i *) (p + i) ) );
+
+    x = _mm_xor_si128( _mm256_castsi256_si128( y ), _mm256_extracti128_si256( y, 1 ) );
+    x = _mm_xor_si128( x, _mm_srli_si128( x, 8 ) );
+    x = _mm_xor_si128( x, _mm_srli_si128( x, 4 ) );
+    x = _mm_xor_si128( x, _mm_srli_si128( x, 2 ) );
+    x = _mm_xor_si128( x, _mm_srli_si128( x, 1 ) );
+
+    return (unsigned char) _mm_cvtsi128_si32( x );
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** AVX2 delimiter kernel, len must be a multiple of 32
+
+    Each block fills a whole mask word.
+*/
+/* ----------------------------------------------------------------------- */
+__attribute__((target("avx2")))
+static unsigned char delim_avx2( const char *p, unsigned int len, unsigned int *mask )
+{
+    const __m256i comma = _mm256_set1_epi8( ',' );
+    const __m256i star  = _mm256_set1_epi8( '*' );
+    const __m256i bang  = _mm256_set1_epi8( '!' );
+    const __m256i cash  = _mm256_set1_epi8( '$' );
+    __m256i       y = _mm256_setzero_si256();
+    __m256i       c, d;
+    __m128i       x;
+    unsigned int  i;
+
+    for( i = 0; i < len; i += 32 )
+    {
+        c = _mm256_loadu_si256( (const __m256i *) (p + i) );
+        y = _mm256_xor_si256( y, c );
+        d = _mm256_or_si256( _mm256_or_si256( _mm256_cmpeq_epi8( c, comma ), _mm256_cmpeq_epi8( c, star ) ),
+                             _mm256_or_si256( _mm256_cmpeq_epi8( c, bang ), _mm256_cmpeq_epi8( c, cash ) ) );
+        mask[i >> 5] = (unsigned int) _mm256_movemask_epi8( d );
+    }
+
+    x = _mm_xor_si128( _mm256_castsi256_si128( y ), _mm256_extracti128_si256( y, 1 ) );
+    x = _mm_xor_si128( x, _mm_srli_si128( x, 8 ) );
+    x = _mm_xor_si128( x, _mm_srli_si128( x, 4 ) );
+    x = _mm_xor_si128( x, _mm_srli_si128( x, 2 ) );
+    x = _mm_xor_si128( x, _mm_srli_si128( x, 1 ) );
+
+    return (unsigned char) _mm_cvtsi128_si32( x );
+}
+
+
+/** The kernels of one level and the number of characters they handle at a time */
+typedef struct {
+    unsigned char   (*xor_sum)( const char *, unsigned int );
+    unsigned char   (*delim)( const char *, unsigned int, unsigned int * );
+    unsigned int    block;
+} nmea_kernels;
+
+static const nmea_kernels simd_kernels[3] = {
+    { xor_scalar, delim_scalar, 1 },
+    { xor_sse2,   delim_sse2,   16 },
+    { xor_avx2,   delim_avx2,   32 }
+};
+
+/** Kernels selected by nmea_simd(), NULL until the first call
+
+    They are switched together with their block size through this one
+    pointer, so a thread that is scanning while another one picks the
+    kernels never sees the kernels of one level with the block size of
+    another.
+*/
+static const nmea_kernels * volatile kernels = NULL;
+#endif
+
+
+/* ----------------------------------------------------------------------- */
+/** Select the checksum and delimiter kernels
+
+    \param level highest instruction set to use, 0 = scalar, 1 = SSE2,
+                 2 = AVX2
+
+    returns:
+      - the level actually in use
+
+    The kernels are normally picked automatically the first time they
+    are needed, using the best ones the CPU supports. This can be used
+    to limit them, eg. for benchmarking the scalar code. It is safe to
+    call while other threads are scanning, they switch to the new
+    kernels on their next call.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall nmea_simd( int level )
+{
+#ifdef NMEA_SIMD
+    __builtin_cpu_init();
+    if( (level >= 2) && __builtin_cpu_supports( "avx2" ) )
+        level = 2;
+    else if( (level >= 1) && __builtin_cpu_supports( "sse2" ) )
+        level = 1;
+    else
+        level = 0;
+    kernels = &simd_kernels[level];
+    return level;
+#else
+    return 0;
+#endif
+}
+
+
+#ifdef NMEA_SIMD
+/* ----------------------------------------------------------------------- */
+/* The kernels in use, picking them on the first call */
+/* ----------------------------------------------------------------------- */
+static const nmea_kernels *get_kernels( void )
+{
+    const nmea_kernels *k;
+
+    /* Read the selection once, the block size must match the kernels */
+    if( (k = kernels) == NULL )
+    {
+        nmea_simd( 2 );
+        k = kernels;
+    }
+    return k;
+}
+#endif
+
+
+/* ----------------------------------------------------------------------- */
+/** XOR a span of characters together
+
+    \param p pointer to the first character
+    \param len number of characters
+
+    Returns:
+      - the XOR of all of the characters
+
+    This is the NMEA 0183 checksum when p points just after the '!' or '$'
+    and len stops just before the '*'. Whole 16 or 32 byte blocks are
+    done by the kernel picked by nmea_simd(), the rest one at a time.
+
+    Example:
+    \code
+    char *s = "!AIVDM,1,1,,A,15N;<J0P00Jro1<H>bAP0?vL00Rb,0*1B";
+
+    nmea_xor( s+1, strchr( s, '*' ) - (s+1) ) == 0x1B
+    \endcode
+*/
+/* ----------------------------------------------------------------------- */
+unsigned char __stdcall nmea_xor( const char *p, unsigned int len )
+{
+    unsigned int  bulk = 0;
+    unsigned char sum = 0;
+#ifdef NMEA_SIMD
+    const nmea_kernels *k;
+#endif
+
+    if( !p )
+        return 0;
+
+#ifdef NMEA_SIMD
+    k = get_kernels();
+    bulk = len - (len % k->block);
+    sum = k->xor_sum( p, bulk );
+#endif
+
+    return sum ^ xor_scalar( p + bulk, len - bulk );
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Find the delimiters in a span and return its XOR, len is up to
+   NMEA_MASK_WORDS * 32
+*/
+/* ----------------------------------------------------------------------- */
+static unsigned char delim_scan( const char *p, unsigned int len, unsigned int *mask )
+{
+    unsigned int  bulk = 0;
+    unsigned char sum = 0;
+#ifdef NMEA_SIMD
+    const nmea_kernels *k;
+#endif
+
+    memset( mask, 0, ((len + 31) / 32) * sizeof( unsigned int ) );
+
+#ifdef NMEA_SIMD
+    k = get_kernels();
+    bulk = len - (len % k->block);
+    sum = k->delim( p, bulk, mask );
+#endif
+
+    /* Bits are ORed in, so the tail can start part way through a word */
+    while( bulk < len )
+    {
+        sum ^= p[bulk];
+        if( IS_DELIM( p[bulk] ) )
+            mask[bulk >> 5] |= 1U << (bulk & 31);
+        bulk++;
+    }
+
+    return sum;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Find the delimiters in a span of characters
+
+    \param p pointer to the first character
+    \param len number of characters, up to NMEA_MASK_WORDS * 32
+    \param mask pointer to NMEA_MASK_WORDS words to hold the result
+
+    Returns:
+      - 0 if no error
+      - 1 if there was an error
+
+    Bit (i & 31) of mask[i / 32] is set if p[i] is a ',' or a '*' field
+    delimiter, or a '!' or '$' start of sentence. Bits past len are 0.
+
+    Example:
+    \code
+    unsigned int mask[NMEA_MASK_WORDS];
+
+    nmea_delim_mask( "!AIVDM,1,1,,A,15N;<J0P00Jro1<H>bAP0?vL00Rb,0*1B", 48, mask );
+
+    mask[0] == 0x00002D41, mask[1] == 0x00001400
+    \endcode
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall nmea_delim_mask( const char *p, unsigned int len, unsigned int *mask )
+{
+    if( !p || !mask || (len > NMEA_MASK_WORDS * 32) )
+        return 1;
+
+    memset( mask, 0, NMEA_MASK_WORDS * sizeof( unsigned int ) );
+    delim_scan( p, len, mask );
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Return the index of the lowest set bit, m must not be 0
+*/
+/* ----------------------------------------------------------------------- */
+static unsigned int lowest_bit( unsigned int m )
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned int) __builtin_ctz( m );
+#elif defined(_MSC_VER)
+    unsigned long i;
+
+    _BitScanForward( &i, m );
+    return (unsigned int) i;
+#else
+    unsigned int i = 0;
+
+    while( !(m & 1) )
+    {
+        m >>= 1;
+        i++;
+    }
+    return i;
+#endif
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Store one key:value part of a tag block
+
+    \param tag pointer to the tag structure
+    \param p pointer to the key
+    \param end pointer to the character after the value
+*/
+/* ----------------------------------------------------------------------- */
+static void tag_field( nmea_tag *tag, char *p, char *end )
+{
+    unsigned long *group[3];
+    unsigned long num;
+    unsigned long total;
+    unsigned int  i;
+    unsigned int  digits;
+
+    if( (end - p < 2) || (*(p+1) != ':') )
+        return;
+
+    switch( *p )
+    {
+        case 's':
+            p += 2;
+            for( i = 0; (p < end) && (i < NMEA_TAG_SOURCE_LEN - 1); i++ )
+                tag->source[i] = *p++;
+            tag->source[i] = 0;
+            tag->flags |= NMEA_TAG_SOURCE;
+            break;
+
+        case 'c':
+            /* Some stations send milliseconds, only the first 10 digits
+               are seconds. Anything that isn't all digits is ignored.
+            */
+            tag->time = 0;
+            for( p += 2, digits = 0; (p < end) && (*p >= '0') && (*p <= '9'); p++, digits++ )
+            {
+                if( digits < 10 )
+                    tag->time = (tag->time * 10) + (*p - '0');
+            }
+            if( (p < end) || !digits )
+            {
+                tag->time = 0;
+                break;
+            }
+            tag->flags |= NMEA_TAG_TIME;
+            break;
+
+        case 'n':
+            tag->line = nmea_uint( p+2 );
+            tag->flags |= NMEA_TAG_LINE;
+            break;
+
+        case 'g':
+            /* g:num-total-id */
+            group[0] = &num;
+            group[1] = &total;
+            group[2] = &tag->group_id;
+            for( p += 2, i = 0; i < 3; i++ )
+            {
+                *group[i] = 0;
+                while( (p < end) && (*p >= '0') && (*p <= '9') )
+                    *group[i] = (*group[i] * 10) + (*p++ - '0');
+                if( (p < end) && (*p == '-') )
+                    p++;
+            }
+            tag->group_num = (unsigned int) num;
+            tag->group_total = (unsigned int) total;
+            tag->flags |= NMEA_TAG_GROUP;
+            break;
+    }
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Parse a NMEA 4.0 tag block
+
+    \param tag pointer to a nmea_tag structure to fill in
+    \param p pointer to the character after the opening '\\'
+
+    Returns:
+      - pointer to the character after the closing '\\'
+
+    The comma separated parts of the tag block are stored as they are
+    found and the tag block's own checksum is calculated at the same
+    time. The source (s:), UNIX time (c:), line count (n:) and group (g:)
+    are kept, anything else is skipped. If the checksum is missing or
+    does not match the parts are thrown away and only NMEA_TAG_BADSUM
+    is set in tag->flags.
+
+    Example:
+    \code
+    nmea_tag tag;
+    char     buf[255];
+    char     *p;
+
+    strcpy( buf, "\\s:ASM//Port=63//MMSI=2573225,c:1301961602*7A\\!BSVDM,..." );
+    p = nmea_parse_tag( &tag, buf+1 );
+
+    tag.flags == NMEA_TAG_SOURCE | NMEA_TAG_TIME
+    tag.source == "ASM//Port=63//MMSI=2573225"
+    tag.time == 1301961602
+    *p == '!'
+    \endcode
+*/
+/* ----------------------------------------------------------------------- */
+char * __stdcall nmea_parse_tag( nmea_tag *tag, char *p )
+{
+    char          *f;
+    unsigned char sum;
+
+    tag->flags = 0;
+
+    f = p;
+    sum = 0;
+    while( (*p != 0) && (*p != '*') && (*p != '\\') )
+    {
+        if( *p == ',' )
+        {
+            tag_field( tag, f, p );
+            f = p + 1;
+        }
+        sum ^= *p;
+        p++;
+    }
+    tag_field( tag, f, p );
+
+    if(    (*p != '*')
+        || !isxdigit( (unsigned char) *(p+1) ) || !isxdigit( (unsigned char) *(p+2) )
+        || (((ahextobin( p+1 ) << 4) | ahextobin( p+2 )) != sum) )
+    {
+        tag->flags = NMEA_TAG_BADSUM;
+    }
+
+    /* Skip to the end of the tag block */
+    while( (*p != 0) && (*p != '\\') && (*p != '!') && (*p != '$') )
+        p++;
+    if( *p == '\\' )
+        p++;
+
+    return p;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Add the tag block parts of one sentence to a message's tag
+
+    \param tag pointer to the message's tag
+    \param part pointer to the tag of the sentence being added
+
+    Multipart messages usually only have the source and time on the
+    first sentence, so parts already found are kept.
+*/
+/* ----------------------------------------------------------------------- */
+void __stdcall nmea_merge_tag( nmea_tag *tag, nmea_tag *part )
+{
+    unsigned char  add;
+
+    add = part->flags & ~tag->flags;
+    if( add & NMEA_TAG_SOURCE )
+        memcpy( tag->source, part->source, sizeof( tag->source ) );
+    if( add & NMEA_TAG_TIME )
+        tag->time = part->time;
+    if( add & NMEA_TAG_LINE )
+        tag->line = part->line;
+    if( add & NMEA_TAG_GROUP )
+    {
+        tag->group_num   = part->group_num;
+        tag->group_total = part->group_total;
+        tag->group_id    = part->group_id;
+    }
+    tag->flags |= add;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Split a NMEA 0183 sentence into fields and check its checksum
+
+    \param state pointer to a nmea_state structure to fill in
+    \param buffer pointer to a 0 terminated buffer
+
+    Returns:
+        - 0 if the checksum matches
+        - 1 if the checksum does not match or is missing
+        - 2 if there was an error
+
+    This finds the start of the sentence, calculates the checksum and
+    records the position and length of each field. A NMEA 4.0 tag block
+    in front of the sentence is parsed into state->tag by nmea_parse_tag()
+    while looking for the start of the sentence. The delimiters and the
+    checksum are found together by the nmea_delim_mask() kernels, so the
+    sentence is scanned once, a block at a time instead of a character
+    at a time. The scan stops at the block holding the '*', the rest of
+    the line is not looked at.
+    The fields are filled in even if the checksum does not match. If no
+    start character is found num_fields is 0. The field pointers point
+    into buffer, it must not be changed while they are in use.
+
+    Example:
+    \code
+    nmea_state  nmea;
+
+    nmea_tokenize( &nmea, "!AIVDM,1,1,,A,15N;<J0P00Jro1<H>bAP0?vL00Rb,0*1B\n" );
+
+    nmea.num_fields == 7
+    nmea.field[5] == "15N;<J0P00Jro1<H>bAP0?vL00Rb,0*1B\n"
+    nmea.field_len[5] == 28
+    nmea.checksum == 0x1B
+    \endcode
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall nmea_tokenize( nmea_state *state, char *buffer )
+{
+    unsigned int    mask[NMEA_MASK_WORDS];
+    char            *p;
+    char            *f;
+    char            *end;
+    char            *d;
+    char            *z;
+    unsigned int    chunk;
+    unsigned int    base;
+    unsigned int    w;
+    unsigned int    n;
+    unsigned char   sum;
+
+    if( !state )
+        return 2;
+    state->num_fields = 0;
+    if( !buffer )
+        return 2;
+
+    /* Find start of sentence, after a '!' or '$', picking up any tag
+       block on the way
+    */
+    state->tag.flags = 0;
+    p = buffer;
+    while( (*p != 0) && (*p != '!') && (*p != '$') )
+    {
+        if( *p == '\\' )
+            p = nmea_parse_tag( &state->tag, p+1 );
+        else
+            p++;
+    }
+    if( *p == 0 )
+        return 2;
+    p++;
+
+    /* Walk the delimiters a block at a time until the '*' or a new start,
+       the checksum is worked out in the same pass. memchr() stops at the
+       end of the string, so nothing past it is read.
+    */
+    f = p;
+    n = 0;
+    end = NULL;
+    sum = 0;
+    for( base = 0, chunk = NMEA_SCAN_LEN; !end && (chunk == NMEA_SCAN_LEN); base += chunk )
+    {
+        z = memchr( p + base, 0, NMEA_SCAN_LEN );
+        chunk = z ? (unsigned int) (z - (p + base)) : NMEA_SCAN_LEN;
+        sum ^= delim_scan( p + base, chunk, mask );
+
+        for( w = 0; (w * 32 < chunk) && !end; w++ )
+        {
+            while( mask[w] )
+            {
+                d = p + base + (w * 32) + lowest_bit( mask[w] );
+                mask[w] &= mask[w] - 1;
+
+                if( *d != ',' )
+                {
+                    end = d;
+                    break;
+                }
+                if( n == MAX_NMEA_FIELDS - 1 )
+                    return 2;
+                state->field[n] = f;
+                state->field_len[n] = (unsigned short) (d - f);
+                n++;
+                f = d + 1;
+            }
+        }
+    }
+
+    /* Take out the characters scanned from the '*' on */
+    if( end )
+        sum ^= xor_scalar( end, (unsigned int) ((p + base) - end) );
+    else
+        end = p + base;
+
+    /* The last field ends at the '*' */
+    state->field[n] = f;
+    state->field_len[n] = (unsigned short) (end - f);
+    state->num_fields = n + 1;
+    state->checksum = sum;
+
+    if( *end != '*' )
+        return 2;
+
+    /* Make sure there is a checksum to check */
+    if( !isxdigit( (unsigned char) *(end+1) ) || !isxdigit( (unsigned char) *(end+2) ) )
+        return 1;
+
+    if( ((ahextobin( end+1 ) << 4) | ahextobin( end+2 )) != state->checksum )
+        return 1;
+
+    return 0;
+}
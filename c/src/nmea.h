@@ -13,16 +13,54 @@
 
 #define MAX_NMEA_LENGTH  255
 #define MAX_NMEA_FIELDS  50
+
+/** Number of 32 bit words in a delimiter mask, one bit per character */
+#define NMEA_MASK_WORDS  ((MAX_NMEA_LENGTH + 31) / 32)
 #define START  0
 #define END    1
 #define DONE   2
 
 
+/** NMEA 4.0 tag block flags, set for each part of the tag block found */
+#define NMEA_TAG_SOURCE  0x01
+#define NMEA_TAG_TIME    0x02
+#define NMEA_TAG_LINE    0x04
+#define NMEA_TAG_GROUP   0x08
+#define NMEA_TAG_BADSUM  0x80
+
+#define NMEA_TAG_SOURCE_LEN  32
+
+
+/** NMEA 4.0 tag block metadata
+
+    Only the parts listed in flags are valid. If the tag block checksum
+    does not match only NMEA_TAG_BADSUM is set.
+*/
+typedef struct {
+    unsigned char  flags;                      //!< NMEA_TAG_* flags
+    char           source[NMEA_TAG_SOURCE_LEN]; //!< s: Source station
+    unsigned long  time;                       //!< c: UNIX time in seconds
+    unsigned long  line;                       //!< n: Line count
+    unsigned int   group_num;                  //!< g: Sentence number in the group
+    unsigned int   group_total;                //!< g: Number of sentences in the group
+    unsigned long  group_id;                   //!< g: Group id
+} nmea_tag;
+
+
 /** NMEA parser state structure
+
+    nmea_tokenize() fills in the fields, checksum and num_fields. field[0]
+    is the address field, eg. AIVDM, without the start character and the
+    last field ends at the '*'. The pointers point into the buffer that
+    was tokenized, not into str.
 */
 typedef struct {
     unsigned char  search;                     //!< State of the search: START, END or DONE
     char           *field[MAX_NMEA_FIELDS];    //!< Pointers to fields in the buffer
+    unsigned short field_len[MAX_NMEA_FIELDS]; //!< Number of characters in each field
+    unsigned int   num_fields;                 //!< Number of fields found
+    unsigned char  checksum;                   //!< Calculated checksum
+    nmea_tag       tag;                        //!< Tag block in front of the sentence
     char           str[MAX_NMEA_LENGTH];       //!< Incoming NMEA 0183 string
     unsigned long  str_len;                    //!< Number of bytes in str
 } nmea_state;
@@ -36,3 +74,9 @@ char __stdcall ahextobin( char *c );
 char * __stdcall nmea_next_field( char *p );
 unsigned int __stdcall nmea_uint( char *p );
 char * __stdcall nmea_copy_field( char *dest, char *src, int len );
+int __stdcall nmea_simd( int level );
+unsigned char __stdcall nmea_xor( const char *p, unsigned int len );
+int __stdcall nmea_delim_mask( const char *p, unsigned int len, unsigned int *mask );
+char * __stdcall nmea_parse_tag( nmea_tag *tag, char *p );
+void __stdcall nmea_merge_tag( nmea_tag *tag, nmea_tag *part );
+int __stdcall nmea_tokenize( nmea_state *state, char *buffer );
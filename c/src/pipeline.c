@@ -0,0 +1,754 @@
+/* -----------------------------------------------------------------------
+   Reader / decoder / serializer pipeline
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>
+   All rights Reserved
+   ----------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include "portable.h"
+#include "nmea.h"
+#include "sixbit.h"
+#include "vdm_parse.h"
+#include "reassembly.h"
+#include "batch.h"
+#include "pipeline.h"
+
+/*! \file
+    \brief Reader / decoder / serializer pipeline
+    \author Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>, All Rights Reserved
+    \version 1.8
+
+    A live feed is usually handled in one loop that reads a line, calls
+    assemble_vdm(), parses the message and writes it out. The pipeline
+    splits that loop into 3 stages so that they can overlap:
+
+      - The reader is the thread calling ais_pipeline_push() or
+        ais_pipeline_read(). It copies each line into the ring of one
+        of the workers.
+      - Each worker thread tokenizes its lines, puts multipart messages
+        together in its own reassembly table and parses them into
+        ais_records, which go into its ring to the serializer.
+      - The serializer thread takes the records from all of the workers
+        and calls the pipeline's callback with them, eg. to write JSON.
+        The callback is only ever called from this thread.
+
+    The parts of a multipart message are routed to a worker by a hash
+    of the talker, sequence id and channel, and of the g: group id when
+    the tag block has one, so they all go to the same worker even when
+    only the first part has an s: tag. Other sentences are spread over
+    all of the workers by a hash of their payload. Messages from
+    different workers may be passed to the callback in any order.
+
+    The stages are joined by ais_ring, a bounded single producer, single
+    consumer ring that needs no locks. When a ring is full the stage
+    filling it waits for room, which holds back the stages in front of
+    it, and counts a stall. With ais_pipeline.drop set the line or
+    message is dropped and counted instead, so a slow consumer never
+    holds up the reader.
+
+    The threads are POSIX threads, so this file is only built on POSIX
+    systems and is left out of the Windows DLL. On Windows decode logs
+    with ais_decode_archive(), which uses one thread there.
+
+    Example:
+    \code
+    void __stdcall write_json( ais_record *record, void *data )
+    {
+        printf( "{ \"msgid\": %d }\n", record->msg.msgid );
+    }
+
+    ais_pipeline pipeline;
+
+    init_ais_pipeline( &pipeline, write_json, NULL );
+    pipeline.workers = 4;
+    ais_pipeline_start( &pipeline );
+    ais_pipeline_read( &pipeline, stdin );
+    ais_pipeline_finish( &pipeline );
+    \endcode
+*/
+
+
+/** A line on its way to a worker */
+typedef struct {
+    unsigned long  line;               /* Number of the line, from 0 */
+    char           str[MAX_NMEA_LENGTH];
+} pipeline_line;
+
+
+/** A message on its way to the serializer */
+typedef struct {
+    ais_record     record;
+    sixbit         payload;            /* Binary data of messages 6, 8 and 17 */
+} pipeline_msg;
+
+
+/** Arguments for a worker thread */
+typedef struct {
+    ais_pipeline   *pipeline;
+    unsigned int   index;
+} pipeline_arg;
+
+
+/** Threads of a running pipeline */
+typedef struct {
+    pthread_t      worker[AIS_PIPELINE_WORKERS];
+    pipeline_arg   arg[AIS_PIPELINE_WORKERS];
+    pthread_t      serializer;
+    unsigned int   started;            /* Worker threads started */
+    int            serializer_started;
+    unsigned int   finished;           /* Worker threads that have finished */
+} pipeline_threads;
+
+
+/* ----------------------------------------------------------------------- */
+/** Initialize a ring
+
+    \param ring pointer to the ring
+    \param size number of slots, a power of 2
+    \param slot_size number of bytes in each slot
+
+    returns:
+      - 0 if no error
+      - 1 if there was an error with the parameters
+      - 2 if the slots could not be allocated
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall init_ais_ring( ais_ring *ring, unsigned long size, size_t slot_size )
+{
+    if( !ring || !size || (size & (size - 1)) || !slot_size )
+        return 1;
+
+    memset( ring, 0, sizeof( ais_ring ) );
+    ring->slots = malloc( size * slot_size );
+    if( !ring->slots )
+        return 2;
+    ring->size = size;
+    ring->slot_size = slot_size;
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Free the slots of a ring
+
+    \param ring pointer to the ring
+*/
+/* ----------------------------------------------------------------------- */
+void __stdcall free_ais_ring( ais_ring *ring )
+{
+    if( !ring )
+        return;
+
+    free( ring->slots );
+    ring->slots = NULL;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Get the next free slot of a ring, producer only
+
+    \param ring pointer to the ring
+
+    Returns a pointer to the slot or NULL if the ring is full. Fill it in
+    and then call ais_ring_publish() to pass it to the consumer.
+*/
+/* ----------------------------------------------------------------------- */
+void * __stdcall ais_ring_claim( ais_ring *ring )
+{
+    unsigned long tail;
+
+    tail = __atomic_load_n( &ring->tail, __ATOMIC_ACQUIRE );
+    if( ring->head - tail >= ring->size )
+        return NULL;
+
+    return ring->slots + (ring->head & (ring->size - 1)) * ring->slot_size;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Pass the slot from ais_ring_claim() to the consumer, producer only
+
+    \param ring pointer to the ring
+*/
+/* ----------------------------------------------------------------------- */
+void __stdcall ais_ring_publish( ais_ring *ring )
+{
+    __atomic_store_n( &ring->head, ring->head + 1, __ATOMIC_RELEASE );
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Get the oldest slot of a ring, consumer only
+
+    \param ring pointer to the ring
+
+    Returns a pointer to the slot or NULL if the ring is empty. Call
+    ais_ring_release() when done with it.
+*/
+/* ----------------------------------------------------------------------- */
+void * __stdcall ais_ring_peek( ais_ring *ring )
+{
+    unsigned long head;
+
+    head = __atomic_load_n( &ring->head, __ATOMIC_ACQUIRE );
+    if( head == ring->tail )
+        return NULL;
+
+    return ring->slots + (ring->tail & (ring->size - 1)) * ring->slot_size;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Give the slot from ais_ring_peek() back to the producer, consumer only
+
+    \param ring pointer to the ring
+*/
+/* ----------------------------------------------------------------------- */
+void __stdcall ais_ring_release( ais_ring *ring )
+{
+    __atomic_store_n( &ring->tail, ring->tail + 1, __ATOMIC_RELEASE );
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Number of slots in use
+
+    \param ring pointer to the ring
+
+    Only a snapshot when the other thread is running.
+*/
+/* ----------------------------------------------------------------------- */
+unsigned long __stdcall ais_ring_count( ais_ring *ring )
+{
+    return __atomic_load_n( &ring->head, __ATOMIC_ACQUIRE )
+         - __atomic_load_n( &ring->tail, __ATOMIC_ACQUIRE );
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Wait a little for another stage, yield first and then sleep */
+/* ----------------------------------------------------------------------- */
+static void pipeline_wait( unsigned int *spins )
+{
+    struct timespec ts;
+
+    if( ++(*spins) < 64 )
+    {
+        sched_yield();
+    } else {
+        ts.tv_sec = 0;
+        ts.tv_nsec = 100000;
+        nanosleep( &ts, NULL );
+    }
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Hash a field of a raw line, up to the end of the field */
+/* ----------------------------------------------------------------------- */
+static unsigned long pipeline_hash( unsigned long h, const char *p )
+{
+    for( ; *p && (*p != ',') && (*p != '*') && (*p != '\\'); p++ )
+        h = (h ^ (unsigned char) *p) * 16777619UL;
+
+    return h;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Hash a raw line to pick its worker
+   The parts of a multipart message hash the talker, sequence id and
+   channel, and the group id of a g: tag when there is one, so they all
+   go to the same worker even when only the first part has an s: tag.
+   Other sentences hash the rest of the line from the channel on, so
+   they are spread over all of the workers.
+*/
+/* ----------------------------------------------------------------------- */
+static unsigned long pipeline_route( const char *line )
+{
+    unsigned long  h = 2166136261UL;
+    const char     *p;
+    const char     *group;
+    const char     *field[5];
+    int            n;
+
+    p = line;
+    group = NULL;
+    if( *p == '\\' )
+    {
+        for( p++; *p && (*p != '\\'); p++ )
+        {
+            /* g:part-total-id, only the id is the same in each part */
+            if( (p[0] == 'g') && (p[1] == ':') && ((p[-1] == '\\') || (p[-1] == ',')) )
+            {
+                for( group = p + 2, n = 0; *group && (n < 2); group++ )
+                {
+                    if( *group == '-' )
+                        n++;
+                    else if( (*group == ',') || (*group == '*') || (*group == '\\') )
+                        break;
+                }
+                if( n < 2 )
+                    group = NULL;
+            }
+        }
+    }
+
+    while( *p && (*p != '!') && (*p != '$') )
+        p++;
+
+    /* Address, total, part, sequence id and channel */
+    field[0] = p;
+    for( n = 1; *p && (n < 5); p++ )
+    {
+        if( *p == ',' )
+            field[n++] = p + 1;
+    }
+    if( n < 5 )
+        p = line;
+
+    if( (field[1][0] >= '2') && (field[1][0] <= '9') && (field[1][1] == ',') )
+    {
+        h = pipeline_hash( h, field[0] );
+        h = pipeline_hash( h, field[3] );
+        h = pipeline_hash( h, field[4] );
+        if( group )
+            h = pipeline_hash( h, group );
+        return h;
+    }
+
+    for( ; *p; p++ )
+        h = (h ^ (unsigned char) *p) * 16777619UL;
+
+    return h;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* The binary payload of a record, NULL if it doesn't have one */
+/* ----------------------------------------------------------------------- */
+static sixbit_view *pipeline_data( ais_record *r )
+{
+    switch( r->msg.msgid )
+    {
+        case 6:
+            return &r->msg.u.msg_6.data;
+        case 8:
+            return &r->msg.u.msg_8.data;
+        case 17:
+            return &r->msg.u.msg_17.data;
+    }
+    return NULL;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Parse a completed message and pass it to the serializer */
+/* ----------------------------------------------------------------------- */
+static void pipeline_emit( ais_pipeline *pipeline, ais_pipeline_worker *w, ais_state *state, unsigned long line )
+{
+    pipeline_msg  *msg;
+    sixbit_view   *data;
+    unsigned int  spins;
+    int           stalled;
+
+    spins = 0;
+    stalled = 0;
+    while( (msg = ais_ring_claim( &w->out )) == NULL )
+    {
+        if( pipeline->drop )
+        {
+            w->dropped++;
+            return;
+        }
+        if( !stalled )
+        {
+            w->stalls++;
+            stalled = 1;
+        }
+        pipeline_wait( &spins );
+    }
+
+    msg->record.msg.msgid = 0;
+    if( parse_ais_any( state, &msg->record.msg ) != 0 )
+    {
+        w->errors++;
+        return;
+    }
+    msg->record.offset = line;
+    msg->record.channel = state->channel;
+    msg->record.tag = state->tag;
+
+    data = pipeline_data( &msg->record );
+    if( data )
+    {
+        msg->payload = state->six_state;
+        data->six = &msg->payload;
+    }
+
+    ais_ring_publish( &w->out );
+    w->records++;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Decoding thread, runs until the reader is done and its ring is empty */
+/* ----------------------------------------------------------------------- */
+static void *pipeline_worker( void *arg )
+{
+    ais_pipeline        *pipeline;
+    ais_pipeline_worker *w;
+    pipeline_threads    *threads;
+    pipeline_line       *line;
+    reasm_table         reasm;
+    ais_state           state;
+    nmea_state          nmea;
+    unsigned int        spins;
+    int                 rv;
+
+    pipeline = ((pipeline_arg *) arg)->pipeline;
+    w = &pipeline->worker[((pipeline_arg *) arg)->index];
+    threads = (pipeline_threads *) pipeline->threads;
+
+    memset( &state, 0, sizeof( state ) );
+    init_reasm( &reasm, pipeline->timeout );
+
+    spins = 0;
+    for( ;; )
+    {
+        line = ais_ring_peek( &w->in );
+        if( !line )
+        {
+            if( __atomic_load_n( &pipeline->done, __ATOMIC_ACQUIRE ) && !ais_ring_peek( &w->in ) )
+                break;
+            pipeline_wait( &spins );
+            continue;
+        }
+        spins = 0;
+
+        w->sentences++;
+        rv = nmea_tokenize( &nmea, line->str );
+        if( is_vdm( &nmea ) )
+        {
+            if( rv != 0 )
+            {
+                w->errors++;
+            } else {
+                rv = reasm_vdm_tokens( &reasm, &state, &nmea, w->sentences );
+                if( rv == 0 )
+                    pipeline_emit( pipeline, w, &state, line->line );
+                else if( rv != 1 )
+                    w->errors++;
+            }
+        }
+        ais_ring_release( &w->in );
+    }
+
+    __atomic_add_fetch( &threads->finished, 1, __ATOMIC_RELEASE );
+    return NULL;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Serializer thread, calls the callback with the workers' messages */
+/* ----------------------------------------------------------------------- */
+static void *pipeline_serializer( void *arg )
+{
+    ais_pipeline      *pipeline;
+    pipeline_threads  *threads;
+    pipeline_msg      *msg;
+    unsigned int      spins;
+    unsigned int      found;
+    unsigned int      finished;
+    unsigned int      i;
+    unsigned int      n;
+
+    pipeline = (ais_pipeline *) arg;
+    threads = (pipeline_threads *) pipeline->threads;
+
+    spins = 0;
+    for( ;; )
+    {
+        /* Anything published before a worker finished is seen below */
+        finished = __atomic_load_n( &threads->finished, __ATOMIC_ACQUIRE );
+
+        found = 0;
+        for( i = 0; i < pipeline->workers; i++ )
+        {
+            for( n = 0; (n < 64) && ((msg = ais_ring_peek( &pipeline->worker[i].out )) != NULL); n++ )
+            {
+                pipeline->callback( &msg->record, pipeline->data );
+                ais_ring_release( &pipeline->worker[i].out );
+                pipeline->records++;
+            }
+            found += n;
+        }
+
+        if( found )
+        {
+            spins = 0;
+            continue;
+        }
+        if( finished == threads->started )
+            break;
+        pipeline_wait( &spins );
+    }
+
+    return NULL;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Initialize a pipeline
+
+    \param pipeline pointer to the pipeline
+    \param callback function to call with each decoded message
+    \param data pointer passed to callback
+
+    returns:
+      - 0 if no error
+      - 1 if there was an error
+
+    It is set up to use 2 workers, rings of #AIS_PIPELINE_RING slots, no
+    timeout and to wait when a ring is full.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall init_ais_pipeline( ais_pipeline *pipeline, ais_pipeline_cb callback, void *data )
+{
+    if( !pipeline || !callback )
+        return 1;
+
+    memset( pipeline, 0, sizeof( ais_pipeline ) );
+    pipeline->workers = 2;
+    pipeline->ring_size = AIS_PIPELINE_RING;
+    pipeline->callback = callback;
+    pipeline->data = data;
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Start the worker and serializer threads
+
+    \param pipeline pointer to the pipeline
+
+    returns:
+      - 0 if no error
+      - 1 if there was an error with the settings
+      - 2 if memory or a thread could not be had
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall ais_pipeline_start( ais_pipeline *pipeline )
+{
+    pipeline_threads  *threads;
+    unsigned int      i;
+    int               rv;
+
+    if( !pipeline || pipeline->threads || (pipeline->workers < 1)
+        || (pipeline->workers > AIS_PIPELINE_WORKERS) )
+        return 1;
+
+    for( i = 0; i < pipeline->workers; i++ )
+    {
+        rv = init_ais_ring( &pipeline->worker[i].in, pipeline->ring_size, sizeof( pipeline_line ) );
+        if( rv == 0 )
+        {
+            rv = init_ais_ring( &pipeline->worker[i].out, pipeline->ring_size, sizeof( pipeline_msg ) );
+            if( rv != 0 )
+                free_ais_ring( &pipeline->worker[i].in );
+        }
+        if( rv != 0 )
+        {
+            while( i-- )
+            {
+                free_ais_ring( &pipeline->worker[i].in );
+                free_ais_ring( &pipeline->worker[i].out );
+            }
+            return rv;
+        }
+    }
+
+    threads = calloc( 1, sizeof( pipeline_threads ) );
+    if( !threads )
+    {
+        for( i = 0; i < pipeline->workers; i++ )
+        {
+            free_ais_ring( &pipeline->worker[i].in );
+            free_ais_ring( &pipeline->worker[i].out );
+        }
+        return 2;
+    }
+    pipeline->threads = threads;
+    pipeline->done = 0;
+
+    for( i = 0; i < pipeline->workers; i++ )
+    {
+        threads->arg[i].pipeline = pipeline;
+        threads->arg[i].index = i;
+        if( pthread_create( &threads->worker[i], NULL, pipeline_worker, &threads->arg[i] ) != 0 )
+            break;
+        threads->started++;
+    }
+    if( (threads->started == pipeline->workers)
+        && (pthread_create( &threads->serializer, NULL, pipeline_serializer, pipeline ) == 0) )
+    {
+        threads->serializer_started = 1;
+        return 0;
+    }
+
+    ais_pipeline_finish( pipeline );
+    return 2;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Pass a line to the pipeline, reader only
+
+    \param pipeline pointer to a started pipeline
+    \param line 0 terminated NMEA sentence
+
+    returns:
+      - 0 if no error
+      - 1 if the line was dropped because the worker's ring was full
+      - 2 if the line was too long
+      - 3 if the pipeline is not running
+
+    Only one thread may call this. Unless ais_pipeline.drop is set it
+    waits for room in the worker's ring.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall ais_pipeline_push( ais_pipeline *pipeline, const char *line )
+{
+    ais_pipeline_worker *w;
+    pipeline_line       *slot;
+    unsigned int        spins;
+    int                 stalled;
+    size_t              len;
+
+    if( !pipeline || !pipeline->threads || pipeline->done )
+        return 3;
+
+    pipeline->lines++;
+    len = strlen( line );
+    if( len > MAX_NMEA_LENGTH - 1 )
+    {
+        pipeline->too_long++;
+        return 2;
+    }
+
+    w = &pipeline->worker[pipeline_route( line ) % pipeline->workers];
+    spins = 0;
+    stalled = 0;
+    while( (slot = ais_ring_claim( &w->in )) == NULL )
+    {
+        if( pipeline->drop )
+        {
+            pipeline->dropped++;
+            return 1;
+        }
+        if( !stalled )
+        {
+            pipeline->stalls++;
+            stalled = 1;
+        }
+        pipeline_wait( &spins );
+    }
+
+    slot->line = pipeline->lines - 1;
+    memcpy( slot->str, line, len + 1 );
+    ais_ring_publish( &w->in );
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Pass all of the lines from a file to the pipeline
+
+    \param pipeline pointer to a started pipeline
+    \param fp file to read until the end
+
+    returns:
+      - 0 if no error
+      - 3 if the pipeline is not running
+
+    Lines that are dropped or too long are counted in the pipeline. A
+    line longer than MAX_NMEA_LENGTH - 1 is skipped as a whole, not
+    split into pieces.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall ais_pipeline_read( ais_pipeline *pipeline, FILE *fp )
+{
+    char  buf[MAX_NMEA_LENGTH];
+    int   c;
+
+    if( !pipeline || !pipeline->threads || pipeline->done )
+        return 3;
+
+    while( fgets( buf, sizeof( buf ), fp ) != NULL )
+    {
+        if( !strchr( buf, '\n' ) && ((c = fgetc( fp )) != EOF) && (c != '\n') )
+        {
+            /* Longer than a sentence can be, skip the rest of it */
+            while( (c != '\n') && (c != EOF) )
+                c = fgetc( fp );
+            pipeline->lines++;
+            pipeline->too_long++;
+            continue;
+        }
+        if( ais_pipeline_push( pipeline, buf ) == 3 )
+            return 3;
+    }
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Finish the lines already passed to the pipeline and stop it
+
+    \param pipeline pointer to a started pipeline
+
+    returns:
+      - 0 if no error
+      - 1 if the pipeline was not running
+
+    Waits for the workers and the serializer to finish everything that
+    was pushed, adds up the workers' errors and frees the rings. The
+    counters are kept until the pipeline is initialized again.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall ais_pipeline_finish( ais_pipeline *pipeline )
+{
+    pipeline_threads  *threads;
+    unsigned int      i;
+
+    if( !pipeline || !pipeline->threads )
+        return 1;
+    threads = (pipeline_threads *) pipeline->threads;
+
+    __atomic_store_n( &pipeline->done, 1, __ATOMIC_RELEASE );
+    for( i = 0; i < threads->started; i++ )
+        pthread_join( threads->worker[i], NULL );
+    if( threads->serializer_started )
+        pthread_join( threads->serializer, NULL );
+
+    pipeline->errors = 0;
+    for( i = 0; i < pipeline->workers; i++ )
+    {
+        pipeline->errors += pipeline->worker[i].errors;
+        free_ais_ring( &pipeline->worker[i].in );
+        free_ais_ring( &pipeline->worker[i].out );
+    }
+
+    free( threads );
+    pipeline->threads = NULL;
+
+    return 0;
+}
@@ -0,0 +1,90 @@
+/* -----------------------------------------------------------------------
+   Reader / decoder / serializer pipeline
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>
+   All rights Reserved
+   ----------------------------------------------------------------------- */
+
+/*! \file
+    \brief Header file for pipeline.c
+
+    Requires nmea.h, sixbit.h, vdm_parse.h, reassembly.h and batch.h to
+    be included first.
+*/
+
+/** Most decoding threads in a pipeline */
+#define AIS_PIPELINE_WORKERS   16
+
+/** Default number of slots in each ring, must be a power of 2 */
+#define AIS_PIPELINE_RING      1024
+
+
+/** Bounded single producer, single consumer ring of fixed size slots
+
+    One thread adds to it with ais_ring_claim() and ais_ring_publish(),
+    one other thread takes from it with ais_ring_peek() and
+    ais_ring_release(). No locks are used.
+*/
+typedef struct {
+    unsigned long  size;               //!< Number of slots, a power of 2
+    size_t         slot_size;          //!< Bytes in each slot
+    unsigned char  *slots;             //!< size * slot_size bytes
+    unsigned long  head;               //!< Slots published, only written by the producer
+    char           pad[64];            //!< Keeps head and tail in different cache lines
+    unsigned long  tail;               //!< Slots released, only written by the consumer
+} ais_ring;
+
+
+/** Called by the serializer thread for each decoded message */
+typedef void (__stdcall *ais_pipeline_cb)( ais_record *record, void *data );
+
+
+/** One decoding thread and the rings on either side of it */
+typedef struct {
+    ais_ring       in;                 //!< Sentences from the reader
+    ais_ring       out;                //!< Messages to the serializer
+    unsigned long  sentences;          //!< Sentences decoded, used as the time for reasm
+    unsigned long  records;            //!< Messages passed to the serializer
+    unsigned long  errors;             //!< Sentences or messages that could not be decoded
+    unsigned long  dropped;            //!< Messages dropped because out was full
+    unsigned long  stalls;             //!< Times it waited because out was full
+} ais_pipeline_worker;
+
+
+/** Pipeline settings, threads and counters
+
+    Set up by init_ais_pipeline(), change the settings before calling
+    ais_pipeline_start().
+*/
+typedef struct {
+    unsigned int        workers;       //!< Number of decoding threads
+    unsigned long       ring_size;     //!< Slots in each ring, a power of 2
+    unsigned long       timeout;       //!< Sentences a worker keeps an incomplete message for, 0 = never dropped
+    unsigned char       drop;          //!< 1 to drop when a ring is full, 0 to wait for room
+    ais_pipeline_cb     callback;      //!< Called with each decoded message
+    void                *data;         //!< Passed to callback
+    unsigned long       lines;         //!< Lines passed to ais_pipeline_push()
+    unsigned long       dropped;       //!< Lines dropped because a worker's ring was full
+    unsigned long       too_long;      //!< Lines longer than MAX_NMEA_LENGTH - 1, not passed on
+    unsigned long       stalls;        //!< Times the reader waited because a worker's ring was full
+    unsigned long       records;       //!< Messages passed to callback
+    unsigned long       errors;        //!< Total of the workers' errors, after ais_pipeline_finish()
+    ais_pipeline_worker worker[AIS_PIPELINE_WORKERS]; //!< Per worker rings and counters
+    void                *threads;      //!< Private thread handles
+    int                 done;          //!< Set when there are no more lines
+} ais_pipeline;
+
+
+/* Prototypes */
+int __stdcall init_ais_ring( ais_ring *ring, unsigned long size, size_t slot_size );
+void __stdcall free_ais_ring( ais_ring *ring );
+void * __stdcall ais_ring_claim( ais_ring *ring );
+void __stdcall ais_ring_publish( ais_ring *ring );
+void * __stdcall ais_ring_peek( ais_ring *ring );
+void __stdcall ais_ring_release( ais_ring *ring );
+unsigned long __stdcall ais_ring_count( ais_ring *ring );
+
+int __stdcall init_ais_pipeline( ais_pipeline *pipeline, ais_pipeline_cb callback, void *data );
+int __stdcall ais_pipeline_start( ais_pipeline *pipeline );
+int __stdcall ais_pipeline_push( ais_pipeline *pipeline, const char *line );
+int __stdcall ais_pipeline_read( ais_pipeline *pipeline, FILE *fp );
+int __stdcall ais_pipeline_finish( ais_pipeline *pipeline );
@@ -0,0 +1,392 @@
+/* -----------------------------------------------------------------------
+   Multipart VDM reassembly table
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>
+   All rights Reserved
+   ----------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "portable.h"
+#include "nmea.h"
+#include "sixbit.h"
+#include "vdm_parse.h"
+#include "reassembly.h"
+
+/*! \file
+    \brief Multipart VDM reassembly table
+    \author Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>, All Rights Reserved
+    \version 1.8
+
+    assemble_vdm() can only hold one multipart message at a time, so when
+    the parts of two messages are interleaved, eg. sequence 3 on channel
+    A and sequence 4 on channel B, both are thrown away. The functions in
+    this module keep up to #REASM_SLOTS messages in progress at once, each
+    one identified by its source, channel and sequence id.
+
+    The source is the tag block s: station of the first part, if there
+    is one, and the talker of the sentence. The later parts of a message
+    usually have no s:, they are added to the message from their talker
+    with the same channel and sequence id, using the g: group id if
+    there is one to tell apart messages from different stations. The
+    table is a fixed array of slots, nothing is allocated while running.
+    Incomplete messages are dropped after their timeout, which is the
+    table's timeout when the first part arrived, and when the table is
+    full the message that has gone the longest without a new part is
+    dropped to make room. Each way a message can be lost is counted in
+    the table.
+
+    Time is supplied by the caller as the now parameter, in any unit, so
+    that logs can be replayed using their own timestamps.
+
+    Example:
+    \code
+    reasm_table table;
+    ais_state   state;
+
+    init_reasm( &table, 60 );
+    memset( &state, 0, sizeof(state) );
+
+    while( fgets( buf, 255, fp ) )
+    {
+        if( reasm_vdm( &table, &state, buf, time( NULL ) ) == 0 )
+        {
+            state.msgid = (char) get_6bit( &state.six_state, 6 );
+            ...
+        }
+    }
+    \endcode
+*/
+
+
+/* ----------------------------------------------------------------------- */
+/** Hash the source of a sentence
+
+    \param nmea pointer to a tokenized sentence
+    \param station 1 to add the tag block source, if there is one
+
+    The talker, eg. AI or BS, is always part of the hash.
+*/
+/* ----------------------------------------------------------------------- */
+static unsigned long source_key( nmea_state *nmea, int station )
+{
+    unsigned long  h = 2166136261UL;
+    const char     *p;
+
+    h = (h ^ (unsigned char) nmea->field[0][0]) * 16777619UL;
+    h = (h ^ (unsigned char) nmea->field[0][1]) * 16777619UL;
+
+    if( station && (nmea->tag.flags & NMEA_TAG_SOURCE) )
+    {
+        for( p = nmea->tag.source; *p; p++ )
+            h = (h ^ (unsigned char) *p) * 16777619UL;
+    }
+
+    return h & 0xFFFFFFFFUL;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Could a later part belong to the message in a slot
+
+    \param slot slot holding a message
+    \param nmea the part
+    \param key source_key() of the part, with the station
+
+    Returns 2 if its source matches exactly, 1 if it could belong to
+    it and 0 if it doesn't. Usually only the first part of a message
+    has the s: station, the later ones have only a g: group or no tag
+    block at all. They are matched on the group id when both have one,
+    otherwise on the talker, channel and sequence alone.
+*/
+/* ----------------------------------------------------------------------- */
+static int slot_matches( reasm_slot *slot, nmea_state *nmea, unsigned long key )
+{
+    if( slot->source == key )
+        return 2;
+    if( nmea->tag.flags & NMEA_TAG_SOURCE )
+        return 0;
+    if( (nmea->tag.flags & NMEA_TAG_GROUP) && (slot->tag.flags & NMEA_TAG_GROUP) )
+        return (slot->tag.group_id == nmea->tag.group_id) ? 2 : 0;
+
+    return 1;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Initialize a reassembly table
+
+    \param table pointer to the table
+    \param timeout age of an incomplete message before it is dropped, in
+                   the same units as the now passed to reasm_vdm().
+                   0 to never time out.
+
+    returns:
+      - 0 if no error
+      - 1 if there was an error
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall init_reasm( reasm_table *table, unsigned long timeout )
+{
+    if( !table )
+        return 1;
+
+    memset( table, 0, sizeof( reasm_table ) );
+    table->timeout = timeout;
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Drop incomplete messages that have timed out
+
+    \param table pointer to the table
+    \param now current time
+
+    returns:
+      - number of messages dropped
+
+    reasm_vdm() does this as it looks for a slot, call it directly to
+    clear out the table when the feed goes quiet.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall reasm_expire( reasm_table *table, unsigned long now )
+{
+    unsigned int  i;
+    int           dropped = 0;
+
+    if( !table )
+        return 0;
+
+    for( i = 0; i < REASM_SLOTS; i++ )
+    {
+        if(    table->slot[i].used && table->slot[i].timeout
+            && (now - table->slot[i].started > table->slot[i].timeout) )
+        {
+            table->slot[i].used = 0;
+            table->timed_out++;
+            dropped++;
+        }
+    }
+
+    return dropped;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Assemble AIVDM/VDO sentences using a reassembly table
+
+    \param table pointer to the table
+    \param state pointer to ais_state to hold the completed message
+    \param str pointer to the NMEA 0183 sentence
+    \param now current time
+
+    This works like assemble_vdm(), with the same return values, except
+    that parts of different messages may be mixed together. When a
+    message is completed it is placed in state->six_state and its tag
+    block metadata in state->tag. Nothing in state is used to hold
+    incomplete messages.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall reasm_vdm( reasm_table *table, ais_state *state, char *str, unsigned long now )
+{
+    nmea_state  nmea;
+    int         rv;
+
+    rv = nmea_tokenize( &nmea, str );
+
+    /* Is the string an AIS message? */
+    if( !is_vdm( &nmea ) )
+        return 3;
+
+    /* Check the string's checksum */
+    if( rv != 0 )
+        return 2;
+
+    return reasm_vdm_tokens( table, state, &nmea, now );
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Assemble a tokenized AIVDM/VDO sentence using a reassembly table
+
+    \param table pointer to the table
+    \param state pointer to ais_state to hold the completed message
+    \param nmea pointer to a nmea_state filled in by nmea_tokenize()
+    \param now current time
+
+    Returns
+        - 0 Complete packet
+        - 1 Incomplete packet
+        - 3 Not an AIS message
+        - 4 Error with the fields of the sentence
+        - 5 Part out of order, or with no first part
+        - 6 Invalid character in the 6-bit data
+
+    A first part whose key matches a message already in progress starts
+    the message again. A part that doesn't follow on from the one before
+    drops the message.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall reasm_vdm_tokens( reasm_table *table, ais_state *state, nmea_state *nmea, unsigned long now )
+{
+    reasm_slot    *slot;
+    reasm_slot    *match;
+    reasm_slot    *empty;
+    reasm_slot    *oldest;
+    unsigned long key;
+    unsigned long talker;
+    unsigned int  total;
+    unsigned int  num;
+    unsigned int  sequence;
+    unsigned int  fill;
+    unsigned int  i;
+    int           best;
+    int           m;
+    char          channel;
+
+    if( !table || !state || !nmea )
+        return 4;
+    if( !is_vdm( nmea ) )
+        return 3;
+
+    /* Need everything up to the 6-bit data */
+    if( nmea->num_fields < 6 )
+        return 4;
+
+    total    = nmea_uint( nmea->field[1] );
+    num      = nmea_uint( nmea->field[2] );
+    sequence = nmea_uint( nmea->field[3] );
+    channel  = *nmea->field[4];
+    fill     = (nmea->num_fields > 6) ? nmea_uint( nmea->field[6] ) : 0;
+
+    /* Single part messages go straight to the state */
+    if( total <= 1 )
+    {
+        if( num != 1 )
+            return 5;
+
+        state->channel = channel;
+        state->tag = nmea->tag;
+        init_6bit( &state->six_state );
+        if( sixbit_append( &state->six_state, nmea->field[5], nmea->field_len[5], fill ) != 0 )
+            return 4;
+        if( sixbit_pack( &state->six_state ) != 0 )
+            return 6;
+        return 0;
+    }
+
+    /* Find the message this part belongs to, a free slot and the slot
+       that has waited the longest for a part, dropping any that have
+       timed out on the way
+    */
+    key = source_key( nmea, 1 );
+    talker = source_key( nmea, 0 );
+    match = empty = oldest = NULL;
+    best = 0;
+    for( i = 0; i < REASM_SLOTS; i++ )
+    {
+        slot = &table->slot[i];
+        if( slot->used && slot->timeout && (now - slot->started > slot->timeout) )
+        {
+            slot->used = 0;
+            table->timed_out++;
+        }
+        if( !slot->used )
+        {
+            if( !empty )
+                empty = slot;
+            continue;
+        }
+
+        /* A first part only matches its own source. Of the messages a
+           later part could belong to, the closest match that had a part
+           most recently is used.
+        */
+        m = 0;
+        if( (slot->talker == talker) && (slot->channel == channel) && (slot->sequence == sequence) )
+            m = (num == 1) ? ((slot->source == key) ? 2 : 0) : slot_matches( slot, nmea, key );
+        if( m && ((m > best) || ((m == best) && (now - slot->touched < now - match->touched))) )
+        {
+            match = slot;
+            best = m;
+        } else if( !m && (!oldest || (now - slot->touched > now - oldest->touched)) ) {
+            oldest = slot;
+        }
+    }
+
+    if( num == 1 )
+    {
+        if( match )
+        {
+            /* Previous message with this key never finished */
+            slot = match;
+            table->broken++;
+        } else if( empty ) {
+            slot = empty;
+        } else {
+            slot = oldest;
+            table->evicted++;
+        }
+
+        slot->used     = 1;
+        slot->source   = key;
+        slot->talker   = talker;
+        slot->channel  = channel;
+        slot->sequence = sequence;
+        slot->total    = total;
+        slot->num      = 1;
+        slot->started  = now;
+        slot->touched  = now;
+        slot->timeout  = table->timeout;
+        slot->tag      = nmea->tag;
+        slot->len      = 0;
+    } else {
+        if( !match )
+        {
+            table->orphans++;
+            return 5;
+        }
+        slot = match;
+        if( (num != slot->num + 1) || (total != slot->total) )
+        {
+            slot->used = 0;
+            table->broken++;
+            return 5;
+        }
+        slot->num = num;
+        slot->touched = now;
+        nmea_merge_tag( &slot->tag, &nmea->tag );
+    }
+
+    if( num < total )
+    {
+        /* Hold on to the 6-bit data until the last part arrives */
+        if( slot->len + nmea->field_len[5] > SIXBIT_LEN - 1 )
+        {
+            slot->used = 0;
+            table->broken++;
+            return 4;
+        }
+        memcpy( slot->bits + slot->len, nmea->field[5], nmea->field_len[5] );
+        slot->len += nmea->field_len[5];
+        return 1;
+    }
+
+    /* Last part, put the whole message together in the state */
+    slot->used = 0;
+    table->completed++;
+
+    state->channel = channel;
+    state->tag = slot->tag;
+    init_6bit( &state->six_state );
+    if(    (sixbit_append( &state->six_state, slot->bits, slot->len, 0 ) != 0)
+        || (sixbit_append( &state->six_state, nmea->field[5], nmea->field_len[5], fill ) != 0) )
+    {
+        return 4;
+    }
+    if( sixbit_pack( &state->six_state ) != 0 )
+        return 6;
+
+    return 0;
+}
@@ -0,0 +1,56 @@
+/* -----------------------------------------------------------------------
+   Multipart VDM reassembly table
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>
+   All rights Reserved
+   ----------------------------------------------------------------------- */
+
+/*! \file
+    \brief Header file for reassembly.c
+
+    Requires nmea.h, sixbit.h and vdm_parse.h to be included first.
+*/
+
+/** Number of multipart messages that can be in progress at once */
+#define REASM_SLOTS  32
+
+
+/** One multipart message in progress
+*/
+typedef struct {
+    unsigned char  used;               //!< 1 if the slot holds a message
+    unsigned long  source;             //!< Hash of the tag block source and talker
+    unsigned long  talker;             //!< Hash of the talker only
+    char           channel;            //!< AIS Channel character
+    unsigned int   sequence;           //!< VDM message sequence number
+    unsigned int   total;              //!< Total # of parts for the message
+    unsigned int   num;                //!< Number of the last part stored
+    unsigned long  started;            //!< Time the first part arrived
+    unsigned long  touched;            //!< Time the last part arrived
+    unsigned long  timeout;            //!< Age before it is dropped, from the table when started, 0 = never
+    nmea_tag       tag;                //!< Tag block metadata from the parts so far
+    char           bits[SIXBIT_LEN];   //!< 6-bit data from the parts so far
+    unsigned int   len;                //!< Number of characters in bits
+} reasm_slot;
+
+
+/** Reassembly table
+
+    Times are in whatever units the caller passes as now, eg. seconds
+    from the tag block or a tick counter.
+*/
+typedef struct {
+    reasm_slot     slot[REASM_SLOTS];  //!< Messages in progress
+    unsigned long  timeout;            //!< Timeout given to new messages, 0 = never
+    unsigned long  completed;          //!< Multipart messages completed
+    unsigned long  timed_out;          //!< Incomplete messages dropped after timeout
+    unsigned long  evicted;            //!< Incomplete messages dropped to make room
+    unsigned long  broken;             //!< Incomplete messages dropped for a missing or repeated part
+    unsigned long  orphans;            //!< Parts with no first part to add to
+} reasm_table;
+
+
+/* Prototypes */
+int __stdcall init_reasm( reasm_table *table, unsigned long timeout );
+int __stdcall reasm_vdm( reasm_table *table, ais_state *state, char *str, unsigned long now );
+int __stdcall reasm_vdm_tokens( reasm_table *table, ais_state *state, nmea_state *nmea, unsigned long now );
+int __stdcall reasm_expire( reasm_table *table, unsigned long now );
@@ -35,7 +35,7 @@
 	\code
 	ais_state state;
     aismsg_8  message;
-	sixbit seaway;
+	sixbit_view seaway;
 	int dac, fi, spare, msgid;
 	seaway1_3 msg1_3;
     unsigned int  result;
@@ -50,17 +50,16 @@
 	{
 	    result = parse_ais_8( &state, &message );
 
-		// Get the seaway info from the payload of the message 8
-		memset( &seaway, 0, sizeof( seaway ) );
-
-		// Copy the DAC and FI from the message 8 over to seaway
+		// Get the DAC and FI from the message 8
 		dac = message.app_id >> 6;
 		fi = message.app_id & 0x3F;
+
+		// The seaway info is in the payload of the message 8
 		seaway = message.data;
 
 		// Get the Seaway msgid
-		spare = (char) get_6bit( &seaway, 2);
-		msgid = (char) get_6bit( &seaway, 6);
+		spare = (char) sixbit_view_get( &seaway, 2);
+		msgid = (char) sixbit_view_get( &seaway, 6);
 
 		// Is it a Water Level Message?
 		if ((fi == 1) && (msgid == 3))
@@ -84,11 +83,12 @@
     return
       - return 0 if there was no error
       - return 1 if there was an error
+      - return 2 if there was a length error
 
     This function parses a Weather Station message into seaway1_1 structure
 */
 /* ----------------------------------------------------------------------- */
-int __stdcall parse_seaway1_1( sixbit *state, seaway1_1 *result )
+int __stdcall parse_seaway1_1( sixbit_view *state, seaway1_1 *result )
 {
     int length;
     int i;
@@ -99,7 +99,7 @@ int __stdcall parse_seaway1_1( sixbit *state, seaway1_1 *result )
     if( !result )
         return 1;
 
-	length = sixbit_length(state);
+	length = sixbit_view_length(state);
     if( (length < 0) || (length > 1008) )
         return 2;
 
@@ -115,21 +115,21 @@ int __stdcall parse_seaway1_1( sixbit *state, seaway1_1 *result )
         j = 0;
         while( j != 7 )
         {
-            result->report[i].station_id[j] = ais2ascii( (char) get_6bit( state, 6 ));
+            result->report[i].station_id[j] = ais2ascii( (char) sixbit_view_get( state, 6 ));
             j++;
         }
         result->report[i].station_id[j] = 0;
 
-        result->report[i].longitude = (long) get_6bit( state, 25 );
-        result->report[i].latitude  = (long) get_6bit( state, 24 );
-        result->report[i].speed     = (int) get_6bit( state, 10 );
-        result->report[i].gust      = (int) get_6bit( state, 10 );
-        result->report[i].direction = (int) get_6bit( state, 9 );
-        result->report[i].pressure  = (int) get_6bit( state, 14 );
-        result->report[i].air_temp  = (int) get_6bit( state, 10 );
-        result->report[i].dew_point = (int) get_6bit( state, 10 );
-        result->report[i].visibility= (unsigned char) get_6bit( state, 8 );
-        result->report[i].water_temp= (int) get_6bit( state, 10 );
+        result->report[i].longitude = (long) sixbit_view_get( state, 25 );
+        result->report[i].latitude  = (long) sixbit_view_get( state, 24 );
+        result->report[i].speed     = (int) sixbit_view_get( state, 10 );
+        result->report[i].gust      = (int) sixbit_view_get( state, 10 );
+        result->report[i].direction = (int) sixbit_view_get( state, 9 );
+        result->report[i].pressure  = (int) sixbit_view_get( state, 14 );
+        result->report[i].air_temp  = (int) sixbit_view_get( state, 10 );
+        result->report[i].dew_point = (int) sixbit_view_get( state, 10 );
+        result->report[i].visibility= (unsigned char) sixbit_view_get( state, 8 );
+        result->report[i].water_temp= (int) sixbit_view_get( state, 10 );
 
     	/* Convert the position to signed value */
 		result->report[i].longitude *= 10;
@@ -142,9 +142,14 @@ int __stdcall parse_seaway1_1( sixbit *state, seaway1_1 *result )
 		conv_sign( 0x0200, &result->report[i].water_temp);
 
         /* Is there enough data for another? */
-        if( sixbit_length(state) < 192)
+        if( sixbit_view_length(state) < 192)
             break;
     }
+
+	/* The message was shorter than its fields */
+	if( state->overrun )
+		return 2;
+
     return 0;
 }
 
@@ -158,11 +163,12 @@ int __stdcall parse_seaway1_1( sixbit *state, seaway1_1 *result )
     return
       - return 0 if there was no error
       - return 1 if there was an error
+      - return 2 if there was a length error
 
     This function parses a Wind Information message into seaway1_2 structure
 */
 /* ----------------------------------------------------------------------- */
-int __stdcall parse_seaway1_2( sixbit *state, seaway1_2 *result )
+int __stdcall parse_seaway1_2( sixbit_view *state, seaway1_2 *result )
 {
     int length;
     int i;
@@ -173,7 +179,7 @@ int __stdcall parse_seaway1_2( sixbit *state, seaway1_2 *result )
     if( !result )
         return 1;
 
-	length = sixbit_length(state);
+	length = sixbit_view_length(state);
     if( (length < 0) || (length > 1008) )
         return 2;
 
@@ -189,17 +195,17 @@ int __stdcall parse_seaway1_2( sixbit *state, seaway1_2 *result )
         j = 0;
         while( j != 7 )
         {
-            result->report[i].station_id[j] = ais2ascii( (char) get_6bit( state, 6 ));
+            result->report[i].station_id[j] = ais2ascii( (char) sixbit_view_get( state, 6 ));
             j++;
         }
         result->report[i].station_id[j] = 0;
 
-        result->report[i].longitude = (long) get_6bit( state, 25 );
-        result->report[i].latitude  = (long) get_6bit( state, 24 );
-        result->report[i].speed     = (int)  get_6bit( state, 10 );
-        result->report[i].gust      = (int)  get_6bit( state, 10 );
-        result->report[i].direction = (int)  get_6bit( state, 9 );
-        result->report[i].spare     = (char) get_6bit( state, 4 );
+        result->report[i].longitude = (long) sixbit_view_get( state, 25 );
+        result->report[i].latitude  = (long) sixbit_view_get( state, 24 );
+        result->report[i].speed     = (int)  sixbit_view_get( state, 10 );
+        result->report[i].gust      = (int)  sixbit_view_get( state, 10 );
+        result->report[i].direction = (int)  sixbit_view_get( state, 9 );
+        result->report[i].spare     = (char) sixbit_view_get( state, 4 );
 
     	/* Convert the position to signed value */
 		result->report[i].longitude *= 10;
@@ -207,9 +213,14 @@ int __stdcall parse_seaway1_2( sixbit *state, seaway1_2 *result )
     	conv_pos( &result->report[i].latitude, &result->report[i].longitude);
 
         /* Is there enough data for another? */
-        if( sixbit_length(state) < 144)
+        if( sixbit_view_length(state) < 144)
             break;
     }
+
+	/* The message was shorter than its fields */
+	if( state->overrun )
+		return 2;
+
     return 0;
 }
 
@@ -223,11 +234,12 @@ int __stdcall parse_seaway1_2( sixbit *state, seaway1_2 *result )
     return
       - return 0 if there was no error
       - return 1 if there was an error
+      - return 2 if there was a length error
 
     This function parses a Water Level message into seaway1_2 structure
 */
 /* ----------------------------------------------------------------------- */
-int __stdcall parse_seaway1_3( sixbit *state, seaway1_3 *result )
+int __stdcall parse_seaway1_3( sixbit_view *state, seaway1_3 *result )
 {
     int length;
     int i;
@@ -238,7 +250,7 @@ int __stdcall parse_seaway1_3( sixbit *state, seaway1_3 *result )
     if( !result )
         return 1;
 
-	length = sixbit_length(state);
+	length = sixbit_view_length(state);
     if( (length < 0) || (length > 1008) )
         return 2;
 
@@ -254,17 +266,17 @@ int __stdcall parse_seaway1_3( sixbit *state, seaway1_3 *result )
         j = 0;
         while( j != 7 )
         {
-            result->report[i].station_id[j] = ais2ascii( (char) get_6bit( state, 6 ));
+            result->report[i].station_id[j] = ais2ascii( (char) sixbit_view_get( state, 6 ));
             j++;
         }
         result->report[i].station_id[j] = 0;
 
-        result->report[i].longitude = (long) get_6bit( state, 25 );
-        result->report[i].latitude  = (long) get_6bit( state, 24 );
-        result->report[i].type      = (char) get_6bit( state, 1 );
-        result->report[i].level     = (unsigned int) get_6bit( state, 16 );
-        result->report[i].datum     = (char) get_6bit( state, 2 );
-        result->report[i].spare     = (int)  get_6bit( state, 14 );
+        result->report[i].longitude = (long) sixbit_view_get( state, 25 );
+        result->report[i].latitude  = (long) sixbit_view_get( state, 24 );
+        result->report[i].type      = (char) sixbit_view_get( state, 1 );
+        result->report[i].level     = (unsigned int) sixbit_view_get( state, 16 );
+        result->report[i].datum     = (char) sixbit_view_get( state, 2 );
+        result->report[i].spare     = (int)  sixbit_view_get( state, 14 );
 
     	/* Convert the position to signed value */
 		result->report[i].longitude *= 10;
@@ -275,9 +287,14 @@ int __stdcall parse_seaway1_3( sixbit *state, seaway1_3 *result )
 		conv_sign( 0x8000, &result->report[i].level );
 
         /* Is there enough data for another? */
-        if( sixbit_length(state) < 144)
+        if( sixbit_view_length(state) < 144)
             break;
     }
+
+	/* The message was shorter than its fields */
+	if( state->overrun )
+		return 2;
+
     return 0;
 }
 
@@ -291,11 +308,12 @@ int __stdcall parse_seaway1_3( sixbit *state, seaway1_3 *result )
     return
       - return 0 if there was no error
       - return 1 if there was an error
+      - return 2 if there was a length error
 
     This function parses a Water Flow message into seaway1_2 structure
 */
 /* ----------------------------------------------------------------------- */
-int __stdcall parse_seaway1_6( sixbit *state, seaway1_6 *result )
+int __stdcall parse_seaway1_6( sixbit_view *state, seaway1_6 *result )
 {
     int length;
     int i;
@@ -306,7 +324,7 @@ int __stdcall parse_seaway1_6( sixbit *state, seaway1_6 *result )
     if( !result )
         return 1;
 
-	length = sixbit_length(state);
+	length = sixbit_view_length(state);
     if( (length < 0) || (length > 1008) )
         return 2;
 
@@ -322,15 +340,15 @@ int __stdcall parse_seaway1_6( sixbit *state, seaway1_6 *result )
         j = 0;
         while( j != 7 )
         {
-            result->report[i].station_id[j] = ais2ascii( (char) get_6bit( state, 6 ));
+            result->report[i].station_id[j] = ais2ascii( (char) sixbit_view_get( state, 6 ));
             j++;
         }
         result->report[i].station_id[j] = 0;
 
-        result->report[i].longitude = (long) get_6bit( state, 25 );
-        result->report[i].latitude  = (long) get_6bit( state, 24 );
-        result->report[i].flow      = (int)  get_6bit( state, 14 );
-        result->report[i].spare     = (long) get_6bit( state, 19 );
+        result->report[i].longitude = (long) sixbit_view_get( state, 25 );
+        result->report[i].latitude  = (long) sixbit_view_get( state, 24 );
+        result->report[i].flow      = (int)  sixbit_view_get( state, 14 );
+        result->report[i].spare     = (long) sixbit_view_get( state, 19 );
 
     	/* Convert the position to signed value */
 		result->report[i].longitude *= 10;
@@ -338,9 +356,14 @@ int __stdcall parse_seaway1_6( sixbit *state, seaway1_6 *result )
     	conv_pos( &result->report[i].latitude, &result->report[i].longitude);
 
         /* Is there enough data for another? */
-        if( sixbit_length(state) < 144)
+        if( sixbit_view_length(state) < 144)
             break;
     }
+
+	/* The message was shorter than its fields */
+	if( state->overrun )
+		return 2;
+
     return 0;
 }
 
@@ -354,11 +377,12 @@ int __stdcall parse_seaway1_6( sixbit *state, seaway1_6 *result )
     return
       - return 0 if there was no error
       - return 1 if there was an error
+      - return 2 if there was a length error
 
     This function parses a Lockage Order message into seaway1_2 structure
 */
 /* ----------------------------------------------------------------------- */
-int __stdcall parse_seaway2_1( sixbit *state, seaway2_1 *result )
+int __stdcall parse_seaway2_1( sixbit_view *state, seaway2_1 *result )
 {
     int length;
     int i;
@@ -369,7 +393,7 @@ int __stdcall parse_seaway2_1( sixbit *state, seaway2_1 *result )
     if( !result )
         return 1;
 
-	length = sixbit_length(state);
+	length = sixbit_view_length(state);
     if( (length < 0) || (length > 1008) )
         return 2;
 
@@ -383,14 +407,14 @@ int __stdcall parse_seaway2_1( sixbit *state, seaway2_1 *result )
     j = 0;
     while( j != 7 )
     {
-        result->lock_id[j] = ais2ascii( (char) get_6bit( state, 6 ));
+        result->lock_id[j] = ais2ascii( (char) sixbit_view_get( state, 6 ));
         j++;
     }
     result->lock_id[j] = 0;
 
-    result->longitude = (long) get_6bit( state, 25 );
-    result->latitude  = (long) get_6bit( state, 24 );
-    result->spare2    = (int) get_6bit( state, 9 );
+    result->longitude = (long) sixbit_view_get( state, 25 );
+    result->latitude  = (long) sixbit_view_get( state, 24 );
+    result->spare2    = (int) sixbit_view_get( state, 9 );
 
    	/* Convert the position to signed value */
 	result->longitude *= 10;
@@ -403,20 +427,25 @@ int __stdcall parse_seaway2_1( sixbit *state, seaway2_1 *result )
         j = 0;
         while( j != 15 )
         {
-            result->schedule[i].name[j] = ais2ascii( (char) get_6bit( state, 6 ));
+            result->schedule[i].name[j] = ais2ascii( (char) sixbit_view_get( state, 6 ));
             j++;
         }
         result->schedule[i].name[j] = 0;
 
-        result->schedule[i].direction = (char) get_6bit( state, 1 );
+        result->schedule[i].direction = (char) sixbit_view_get( state, 1 );
 		if ( get_timetag( state, &result->schedule[i].eta ) )
 			return 4;
-        result->schedule[i].spare     = (int)  get_6bit( state, 9 );
+        result->schedule[i].spare     = (int)  sixbit_view_get( state, 9 );
 
         /* Is there enough data for another? */
-        if( sixbit_length(state) < 120)
+        if( sixbit_view_length(state) < 120)
             break;
     }
+
+	/* The message was shorter than its fields */
+	if( state->overrun )
+		return 2;
+
     return 0;
 }
 
@@ -430,11 +459,12 @@ int __stdcall parse_seaway2_1( sixbit *state, seaway2_1 *result )
     return
       - return 0 if there was no error
       - return 1 if there was an error
+      - return 2 if there was a length error
 
     This function parses a Estimated Lock Times message into seaway1_2 structure
 */
 /* ----------------------------------------------------------------------- */
-int __stdcall parse_seaway2_2( sixbit *state, seaway2_2 *result )
+int __stdcall parse_seaway2_2( sixbit_view *state, seaway2_2 *result )
 {
     int length;
     int j;
@@ -444,7 +474,7 @@ int __stdcall parse_seaway2_2( sixbit *state, seaway2_2 *result )
     if( !result )
         return 1;
 
-	length = sixbit_length(state);
+	length = sixbit_view_length(state);
     if( (length < 0) || (length > 1008) )
         return 2;
 
@@ -458,7 +488,7 @@ int __stdcall parse_seaway2_2( sixbit *state, seaway2_2 *result )
     j = 0;
     while( j != 15 )
     {
-        result->name[j] = ais2ascii( (char) get_6bit( state, 6 ));
+        result->name[j] = ais2ascii( (char) sixbit_view_get( state, 6 ));
         j++;
     }
     result->name[j] = 0;
@@ -467,7 +497,7 @@ int __stdcall parse_seaway2_2( sixbit *state, seaway2_2 *result )
     j = 0;
     while( j != 7 )
     {
-        result->last_location[j] = ais2ascii( (char) get_6bit( state, 6 ));
+        result->last_location[j] = ais2ascii( (char) sixbit_view_get( state, 6 ));
         j++;
     }
     result->last_location[j] = 0;
@@ -479,7 +509,7 @@ int __stdcall parse_seaway2_2( sixbit *state, seaway2_2 *result )
     j = 0;
     while( j != 7 )
     {
-        result->first_lock[j] = ais2ascii( (char) get_6bit( state, 6 ));
+        result->first_lock[j] = ais2ascii( (char) sixbit_view_get( state, 6 ));
         j++;
     }
     result->first_lock[j] = 0;
@@ -491,7 +521,7 @@ int __stdcall parse_seaway2_2( sixbit *state, seaway2_2 *result )
     j = 0;
     while( j != 7 )
     {
-        result->second_lock[j] = ais2ascii( (char) get_6bit( state, 6 ));
+        result->second_lock[j] = ais2ascii( (char) sixbit_view_get( state, 6 ));
         j++;
     }
     result->second_lock[j] = 0;
@@ -503,12 +533,16 @@ int __stdcall parse_seaway2_2( sixbit *state, seaway2_2 *result )
     j = 0;
     while( j != 7 )
     {
-        result->delay[j] = ais2ascii( (char) get_6bit( state, 6 ));
+        result->delay[j] = ais2ascii( (char) sixbit_view_get( state, 6 ));
         j++;
     }
     result->delay[j] = 0;
 
-    result->spare2 = (int) get_6bit( state, 4 );
+    result->spare2 = (int) sixbit_view_get( state, 4 );
+
+	/* The message was shorter than its fields */
+	if( state->overrun )
+		return 2;
 
     return 0;
 }
@@ -523,11 +557,12 @@ int __stdcall parse_seaway2_2( sixbit *state, seaway2_2 *result )
     return
       - return 0 if there was no error
       - return 1 if there was an error
+      - return 2 if there was a length error
 
     This function parses a Version message into seaway1_2 structure
 */
 /* ----------------------------------------------------------------------- */
-int __stdcall parse_seaway32_1( sixbit *state, seaway32_1 *result )
+int __stdcall parse_seaway32_1( sixbit_view *state, seaway32_1 *result )
 {
     int length;
 
@@ -536,16 +571,20 @@ int __stdcall parse_seaway32_1( sixbit *state, seaway32_1 *result )
     if( !result )
         return 1;
 
-	length = sixbit_length(state);
+	length = sixbit_view_length(state);
     if( (length < 0) || (length > 1008) )
         return 2;
 
     /* Clear out the structure first */
     memset( result, 0, sizeof( seaway32_1 ) );
 
-    result->major = (unsigned char)  get_6bit( state, 8 );
-    result->minor = (unsigned char)  get_6bit( state, 8 );
-    result->spare2= (unsigned char)  get_6bit( state, 8 );
+    result->major = (unsigned char)  sixbit_view_get( state, 8 );
+    result->minor = (unsigned char)  sixbit_view_get( state, 8 );
+    result->spare2= (unsigned char)  sixbit_view_get( state, 8 );
+
+	/* The message was shorter than its fields */
+	if( state->overrun )
+		return 2;
 
     return 0;
 }
@@ -560,11 +599,12 @@ int __stdcall parse_seaway32_1( sixbit *state, seaway32_1 *result )
     return
       - return 0 if there was no error
       - return 1 if there was an error
+      - return 2 if there was a length error
 
     This function parses a Hydro/Current message into seaway1_1 structure
 */
 /* ----------------------------------------------------------------------- */
-int __stdcall parse_pawss1_4( sixbit *state, pawss1_4 *result )
+int __stdcall parse_pawss1_4( sixbit_view *state, pawss1_4 *result )
 {
     int length;
     int i;
@@ -575,7 +615,7 @@ int __stdcall parse_pawss1_4( sixbit *state, pawss1_4 *result )
     if( !result )
         return 1;
 
-	length = sixbit_length(state);
+	length = sixbit_view_length(state);
     if( (length < 0) || (length > 1008) )
         return 2;
 
@@ -591,16 +631,16 @@ int __stdcall parse_pawss1_4( sixbit *state, pawss1_4 *result )
         j = 0;
         while( j != 7 )
         {
-            result->report[i].station_id[j] = ais2ascii( (char) get_6bit( state, 6 ));
+            result->report[i].station_id[j] = ais2ascii( (char) sixbit_view_get( state, 6 ));
             j++;
         }
         result->report[i].station_id[j] = 0;
 
-        result->report[i].longitude = (long) get_6bit( state, 25 );
-        result->report[i].latitude  = (long) get_6bit( state, 24 );
-        result->report[i].speed     = (unsigned char) get_6bit( state, 8 );
-        result->report[i].direction = (int) get_6bit( state, 9 );
-        result->report[i].spare     = (unsigned int) get_6bit( state, 16 );
+        result->report[i].longitude = (long) sixbit_view_get( state, 25 );
+        result->report[i].latitude  = (long) sixbit_view_get( state, 24 );
+        result->report[i].speed     = (unsigned char) sixbit_view_get( state, 8 );
+        result->report[i].direction = (int) sixbit_view_get( state, 9 );
+        result->report[i].spare     = (unsigned int) sixbit_view_get( state, 16 );
 
     	/* Convert the position to signed value */
 		result->report[i].longitude *= 10;
@@ -608,9 +648,14 @@ int __stdcall parse_pawss1_4( sixbit *state, pawss1_4 *result )
     	conv_pos( &result->report[i].latitude, &result->report[i].longitude);
 
         /* Is there enough data for another? */
-        if( sixbit_length(state) < 144)
+        if( sixbit_view_length(state) < 144)
             break;
     }
+
+	/* The message was shorter than its fields */
+	if( state->overrun )
+		return 2;
+
     return 0;
 }
 
@@ -624,11 +669,12 @@ int __stdcall parse_pawss1_4( sixbit *state, pawss1_4 *result )
     return
       - return 0 if there was no error
       - return 1 if there was an error
+      - return 2 if there was a length error
 
     This function parses a Hydro/Salinity Temp message into seaway1_1 structure
 */
 /* ----------------------------------------------------------------------- */
-int __stdcall parse_pawss1_5( sixbit *state, pawss1_5 *result )
+int __stdcall parse_pawss1_5( sixbit_view *state, pawss1_5 *result )
 {
     int length;
     int i;
@@ -639,7 +685,7 @@ int __stdcall parse_pawss1_5( sixbit *state, pawss1_5 *result )
     if( !result )
         return 1;
 
-	length = sixbit_length(state);
+	length = sixbit_view_length(state);
     if( (length < 0) || (length > 1008) )
         return 2;
 
@@ -655,16 +701,16 @@ int __stdcall parse_pawss1_5( sixbit *state, pawss1_5 *result )
         j = 0;
         while( j != 7 )
         {
-            result->report[i].station_id[j] = ais2ascii( (char) get_6bit( state, 6 ));
+            result->report[i].station_id[j] = ais2ascii( (char) sixbit_view_get( state, 6 ));
             j++;
         }
         result->report[i].station_id[j] = 0;
 
-        result->report[i].longitude = (long) get_6bit( state, 25 );
-        result->report[i].latitude  = (long) get_6bit( state, 24 );
-        result->report[i].salinity  = (int) get_6bit( state, 10 );
-        result->report[i].water_temp= (int) get_6bit( state, 10 );
-        result->report[i].spare     = (unsigned int) get_6bit( state, 13 );
+        result->report[i].longitude = (long) sixbit_view_get( state, 25 );
+        result->report[i].latitude  = (long) sixbit_view_get( state, 24 );
+        result->report[i].salinity  = (int) sixbit_view_get( state, 10 );
+        result->report[i].water_temp= (int) sixbit_view_get( state, 10 );
+        result->report[i].spare     = (unsigned int) sixbit_view_get( state, 13 );
 
     	/* Convert the position to signed value */
 		result->report[i].longitude *= 10;
@@ -675,9 +721,14 @@ int __stdcall parse_pawss1_5( sixbit *state, pawss1_5 *result )
 		conv_sign( 0x0200, &result->report[i].water_temp);
 
         /* Is there enough data for another? */
-        if( sixbit_length(state) < 144)
+        if( sixbit_view_length(state) < 144)
             break;
     }
+
+	/* The message was shorter than its fields */
+	if( state->overrun )
+		return 2;
+
     return 0;
 }
 
@@ -691,11 +742,12 @@ int __stdcall parse_pawss1_5( sixbit *state, pawss1_5 *result )
     return
       - return 0 if there was no error
       - return 1 if there was an error
+      - return 2 if there was a length error
 
     This function parses a Vessel Procession Order Message into seaway1_1 structure
 */
 /* ----------------------------------------------------------------------- */
-int __stdcall parse_pawss2_3( sixbit *state, pawss2_3 *result )
+int __stdcall parse_pawss2_3( sixbit_view *state, pawss2_3 *result )
 {
     int length;
     int i;
@@ -706,7 +758,7 @@ int __stdcall parse_pawss2_3( sixbit *state, pawss2_3 *result )
     if( !result )
         return 1;
 
-	length = sixbit_length(state);
+	length = sixbit_view_length(state);
     if( (length < 0) || (length > 1008) )
         return 2;
 
@@ -720,14 +772,14 @@ int __stdcall parse_pawss2_3( sixbit *state, pawss2_3 *result )
     j = 0;
     while( j != 16 )
     {
-        result->direction[j] = ais2ascii( (char) get_6bit( state, 6 ));
+        result->direction[j] = ais2ascii( (char) sixbit_view_get( state, 6 ));
         j++;
     }
     result->direction[j] = 0;
 
-    result->longitude = (long) get_6bit( state, 25 );
-    result->latitude  = (long) get_6bit( state, 24 );
-    result->spare2 = (char)  get_6bit( state, 3 );
+    result->longitude = (long) sixbit_view_get( state, 25 );
+    result->latitude  = (long) sixbit_view_get( state, 24 );
+    result->spare2 = (char)  sixbit_view_get( state, 3 );
 
    	/* Convert the position to signed value */
 	result->longitude *= 10;
@@ -736,13 +788,13 @@ int __stdcall parse_pawss2_3( sixbit *state, pawss2_3 *result )
 
     for( i=0; i<4; i++ )
     {
-        result->report[i].order  = (char) get_6bit( state, 5 );
+        result->report[i].order  = (char) sixbit_view_get( state, 5 );
 
         /* Get the Vessel Name, convert to ASCII */
         j = 0;
         while( j != 15 )
         {
-            result->report[i].vessel_name[j] = ais2ascii( (char) get_6bit( state, 6 ));
+            result->report[i].vessel_name[j] = ais2ascii( (char) sixbit_view_get( state, 6 ));
             j++;
         }
         result->report[i].vessel_name[j] = 0;
@@ -751,19 +803,24 @@ int __stdcall parse_pawss2_3( sixbit *state, pawss2_3 *result )
         j = 0;
         while( j != 13 )
         {
-            result->report[i].position_name[j] = ais2ascii( (char) get_6bit( state, 6 ));
+            result->report[i].position_name[j] = ais2ascii( (char) sixbit_view_get( state, 6 ));
             j++;
         }
         result->report[i].position_name[j] = 0;
 
-        result->report[i].time_hh = (char) get_6bit( state, 5 );
-        result->report[i].time_mm = (char) get_6bit( state, 6 );
-        result->report[i].spare   = (char) get_6bit( state, 6 );
+        result->report[i].time_hh = (char) sixbit_view_get( state, 5 );
+        result->report[i].time_mm = (char) sixbit_view_get( state, 6 );
+        result->report[i].spare   = (char) sixbit_view_get( state, 6 );
 
         /* Is there enough data for another? */
-        if( sixbit_length(state) < 184)
+        if( sixbit_view_length(state) < 184)
             break;
     }
+
+	/* The message was shorter than its fields */
+	if( state->overrun )
+		return 2;
+
     return 0;
 }
 
@@ -221,13 +221,13 @@ typedef struct {
 
 
 /* Prototypes */
-int __stdcall parse_seaway1_1( sixbit *state, seaway1_1 *result );
-int __stdcall parse_seaway1_2( sixbit *state, seaway1_2 *result );
-int __stdcall parse_seaway1_3( sixbit *state, seaway1_3 *result );
-int __stdcall parse_seaway1_6( sixbit *state, seaway1_6 *result );
-int __stdcall parse_seaway2_1( sixbit *state, seaway2_1 *result );
-int __stdcall parse_seaway2_2( sixbit *state, seaway2_2 *result );
-int __stdcall parse_seaway32_1( sixbit *state, seaway32_1 *result );
-int __stdcall parse_pawss1_4( sixbit *state, pawss1_4 *result );
-int __stdcall parse_pawss1_5( sixbit *state, pawss1_5 *result );
-int __stdcall parse_pawss2_3( sixbit *state, pawss2_3 *result );
+int __stdcall parse_seaway1_1( sixbit_view *state, seaway1_1 *result );
+int __stdcall parse_seaway1_2( sixbit_view *state, seaway1_2 *result );
+int __stdcall parse_seaway1_3( sixbit_view *state, seaway1_3 *result );
+int __stdcall parse_seaway1_6( sixbit_view *state, seaway1_6 *result );
+int __stdcall parse_seaway2_1( sixbit_view *state, seaway2_1 *result );
+int __stdcall parse_seaway2_2( sixbit_view *state, seaway2_2 *result );
+int __stdcall parse_seaway32_1( sixbit_view *state, seaway32_1 *result );
+int __stdcall parse_pawss1_4( sixbit_view *state, pawss1_4 *result );
+int __stdcall parse_pawss1_5( sixbit_view *state, pawss1_5 *result );
+int __stdcall parse_pawss2_3( sixbit_view *state, pawss2_3 *result );
@@ -0,0 +1,356 @@
+/* -----------------------------------------------------------------------
+   Dead reckoning trajectory simplification
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>
+   All rights Reserved
+   ----------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "portable.h"
+#include "nmea.h"
+#include "sixbit.h"
+#include "vdm_parse.h"
+#include "mmsi_index.h"
+#include "simplify.h"
+
+/*! \file
+    \brief Dead reckoning trajectory simplification
+    \author Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>, All Rights Reserved
+    \version 1.8
+
+    An ais_simplify decides, as each position report is decoded, which
+    ones need to be stored to keep the shape of a vessel's track.
+
+    The last report kept for each MMSI is remembered with its speed and
+    course. A new report is compared with where the vessel would be if
+    it had kept that speed and course since then. It only needs to be
+    kept if it is more than tolerance nautical miles from there, it
+    then becomes the one the next predictions are made from. A vessel
+    going straight or lying still has few reports kept, turns and
+    changes of speed are kept.
+
+    Reports without a speed or course are predicted to stay where the
+    last kept report was. Setting max_interval keeps a report at least
+    that often, even when the prediction is good.
+
+    Each vessel uses a 32 byte record in a fixed size mmsi_index
+    hash. ais_simplify_ratio() gives the number of reports checked for
+    each one kept.
+
+    Example:
+    \code
+    ais_simplify simplify;
+
+    init_ais_simplify( &simplify, 50000 );
+    ...
+    if( parse_ais_any( &ais, &msg ) == 0 )
+    {
+        if( ais_simplify_check_msg( &simplify, &msg, time( NULL ) ) == 0 )
+            store msg
+    }
+    ...
+    printf( "%0.1f:1\n", ais_simplify_ratio( &simplify ) );
+    \endcode
+*/
+
+
+/** Radians in 1/10 degree */
+#define SIMPLIFY_RADIANS      (3.14159265358979323846 / 1800.0)
+
+/** Radians in 1/10000 minute */
+#define SIMPLIFY_LAT_RADIANS  (3.14159265358979323846 / (180.0 * 600000.0))
+
+/** 180 degrees and 90 degrees in 1/10000 minute */
+#define SIMPLIFY_LON_MAX      108000000L
+#define SIMPLIFY_LAT_MAX      54000000L
+
+
+/* ----------------------------------------------------------------------- */
+/* The hash over the slots */
+/* ----------------------------------------------------------------------- */
+static void simplify_index( ais_simplify *simplify, mmsi_index *index )
+{
+    init_mmsi_index( index, simplify->slots, sizeof( simplify_vessel ), sizeof( simplify->slots->userid ),
+                     simplify->size );
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Initialize a simplifier
+
+    \param simplify pointer to the ais_simplify
+    \param vessels number of vessels it must be able to hold
+
+    returns:
+      - 0 if no error
+      - 1 if there was an error with the parameters
+      - 2 if the slots could not be allocated
+
+    The tolerance is set to AIS_SIMPLIFY_TOLERANCE and max_interval to
+    0, change them afterwards.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall init_ais_simplify( ais_simplify *simplify, unsigned long vessels )
+{
+    unsigned long size;
+
+    if( !simplify || !vessels )
+        return 1;
+
+    memset( simplify, 0, sizeof( ais_simplify ) );
+
+    size = mmsi_index_size( vessels );
+    simplify->slots = calloc( size, sizeof( simplify_vessel ) );
+    if( !simplify->slots )
+        return 2;
+    simplify->size = size;
+    simplify->tolerance = AIS_SIMPLIFY_TOLERANCE;
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Free the slots of a simplifier
+
+    \param simplify pointer to the ais_simplify
+*/
+/* ----------------------------------------------------------------------- */
+void __stdcall free_ais_simplify( ais_simplify *simplify )
+{
+    if( !simplify )
+        return;
+
+    free( simplify->slots );
+    simplify->slots = NULL;
+    simplify->size = 0;
+    simplify->count = 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Is a report further than the tolerance from the predicted position */
+/* ----------------------------------------------------------------------- */
+static int simplify_off( ais_simplify *simplify, simplify_vessel *v, long latitude, long longitude,
+                         unsigned int elapsed )
+{
+    double speed;
+    double dx, dy;
+    long   dlon;
+
+    dlon = longitude - v->longitude;
+    if( dlon > SIMPLIFY_LON_MAX )
+        dlon -= 2 * SIMPLIFY_LON_MAX;
+    if( dlon < -SIMPLIFY_LON_MAX )
+        dlon += 2 * SIMPLIFY_LON_MAX;
+
+    /* Nautical miles from where it was kept */
+    dx = dlon / 10000.0 * cos( v->latitude * SIMPLIFY_LAT_RADIANS );
+    dy = (latitude - v->latitude) / 10000.0;
+
+    /* Less the distance it was expected to go */
+    if( (v->sog < 1023) && (v->cog < 3600) )
+    {
+        speed = v->sog / 10.0 / 3600.0 * elapsed;
+        dx -= speed * sin( v->cog * SIMPLIFY_RADIANS );
+        dy -= speed * cos( v->cog * SIMPLIFY_RADIANS );
+    }
+
+    return dx * dx + dy * dy > simplify->tolerance * simplify->tolerance;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Check if a position report can be left out of a track
+
+    \param simplify pointer to the ais_simplify
+    \param userid MMSI of the vessel
+    \param latitude latitude in 1/10000 minute
+    \param longitude longitude in 1/10000 minute
+    \param sog speed over ground in 1/10 knot, 1023 = N/A
+    \param cog course over ground in 1/10 degree, 3600 = N/A
+    \param now time of the report in seconds
+
+    returns:
+      - 1 if it can be left out
+      - 0 if it must be kept, or there was an error with the parameters
+
+    Reports without a position are always left out. Reports for new
+    vessels are kept when there is no room for them. Reports older than
+    the last one kept for the vessel are left out.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall ais_simplify_check( ais_simplify *simplify, unsigned long userid, long latitude, long longitude,
+                                  int sog, int cog, unsigned long now )
+{
+    mmsi_index      index;
+    simplify_vessel *v;
+    int             elapsed;
+
+    if( !simplify || !simplify->slots || !userid )
+        return 0;
+
+    /* 91 and 181 degrees mean no position */
+    if(    (latitude < -SIMPLIFY_LAT_MAX) || (latitude > SIMPLIFY_LAT_MAX)
+        || (longitude < -SIMPLIFY_LON_MAX) || (longitude > SIMPLIFY_LON_MAX) )
+        return 1;
+    simplify->reports++;
+
+    simplify_index( simplify, &index );
+    v = &simplify->slots[mmsi_index_slot( &index, userid )];
+
+    if( v->userid )
+    {
+        /* Wraps around with the 32 bit time, negative for an older report */
+        elapsed = (int) ((unsigned int) now - v->time);
+        if( elapsed < 0 )
+            return 1;
+        if(    (!simplify->max_interval || ((unsigned long) elapsed < simplify->max_interval))
+            && !simplify_off( simplify, v, latitude, longitude, (unsigned int) elapsed ) )
+            return 1;
+    } else {
+        if( simplify->count >= simplify->size - simplify->size / 4 )
+        {
+            simplify->full++;
+            simplify->kept++;
+            return 0;
+        }
+        v->userid = (unsigned int) userid;
+        simplify->count++;
+    }
+
+    v->time = (unsigned int) now;
+    v->latitude = latitude;
+    v->longitude = longitude;
+    v->sog = (unsigned short) sog;
+    v->cog = (unsigned short) cog;
+    simplify->kept++;
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Check a position from parse_ais_position()
+
+    \param simplify pointer to the ais_simplify
+    \param pos position report
+    \param now time of the report in seconds
+
+    Returns the same as ais_simplify_check(), 0 if pos doesn't have the
+    MMSI and position.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall ais_simplify_check_pos( ais_simplify *simplify, aismsg_pos *pos, unsigned long now )
+{
+    if( !pos || ((pos->fields & (AIS_FIELD_USERID | AIS_FIELD_POSITION)) != (AIS_FIELD_USERID | AIS_FIELD_POSITION)) )
+        return 0;
+
+    return ais_simplify_check( simplify, pos->userid, pos->latitude, pos->longitude,
+                               (pos->fields & AIS_FIELD_SOG) ? pos->sog : 1023,
+                               (pos->fields & AIS_FIELD_COG) ? pos->cog : 3600, now );
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Check a parsed message
+
+    \param simplify pointer to the ais_simplify
+    \param msg message from parse_ais_any()
+    \param now time of the report in seconds
+
+    Returns the same as ais_simplify_check(). Only messages 1, 2, 3, 18,
+    19 and 27 are simplified, 0 is returned for the others.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall ais_simplify_check_msg( ais_simplify *simplify, aismsg_any *msg, unsigned long now )
+{
+    if( !msg )
+        return 0;
+
+    switch( msg->msgid )
+    {
+        case 1:
+            return ais_simplify_check( simplify, msg->u.msg_1.userid, msg->u.msg_1.latitude,
+                                       msg->u.msg_1.longitude, msg->u.msg_1.sog, msg->u.msg_1.cog, now );
+        case 2:
+            return ais_simplify_check( simplify, msg->u.msg_2.userid, msg->u.msg_2.latitude,
+                                       msg->u.msg_2.longitude, msg->u.msg_2.sog, msg->u.msg_2.cog, now );
+        case 3:
+            return ais_simplify_check( simplify, msg->u.msg_3.userid, msg->u.msg_3.latitude,
+                                       msg->u.msg_3.longitude, msg->u.msg_3.sog, msg->u.msg_3.cog, now );
+        case 18:
+            return ais_simplify_check( simplify, msg->u.msg_18.userid, msg->u.msg_18.latitude,
+                                       msg->u.msg_18.longitude, msg->u.msg_18.sog, msg->u.msg_18.cog, now );
+        case 19:
+            return ais_simplify_check( simplify, msg->u.msg_19.userid, msg->u.msg_19.latitude,
+                                       msg->u.msg_19.longitude, msg->u.msg_19.sog, msg->u.msg_19.cog, now );
+        case 27:
+            return ais_simplify_check( simplify, msg->u.msg_27.userid, msg->u.msg_27.latitude,
+                                       msg->u.msg_27.longitude, conv_sog27( msg->u.msg_27.sog ),
+                                       conv_cog27( msg->u.msg_27.cog ), now );
+    }
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Compression ratio
+
+    \param simplify pointer to the ais_simplify
+
+    Returns the number of position reports checked for each one kept,
+    or 0 if none have been kept.
+*/
+/* ----------------------------------------------------------------------- */
+double __stdcall ais_simplify_ratio( ais_simplify *simplify )
+{
+    if( !simplify || !simplify->kept )
+        return 0.0;
+
+    return (double) simplify->reports / (double) simplify->kept;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Has a vessel not had a report kept for longer than age */
+/* ----------------------------------------------------------------------- */
+static int __stdcall simplify_expired( void *slot, unsigned long now, unsigned long age )
+{
+    simplify_vessel *v = (simplify_vessel *) slot;
+    int             elapsed;
+
+    /* Wraps around with the 32 bit time, negative if updated after now */
+    elapsed = (int) ((unsigned int) now - v->time);
+    return (elapsed > 0) && ((unsigned long) elapsed > age);
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Forget vessels that haven't had a report kept
+
+    \param simplify pointer to the ais_simplify
+    \param now current time
+    \param age time since the last report kept
+
+    Returns the number of vessels removed. Their next report is kept.
+    Use an age longer than max_interval, or vessels lying still will be
+    removed.
+*/
+/* ----------------------------------------------------------------------- */
+unsigned long __stdcall ais_simplify_expire( ais_simplify *simplify, unsigned long now, unsigned long age )
+{
+    mmsi_index    index;
+    unsigned long n;
+
+    if( !simplify || !simplify->slots )
+        return 0;
+
+    simplify_index( simplify, &index );
+    n = mmsi_index_expire( &index, now, age, simplify_expired );
+    simplify->count -= n;
+
+    return n;
+}
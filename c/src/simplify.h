@@ -0,0 +1,51 @@
+/* -----------------------------------------------------------------------
+   Dead reckoning trajectory simplification
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>
+   All rights Reserved
+   ----------------------------------------------------------------------- */
+
+/*! \file
+    \brief Header file for simplify.c
+
+    Requires nmea.h, sixbit.h and vdm_parse.h to be included first.
+*/
+
+/** Default distance from the predicted position that is kept, in nautical miles */
+#define AIS_SIMPLIFY_TOLERANCE  0.05
+
+
+/** Last position kept for one vessel, predictions are made from it
+*/
+typedef struct {
+    unsigned int    userid;            //!< UserID / MMSI, 0 for an empty slot
+    unsigned int    time;              //!< Time it was kept, low 32 bits
+    long            longitude;         //!< Longitude in 1/10000 minute
+    long            latitude;          //!< Latitude in 1/10000 minute
+    unsigned short  sog;               //!< Speed over ground in 1/10 knot, 1023 = N/A
+    unsigned short  cog;               //!< Course over ground in 1/10 degree, 3600 = N/A
+} simplify_vessel;
+
+
+/** Simplifier settings and per vessel state, a fixed size hash keyed by MMSI
+*/
+typedef struct {
+    double          tolerance;         //!< Keep reports further than this from the prediction, in nautical miles
+    unsigned long   max_interval;      //!< Keep a report at least this often, in seconds, 0 = off
+    simplify_vessel *slots;            //!< size slots
+    unsigned long   size;              //!< Number of slots, a power of 2
+    unsigned long   count;             //!< Vessels in slots
+    unsigned long   reports;           //!< Reports checked
+    unsigned long   kept;              //!< Reports that must be stored
+    unsigned long   full;              //!< Reports kept because slots was full
+} ais_simplify;
+
+
+/* Prototypes */
+int __stdcall init_ais_simplify( ais_simplify *simplify, unsigned long vessels );
+void __stdcall free_ais_simplify( ais_simplify *simplify );
+int __stdcall ais_simplify_check( ais_simplify *simplify, unsigned long userid, long latitude, long longitude,
+                                  int sog, int cog, unsigned long now );
+int __stdcall ais_simplify_check_pos( ais_simplify *simplify, aismsg_pos *pos, unsigned long now );
+int __stdcall ais_simplify_check_msg( ais_simplify *simplify, aismsg_any *msg, unsigned long now );
+double __stdcall ais_simplify_ratio( ais_simplify *simplify );
+unsigned long __stdcall ais_simplify_expire( ais_simplify *simplify, unsigned long now, unsigned long age );
@@ -9,6 +9,12 @@
 #include "portable.h"
 #include "sixbit.h"
 
+#if !defined(SIXBIT_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) \
+    && (defined(__x86_64__) || defined(__i386__))
+#define SIXBIT_SIMD
+#include <immintrin.h>
+#endif
+
 /*! \file
     \brief 6-bit packed ASCII functions
     \author Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>, All Rights Reserved
@@ -26,13 +32,35 @@
 
     Up to 32 bits of data are fetched from the string by calling get_6bit()
 
-    The size of the packet can be calculated with strlen(state->bits) * 6 but
-    note that due to padding at the end of the string the data may be
-    1-6 bits longer than the the expected length for the message id.
-
-    It is up to the calling function to keep track of how many bits have
-    been fetched. When it reaches the end of the 6-bit string get_6bit()
-    will return 0's.
+    Characters should be added with sixbit_append(), it keeps count of
+    the characters and of the exact number of bits in the payload, taking
+    the fill bits from the end of the VDM sentence into account. The size
+    of the payload is returned by sixbit_size() and the number of bits not
+    fetched yet by sixbit_length(), neither has to walk the string. If the
+    string is copied into sixbit.bits directly it is counted once, on first
+    use, and any fill bits are counted as part of the payload.
+
+    When get_6bit() reaches the end of the payload it returns 0's and sets
+    sixbit.overrun so that the caller can tell a short message from one
+    that really had 0's in it.
+
+    For faster field extraction the whole string can be de-armored once
+    with sixbit_pack(). The payload is then held as 64-bit words and
+    get_6bit() pulls each field out with a couple of shifts instead of
+    walking the string a character at a time. get_bits() can be used to
+    fetch a field from any bit offset without changing the state.
+    assemble_vdm() packs every message it completes.
+
+    A sixbit_view is a position and an end over a packed payload. The
+    binary data of messages 6, 8 and 17 is handed to the Seaway and IMO
+    parsers as a view made with sixbit_view_init(), so the payload is
+    never copied. Fields are fetched from it with sixbit_view_get().
+
+    sixbit_dearmor() does the conversion. On x86 CPUs it converts and
+    checks 16 (SSE2) or 32 (AVX2) characters at a time, the best kernel
+    is picked at runtime. Other CPUs use a table driven scalar loop.
+    Any character outside the 6-bit alphabet causes the payload to be
+    rejected instead of being decoded into garbage.
 
 */
 
@@ -40,6 +68,48 @@
 
 const unsigned char pow2_mask[] = { 0x00, 0x01, 0x03, 0x07, 0x0F, 0x1F, 0x3F };
 
+/** 6-bit ASCII to binary, 0xFF for characters outside the alphabet */
+static const unsigned char armor_table[256] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+    0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F,
+    0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37,
+    0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E, 0x3F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
+
+/* ----------------------------------------------------------------------- */
+/** Count the characters in bits if they haven't been counted yet
+
+    \param state
+
+    This is only needed when the string was copied straight into bits,
+    sixbit_append() keeps the counts up to date as it goes.
+*/
+/* ----------------------------------------------------------------------- */
+static void sixbit_count( sixbit *state )
+{
+    const char *end;
+
+    if( (state->len == 0) && (state->bits[0] != 0) )
+    {
+        end = memchr( state->bits, 0, SIXBIT_LEN );
+        state->len = end ? (unsigned int) (end - state->bits) : SIXBIT_LEN;
+        state->bit_len = state->len * 6;
+    }
+}
+
 
 /* ----------------------------------------------------------------------- */
 /** Calculate the number of bits remaining in the six_state
@@ -52,7 +122,95 @@ const unsigned char pow2_mask[] = { 0x00, 0x01, 0x03, 0x07, 0x0F, 0x1F, 0x3F };
 /* ----------------------------------------------------------------------- */
 unsigned int __stdcall sixbit_length( sixbit *state )
 {
-    return state->remainder_bits + (strlen(state->bits) * 6);
+    unsigned int used;
+
+    sixbit_count( state );
+
+    used = 0;
+    if( state->packed )
+        used = state->pos;
+    else if( (state->p >= state->bits) && (state->p <= state->bits + SIXBIT_LEN) )
+        used = ((state->p - state->bits) * 6) - state->remainder_bits;
+
+    if( used >= state->bit_len )
+        return 0;
+    return state->bit_len - used;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Return the size of the payload in bits
+
+    \param state
+
+    returns:
+      - Number of payload bits, not including the fill bits
+
+    This is the length of the whole payload, no matter how much of it has
+    already been fetched.
+*/
+/* ----------------------------------------------------------------------- */
+unsigned int __stdcall sixbit_size( sixbit *state )
+{
+    sixbit_count( state );
+
+    return state->bit_len;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Append 6-bit ASCII characters to the state
+
+    \param state pointer to a sixbit state structure
+    \param ascii 6-bit ASCII characters to append
+    \param len number of characters to append
+    \param fill number of fill bits at the end of the characters
+
+    returns:
+      - 0 if no error
+      - 1 if there was an error
+      - 2 if there is not enough room for the characters
+
+    The character and bit counts are updated so that the payload size
+    is known without counting the string again. The fill bits are the
+    last field of the VDM sentence, they are only counted from the last
+    part appended. Values outside 0-5 are ignored.
+
+    Example:
+    \code
+    sixbit  state;
+
+    init_6bit( &state );
+    sixbit_append( &state, "55Mf@6P00001MUS;7GQL4hh61L4hh6222222220t41H", 43, 0 );
+    sixbit_append( &state, "==40HtI4i@E531H1QDTVH51DSCS0", 28, 2 );
+
+    sixbit_size( &state ) == 424
+    \endcode
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall sixbit_append( sixbit *state, const char *ascii, unsigned int len, unsigned int fill )
+{
+    if( !state || !ascii )
+        return 1;
+
+    sixbit_count( state );
+
+    /* Leave room for the terminating 0 */
+    if( state->len + len > SIXBIT_LEN - 1 )
+        return 2;
+
+    memcpy( state->bits + state->len, ascii, len );
+    state->len += len;
+    state->bits[state->len] = 0;
+
+    if( (fill > 5) || (fill > state->len * 6) )
+        fill = 0;
+    state->bit_len = (state->len * 6) - fill;
+
+    /* Words no longer match the string */
+    state->packed = 0;
+
+    return 0;
 }
 
 
@@ -76,12 +234,7 @@ unsigned int __stdcall sixbit_length( sixbit *state )
 /* ----------------------------------------------------------------------- */
 char __stdcall binfrom6bit( char ascii )
 {
-    if( (ascii < 0x30) || (ascii > 0x77) || ((ascii > 0x57) && (ascii < 0x60)) )
-        return -1;
-    if( ascii < 0x60 )
-        return (ascii - 0x30) & 0x3F;
-    else
-        return (ascii - 0x38) & 0x3F;
+    return (char) armor_table[(unsigned char) ascii];
 }
 
 
@@ -114,6 +267,290 @@ char __stdcall binto6bit( char value )
 }
 
 
+/* ----------------------------------------------------------------------- */
+/** Pack 4 6-bit values into 3 bytes, most significant bits first
+*/
+/* ----------------------------------------------------------------------- */
+static void pack_24( const unsigned char *v, unsigned char *dst )
+{
+    dst[0] = (v[0] << 2) | (v[1] >> 4);
+    dst[1] = (v[1] << 4) | (v[2] >> 2);
+    dst[2] = (v[2] << 6) | v[3];
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Scalar de-armor kernel
+
+    Converts len characters, a multiple of 4, and returns non-zero if
+    any of them were invalid.
+*/
+/* ----------------------------------------------------------------------- */
+static unsigned int dearmor_scalar( const char *ascii, unsigned int len, unsigned char *dst )
+{
+    unsigned char v[4];
+    unsigned char bad = 0;
+    unsigned int  i;
+
+    for( i = 0; i < len; i += 4 )
+    {
+        v[0] = armor_table[(unsigned char) ascii[i]];
+        v[1] = armor_table[(unsigned char) ascii[i+1]];
+        v[2] = armor_table[(unsigned char) ascii[i+2]];
+        v[3] = armor_table[(unsigned char) ascii[i+3]];
+        bad |= v[0] | v[1] | v[2] | v[3];
+        pack_24( v, dst );
+        dst += 3;
+    }
+
+    /* Only invalid characters have the top bits set */
+    return bad & 0xC0;
+}
+
+
+#ifdef SIXBIT_SIMD
+/* ----------------------------------------------------------------------- */
+/** SSE2 de-armor kernel, 16 characters at a time
+
+    Each block is converted with a handful of byte wide compares and the
+    result combined into 24 bit groups with 16 and 32 bit shifts. The
+    return value is the OR of each block's mask of invalid character
+    positions, 0 if all of the characters were valid.
+*/
+/* ----------------------------------------------------------------------- */
+__attribute__((target("sse2")))
+static unsigned int dearmor_sse2( const char *ascii, unsigned int len, unsigned char *dst )
+{
+    const __m128i  k30 = _mm_set1_epi8( 0x30 );
+    const __m128i  k27 = _mm_set1_epi8( 0x27 );
+    const __m128i  k17 = _mm_set1_epi8( 0x17 );
+    const __m128i  k08 = _mm_set1_epi8( 0x08 );
+    const __m128i  lo8 = _mm_set1_epi16( 0x00FF );
+    const __m128i  lo16 = _mm_set1_epi32( 0x0000FFFF );
+    __m128i        c, v, lo, hi, valid;
+    unsigned int   groups[4];
+    unsigned int   bad = 0;
+    unsigned int   i, j;
+
+    for( i = 0; i < len; i += 16 )
+    {
+        c = _mm_loadu_si128( (const __m128i *) (ascii + i) );
+
+        /* 0x30-0x57 and 0x60-0x77 are valid, checked as unsigned */
+        v  = _mm_sub_epi8( c, k30 );
+        lo = _mm_cmpeq_epi8( _mm_min_epu8( v, k27 ), v );
+        hi = _mm_sub_epi8( v, k30 );
+        hi = _mm_cmpeq_epi8( _mm_min_epu8( hi, k17 ), hi );
+        valid = _mm_or_si128( lo, hi );
+        bad |= ~_mm_movemask_epi8( valid ) & 0xFFFF;
+
+        /* Upper range is offset by another 8 */
+        v = _mm_sub_epi8( v, _mm_and_si128( hi, k08 ) );
+
+        /* Combine pairs into 12 bits, then pairs of those into 24 */
+        v = _mm_or_si128( _mm_slli_epi16( _mm_and_si128( v, lo8 ), 6 ),
+                          _mm_srli_epi16( v, 8 ) );
+        v = _mm_or_si128( _mm_slli_epi32( _mm_and_si128( v, lo16 ), 12 ),
+                          _mm_srli_epi32( v, 16 ) );
+        _mm_storeu_si128( (__m128i *) groups, v );
+
+        for( j = 0; j < 4; j++ )
+        {
+            *dst++ = (unsigned char) (groups[j] >> 16);
+            *dst++ = (unsigned char) (groups[j] >> 8);
+            *dst++ = (unsigned char) groups[j];
+        }
+    }
+    return bad;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** AVX2 de-armor kernel, 32 characters at a time
+
+    Same checks as the SSE2 kernel. The 24 bit groups are gathered into
+    24 contiguous bytes with a byte shuffle and a lane permute.
+*/
+/* ----------------------------------------------------------------------- */
+__attribute__((target("avx2")))
+static unsigned int dearmor_avx2( const char *ascii, unsigned int len, unsigned char *dst )
+{
+    const __m256i  k30 = _mm256_set1_epi8( 0x30 );
+    const __m256i  k27 = _mm256_set1_epi8( 0x27 );
+    const __m256i  k17 = _mm256_set1_epi8( 0x17 );
+    const __m256i  k08 = _mm256_set1_epi8( 0x08 );
+    const __m256i  pairs = _mm256_set1_epi32( 0x01400140 );
+    const __m256i  quads = _mm256_set1_epi32( 0x00011000 );
+    const __m256i  order = _mm256_setr_epi8( 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                             2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1 );
+    const __m256i  lanes = _mm256_setr_epi32( 0, 1, 2, 4, 5, 6, 3, 7 );
+    __m256i        c, v, lo, hi, valid;
+    unsigned int   bad = 0;
+    unsigned int   i;
+
+    for( i = 0; i < len; i += 32 )
+    {
+        c = _mm256_loadu_si256( (const __m256i *) (ascii + i) );
+
+        v  = _mm256_sub_epi8( c, k30 );
+        lo = _mm256_cmpeq_epi8( _mm256_min_epu8( v, k27 ), v );
+        hi = _mm256_sub_epi8( v, k30 );
+        hi = _mm256_cmpeq_epi8( _mm256_min_epu8( hi, k17 ), hi );
+        valid = _mm256_or_si256( lo, hi );
+        bad |= ~(unsigned int) _mm256_movemask_epi8( valid );
+
+        v = _mm256_sub_epi8( v, _mm256_and_si256( hi, k08 ) );
+
+        /* (v0 << 6) + v1, then (w0 << 12) + w1 */
+        v = _mm256_maddubs_epi16( v, pairs );
+        v = _mm256_madd_epi16( v, quads );
+
+        v = _mm256_shuffle_epi8( v, order );
+        v = _mm256_permutevar8x32_epi32( v, lanes );
+        _mm_storeu_si128( (__m128i *) dst, _mm256_castsi256_si128( v ) );
+        _mm_storel_epi64( (__m128i *) (dst + 16), _mm256_extracti128_si256( v, 1 ) );
+        dst += 24;
+    }
+    return bad;
+}
+
+
+/** A de-armor kernel and the number of characters it handles at a time */
+typedef struct {
+    unsigned int    (*kernel)( const char *, unsigned int, unsigned char * );
+    unsigned int    block;
+} dearmor_simd;
+
+static const dearmor_simd dearmor_kernels[3] = {
+    { dearmor_scalar, 4 },
+    { dearmor_sse2,   16 },
+    { dearmor_avx2,   32 }
+};
+
+/** Kernel selected by sixbit_simd(), NULL until the first call
+
+    The kernel and its block size are switched together through this one
+    pointer, so a thread calling sixbit_dearmor() while another one picks
+    the kernel never sees the kernel of one level with the block size of
+    another.
+*/
+static const dearmor_simd * volatile dearmor = NULL;
+#endif
+
+
+/* ----------------------------------------------------------------------- */
+/** Select the de-armor kernel
+
+    \param level highest instruction set to use, 0 = scalar, 1 = SSE2,
+                 2 = AVX2
+
+    returns:
+      - the level actually in use
+
+    The kernel is normally picked automatically the first time
+    sixbit_dearmor() is called, using the best one the CPU supports.
+    This can be used to limit it, eg. for benchmarking the scalar code.
+    It is safe to call while other threads are de-armoring, they switch
+    to the new kernel on their next call.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall sixbit_simd( int level )
+{
+#ifdef SIXBIT_SIMD
+    __builtin_cpu_init();
+    if( (level >= 2) && __builtin_cpu_supports( "avx2" ) )
+        level = 2;
+    else if( (level >= 1) && __builtin_cpu_supports( "sse2" ) )
+        level = 1;
+    else
+        level = 0;
+    dearmor = &dearmor_kernels[level];
+    return level;
+#else
+    return 0;
+#endif
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Convert a 6-bit ASCII string to packed binary
+
+    \param ascii pointer to the 6-bit ASCII characters
+    \param len number of characters to convert
+    \param dst pointer to the destination, (len * 6 + 7) / 8 bytes
+
+    returns:
+      - 0 if no error
+      - 1 if there was a parameter error
+      - 2 if there was a character outside the 6-bit alphabet
+
+    The characters are converted to 6-bit values and packed into dst
+    most significant bit first, the last byte is padded with 0 bits.
+    The bulk of the string is handled by the SIMD kernel picked by
+    sixbit_simd(), the kernels also return a mask of the invalid
+    characters in each block so that one bad character rejects the
+    whole payload.
+
+    Example:
+    \code
+    unsigned char buf[3];
+
+    sixbit_dearmor( "1P00", 4, buf );
+
+    buf[0] == 0x06, buf[1] == 0x00, buf[2] == 0x00
+    \endcode
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall sixbit_dearmor( const char *ascii, unsigned int len, unsigned char *dst )
+{
+    char          tail[4];
+    unsigned char last[3];
+    unsigned int  bulk;
+    unsigned int  bad;
+#ifdef SIXBIT_SIMD
+    const dearmor_simd *k;
+#endif
+
+    if( !ascii || !dst )
+        return 1;
+
+#ifdef SIXBIT_SIMD
+    /* Read the selection once, the block size must match the kernel */
+    if( (k = dearmor) == NULL )
+    {
+        sixbit_simd( 2 );
+        k = dearmor;
+    }
+
+    /* Whole SIMD blocks */
+    bulk = len - (len % k->block);
+    bad = k->kernel( ascii, bulk, dst );
+    dst += (bulk / 4) * 3;
+#else
+    bulk = 0;
+    bad = 0;
+#endif
+
+    /* Remaining groups of 4 */
+    bad |= dearmor_scalar( ascii + bulk, (len - bulk) & ~3U, dst );
+    dst += ((len - bulk) / 4) * 3;
+    bulk = len & ~3U;
+
+    /* Last 1-3 characters, padded with '0' which is a 0 value */
+    if( bulk < len )
+    {
+        memset( tail, '0', sizeof( tail ) );
+        memcpy( tail, ascii + bulk, len - bulk );
+        bad |= dearmor_scalar( tail, 4, last );
+        memcpy( dst, last, ((len - bulk) * 6 + 7) / 8 );
+    }
+
+    if( bad )
+        return 2;
+    return 0;
+}
+
+
 /* ----------------------------------------------------------------------- */
 /** Initialize a 6-bit datastream structure
 
@@ -136,11 +573,150 @@ int __stdcall init_6bit( sixbit *state )
     state->remainder_bits = 0;
     state->p = state->bits;
     *state->p = 0;
+    state->len = 0;
+    state->bit_len = 0;
+    state->overrun = 0;
+    state->packed = 0;
+    state->pos = 0;
+    state->num_bits = 0;
 
     return 0;
 }
 
 
+/* ----------------------------------------------------------------------- */
+/** De-armor the 6-bit ASCII string into 64-bit words
+
+    \param state pointer to a sixbit state structure
+
+    returns:
+      - 0 if no error
+      - 1 if there was an error
+      - 2 if the string has characters outside the 6-bit alphabet
+
+    The whole of state->bits is converted to binary with sixbit_dearmor()
+    and stored, most significant bit first, in state->words. Fill bits
+    are not counted as part of the payload. Any bits that have already
+    been fetched with get_6bit() are skipped so that parsing continues
+    from the same place. After this get_6bit() and get_bits() read from
+    the words instead of the string.
+
+    Example:
+    \code
+    sixbit  state;
+
+    init_6bit( &state );
+    strcpy( state.bits, "5678901234" );
+    sixbit_pack( &state );
+    i = get_6bit( &state, 6 );
+
+    i == 5
+    \endcode
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall sixbit_pack( sixbit *state )
+{
+    unsigned char buf[SIXBIT_WORDS * 8];
+    unsigned char *b;
+    unsigned int  len;
+    unsigned int  nwords;
+    unsigned int  i;
+    int           rv;
+
+    if( !state )
+        return 1;
+
+    sixbit_count( state );
+    len = state->len;
+
+    /* Words that get_bits() may touch, including the spare one */
+    nwords = (len * 6 + 63) / 64 + 1;
+    memset( buf, 0, nwords * 8 );
+
+    if( (rv = sixbit_dearmor( state->bits, len, buf )) != 0 )
+    {
+        state->packed = 0;
+        state->num_bits = 0;
+        return rv;
+    }
+
+    for( i = 0, b = buf; i < nwords; i++, b += 8 )
+    {
+        state->words[i] = ((sixbit_word) b[0] << 56) | ((sixbit_word) b[1] << 48)
+                        | ((sixbit_word) b[2] << 40) | ((sixbit_word) b[3] << 32)
+                        | ((sixbit_word) b[4] << 24) | ((sixbit_word) b[5] << 16)
+                        | ((sixbit_word) b[6] << 8)  |  (sixbit_word) b[7];
+    }
+    state->num_bits = state->bit_len;
+
+    /* Skip anything already fetched from the string */
+    state->pos = 0;
+    if( (state->p >= state->bits) && (state->p <= state->bits + SIXBIT_LEN) )
+        state->pos = ((state->p - state->bits) * 6) - state->remainder_bits;
+
+    state->packed = 1;
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Return 0-32 bits from any offset of a packed payload
+
+    \param state pointer to a sixbit state structure
+    \param offset bit offset of the field from the start of the payload
+    \param numbits number of bits to return
+
+    This function does not change the position used by get_6bit() so
+    fields can be fetched in any order. Bits past the end of the payload
+    are returned as 0 and state->overrun is set. If the state has not been
+    packed yet sixbit_pack() is called first.
+
+    Example:
+    \code
+    sixbit  state;
+
+    init_6bit( &state );
+    strcpy( state.bits, "15MqvC0Oh9G?qinK?VlPhA480@2n" );
+    userid = get_bits( &state, 8, 30 );
+
+    userid == 366902860
+    \endcode
+*/
+/* ----------------------------------------------------------------------- */
+unsigned long __stdcall get_bits( sixbit *state, unsigned int offset, short numbits )
+{
+    sixbit_word   w;
+    unsigned int  shift;
+
+    if( !state->packed )
+        sixbit_pack( state );
+
+    if( numbits <= 0 )
+        return 0;
+    if( offset >= state->num_bits )
+    {
+        state->overrun = 1;
+        return 0;
+    }
+
+    shift = offset & 0x3F;
+    w = state->words[offset >> 6] << shift;
+    if( shift + numbits > 64 )
+        w |= state->words[(offset >> 6) + 1] >> (64 - shift);
+    w >>= 64 - numbits;
+
+    /* Don't return the fill bits */
+    if( offset + numbits > state->num_bits )
+    {
+        state->overrun = 1;
+        w &= ~(((sixbit_word) 1 << (offset + numbits - state->num_bits)) - 1);
+    }
+
+    return (unsigned long) w;
+}
+
+
 /* ----------------------------------------------------------------------- */
 /** Return 0-32 bits from a 6-bit ASCII stream
 
@@ -151,10 +727,10 @@ int __stdcall init_6bit( sixbit *state )
     function. It pulls the bits from the raw 6-bit ASCII as they are
     needed.
 
-    The full string can be addressed by pointing to state->bits and the
-    length can be calculated by strlen(state->bits) * 6, but note that the
-    string also includes any final padding, so when checking lengths take
-    into account that it will be a multiples of 6 bits.
+    The full string can be addressed by pointing to state->bits, the size
+    of the payload is returned by sixbit_size() and the number of bits
+    not fetched yet by sixbit_length(). Fetching past the end of the
+    payload sets state->overrun, the missing bits are returned as 0.
 
     Example:
     \code
@@ -174,6 +750,21 @@ unsigned long __stdcall get_6bit( sixbit *state, short numbits )
     unsigned long result;
     short         fetch_bits;
 
+    /* Fetch directly from the de-armored payload */
+    if( state->packed )
+    {
+        if( numbits > (short) (state->num_bits - state->pos) )
+        {
+            state->overrun = 1;
+            numbits = state->num_bits - state->pos;
+        }
+
+        result = get_bits( state, state->pos, numbits );
+        state->pos += numbits;
+
+        return result;
+    }
+
     result = 0;
     fetch_bits = numbits;
 
@@ -212,8 +803,84 @@ unsigned long __stdcall get_6bit( sixbit *state, short numbits )
             state->p++;
         } else {
             /* Nothing more to fetch, return what we have */
+            if( fetch_bits > 0 )
+                state->overrun = 1;
             return result;
         }
     }
     return result;
 }
+
+
+/* ----------------------------------------------------------------------- */
+/** Make a view of the rest of a payload
+
+    \param view pointer to the view to setup
+    \param state pointer to a sixbit state structure
+
+    returns:
+      - 0 if no error
+      - 1 if there was an error
+
+    The view starts at the next bit get_6bit() would return and ends at
+    the end of the payload. The state is packed first if needed. Fetching
+    from the view does not change the state.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall sixbit_view_init( sixbit_view *view, sixbit *state )
+{
+    if( !view || !state )
+        return 1;
+
+    if( !state->packed && sixbit_pack( state ) )
+        return 1;
+
+    view->six = state;
+    view->pos = state->pos;
+    view->end = state->num_bits;
+    view->overrun = 0;
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Return 0-32 bits from a view
+
+    \param view pointer to a view made by sixbit_view_init()
+    \param numbits number of bits to return
+
+    This works like get_6bit(). Fetching past the end of the view sets
+    view->overrun, the missing bits are returned as 0.
+*/
+/* ----------------------------------------------------------------------- */
+unsigned long __stdcall sixbit_view_get( sixbit_view *view, short numbits )
+{
+    unsigned long result;
+
+    if( numbits > (short) (view->end - view->pos) )
+    {
+        view->overrun = 1;
+        numbits = view->end - view->pos;
+    }
+
+    result = get_bits( view->six, view->pos, numbits );
+    view->pos += numbits;
+
+    return result;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Calculate the number of bits remaining in a view
+
+    \param view pointer to a view made by sixbit_view_init()
+
+    returns:
+      - Number of bits remaining
+*/
+/* ----------------------------------------------------------------------- */
+unsigned int __stdcall sixbit_view_length( sixbit_view *view )
+{
+    return view->end - view->pos;
+}
@@ -13,21 +13,71 @@
 
 #define SIXBIT_LEN   255
 
+/** Number of words needed to hold SIXBIT_LEN de-armored characters, plus
+    one spare so a field may always be read from 2 adjacent words
+*/
+#define SIXBIT_WORDS ((SIXBIT_LEN * 6 + 63) / 64 + 1)
+
+/** 64-bit word used to hold the de-armored payload
+*/
+#ifdef _MSC_VER
+typedef unsigned __int64   sixbit_word;
+#else
+typedef unsigned long long sixbit_word;
+#endif
+
 /** sixbit state
 
     The size of bits is enough to handle a little over 5 slots of data
     ((5 * 256) / 6) = 214
+
+    When packed is set the payload has been de-armored into words by
+    sixbit_pack() and fields are fetched from there instead of from bits.
+
+    len and bit_len are kept up to date by sixbit_append(). If the string
+    was copied into bits directly they are counted on first use, bit_len
+    then includes any fill bits.
 */
 typedef struct {
     char bits[SIXBIT_LEN];          //!< raw 6-bit ASCII data string
     char *p;                        //!< pointer to current character in bits
     unsigned char remainder;        //!< Remainder bits
     unsigned char remainder_bits;   //!< Number of remainder bits
+    unsigned int  len;              //!< Number of characters in bits, 0 if not counted
+    unsigned int  bit_len;          //!< Number of payload bits, without the fill bits
+    unsigned char overrun;          //!< Set when a fetch runs past the end of the payload
+    unsigned char packed;           //!< 1 if words holds the payload
+    unsigned int  pos;              //!< Next bit to fetch from words
+    unsigned int  num_bits;         //!< Number of bits held in words
+    sixbit_word   words[SIXBIT_WORDS]; //!< De-armored payload, MSB first
 } sixbit;
 
+/** Read-only view of part of a packed payload
+
+    Used to hand the binary data of messages 6, 8 and 17 to the Seaway
+    and IMO parsers without copying the sixbit state. It does not own
+    the payload, it is only good for as long as the sixbit it was made
+    from holds the same message.
+*/
+typedef struct {
+    sixbit          *six;           //!< Packed payload the view is over
+    unsigned int    pos;            //!< Next bit to fetch
+    unsigned int    end;            //!< Bit offset of the end of the view
+    unsigned char   overrun;        //!< Set when a fetch runs past the end of the view
+} sixbit_view;
+
 /* Prototypes -- need to document these */
 char __stdcall binfrom6bit( char ascii );
 int __stdcall init_6bit( sixbit *state );
 unsigned long __stdcall get_6bit( sixbit *state, short numbits );
 unsigned int __stdcall sixbit_length( sixbit *state );
+unsigned int __stdcall sixbit_size( sixbit *state );
+int __stdcall sixbit_append( sixbit *state, const char *ascii, unsigned int len, unsigned int fill );
 char __stdcall binto6bit( char value );
+int __stdcall sixbit_simd( int level );
+int __stdcall sixbit_dearmor( const char *ascii, unsigned int len, unsigned char *dst );
+int __stdcall sixbit_pack( sixbit *state );
+unsigned long __stdcall get_bits( sixbit *state, unsigned int offset, short numbits );
+int __stdcall sixbit_view_init( sixbit_view *view, sixbit *state );
+unsigned long __stdcall sixbit_view_get( sixbit_view *view, short numbits );
+unsigned int __stdcall sixbit_view_length( sixbit_view *view );
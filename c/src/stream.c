@@ -0,0 +1,217 @@
+/* -----------------------------------------------------------------------
+   Streaming AIVDM/AIVDO parser
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>
+   All rights Reserved
+   ----------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "portable.h"
+#include "nmea.h"
+#include "sixbit.h"
+#include "vdm_parse.h"
+#include "reassembly.h"
+#include "stream.h"
+
+/*! \file
+    \brief Streaming AIVDM/AIVDO parser
+    \author Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>, All Rights Reserved
+    \version 1.8
+
+    Data from a serial port or a TCP connection arrives in chunks that
+    have nothing to do with the line endings. Instead of gathering it
+    into lines before calling assemble_vdm(), pass each chunk straight
+    to ais_stream_feed() as it is read. Every AIS message that is
+    completed is handed to the stream's callback.
+
+    Sentences that are wholly inside a chunk are parsed where they are,
+    the '\\n' at the end is replaced by a 0 while it is tokenized and then
+    put back. Only a sentence that is split between 2 chunks is copied,
+    into the str buffer of the stream's nmea_state. nmea_state.search is
+    START when nothing is held, END while waiting for the rest of a
+    sentence and DONE while the completed sentence is being used.
+
+    Multipart messages are put together in the stream's ais_state, like
+    assemble_vdm() does. Set stream->reasm to a reassembly table after
+    init_ais_stream() to allow the parts of different messages to be
+    mixed together.
+
+    Example:
+    \code
+    void __stdcall got_message( ais_state *state, void *data )
+    {
+        aismsg_any msg;
+
+        if( parse_ais_any( state, &msg ) == 0 )
+            ...
+    }
+
+    ais_stream stream;
+    char       buf[1024];
+    int        n;
+
+    init_ais_stream( &stream, got_message, NULL );
+    while( (n = recv( sock, buf, sizeof(buf), 0 )) > 0 )
+        ais_stream_feed( &stream, buf, n );
+    \endcode
+*/
+
+
+/* ----------------------------------------------------------------------- */
+/** Initialize a streaming parser
+
+    \param stream pointer to the stream state
+    \param callback function to call with each completed message
+    \param data pointer passed to callback
+
+    returns:
+      - 0 if no error
+      - 1 if there was an error
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall init_ais_stream( ais_stream *stream, ais_stream_cb callback, void *data )
+{
+    if( !stream || !callback )
+        return 1;
+
+    memset( stream, 0, sizeof( ais_stream ) );
+    stream->nmea.search = START;
+    stream->callback = callback;
+    stream->data = data;
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Use one complete sentence
+
+    \param stream pointer to the stream state
+    \param line sentence ending with a 0
+
+    returns:
+      - 1 if a message was completed
+      - 0 if not
+*/
+/* ----------------------------------------------------------------------- */
+static int stream_sentence( ais_stream *stream, char *line )
+{
+    int rv;
+
+    /* Empty lines between sentences */
+    if( (*line == 0) || (*line == '\r') )
+        return 0;
+
+    stream->sentences++;
+    rv = nmea_tokenize( &stream->nmea, line );
+    if( !is_vdm( &stream->nmea ) )
+        return 0;
+    if( rv != 0 )
+    {
+        stream->errors++;
+        return 0;
+    }
+
+    if( stream->reasm )
+        rv = reasm_vdm_tokens( stream->reasm, &stream->state, &stream->nmea, stream->sentences );
+    else
+        rv = assemble_vdm_tokens( &stream->state, &stream->nmea );
+
+    if( rv == 1 )
+        return 0;
+    if( rv != 0 )
+    {
+        stream->errors++;
+        return 0;
+    }
+
+    stream->callback( &stream->state, stream->data );
+    return 1;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Parse the next chunk of a stream of sentences
+
+    \param stream pointer to the stream state
+    \param buf pointer to the bytes read
+    \param len number of bytes in buf
+
+    returns:
+      - number of messages completed
+      - -1 if there was an error
+
+    The chunk may start and end anywhere in a sentence. Sentences end with
+    a '\\n', the callback is called for each message as soon as its last
+    sentence has been read. buf is changed while it is parsed but it is
+    the same when this returns.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall ais_stream_feed( ais_stream *stream, char *buf, size_t len )
+{
+    nmea_state  *nmea;
+    char        *p;
+    char        *end;
+    char        *eol;
+    size_t      n;
+    int         count;
+
+    if( !stream || !buf )
+        return -1;
+
+    nmea = &stream->nmea;
+    count = 0;
+    p = buf;
+    end = buf + len;
+    while( p < end )
+    {
+        eol = memchr( p, '\n', end - p );
+        n = (eol ? eol : end) - p;
+
+        if( stream->discard )
+        {
+            /* Skip to the end of a sentence that was too long */
+            if( eol )
+                stream->discard = 0;
+        } else if( nmea->search == END ) {
+            /* Finish the sentence started in an earlier chunk */
+            if( nmea->str_len + n > MAX_NMEA_LENGTH - 1 )
+            {
+                stream->overflows++;
+                stream->discard = (eol == NULL);
+                nmea->str_len = 0;
+                nmea->search = START;
+            } else {
+                memcpy( nmea->str + nmea->str_len, p, n );
+                nmea->str_len += n;
+                if( eol )
+                {
+                    nmea->str[nmea->str_len] = 0;
+                    nmea->search = DONE;
+                    count += stream_sentence( stream, nmea->str );
+                    nmea->str_len = 0;
+                    nmea->search = START;
+                }
+            }
+        } else if( n > MAX_NMEA_LENGTH - 1 ) {
+            stream->overflows++;
+            stream->discard = (eol == NULL);
+        } else if( eol ) {
+            /* Whole sentence in this chunk */
+            *eol = 0;
+            count += stream_sentence( stream, p );
+            *eol = '\n';
+        } else {
+            /* Keep the start of the sentence for the next chunk */
+            memcpy( nmea->str, p, n );
+            nmea->str_len = n;
+            nmea->search = END;
+        }
+
+        if( !eol )
+            break;
+        p = eol + 1;
+    }
+
+    return count;
+}
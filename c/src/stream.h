@@ -0,0 +1,39 @@
+/* -----------------------------------------------------------------------
+   Streaming AIVDM/AIVDO parser
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>
+   All rights Reserved
+   ----------------------------------------------------------------------- */
+
+/*! \file
+    \brief Header file for stream.c
+
+    Requires nmea.h, sixbit.h, vdm_parse.h and reassembly.h to be
+    included first.
+*/
+
+/** Called for each message completed by ais_stream_feed()
+
+    The message is in state->six_state, ready for parse_ais_any() or
+    get_6bit(). data is the pointer passed to init_ais_stream().
+*/
+typedef void (__stdcall *ais_stream_cb)( ais_state *state, void *data );
+
+
+/** Streaming parser state
+*/
+typedef struct {
+    nmea_state     nmea;               //!< Holds a sentence split across 2 chunks in str
+    ais_state      state;              //!< Message being assembled
+    reasm_table    *reasm;             //!< Optional reassembly table, NULL to use state only
+    ais_stream_cb  callback;           //!< Called with each completed message
+    void           *data;              //!< Passed to callback
+    unsigned char  discard;            //!< 1 while skipping the rest of a sentence that was too long
+    unsigned long  sentences;          //!< Sentences read, used as the time for reasm
+    unsigned long  errors;             //!< Sentences that could not be used
+    unsigned long  overflows;          //!< Sentences longer than MAX_NMEA_LENGTH that were dropped
+} ais_stream;
+
+
+/* Prototypes */
+int __stdcall init_ais_stream( ais_stream *stream, ais_stream_cb callback, void *data );
+int __stdcall ais_stream_feed( ais_stream *stream, char *buf, size_t len );
@@ -6,6 +6,7 @@
 #include <stdio.h>
 #include <string.h>
 #include "portable.h"
+#include "nmea.h"
 #include "sixbit.h"
 #include "vdm_parse.h"
 #include "seaway.h"
@@ -19,7 +20,7 @@ void test_access()
 	ais_state state;
     aismsg_8  message;
 	seaway1_3 msg1_3;
-	sixbit *seaway;
+	sixbit_view *seaway;
 	water_level_report *report;
 	timetag *utc_time;
 	int dac, fi, spare, msgid;
@@ -53,8 +54,8 @@ void test_access()
 			dac = message.app_id >> 6;
 			fi = message.app_id & 0x3F;
 
-			spare = (char) get_6bit( seaway, 2);
-			msgid = (char) get_6bit( seaway, 6);
+			spare = (char) sixbit_view_get( seaway, 2);
+			msgid = (char) sixbit_view_get( seaway, 6);
 
 			printf( "AppID: 0x%04X\n", message.app_id );
 			printf( "DAC  : 0x%03X (%d)\n", dac, dac );
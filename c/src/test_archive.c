@@ -0,0 +1,222 @@
+/* -----------------------------------------------------------------------
+   Archive decoder Test functions
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com
+   All Rights Reserved
+   ----------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "portable.h"
+#include "nmea.h"
+#include "sixbit.h"
+#include "vdm_parse.h"
+#include "reassembly.h"
+#include "batch.h"
+#include "archive.h"
+#include "test_archive.h"
+
+/*! \file
+    \brief Archive decoder Test functions
+    \author Brian C. Lane <bcl@brianlane.com>
+
+*/
+
+static char test_block[] =
+    "!AIVDM,2,1,2,B,8030ojA?0@=DE3@?BDPA3onQiUFttP1Wh01DE3<1EJ?>0onlkUG0e01I,0*3D\r\n"
+    "$GPGGA,161229.487,3723.2475,N,12158.3416,W,1,07,1.0,9.0,M,,,,0000*18\r\n"
+    "!AIVDM,2,2,2,B,h00,2*7D\r\n"
+    "!AIVDM,2,1,9,A,55Mf@6P00001MUS;7GQL4hh61L4hh6222222220t41H,0*49\r\n"
+    "!AIVDM,1,1,,B,19NS7Sp02wo?HETKA2K6mUM20<L=,0*27\r\n"
+    "!AIVDM,2,2,9,A,==40HtI4i@E531H1QDTVH51DSCS0,2*16\r\n"
+    "!AIVDM,1,1,,B,19NS7Sp02wo?HETKA2K6mUM20<L=,0*28\r\n"
+    "!AIVDM,1,1,,A,H52IRsP518Tj0l59D0000000000,2*45\r\n";
+
+#define TEST_BLOCKS    200
+#define TEST_MESSAGES  (4 * TEST_BLOCKS)
+
+
+/* Build an archive by repeating test_block */
+static char *make_archive( size_t *len )
+{
+    char    *buf;
+    size_t  n;
+    int     i;
+
+    n = strlen( test_block );
+    buf = malloc( n * TEST_BLOCKS );
+    if( !buf )
+        return NULL;
+    for( i = 0; i < TEST_BLOCKS; i++ )
+        memcpy( buf + i * n, test_block, n );
+    *len = n * TEST_BLOCKS;
+
+    return buf;
+}
+
+
+/* Record the offset and message id of each message */
+static size_t       offsets[TEST_MESSAGES];
+static char         msgids[TEST_MESSAGES];
+static unsigned int num_records;
+static unsigned int bad_data;
+
+static void __stdcall got_record( ais_record *record, void *data )
+{
+    sixbit_view view;
+
+    if( num_records < TEST_MESSAGES )
+    {
+        offsets[num_records] = record->offset;
+        msgids[num_records] = record->msg.msgid;
+    }
+    num_records++;
+
+    /* The message 8 payload has to survive being held */
+    if( record->msg.msgid == 8 )
+    {
+        view = record->msg.u.msg_8.data;
+        sixbit_view_get( &view, 2 );
+        if( sixbit_view_get( &view, 6 ) != 3 )
+            bad_data++;
+    }
+}
+
+
+/* Counts messages from several threads */
+static unsigned long total_offsets;
+
+static void __stdcall count_record( ais_record *record, void *data )
+{
+    __sync_fetch_and_add( &total_offsets, (unsigned long) record->offset );
+}
+
+
+int test_ais_decode_archive( void )
+{
+    ais_archive archive;
+    char        *buf;
+    size_t      len;
+    size_t      n;
+    FILE        *fp;
+    int         i;
+
+    if( (buf = make_archive( &len )) == NULL )
+        return 0;
+
+    /* One thread, small chunks so that messages are split across them */
+    num_records = bad_data = 0;
+    init_ais_archive( &archive, got_record, NULL );
+    archive.chunk_size = 4096;
+    archive.ordered = 1;
+    if(    (ais_decode_archive_mem( &archive, buf, len ) != 0)
+        || (num_records != TEST_MESSAGES) || (archive.records != TEST_MESSAGES)
+        || (archive.stitched == 0) || (archive.errors != TEST_BLOCKS) || bad_data )
+    {
+        fprintf( stderr, "test_ais_decode_archive() 1: failed %u %lu %lu\n", num_records, archive.stitched, archive.errors );
+        free( buf );
+        return 0;
+    }
+
+    /* In file order */
+    n = strlen( test_block );
+    for( i = 0; i < TEST_MESSAGES; i++ )
+    {
+        if( (i > 0) && (offsets[i] <= offsets[i-1]) )
+            break;
+    }
+    if( (i != TEST_MESSAGES) || (msgids[0] != 8) || (msgids[1] != 1) || (msgids[2] != 5)
+        || (msgids[3] != 24) || (offsets[4] != n + 78 + 70) )
+    {
+        fprintf( stderr, "test_ais_decode_archive() 2: failed %d\n", i );
+        free( buf );
+        return 0;
+    }
+
+    /* From a file */
+    fp = fopen( "test_archive.log", "wb" );
+    if( !fp || (fwrite( buf, 1, len, fp ) != len) )
+    {
+        fprintf( stderr, "test_ais_decode_archive() 3: failed\n" );
+        free( buf );
+        return 0;
+    }
+    fclose( fp );
+    free( buf );
+
+    num_records = 0;
+    init_ais_archive( &archive, got_record, NULL );
+    i = ais_decode_archive( &archive, "test_archive.log" );
+    remove( "test_archive.log" );
+    if( (i != 0) || (num_records != TEST_MESSAGES) || (archive.stitched != 0) )
+    {
+        fprintf( stderr, "test_ais_decode_archive() 4: failed\n" );
+        return 0;
+    }
+
+    if( ais_decode_archive( &archive, "test_archive.log" ) != 1 )
+    {
+        fprintf( stderr, "test_ais_decode_archive() 5: failed\n" );
+        return 0;
+    }
+
+    fprintf( stderr, "test_ais_decode_archive(): Passed\n" );
+    return 1;
+}
+
+
+int test_ais_decode_archive_threads( void )
+{
+    ais_archive   archive;
+    size_t        serial[TEST_MESSAGES];
+    char          *buf;
+    size_t        len;
+    unsigned long total;
+    int           i;
+
+    if( (buf = make_archive( &len )) == NULL )
+        return 0;
+
+    num_records = bad_data = 0;
+    init_ais_archive( &archive, got_record, NULL );
+    archive.chunk_size = 4096;
+    archive.ordered = 1;
+    ais_decode_archive_mem( &archive, buf, len );
+    memcpy( serial, offsets, sizeof( serial ) );
+    total = 0;
+    for( i = 0; i < TEST_MESSAGES; i++ )
+        total += serial[i];
+
+    /* Ordered, the same as one thread */
+    num_records = bad_data = 0;
+    init_ais_archive( &archive, got_record, NULL );
+    archive.chunk_size = 4096;
+    archive.threads = 4;
+    archive.ordered = 1;
+    if(    (ais_decode_archive_mem( &archive, buf, len ) != 0)
+        || (num_records != TEST_MESSAGES) || (archive.records != TEST_MESSAGES)
+        || (archive.errors != TEST_BLOCKS) || bad_data
+        || (memcmp( serial, offsets, sizeof( serial ) ) != 0) )
+    {
+        fprintf( stderr, "test_ais_decode_archive_threads() 1: failed %u\n", num_records );
+        free( buf );
+        return 0;
+    }
+
+    /* In any order, the same messages */
+    total_offsets = 0;
+    init_ais_archive( &archive, count_record, NULL );
+    archive.chunk_size = 4096;
+    archive.threads = 4;
+    if(    (ais_decode_archive_mem( &archive, buf, len ) != 0)
+        || (archive.records != TEST_MESSAGES) || (archive.errors != TEST_BLOCKS)
+        || (total_offsets != total) )
+    {
+        fprintf( stderr, "test_ais_decode_archive_threads() 2: failed %lu\n", archive.records );
+        free( buf );
+        return 0;
+    }
+    free( buf );
+
+    fprintf( stderr, "test_ais_decode_archive_threads(): Passed\n" );
+    return 1;
+}
@@ -0,0 +1,13 @@
+/* -----------------------------------------------------------------------
+   Archive decoder Test functions
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com
+   All Rights Reserved
+   ----------------------------------------------------------------------- */
+
+/*! \file
+    \brief Header file for test_archive.c
+*/
+
+
+int test_ais_decode_archive( void );
+int test_ais_decode_archive_threads( void );
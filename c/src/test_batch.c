@@ -0,0 +1,83 @@
+/* -----------------------------------------------------------------------
+   Batch decoding Test functions
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com
+   All Rights Reserved
+   ----------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "portable.h"
+#include "nmea.h"
+#include "sixbit.h"
+#include "vdm_parse.h"
+#include "reassembly.h"
+#include "batch.h"
+#include "test_batch.h"
+
+/*! \file
+    \brief Batch decoding Test functions
+    \author Brian C. Lane <bcl@brianlane.com>
+
+*/
+
+static ais_batch batch;
+
+
+int test_ais_decode_batch( void )
+{
+    ais_record  records[4];
+    sixbit_view data;
+    size_t      used;
+    int         n;
+    char buf[] = "!AIVDM,2,1,2,B,8030ojA?0@=DE3@?BDPA3onQiUFttP1Wh01DE3<1EJ?>0onlkUG0e01I,0*3D\r\n"
+                 "$GPGGA,161229.487,3723.2475,N,12158.3416,W,1,07,1.0,9.0,M,,,,0000*18\r\n"
+                 "!AIVDM,2,2,2,B,h00,2*7D\r\n"
+                 "!AIVDM,2,1,9,A,55Mf@6P00001MUS;7GQL4hh61L4hh6222222220t41H,0*49\r\n"
+                 "!AIVDM,1,1,,B,19NS7Sp02wo?HETKA2K6mUM20<L=,0*27\r\n"
+                 "!AIVDM,2,2,9,A,==40HtI4i@E531H1QDTVH51DSCS0,2*16\r\n"
+                 "!AIVDM,1,1,,B,19NS7Sp02wo?HETKA2K6mUM20<L=,0*28\r\n"
+                 "!AIVDM,1,1,,A,H52IRsP518Tj0l";
+    char rest[] = "!AIVDM,1,1,,A,H52IRsP518Tj0l59D0000000000,2*45\r\n";
+
+    init_ais_batch( &batch, 10 );
+
+    /* Stops when the records are full */
+    n = ais_decode_batch( &batch, buf, strlen( buf ), records, 1, &used );
+    if( (n != 1) || (records[0].msg.msgid != 8) || (records[0].channel != 'B') || (used != 173) )
+    {
+        fprintf( stderr, "test_ais_decode_batch() 1: failed %d %d\n", n, (int) used );
+        return 0;
+    }
+
+    /* The part 2 of the message 5 is after a message 1, the bad checksum
+       is counted and the last line is left for later
+    */
+    n = ais_decode_batch( &batch, buf + used, strlen( buf ) - used, records + 1, 3, &used );
+    if(    (n != 2) || (records[1].msg.msgid != 1) || (records[1].msg.u.msg_1.userid != 636012431)
+        || (records[2].msg.msgid != 5) || (records[2].msg.u.msg_5.userid != 366710810)
+        || (records[2].offset != 114) || (batch.errors != 1)
+        || (strcmp( buf + 173 + used, "!AIVDM,1,1,,A,H52IRsP518Tj0l" ) != 0) )
+    {
+        fprintf( stderr, "test_ais_decode_batch() 2: failed\n" );
+        return 0;
+    }
+
+    /* The message 8 data is still there after other messages */
+    data = records[0].msg.u.msg_8.data;
+    sixbit_view_get( &data, 2 );
+    if( sixbit_view_get( &data, 6 ) != 3 )
+    {
+        fprintf( stderr, "test_ais_decode_batch() 3: failed\n" );
+        return 0;
+    }
+
+    n = ais_decode_batch( &batch, rest, strlen( rest ), records, 4, &used );
+    if( (n != 1) || (records[0].msg.msgid != 24) || (used != strlen( rest )) )
+    {
+        fprintf( stderr, "test_ais_decode_batch() 4: failed\n" );
+        return 0;
+    }
+
+    fprintf( stderr, "test_ais_decode_batch(): Passed\n" );
+    return 1;
+}
@@ -0,0 +1,12 @@
+/* -----------------------------------------------------------------------
+   Batch decoding Test functions
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com
+   All Rights Reserved
+   ----------------------------------------------------------------------- */
+
+/*! \file
+    \brief Header file for test_batch.c
+*/
+
+
+int test_ais_decode_batch( void );
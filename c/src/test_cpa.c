@@ -0,0 +1,103 @@
+/* -----------------------------------------------------------------------
+   CPA engine Test functions
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com
+   All Rights Reserved
+   ----------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "portable.h"
+#include "nmea.h"
+#include "sixbit.h"
+#include "vdm_parse.h"
+#include "mmsi_index.h"
+#include "grid.h"
+#include "cpa.h"
+#include "test_cpa.h"
+
+/*! \file
+    \brief CPA engine Test functions
+    \author Brian C. Lane <bcl@brianlane.com>
+
+*/
+
+
+/* Keep the last alert */
+static cpa_alert     last_alert;
+static unsigned int  num_alerts;
+
+static void __stdcall got_alert( cpa_alert *alert, void *data )
+{
+    last_alert = *alert;
+    num_alerts++;
+}
+
+
+int test_cpa_update( void )
+{
+    cpa_engine  engine;
+    aismsg_any  msg;
+
+    if( init_cpa_engine( &engine, 100, got_alert, NULL ) != 0 )
+    {
+        fprintf( stderr, "test_cpa_update() 1: failed\n" );
+        return 0;
+    }
+    num_alerts = 0;
+
+    /* Heading south at 10 knots, 2 miles north of 22N 73W */
+    cpa_update( &engine, 2, 13220000, -43800000, 100, 1800, 1000 );
+
+    /* One a degree away, one with no course and one going the other way */
+    cpa_update( &engine, 3, 13800000, -43800000, 100, 1800, 1000 );
+    cpa_update( &engine, 4, 13210000, -43800000, 50, 3600, 1000 );
+    cpa_update( &engine, 5, 13190000, -43800000, 100, 1800, 1000 );
+    if( num_alerts != 0 )
+    {
+        fprintf( stderr, "test_cpa_update() 2: failed\n" );
+        free_cpa_engine( &engine );
+        return 0;
+    }
+
+    /* A minute later, heading north at 10 knots. The other one has come
+       1/6 mile closer, 1.833 miles apart at 20 knots is 330 seconds
+    */
+    memset( &msg, 0, sizeof( msg ) );
+    msg.msgid = 1;
+    msg.u.msg_1.userid = 1;
+    msg.u.msg_1.latitude = 13200000;
+    msg.u.msg_1.longitude = -43800000;
+    msg.u.msg_1.sog = 100;
+    msg.u.msg_1.cog = 0;
+    if(    (cpa_update_msg( &engine, &msg, 1060 ) != 0) || (num_alerts != 1)
+        || (last_alert.userid != 1) || (last_alert.other != 2) || (last_alert.cpa > 0.001)
+        || (last_alert.tcpa < 329.0) || (last_alert.tcpa > 331.0)
+        || (last_alert.range < 1.83) || (last_alert.range > 1.84) )
+    {
+        fprintf( stderr, "test_cpa_update() 3: failed %u %0.3f %0.1f\n", num_alerts, last_alert.cpa, last_alert.tcpa );
+        free_cpa_engine( &engine );
+        return 0;
+    }
+
+    /* Passing a mile apart is not close enough */
+    cpa_update( &engine, 1, 13200000, -43810000, 100, 0, 1060 );
+    if( num_alerts != 1 )
+    {
+        fprintf( stderr, "test_cpa_update() 4: failed %0.3f\n", last_alert.cpa );
+        free_cpa_engine( &engine );
+        return 0;
+    }
+
+    /* Too long ago to count */
+    cpa_update( &engine, 1, 13200000, -43800000, 100, 0, 2000 );
+    if( (num_alerts != 1) || (cpa_expire( &engine, 2000, 600 ) != 4) || (engine.grid.count != 1) )
+    {
+        fprintf( stderr, "test_cpa_update() 5: failed\n" );
+        free_cpa_engine( &engine );
+        return 0;
+    }
+    free_cpa_engine( &engine );
+
+    fprintf( stderr, "test_cpa_update(): Passed\n" );
+    return 1;
+}
@@ -0,0 +1,12 @@
+/* -----------------------------------------------------------------------
+   CPA engine Test functions
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com
+   All Rights Reserved
+   ----------------------------------------------------------------------- */
+
+/*! \file
+    \brief Header file for test_cpa.c
+*/
+
+
+int test_cpa_update( void );
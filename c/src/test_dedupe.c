@@ -0,0 +1,135 @@
+/* -----------------------------------------------------------------------
+   Duplicate suppression Test functions
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com
+   All Rights Reserved
+   ----------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "portable.h"
+#include "nmea.h"
+#include "sixbit.h"
+#include "vdm_parse.h"
+#include "dedupe.h"
+#include "test_dedupe.h"
+
+/*! \file
+    \brief Duplicate suppression Test functions
+    \author Brian C. Lane <bcl@brianlane.com>
+
+*/
+
+
+int test_ais_dedupe( void )
+{
+    ais_state   ais;
+    ais_dedupe  dedupe;
+    char        buf[6][255] = { "\\s:r1*0A\\!AIVDM,1,1,,B,19NS7Sp02wo?HETKA2K6mUM20<L=,0*27\r\n",
+                                "\\s:r2*09\\!AIVDM,1,1,,A,19NS7Sp02wo?HETKA2K6mUM20<L=,0*24\r\n",
+                                "\\s:r3*08\\!AIVDM,1,1,,B,19NS7Sp02wo?HETKA2K6mUM20<L=,0*27\r\n",
+                                "\\s:r2*09\\!AIVDM,1,1,,B,15MgK45P3@G?fl0E`JbR0OwT0@MS,0*4D\r\n",
+                                "\\s:r1*0A\\!AIVDM,1,1,,B,15MgK45P3@G?fl0E`JbR0OwT0@MS,0*4D\r\n",
+                                "!AIVDM,1,1,,B,15MgK45P3@G?fl0E`JbR0OwT0@MS,0*4D\r\n"
+                              };
+    int         expect[6] = { 0, 8, 8, 0, 8, 8 };
+    int         i;
+    int         r1, r2, r3;
+
+    memset( &ais, 0, sizeof( ais_state ) );
+    if( init_ais_dedupe( &dedupe, 100, AIS_DEDUPE_WINDOW ) != 0 )
+    {
+        fprintf( stderr, "test_ais_dedupe() 1: failed\n" );
+        return 0;
+    }
+
+    /* One message heard by 3 stations, another by 2 and a feed without a tag block */
+    for( i = 0; i < 6; i++ )
+    {
+        if( assemble_vdm_dedupe( &ais, &dedupe, buf[i], 1000 + i ) != expect[i] )
+        {
+            fprintf( stderr, "test_ais_dedupe() 2: failed on %d\n", i );
+            free_ais_dedupe( &dedupe );
+            return 0;
+        }
+    }
+
+    r1 = ais_dedupe_station( &dedupe, "r1" );
+    r2 = ais_dedupe_station( &dedupe, "r2" );
+    r3 = ais_dedupe_station( &dedupe, "r3" );
+    if(    (dedupe.unique != 2) || (dedupe.duplicates != 4) || (dedupe.num_stations != 4)
+        || (r1 == 0) || (r2 == 0) || (r3 == 0) || (r1 == r2) || (r2 == r3)
+        || (dedupe.station[r1].first != 1) || (dedupe.station[r1].copies != 1)
+        || (dedupe.station[r2].first != 1) || (dedupe.station[r2].copies != 1)
+        || (dedupe.station[r3].first != 0) || (dedupe.station[r3].copies != 1)
+        || (dedupe.station[0].copies != 1)
+        || (dedupe.heard[r1 * AIS_DEDUPE_STATIONS + r2] != 1)
+        || (dedupe.heard[r1 * AIS_DEDUPE_STATIONS + r3] != 1)
+        || (dedupe.heard[r2 * AIS_DEDUPE_STATIONS + r1] != 1)
+        || (dedupe.heard[r2 * AIS_DEDUPE_STATIONS + 0] != 1) )
+    {
+        fprintf( stderr, "test_ais_dedupe() 3: failed\n" );
+        free_ais_dedupe( &dedupe );
+        return 0;
+    }
+    free_ais_dedupe( &dedupe );
+
+    fprintf( stderr, "test_ais_dedupe(): Passed\n" );
+    return 1;
+}
+
+
+int test_ais_dedupe_window( void )
+{
+    ais_state   ais;
+    ais_dedupe  dedupe;
+    char        buf[4][255] = { "\\s:r1*0A\\!AIVDM,2,1,9,A,55Mf@6P00001MUS;7GQL4hh61L4hh6222222220t41H,0*49\r\n",
+                                "!AIVDM,2,2,9,A,==40HtI4i@E531H1QDTVH51DSCS0,2*16\r\n",
+                                "\\s:r2*09\\!AIVDM,2,1,3,B,55Mf@6P00001MUS;7GQL4hh61L4hh6222222220t41H,0*40\r\n",
+                                "!AIVDM,2,2,3,B,==40HtI4i@E531H1QDTVH51DSCS0,2*1F\r\n"
+                              };
+    unsigned long t;
+
+    memset( &ais, 0, sizeof( ais_state ) );
+    if( init_ais_dedupe( &dedupe, 100, AIS_DEDUPE_WINDOW ) != 0 )
+    {
+        fprintf( stderr, "test_ais_dedupe_window() 1: failed\n" );
+        return 0;
+    }
+
+    /* Multipart copies with different sequence ids and channels */
+    if(    (assemble_vdm_dedupe( &ais, &dedupe, buf[0], 1000 ) != 1)
+        || (assemble_vdm_dedupe( &ais, &dedupe, buf[1], 1000 ) != 0)
+        || (assemble_vdm_dedupe( &ais, &dedupe, buf[2], 1009 ) != 1)
+        || (assemble_vdm_dedupe( &ais, &dedupe, buf[3], 1009 ) != 8) )
+    {
+        fprintf( stderr, "test_ais_dedupe_window() 2: failed\n" );
+        free_ais_dedupe( &dedupe );
+        return 0;
+    }
+
+    /* Not a copy once it is older than the window, or earlier times are late */
+    assemble_vdm_dedupe( &ais, &dedupe, buf[0], 1021 );
+    if(    (assemble_vdm_dedupe( &ais, &dedupe, buf[1], 1021 ) != 0)
+        || (ais_dedupe_check( &dedupe, &ais, 900 ) != 1) )
+    {
+        fprintf( stderr, "test_ais_dedupe_window() 3: failed\n" );
+        free_ais_dedupe( &dedupe );
+        return 0;
+    }
+
+    /* The memory is fixed, the oldest generation is reused. Sent every
+       second, it is passed on again every 11 seconds
+    */
+    for( t = 2000; t < 3000; t++ )
+        ais_dedupe_check( &dedupe, &ais, t );
+    if( (dedupe.unique != 93) || (dedupe.full != 0) )
+    {
+        fprintf( stderr, "test_ais_dedupe_window() 4: failed %lu\n", dedupe.unique );
+        free_ais_dedupe( &dedupe );
+        return 0;
+    }
+    free_ais_dedupe( &dedupe );
+
+    fprintf( stderr, "test_ais_dedupe_window(): Passed\n" );
+    return 1;
+}
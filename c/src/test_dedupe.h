@@ -0,0 +1,13 @@
+/* -----------------------------------------------------------------------
+   Duplicate suppression Test functions
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com
+   All Rights Reserved
+   ----------------------------------------------------------------------- */
+
+/*! \file
+    \brief Header file for test_dedupe.c
+*/
+
+
+int test_ais_dedupe( void );
+int test_ais_dedupe_window( void );
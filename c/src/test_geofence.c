@@ -0,0 +1,212 @@
+/* -----------------------------------------------------------------------
+   Geofence Test functions
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com
+   All Rights Reserved
+   ----------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "portable.h"
+#include "nmea.h"
+#include "sixbit.h"
+#include "vdm_parse.h"
+#include "geofence.h"
+#include "test_geofence.h"
+
+/*! \file
+    \brief Geofence Test functions
+    \author Brian C. Lane <bcl@brianlane.com>
+
+*/
+
+
+/* A square harbor at 22N 73W and a triangle overlapping its east side */
+static geofence_point harbor[4] = {
+    { -43800000, 13200000 }, { -43800000, 13230000 }, { -43770000, 13230000 }, { -43770000, 13200000 }
+};
+static geofence_point triangle[3] = {
+    { -43780000, 13190000 }, { -43740000, 13215000 }, { -43775000, 13240000 }
+};
+
+
+/* Keep the events */
+static geofence_event events[8];
+static unsigned int   num_events;
+
+static void __stdcall got_event( geofence_event *event, void *data )
+{
+    if( num_events < 8 )
+        events[num_events] = *event;
+    num_events++;
+}
+
+
+/* Slow point in polygon test to check the raster against */
+static int brute_inside( geofence_point *p, unsigned int n, long latitude, long longitude )
+{
+    unsigned int i, j;
+    int          inside;
+    double       x;
+
+    inside = 0;
+    for( i = 0, j = n - 1; i < n; j = i++ )
+    {
+        if( (p[i].latitude > latitude) != (p[j].latitude > latitude) )
+        {
+            x = p[i].longitude + (double) (latitude - p[i].latitude) * (p[j].longitude - p[i].longitude)
+                                 / (double) (p[j].latitude - p[i].latitude);
+            if( longitude < x )
+                inside = !inside;
+        }
+    }
+
+    return inside;
+}
+
+
+int test_geofence_find( void )
+{
+    geofence      gf;
+    unsigned int  found[GEOFENCE_INSIDE];
+    unsigned int  n;
+    unsigned int  i;
+    unsigned long seed;
+    long          lat, lon;
+    int           in_harbor, in_triangle;
+
+    /* Cells a bit bigger than a quarter of the harbor */
+    if(    (init_geofence( &gf, 100, 8000, got_event, NULL ) != 0)
+        || (geofence_add( &gf, 10, harbor, 4 ) != 0)
+        || (geofence_add( &gf, 20, triangle, 3 ) != 0)
+        || (geofence_add( &gf, 30, triangle, 2 ) != 1)
+        || (geofence_build( &gf ) != 0) )
+    {
+        fprintf( stderr, "test_geofence_find() 1: failed\n" );
+        free_geofence( &gf );
+        return 0;
+    }
+
+    /* Random points around both of them must agree with the slow test */
+    seed = 1;
+    for( i = 0; i < 20000; i++ )
+    {
+        seed = seed * 1103515245UL + 12345UL;
+        lon = -43810000 + (long) ((seed >> 8) % 80000);
+        seed = seed * 1103515245UL + 12345UL;
+        lat = 13180000 + (long) ((seed >> 8) % 70000);
+
+        in_harbor = in_triangle = 0;
+        n = geofence_find( &gf, lat, lon, found, GEOFENCE_INSIDE );
+        while( n-- )
+        {
+            if( found[n] == 0 )
+                in_harbor = 1;
+            if( found[n] == 1 )
+                in_triangle = 1;
+        }
+        if(    (in_harbor != brute_inside( harbor, 4, lat, lon ))
+            || (in_triangle != brute_inside( triangle, 3, lat, lon )) )
+        {
+            fprintf( stderr, "test_geofence_find() 2: failed at %ld %ld\n", lat, lon );
+            free_geofence( &gf );
+            return 0;
+        }
+    }
+
+    /* Most of them must have been settled by the raster */
+    if( gf.exact > 12000 )
+    {
+        fprintf( stderr, "test_geofence_find() 3: failed %lu\n", gf.exact );
+        free_geofence( &gf );
+        return 0;
+    }
+    free_geofence( &gf );
+
+    fprintf( stderr, "test_geofence_find(): Passed\n" );
+    return 1;
+}
+
+
+int test_geofence_update( void )
+{
+    geofence    gf;
+    aismsg_any  msg;
+
+    if(    (init_geofence( &gf, 100, 0, got_event, NULL ) != 0)
+        || (geofence_update( &gf, 1, 13210000, -43790000, 100 ) != 1)
+        || (geofence_add( &gf, 10, harbor, 4 ) != 0)
+        || (geofence_add( &gf, 20, triangle, 3 ) != 0)
+        || (geofence_build( &gf ) != 0) )
+    {
+        fprintf( stderr, "test_geofence_update() 1: failed\n" );
+        free_geofence( &gf );
+        return 0;
+    }
+    num_events = 0;
+
+    /* Outside of both, then into the harbor */
+    geofence_update( &gf, 1, 13210000, -43810000, 100 );
+    geofence_update( &gf, 1, 13210000, -43790000, 110 );
+    if(    (num_events != 1) || (events[0].userid != 1) || (events[0].id != 10)
+        || (events[0].event != GEOFENCE_ENTER) || (events[0].time != 110) )
+    {
+        fprintf( stderr, "test_geofence_update() 2: failed %u\n", num_events );
+        free_geofence( &gf );
+        return 0;
+    }
+
+    /* Into the part that overlaps, then out of the harbor */
+    memset( &msg, 0, sizeof( msg ) );
+    msg.msgid = 1;
+    msg.u.msg_1.userid = 1;
+    msg.u.msg_1.latitude = 13215000;
+    msg.u.msg_1.longitude = -43772000;
+    if(    (geofence_update_msg( &gf, &msg, 120 ) != 0) || (num_events != 2)
+        || (events[1].id != 20) || (events[1].event != GEOFENCE_ENTER) )
+    {
+        fprintf( stderr, "test_geofence_update() 3: failed %u\n", num_events );
+        free_geofence( &gf );
+        return 0;
+    }
+    geofence_update( &gf, 1, 13215000, -43760000, 130 );
+    if(    (num_events != 3) || (events[2].id != 10) || (events[2].event != GEOFENCE_EXIT)
+        || (events[2].longitude != -43760000) )
+    {
+        fprintf( stderr, "test_geofence_update() 4: failed %u\n", num_events );
+        free_geofence( &gf );
+        return 0;
+    }
+
+    /* No position doesn't leave, then out of the triangle */
+    geofence_update( &gf, 1, 54600000, 108600000, 140 );
+    geofence_update( &gf, 1, 13215000, -43700000, 150 );
+    if( (num_events != 4) || (events[3].id != 20) || (events[3].event != GEOFENCE_EXIT) )
+    {
+        fprintf( stderr, "test_geofence_update() 5: failed %u\n", num_events );
+        free_geofence( &gf );
+        return 0;
+    }
+
+    /* Vessels that never entered one are not kept */
+    geofence_update( &gf, 2, 13215000, -43700000, 150 );
+    if( (gf.vessel_count != 1) || (geofence_expire( &gf, 1000, 600 ) != 1) || (gf.vessel_count != 0) )
+    {
+        fprintf( stderr, "test_geofence_update() 6: failed %lu\n", gf.vessel_count );
+        free_geofence( &gf );
+        return 0;
+    }
+
+    /* A report newer than now is not taken as very old */
+    geofence_update( &gf, 1, 13210000, -43790000, 2000 );
+    if(    (gf.vessel_count != 1) || (geofence_expire( &gf, 1500, 600 ) != 0)
+        || (geofence_expire( &gf, 3000, 600 ) != 1) || (gf.vessel_count != 0) )
+    {
+        fprintf( stderr, "test_geofence_update() 7: failed %lu\n", gf.vessel_count );
+        free_geofence( &gf );
+        return 0;
+    }
+    free_geofence( &gf );
+
+    fprintf( stderr, "test_geofence_update(): Passed\n" );
+    return 1;
+}
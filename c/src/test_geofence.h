@@ -0,0 +1,13 @@
+/* -----------------------------------------------------------------------
+   Geofence Test functions
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com
+   All Rights Reserved
+   ----------------------------------------------------------------------- */
+
+/*! \file
+    \brief Header file for test_geofence.c
+*/
+
+
+int test_geofence_find( void );
+int test_geofence_update( void );
@@ -0,0 +1,206 @@
+/* -----------------------------------------------------------------------
+   Grid index Test functions
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com
+   All Rights Reserved
+   ----------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "portable.h"
+#include "nmea.h"
+#include "sixbit.h"
+#include "vdm_parse.h"
+#include "mmsi_index.h"
+#include "grid.h"
+#include "test_grid.h"
+
+/*! \file
+    \brief Grid index Test functions
+    \author Brian C. Lane <bcl@brianlane.com>
+
+*/
+
+
+/* Add up the MMSIs found */
+static void __stdcall sum_userids( grid_entry *entry, void *data )
+{
+    *(unsigned long *) data += entry->userid;
+}
+
+
+/* Pseudo random numbers, the same every run */
+static unsigned long test_seed = 1;
+
+static long test_random( long range )
+{
+    test_seed = test_seed * 1103515245UL + 12345UL;
+    return (long) ((test_seed >> 8) & 0xFFFFFF) % range;
+}
+
+
+int test_grid_bbox( void )
+{
+    ais_grid      grid;
+    aismsg_pos    pos;
+    unsigned long sum;
+    unsigned long n;
+    long          lat[500];
+    long          lon[500];
+    long          lat_min, lat_max, lon_min, lon_max;
+    unsigned long i;
+    int           j;
+
+    if( init_ais_grid( &grid, 100, AIS_GRID_CELL ) != 0 )
+    {
+        fprintf( stderr, "test_grid_bbox() 1: failed\n" );
+        return 0;
+    }
+    grid_update( &grid, 1, 0, 0 );
+    grid_update( &grid, 2, 30000, 30000 );
+    grid_update( &grid, 3, 600000, 600000 );
+    grid_update( &grid, 4, 0, 107990000 );
+
+    memset( &pos, 0, sizeof( pos ) );
+    pos.fields = AIS_FIELD_USERID | AIS_FIELD_POSITION;
+    pos.userid = 5;
+    pos.longitude = -107990000;
+    grid_update_pos( &grid, &pos );
+
+    sum = 0;
+    if( (grid_bbox( &grid, -10000, -10000, 40000, 40000, sum_userids, &sum ) != 2) || (sum != 3) )
+    {
+        fprintf( stderr, "test_grid_bbox() 2: failed\n" );
+        free_ais_grid( &grid );
+        return 0;
+    }
+
+    /* Moves to another cell */
+    grid_update( &grid, 2, 6000000, 6000000 );
+    sum = 0;
+    if(    (grid_bbox( &grid, -10000, -10000, 40000, 40000, sum_userids, &sum ) != 1) || (sum != 1)
+        || (grid.moves != 1) || (grid_bbox( &grid, 5990000, 5990000, 6010000, 6010000, NULL, NULL ) != 1) )
+    {
+        fprintf( stderr, "test_grid_bbox() 3: failed\n" );
+        free_ais_grid( &grid );
+        return 0;
+    }
+
+    /* Across 180 degrees, and the whole world */
+    sum = 0;
+    if(    (grid_bbox( &grid, -10000, 107000000, 10000, -107000000, sum_userids, &sum ) != 2) || (sum != 9)
+        || (grid_bbox( &grid, -AIS_GRID_LAT_MAX, -AIS_GRID_LON_MAX, AIS_GRID_LAT_MAX, AIS_GRID_LON_MAX, NULL, NULL ) != 5) )
+    {
+        fprintf( stderr, "test_grid_bbox() 4: failed\n" );
+        free_ais_grid( &grid );
+        return 0;
+    }
+
+    /* No position, removed */
+    if(    (grid_update( &grid, 3, 54600000, 108600000 ) != 1) || grid_find( &grid, 3 ) || (grid.count != 4)
+        || (grid_remove( &grid, 3 ) != 1) || (grid_remove( &grid, 4 ) != 0) || grid_find( &grid, 4 )
+        || !grid_find( &grid, 5 ) )
+    {
+        fprintf( stderr, "test_grid_bbox() 5: failed\n" );
+        free_ais_grid( &grid );
+        return 0;
+    }
+    free_ais_grid( &grid );
+
+    /* Compare random boxes to checking every vessel, with many collisions */
+    init_ais_grid( &grid, 500, 1000 );
+    for( j = 0; j < 20; j++ )
+    {
+        for( i = 0; i < 500; i++ )
+        {
+            if( (j > 0) && test_random( 2 ) )
+                continue;
+            if( (j > 0) && (test_random( 10 ) == 0) )
+            {
+                grid_remove( &grid, i + 1 );
+                lat[i] = lon[i] = 1000000000;
+                continue;
+            }
+            lat[i] = test_random( 200000 ) - 100000;
+            lon[i] = test_random( 200000 ) - 100000;
+            grid_update( &grid, i + 1, lat[i], lon[i] );
+        }
+
+        lat_min = test_random( 200000 ) - 100000;
+        lon_min = test_random( 200000 ) - 100000;
+        lat_max = lat_min + test_random( 50000 );
+        lon_max = lon_min + test_random( 50000 );
+        n = 0;
+        for( i = 0; i < 500; i++ )
+        {
+            if( (lat[i] >= lat_min) && (lat[i] <= lat_max) && (lon[i] >= lon_min) && (lon[i] <= lon_max) )
+                n++;
+        }
+        if( grid_bbox( &grid, lat_min, lon_min, lat_max, lon_max, NULL, NULL ) != n )
+        {
+            fprintf( stderr, "test_grid_bbox() 6: failed %d\n", j );
+            free_ais_grid( &grid );
+            return 0;
+        }
+    }
+    free_ais_grid( &grid );
+
+    fprintf( stderr, "test_grid_bbox(): Passed\n" );
+    return 1;
+}
+
+
+int test_grid_radius( void )
+{
+    ais_grid      grid;
+    unsigned long sum;
+
+    init_ais_grid( &grid, 100, AIS_GRID_CELL );
+
+    /* 5, 15 and 8 miles from 0,0 */
+    grid_update( &grid, 1, 50000, 0 );
+    grid_update( &grid, 2, 150000, 0 );
+    grid_update( &grid, 4, 0, -80000 );
+
+    /* At 60N a minute of longitude is half a mile, 7.5 and 12.5 miles */
+    grid_update( &grid, 8, 36000000, 150000 );
+    grid_update( &grid, 16, 36000000, -250000 );
+
+    /* 1.5 miles apart, across 180 degrees */
+    grid_update( &grid, 32, 0, -107995000 );
+
+    sum = 0;
+    if( (grid_radius( &grid, 0, 0, 100000, sum_userids, &sum ) != 2) || (sum != 5) )
+    {
+        fprintf( stderr, "test_grid_radius() 1: failed %lu\n", sum );
+        free_ais_grid( &grid );
+        return 0;
+    }
+
+    sum = 0;
+    if( (grid_radius( &grid, 36000000, 0, 100000, sum_userids, &sum ) != 1) || (sum != 8) )
+    {
+        fprintf( stderr, "test_grid_radius() 2: failed %lu\n", sum );
+        free_ais_grid( &grid );
+        return 0;
+    }
+
+    sum = 0;
+    if( (grid_radius( &grid, 0, 107990000, 20000, sum_userids, &sum ) != 1) || (sum != 32) )
+    {
+        fprintf( stderr, "test_grid_radius() 3: failed %lu\n", sum );
+        free_ais_grid( &grid );
+        return 0;
+    }
+
+    /* Big enough to go around the world */
+    if( grid_radius( &grid, 0, 0, 200000000, NULL, NULL ) != 6 )
+    {
+        fprintf( stderr, "test_grid_radius() 4: failed\n" );
+        free_ais_grid( &grid );
+        return 0;
+    }
+    free_ais_grid( &grid );
+
+    fprintf( stderr, "test_grid_radius(): Passed\n" );
+    return 1;
+}
@@ -0,0 +1,13 @@
+/* -----------------------------------------------------------------------
+   Grid index Test functions
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com
+   All Rights Reserved
+   ----------------------------------------------------------------------- */
+
+/*! \file
+    \brief Header file for test_grid.c
+*/
+
+
+int test_grid_bbox( void );
+int test_grid_radius( void );
@@ -0,0 +1,54 @@
+/* -----------------------------------------------------------------------
+   IMO Test functions
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com
+   All Rights Reserved
+   ----------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "portable.h"
+#include "nmea.h"
+#include "sixbit.h"
+#include "vdm_parse.h"
+#include "imo.h"
+#include "test_imo.h"
+
+/*! \file
+    \brief IMO Test functions
+    \author Brian C. Lane <bcl@brianlane.com>
+
+*/
+
+
+int test_imo_overrun( void )
+{
+    sixbit        six;
+    sixbit_view   view;
+    imo1_11       msg1_11;
+    char          payload[61];
+
+    /* 360 bits holds all of the fields */
+    memset( payload, '0', 60 );
+    payload[60] = 0;
+    init_6bit( &six );
+    sixbit_append( &six, payload, 60, 0 );
+    sixbit_view_init( &view, &six );
+    if( parse_imo1_11( &view, &msg1_11 ) != 0 )
+    {
+        fprintf( stderr, "test_imo_overrun() 1: failed\n" );
+        return 0;
+    }
+
+    /* A truncated payload runs past the end of the view */
+    init_6bit( &six );
+    sixbit_append( &six, payload, 10, 0 );
+    sixbit_view_init( &view, &six );
+    if( (parse_imo1_11( &view, &msg1_11 ) != 2) || !view.overrun )
+    {
+        fprintf( stderr, "test_imo_overrun() 2: failed\n" );
+        return 0;
+    }
+
+    fprintf( stderr, "test_imo_overrun(): Passed\n" );
+    return 1;
+}
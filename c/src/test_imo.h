@@ -0,0 +1,12 @@
+/* -----------------------------------------------------------------------
+   IMO Test functions
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com
+   All Rights Reserved
+   ----------------------------------------------------------------------- */
+
+/*! \file
+    \brief Header file for test_imo.c
+*/
+
+
+int test_imo_overrun( void );
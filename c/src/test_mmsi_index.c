@@ -0,0 +1,131 @@
+/* -----------------------------------------------------------------------
+   MMSI Hash Test functions
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com
+   All Rights Reserved
+   ----------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "portable.h"
+#include "mmsi_index.h"
+#include "test_mmsi_index.h"
+
+/*! \file
+    \brief MMSI Hash Test functions
+    \author Brian C. Lane <bcl@brianlane.com>
+
+*/
+
+
+/* Small slot with a 32 bit MMSI, like thin_vessel */
+typedef struct {
+    unsigned int    userid;
+    unsigned int    time;
+} test_slot;
+
+
+static int __stdcall test_expired( void *slot, unsigned long now, unsigned long age )
+{
+    test_slot *s = (test_slot *) slot;
+
+    return (now > s->time) && (now - s->time > age);
+}
+
+
+int test_mmsi_index( void )
+{
+    mmsi_index    index;
+    test_slot     slots[16];
+    mmsi_entry    entries[16];
+    unsigned long keys[12];
+    unsigned long userid;
+    unsigned long i;
+    unsigned long n;
+
+    if( (mmsi_index_size( 1 ) != 16) || (mmsi_index_size( 12 ) != 16) || (mmsi_index_size( 13 ) != 32) )
+    {
+        fprintf( stderr, "test_mmsi_index() 1: failed\n" );
+        return 0;
+    }
+
+    /* MMSIs that all start at the last slot, so the run wraps around */
+    memset( slots, 0, sizeof( slots ) );
+    init_mmsi_index( &index, slots, sizeof( test_slot ), sizeof( slots[0].userid ), 16 );
+    n = 0;
+    for( userid = 200000000; n < 12; userid++ )
+    {
+        if( mmsi_index_home( &index, userid ) == 15 )
+            keys[n++] = userid;
+    }
+    for( n = 0; n < 12; n++ )
+    {
+        i = mmsi_index_slot( &index, keys[n] );
+        if( (i != ((15 + n) & 15)) || slots[i].userid )
+        {
+            fprintf( stderr, "test_mmsi_index() 2: failed %lu\n", n );
+            return 0;
+        }
+        slots[i].userid = (unsigned int) keys[n];
+        slots[i].time = (unsigned int) n;
+    }
+
+    /* Take out every third one, the rest are moved back over the gaps */
+    for( n = 0; n < 12; n += 3 )
+        mmsi_index_remove( &index, mmsi_index_slot( &index, keys[n] ) );
+    for( n = 0; n < 12; n++ )
+    {
+        i = mmsi_index_slot( &index, keys[n] );
+        if( (n % 3) ? ((slots[i].userid != keys[n]) || (slots[i].time != n)) : (slots[i].userid != 0) )
+        {
+            fprintf( stderr, "test_mmsi_index() 3: failed %lu\n", n );
+            return 0;
+        }
+    }
+    for( n = 0, i = 0; i < 16; i++ )
+        n += slots[i].userid ? 1 : 0;
+    if( (n != 8) || slots[7].userid )
+    {
+        fprintf( stderr, "test_mmsi_index() 4: failed %lu\n", n );
+        return 0;
+    }
+
+    /* Times 0 to 5 are too old, 20 is newer than now */
+    slots[mmsi_index_slot( &index, keys[11] )].time = 20;
+    if( mmsi_index_expire( &index, 10, 4, test_expired ) != 4 )
+    {
+        fprintf( stderr, "test_mmsi_index() 5: failed\n" );
+        return 0;
+    }
+    for( n = 0; n < 12; n++ )
+    {
+        i = mmsi_index_slot( &index, keys[n] );
+        if( ((n % 3) && (n > 5)) != (slots[i].userid != 0) )
+        {
+            fprintf( stderr, "test_mmsi_index() 6: failed %lu\n", n );
+            return 0;
+        }
+    }
+
+    /* Index of entries in another array, with a 64 bit MMSI on some systems */
+    memset( entries, 0, sizeof( entries ) );
+    init_mmsi_index( &index, entries, sizeof( mmsi_entry ), sizeof( entries[0].userid ), 16 );
+    for( n = 0; n < 12; n++ )
+    {
+        i = mmsi_index_slot( &index, keys[n] );
+        entries[i].userid = keys[n];
+        entries[i].entry = (long) n;
+    }
+    mmsi_index_remove( &index, mmsi_index_slot( &index, keys[0] ) );
+    for( n = 1; n < 12; n++ )
+    {
+        i = mmsi_index_slot( &index, keys[n] );
+        if( (entries[i].userid != keys[n]) || (entries[i].entry != (long) n) )
+        {
+            fprintf( stderr, "test_mmsi_index() 7: failed %lu\n", n );
+            return 0;
+        }
+    }
+
+    fprintf( stderr, "test_mmsi_index(): Passed\n" );
+    return 1;
+}
@@ -0,0 +1,12 @@
+/* -----------------------------------------------------------------------
+   MMSI Hash Test functions
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com
+   All Rights Reserved
+   ----------------------------------------------------------------------- */
+
+/*! \file
+    \brief Header file for test_mmsi_index.c
+*/
+
+
+int test_mmsi_index( void );
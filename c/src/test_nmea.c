@@ -350,3 +350,281 @@ int test_check_nmea_checksum( void )
     fprintf( stderr, "check_nmea_checksum(): Passed\n" );
     return 1;
 }
+
+
+int test_nmea_tokenize( void )
+{
+    char buf[255];
+    nmea_state nmea;
+    unsigned char sum;
+    unsigned int len;
+    unsigned int i;
+    char *p;
+    int level;
+    int rv;
+
+    strcpy( (char *) buf, "!AIVDM,1,1,,A,15N;<J0P00Jro1<H>bAP0?vL00Rb,0*1B\n" );
+    if( (nmea_tokenize( &nmea, buf ) != 0) || (nmea.checksum != 0x1B) || (nmea.num_fields != 7) )
+    {
+        fprintf( stderr, "nmea_tokenize() 1: Failed\n" );
+        return 0;
+    }
+    if(    (nmea.field[0] != buf+1) || (nmea.field_len[0] != 5)
+        || (nmea.field_len[3] != 0) || (*nmea.field[4] != 'A')
+        || (nmea.field_len[5] != 28) || (strncmp( nmea.field[5], "15N;<J0P00Jro1<H>bAP0?vL00Rb", 28 ) != 0)
+        || (nmea.field_len[6] != 1) || (*nmea.field[6] != '0') )
+    {
+        fprintf( stderr, "nmea_tokenize() 2: Failed\n" );
+        return 0;
+    }
+
+    /* Bad checksum still fills in the fields */
+    strcpy( (char *) buf, "678,4343,123,585*FF\n!AIVDM,1,1,,A,403OwpiuFt3Sdo=sbvK=CG7008J3,0*41" );
+    if( (nmea_tokenize( &nmea, buf ) != 1) || (nmea.num_fields != 7) || (nmea.field[0] != buf+21) )
+    {
+        fprintf( stderr, "nmea_tokenize() 3: Failed\n" );
+        return 0;
+    }
+
+    /* Missing checksum digits */
+    strcpy( (char *) buf, "!AIVDM,1,1,,A,403OwpiuFt3Sdo=sbvK=CG7008J3,0*4" );
+    if( nmea_tokenize( &nmea, buf ) != 1 )
+    {
+        fprintf( stderr, "nmea_tokenize() 4: Failed\n" );
+        return 0;
+    }
+
+    /* No '*', or a new sentence before it */
+    strcpy( (char *) buf, "!AIVDM,1,1,,A,403OwpiuFt3Sdo=sbvK=CG7008J3,0" );
+    if( nmea_tokenize( &nmea, buf ) != 2 )
+    {
+        fprintf( stderr, "nmea_tokenize() 5: Failed\n" );
+        return 0;
+    }
+    strcpy( (char *) buf, "!AIVDM,1,1,,A,403Owpiu!AIVDM,1,1,,A,403OwpiuFt3Sdo=sbvK=CG7008J3,0*41" );
+    if( nmea_tokenize( &nmea, buf ) != 2 )
+    {
+        fprintf( stderr, "nmea_tokenize() 6: Failed\n" );
+        return 0;
+    }
+
+    /* No start of sentence */
+    strcpy( (char *) buf, "678,4343,123,585*FF" );
+    if( (nmea_tokenize( &nmea, buf ) != 2) || (nmea.num_fields != 0) )
+    {
+        fprintf( stderr, "nmea_tokenize() 7: Failed\n" );
+        return 0;
+    }
+
+    /* Every length, with text after the checksum, at each SIMD level.
+       The sentence is copied to a buffer of its own size so that reading
+       past the end can be caught.
+    */
+    for( level = 2; level >= 0; level-- )
+    {
+        nmea_simd( level );
+        for( len = 0; len < 180; len++ )
+        {
+            strcpy( buf, "!AIVDM,1,1,,A," );
+            for( i = 0; i < len; i++ )
+                buf[14 + i] = (char) ('0' + (i * 7) % 40);
+            buf[14 + len] = 0;
+            strcat( buf, ",0" );
+            sum = nmea_xor( buf+1, strlen( buf+1 ) );
+            sprintf( buf + strlen( buf ), "*%02X,%u,rx", sum, len );
+
+            p = malloc( strlen( buf ) + 1 );
+            if( !p )
+                return 0;
+            strcpy( p, buf );
+            rv = nmea_tokenize( &nmea, p );
+            if( (rv != 0) || (nmea.checksum != sum) || (nmea.num_fields != 7) || (nmea.field_len[5] != len) )
+            {
+                fprintf( stderr, "nmea_tokenize() 8 %d - %d: Failed\n", level, len );
+                free( p );
+                nmea_simd( 2 );
+                return 0;
+            }
+            free( p );
+        }
+    }
+    nmea_simd( 2 );
+
+    fprintf( stderr, "nmea_tokenize(): Passed\n" );
+    return 1;
+}
+
+
+int test_nmea_xor( void )
+{
+    char buf[300];
+    unsigned char sum;
+    unsigned int len;
+    unsigned int i;
+    int level;
+
+    for( i = 0; i < sizeof(buf); i++ )
+        buf[i] = (char) (0x20 + ((i * 37) % 0x5F));
+
+    for( level = 2; level >= 0; level-- )
+    {
+        nmea_simd( level );
+        for( len = 0; len < sizeof(buf); len++ )
+        {
+            for( sum = 0, i = 0; i < len; i++ )
+                sum ^= buf[i];
+            if( nmea_xor( buf, len ) != sum )
+            {
+                fprintf( stderr, "nmea_xor() %d - %d: Failed\n", level, len );
+                nmea_simd( 2 );
+                return 0;
+            }
+
+            /* Also start on an odd address */
+            for( sum = 0, i = 1; i < len; i++ )
+                sum ^= buf[i];
+            if( (len > 0) && (nmea_xor( buf+1, len-1 ) != sum) )
+            {
+                fprintf( stderr, "nmea_xor() %d - %d odd: Failed\n", level, len );
+                nmea_simd( 2 );
+                return 0;
+            }
+        }
+    }
+    nmea_simd( 2 );
+
+    fprintf( stderr, "nmea_xor(): Passed\n" );
+    return 1;
+}
+
+
+int test_nmea_delim_mask( void )
+{
+    char buf[MAX_NMEA_LENGTH + 1];
+    unsigned int mask[NMEA_MASK_WORDS];
+    unsigned int len;
+    unsigned int i;
+    int level;
+    int bit;
+
+    for( i = 0; i < sizeof(buf); i++ )
+        buf[i] = ",A*B!C$D"[(i * 7) % 8];
+
+    for( level = 2; level >= 0; level-- )
+    {
+        nmea_simd( level );
+        for( len = 0; len <= NMEA_MASK_WORDS * 32 - 1; len++ )
+        {
+            if( nmea_delim_mask( buf, len, mask ) != 0 )
+            {
+                fprintf( stderr, "nmea_delim_mask() %d - %d: Failed\n", level, len );
+                nmea_simd( 2 );
+                return 0;
+            }
+            for( i = 0; i < NMEA_MASK_WORDS * 32; i++ )
+            {
+                bit = (mask[i / 32] >> (i % 32)) & 1;
+                if( bit != ((i < len) && ((buf[i] == ',') || (buf[i] == '*') || (buf[i] == '!') || (buf[i] == '$'))) )
+                {
+                    fprintf( stderr, "nmea_delim_mask() %d - %d - %d: Failed\n", level, len, i );
+                    nmea_simd( 2 );
+                    return 0;
+                }
+            }
+        }
+    }
+    nmea_simd( 2 );
+
+    /* Too long for the mask */
+    if( nmea_delim_mask( buf, NMEA_MASK_WORDS * 32 + 1, mask ) != 1 )
+    {
+        fprintf( stderr, "nmea_delim_mask() 2: Failed\n" );
+        return 0;
+    }
+
+    fprintf( stderr, "nmea_delim_mask(): Passed\n" );
+    return 1;
+}
+
+
+int test_nmea_parse_tag( void )
+{
+    char buf[255];
+    nmea_tag tag;
+    nmea_state nmea;
+    char *p;
+
+    strcpy( (char *) buf, "\\s:ASM//Port=63//MMSI=2573225,c:1301961602*7A\\!BSVDM,1,1,,A,13P<JR50h00IkkJQi<Dt29ef0`PL,0*57" );
+    p = nmea_parse_tag( &tag, buf+1 );
+    if(    (*p != '!') || (tag.flags != (NMEA_TAG_SOURCE | NMEA_TAG_TIME))
+        || (strcmp( tag.source, "ASM//Port=63//MMSI=2573225" ) != 0) || (tag.time != 1301961602) )
+    {
+        fprintf( stderr, "nmea_parse_tag() 1: Failed\n" );
+        return 0;
+    }
+
+    /* Picked up by the tokenizer on the way to the sentence */
+    if(    (nmea_tokenize( &nmea, buf ) != 0) || (nmea.tag.flags != tag.flags)
+        || (strncmp( nmea.field[0], "BSVDM", 5 ) != 0) )
+    {
+        fprintf( stderr, "nmea_parse_tag() 2: Failed\n" );
+        return 0;
+    }
+
+    /* Group and line count */
+    strcpy( (char *) buf, "\\g:2-2-1234,n:42*27\\!AIVDM,2,2,9,A,==40HtI4i@E531H1QDTVH51DSCS0,2*16" );
+    p = nmea_parse_tag( &tag, buf+1 );
+    if(    (*p != '!') || (tag.flags != (NMEA_TAG_GROUP | NMEA_TAG_LINE)) || (tag.line != 42)
+        || (tag.group_num != 2) || (tag.group_total != 2) || (tag.group_id != 1234) )
+    {
+        fprintf( stderr, "nmea_parse_tag() 3: Failed\n" );
+        return 0;
+    }
+
+    /* Milliseconds and a source that is too long */
+    strcpy( (char *) buf, "\\c:1241544035123,s:a very long station name that is cut*56\\" );
+    nmea_parse_tag( &tag, buf+1 );
+    if(    (tag.flags != (NMEA_TAG_SOURCE | NMEA_TAG_TIME)) || (tag.time != 1241544035)
+        || (strcmp( tag.source, "a very long station name that i" ) != 0) )
+    {
+        fprintf( stderr, "nmea_parse_tag() 4: Failed\n" );
+        return 0;
+    }
+
+    /* Bad or missing checksum */
+    strcpy( (char *) buf, "\\s:ASM*17\\!AIVDM" );
+    p = nmea_parse_tag( &tag, buf+1 );
+    if( (*p != '!') || (tag.flags != NMEA_TAG_BADSUM) )
+    {
+        fprintf( stderr, "nmea_parse_tag() 5: Failed\n" );
+        return 0;
+    }
+    strcpy( (char *) buf, "\\s:ASM\\!AIVDM" );
+    p = nmea_parse_tag( &tag, buf+1 );
+    if( (*p != '!') || (tag.flags != NMEA_TAG_BADSUM) )
+    {
+        fprintf( stderr, "nmea_parse_tag() 6: Failed\n" );
+        return 0;
+    }
+
+    /* A time that isn't all digits, or is empty, is left out */
+    strcpy( (char *) buf, "\\s:ASM,c:12ab" );
+    sprintf( buf + strlen( buf ), "*%02X\\", nmea_xor( buf+1, strlen( buf+1 ) ) );
+    nmea_parse_tag( &tag, buf+1 );
+    if( (tag.flags != NMEA_TAG_SOURCE) || (tag.time != 0) )
+    {
+        fprintf( stderr, "nmea_parse_tag() 7: Failed\n" );
+        return 0;
+    }
+    strcpy( (char *) buf, "\\c:,s:ASM" );
+    sprintf( buf + strlen( buf ), "*%02X\\", nmea_xor( buf+1, strlen( buf+1 ) ) );
+    nmea_parse_tag( &tag, buf+1 );
+    if( tag.flags != NMEA_TAG_SOURCE )
+    {
+        fprintf( stderr, "nmea_parse_tag() 8: Failed\n" );
+        return 0;
+    }
+
+    fprintf( stderr, "nmea_parse_tag(): Passed\n" );
+    return 1;
+}
@@ -19,4 +19,7 @@ int test_nmea_next_field( void );
 int test_nmea_uint( void );
 int test_nmea_copy_field( void );
 int test_find_nmea_start( void );
-
+int test_nmea_tokenize( void );
+int test_nmea_xor( void );
+int test_nmea_delim_mask( void );
+int test_nmea_parse_tag( void );
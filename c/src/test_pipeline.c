@@ -0,0 +1,284 @@
+/* -----------------------------------------------------------------------
+   Pipeline Test functions
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com
+   All Rights Reserved
+   ----------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "portable.h"
+#include "nmea.h"
+#include "sixbit.h"
+#include "vdm_parse.h"
+#include "reassembly.h"
+#include "batch.h"
+#include "pipeline.h"
+#include "test_pipeline.h"
+
+/*! \file
+    \brief Pipeline Test functions
+    \author Brian C. Lane <bcl@brianlane.com>
+
+*/
+
+/* Parts of messages from 2 stations are mixed together, the reader
+   has to send all the parts of a message to the same worker
+*/
+static char *test_lines[] = {
+    "\\s:r1*0A\\!AIVDM,2,1,2,B,8030ojA?0@=DE3@?BDPA3onQiUFttP1Wh01DE3<1EJ?>0onlkUG0e01I,0*3D\r\n",
+    "\\s:r2*09\\!AIVDM,2,1,9,A,55Mf@6P00001MUS;7GQL4hh61L4hh6222222220t41H,0*49\r\n",
+    "$GPGGA,161229.487,3723.2475,N,12158.3416,W,1,07,1.0,9.0,M,,,,0000*18\r\n",
+    "!AIVDM,1,1,,B,19NS7Sp02wo?HETKA2K6mUM20<L=,0*27\r\n",
+    "\\s:r1*0A\\!AIVDM,2,2,2,B,h00,2*7D\r\n",
+    "!AIVDM,1,1,,A,H52IRsP518Tj0l59D0000000000,2*45\r\n",
+    "\\s:r2*09\\!AIVDM,2,2,9,A,==40HtI4i@E531H1QDTVH51DSCS0,2*16\r\n",
+    "!AIVDM,1,1,,B,19NS7Sp02wo?HETKA2K6mUM20<L=,0*28\r\n",
+    NULL
+};
+
+#define TEST_ROUNDS 500
+
+
+/* Called from the serializer thread only */
+static unsigned long counts[32];
+static unsigned long bad_data;
+
+static void __stdcall got_record( ais_record *record, void *data )
+{
+    sixbit_view view;
+
+    counts[record->msg.msgid & 31]++;
+    if( record->msg.msgid == 8 )
+    {
+        view = record->msg.u.msg_8.data;
+        sixbit_view_get( &view, 2 );
+        if( (sixbit_view_get( &view, 6 ) != 3) || (record->offset % 8 != 4) )
+            bad_data++;
+    }
+}
+
+
+int test_ais_ring( void )
+{
+    ais_ring       ring;
+    unsigned long  *p;
+    unsigned long  i;
+
+    if( (init_ais_ring( &ring, 6, sizeof( unsigned long ) ) != 1)
+        || (init_ais_ring( &ring, 4, sizeof( unsigned long ) ) != 0) )
+    {
+        fprintf( stderr, "test_ais_ring() 1: failed\n" );
+        return 0;
+    }
+
+    /* Fill it, go around the end a few times */
+    for( i = 0; i < 4; i++ )
+    {
+        p = ais_ring_claim( &ring );
+        *p = i;
+        ais_ring_publish( &ring );
+    }
+    if( ais_ring_claim( &ring ) || (ais_ring_count( &ring ) != 4) )
+    {
+        fprintf( stderr, "test_ais_ring() 2: failed\n" );
+        free_ais_ring( &ring );
+        return 0;
+    }
+    for( i = 0; i < 10; i++ )
+    {
+        p = ais_ring_peek( &ring );
+        if( !p || (*p != i) )
+        {
+            fprintf( stderr, "test_ais_ring() 3: failed %lu\n", i );
+            free_ais_ring( &ring );
+            return 0;
+        }
+        ais_ring_release( &ring );
+        p = ais_ring_claim( &ring );
+        *p = i + 4;
+        ais_ring_publish( &ring );
+    }
+    for( i = 0; i < 4; i++ )
+        ais_ring_release( &ring );
+    if( ais_ring_peek( &ring ) || (ais_ring_count( &ring ) != 0) )
+    {
+        fprintf( stderr, "test_ais_ring() 4: failed\n" );
+        free_ais_ring( &ring );
+        return 0;
+    }
+    free_ais_ring( &ring );
+
+    fprintf( stderr, "test_ais_ring(): Passed\n" );
+    return 1;
+}
+
+
+int test_ais_pipeline( void )
+{
+    ais_pipeline  pipeline;
+    int           i;
+    int           j;
+
+    memset( counts, 0, sizeof( counts ) );
+    bad_data = 0;
+
+    /* Small rings so that the reader has to wait for the workers */
+    init_ais_pipeline( &pipeline, got_record, NULL );
+    pipeline.workers = 3;
+    pipeline.ring_size = 8;
+    if( ais_pipeline_start( &pipeline ) != 0 )
+    {
+        fprintf( stderr, "test_ais_pipeline() 1: failed\n" );
+        return 0;
+    }
+    for( i = 0; i < TEST_ROUNDS; i++ )
+    {
+        for( j = 0; test_lines[j]; j++ )
+            ais_pipeline_push( &pipeline, test_lines[j] );
+    }
+    ais_pipeline_finish( &pipeline );
+
+    if(    (pipeline.lines != 8 * TEST_ROUNDS) || (pipeline.dropped != 0)
+        || (pipeline.records != 4 * TEST_ROUNDS) || (pipeline.errors != TEST_ROUNDS)
+        || (counts[1] != TEST_ROUNDS) || (counts[5] != TEST_ROUNDS) || (counts[8] != TEST_ROUNDS)
+        || (counts[24] != TEST_ROUNDS) || bad_data )
+    {
+        fprintf( stderr, "test_ais_pipeline() 2: failed %lu %lu\n", pipeline.records, pipeline.errors );
+        return 0;
+    }
+
+    /* Not running any more */
+    if( ais_pipeline_push( &pipeline, test_lines[0] ) != 3 )
+    {
+        fprintf( stderr, "test_ais_pipeline() 3: failed\n" );
+        return 0;
+    }
+
+    fprintf( stderr, "test_ais_pipeline(): Passed\n" );
+    return 1;
+}
+
+
+/* Only the first part of each message has a tag block, with a different
+   station each time. The later part has to go to the same worker.
+*/
+static int route_rounds( ais_pipeline *pipeline )
+{
+    char           line[MAX_NMEA_LENGTH];
+    char           tag[16];
+    unsigned char  sum;
+    char           *p;
+    int            i;
+
+    for( i = 0; i < TEST_ROUNDS; i++ )
+    {
+        sprintf( tag, "s:r%d", i );
+        sum = 0;
+        for( p = tag; *p; p++ )
+            sum ^= (unsigned char) *p;
+        sprintf( line, "\\%s*%02X\\!AIVDM,2,1,2,B,8030ojA?0@=DE3@?BDPA3onQiUFttP1Wh01DE3<1EJ?>0onlkUG0e01I,0*3D\r\n",
+                 tag, sum );
+        if( ais_pipeline_push( pipeline, line ) != 0 )
+            return 0;
+        if( ais_pipeline_push( pipeline, "!AIVDM,2,2,2,B,h00,2*7D\r\n" ) != 0 )
+            return 0;
+    }
+    return 1;
+}
+
+
+int test_ais_pipeline_route( void )
+{
+    ais_pipeline  pipeline;
+    FILE          *fp;
+    int           i;
+    int           busy;
+
+    memset( counts, 0, sizeof( counts ) );
+
+    init_ais_pipeline( &pipeline, got_record, NULL );
+    pipeline.workers = 4;
+    if( ais_pipeline_start( &pipeline ) != 0 )
+    {
+        fprintf( stderr, "test_ais_pipeline_route() 1: failed\n" );
+        return 0;
+    }
+    if( !route_rounds( &pipeline ) )
+    {
+        fprintf( stderr, "test_ais_pipeline_route() 2: failed\n" );
+        return 0;
+    }
+    ais_pipeline_finish( &pipeline );
+
+    if(    (pipeline.records != TEST_ROUNDS) || (pipeline.errors != 0)
+        || (counts[8] != TEST_ROUNDS) )
+    {
+        fprintf( stderr, "test_ais_pipeline_route() 3: failed %lu %lu\n", pipeline.records, pipeline.errors );
+        return 0;
+    }
+
+    /* A line too long for a sentence is skipped as a whole, not split */
+    if( (fp = tmpfile()) == NULL )
+    {
+        fprintf( stderr, "test_ais_pipeline_route() 4: failed\n" );
+        return 0;
+    }
+    fputs( "\\s:", fp );
+    for( i = 0; i < 2 * MAX_NMEA_LENGTH; i++ )
+        fputc( 'x', fp );
+    fputs( "\\!AIVDM,1,1,,B,19NS7Sp02wo?HETKA2K6mUM20<L=,0*27\r\n", fp );
+    fputs( "!AIVDM,1,1,,B,19NS7Sp02wo?HETKA2K6mUM20<L=,0*27\r\n", fp );
+    rewind( fp );
+
+    memset( counts, 0, sizeof( counts ) );
+    init_ais_pipeline( &pipeline, got_record, NULL );
+    if( ais_pipeline_start( &pipeline ) != 0 )
+    {
+        fclose( fp );
+        fprintf( stderr, "test_ais_pipeline_route() 5: failed\n" );
+        return 0;
+    }
+    ais_pipeline_read( &pipeline, fp );
+    ais_pipeline_finish( &pipeline );
+    fclose( fp );
+
+    if(    (pipeline.lines != 2) || (pipeline.too_long != 1)
+        || (pipeline.records != 1) || (pipeline.errors != 0) || (counts[1] != 1) )
+    {
+        fprintf( stderr, "test_ais_pipeline_route() 6: failed %lu %lu %lu\n",
+                 pipeline.lines, pipeline.too_long, pipeline.records );
+        return 0;
+    }
+
+    /* Single part sentences of a real log are spread over the workers */
+    if( (fp = fopen( "../data/SAR.log", "rb" )) == NULL )
+    {
+        fprintf( stderr, "test_ais_pipeline_route() 7: failed\n" );
+        return 0;
+    }
+    init_ais_pipeline( &pipeline, got_record, NULL );
+    pipeline.workers = 8;
+    if( ais_pipeline_start( &pipeline ) != 0 )
+    {
+        fclose( fp );
+        fprintf( stderr, "test_ais_pipeline_route() 8: failed\n" );
+        return 0;
+    }
+    ais_pipeline_read( &pipeline, fp );
+    ais_pipeline_finish( &pipeline );
+    fclose( fp );
+
+    for( i = 0, busy = 0; i < (int) pipeline.workers; i++ )
+    {
+        if( pipeline.worker[i].sentences > pipeline.lines / 32 )
+            busy++;
+    }
+    if( busy < 6 )
+    {
+        fprintf( stderr, "test_ais_pipeline_route() 9: failed %d\n", busy );
+        return 0;
+    }
+
+    fprintf( stderr, "test_ais_pipeline_route(): Passed\n" );
+    return 1;
+}
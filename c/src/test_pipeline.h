@@ -0,0 +1,14 @@
+/* -----------------------------------------------------------------------
+   Pipeline Test functions
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com
+   All Rights Reserved
+   ----------------------------------------------------------------------- */
+
+/*! \file
+    \brief Header file for test_pipeline.c
+*/
+
+
+int test_ais_ring( void );
+int test_ais_pipeline( void );
+int test_ais_pipeline_route( void );
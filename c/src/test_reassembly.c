@@ -0,0 +1,228 @@
+/* -----------------------------------------------------------------------
+   Multipart VDM reassembly Test functions
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com
+   All Rights Reserved
+   ----------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "portable.h"
+#include "nmea.h"
+#include "sixbit.h"
+#include "vdm_parse.h"
+#include "reassembly.h"
+#include "test_reassembly.h"
+
+/*! \file
+    \brief Multipart VDM reassembly Test functions
+    \author Brian C. Lane <bcl@brianlane.com>
+
+*/
+
+#define PART1 "55Mf@6P00001MUS;7GQL4hh61L4hh6222222220t41H"
+#define PART2 "==40HtI4i@E531H1QDTVH51DSCS0"
+
+
+/* Build a VDM sentence with a good checksum */
+static char *make_vdm( char *buf, int total, int num, int seq, char channel, const char *payload, int fill )
+{
+    sprintf( buf, "!AIVDM,%d,%d,%d,%c,%s,%d*", total, num, seq, channel, payload, fill );
+    sprintf( buf + strlen( buf ), "%02X\r\n", nmea_xor( buf+1, strlen( buf ) - 2 ) );
+
+    return buf;
+}
+
+
+/* Build a VDM sentence with a tag block in front of it */
+static char *make_tagged( char *buf, const char *tag, int total, int num, int seq, char channel,
+                          const char *payload, int fill )
+{
+    sprintf( buf, "\\%s*%02X\\", tag, nmea_xor( tag, strlen( tag ) ) );
+    make_vdm( buf + strlen( buf ), total, num, seq, channel, payload, fill );
+
+    return buf;
+}
+
+
+int test_reasm_interleaved( void )
+{
+    reasm_table table;
+    ais_state   state;
+    char        buf[255];
+
+    init_reasm( &table, 60 );
+    memset( &state, 0, sizeof( state ) );
+
+    /* Two messages with their parts mixed together */
+    if(    (reasm_vdm( &table, &state, make_vdm( buf, 2, 1, 3, 'A', PART1, 0 ), 1 ) != 1)
+        || (reasm_vdm( &table, &state, make_vdm( buf, 2, 1, 4, 'B', PART1, 0 ), 1 ) != 1) )
+    {
+        fprintf( stderr, "test_reasm_interleaved() 1: failed\n" );
+        return 0;
+    }
+    if(    (reasm_vdm( &table, &state, make_vdm( buf, 2, 2, 3, 'A', PART2, 2 ), 2 ) != 0)
+        || (state.channel != 'A') || (strcmp( state.six_state.bits, PART1 PART2 ) != 0)
+        || (sixbit_size( &state.six_state ) != 424) )
+    {
+        fprintf( stderr, "test_reasm_interleaved() 2: failed\n" );
+        return 0;
+    }
+    if(    (reasm_vdm( &table, &state, make_vdm( buf, 2, 2, 4, 'B', PART2, 2 ), 2 ) != 0)
+        || (state.channel != 'B') || (get_6bit( &state.six_state, 6 ) != 5) )
+    {
+        fprintf( stderr, "test_reasm_interleaved() 3: failed\n" );
+        return 0;
+    }
+
+    /* Same sequence and channel from another station */
+    if(    (reasm_vdm( &table, &state, "\\s:ASM*16\\!AIVDM,2,1,9,A,55Mf@6P00001MUS;7GQL4hh61L4hh6222222220t41H,0*49", 3 ) != 1)
+        || (reasm_vdm( &table, &state, make_vdm( buf, 2, 1, 9, 'A', PART1, 0 ), 3 ) != 1)
+        || (reasm_vdm( &table, &state, "\\s:ASM*16\\!AIVDM,2,2,9,A,==40HtI4i@E531H1QDTVH51DSCS0,2*16", 4 ) != 0)
+        || !(state.tag.flags & NMEA_TAG_SOURCE)
+        || (reasm_vdm( &table, &state, make_vdm( buf, 2, 2, 9, 'A', PART2, 2 ), 4 ) != 0)
+        || (state.tag.flags != 0) )
+    {
+        fprintf( stderr, "test_reasm_interleaved() 4: failed\n" );
+        return 0;
+    }
+
+    /* Single part messages don't use the table */
+    if(    (reasm_vdm( &table, &state, "!AIVDM,1,1,,B,19NS7Sp02wo?HETKA2K6mUM20<L=,0*27\r\n", 5 ) != 0)
+        || (strcmp( state.six_state.bits, "19NS7Sp02wo?HETKA2K6mUM20<L=" ) != 0) )
+    {
+        fprintf( stderr, "test_reasm_interleaved() 5: failed\n" );
+        return 0;
+    }
+
+    if(    (table.completed != 4) || table.timed_out || table.evicted
+        || table.broken || table.orphans )
+    {
+        fprintf( stderr, "test_reasm_interleaved() 6: failed\n" );
+        return 0;
+    }
+
+    fprintf( stderr, "test_reasm_interleaved(): Passed\n" );
+    return 1;
+}
+
+
+int test_reasm_lost( void )
+{
+    reasm_table table;
+    ais_state   state;
+    char        buf[255];
+    int         i;
+
+    init_reasm( &table, 10 );
+    memset( &state, 0, sizeof( state ) );
+
+    /* No first part */
+    if( (reasm_vdm( &table, &state, make_vdm( buf, 2, 2, 3, 'A', PART2, 2 ), 0 ) != 5) || (table.orphans != 1) )
+    {
+        fprintf( stderr, "test_reasm_lost() 1: failed\n" );
+        return 0;
+    }
+
+    /* Last part arrives too late */
+    reasm_vdm( &table, &state, make_vdm( buf, 2, 1, 3, 'A', PART1, 0 ), 0 );
+    if(    (reasm_vdm( &table, &state, make_vdm( buf, 2, 2, 3, 'A', PART2, 2 ), 11 ) != 5)
+        || (table.timed_out != 1) || (table.orphans != 2) )
+    {
+        fprintf( stderr, "test_reasm_lost() 2: failed\n" );
+        return 0;
+    }
+
+    /* Skipped part */
+    reasm_vdm( &table, &state, make_vdm( buf, 3, 1, 3, 'A', PART1, 0 ), 20 );
+    if( (reasm_vdm( &table, &state, make_vdm( buf, 3, 3, 3, 'A', PART2, 2 ), 20 ) != 5) || (table.broken != 1) )
+    {
+        fprintf( stderr, "test_reasm_lost() 3: failed\n" );
+        return 0;
+    }
+
+    /* Fill the table, the first one started is pushed out */
+    init_reasm( &table, 1000 );
+    for( i = 0; i < REASM_SLOTS + 1; i++ )
+    {
+        if( reasm_vdm( &table, &state, make_vdm( buf, 2, 1, i, 'B', PART1, 0 ), 30 + i ) != 1 )
+        {
+            fprintf( stderr, "test_reasm_lost() 4: failed\n" );
+            return 0;
+        }
+    }
+    if(    (table.evicted != 1) || table.timed_out
+        || (reasm_vdm( &table, &state, make_vdm( buf, 2, 2, 0, 'B', PART2, 2 ), 32 + i ) != 5)
+        || (reasm_vdm( &table, &state, make_vdm( buf, 2, 2, 1, 'B', PART2, 2 ), 32 + i ) != 0) )
+    {
+        fprintf( stderr, "test_reasm_lost() 5: failed\n" );
+        return 0;
+    }
+
+    /* The rest time out */
+    if( (reasm_expire( &table, 2000 ) != REASM_SLOTS - 1) || (reasm_expire( &table, 2000 ) != 0) )
+    {
+        fprintf( stderr, "test_reasm_lost() 6: failed\n" );
+        return 0;
+    }
+
+    fprintf( stderr, "test_reasm_lost(): Passed\n" );
+    return 1;
+}
+
+
+int test_reasm_tag_first( void )
+{
+    reasm_table table;
+    ais_state   state;
+    char        buf[255];
+
+    init_reasm( &table, 60 );
+    memset( &state, 0, sizeof( state ) );
+
+    /* Only the first part has a tag block */
+    if(    (reasm_vdm( &table, &state, make_tagged( buf, "s:STN1,c:1241544035", 2, 1, 9, 'A', PART1, 0 ), 1 ) != 1)
+        || (reasm_vdm( &table, &state, make_vdm( buf, 2, 2, 9, 'A', PART2, 2 ), 1 ) != 0)
+        || (state.tag.flags != (NMEA_TAG_SOURCE | NMEA_TAG_TIME)) || (strcmp( state.tag.source, "STN1" ) != 0)
+        || (state.tag.time != 1241544035) || (strcmp( state.six_state.bits, PART1 PART2 ) != 0) )
+    {
+        fprintf( stderr, "test_reasm_tag_first() 1: failed\n" );
+        return 0;
+    }
+
+    /* Two stations with the same channel and sequence, told apart by the group */
+    if(    (reasm_vdm( &table, &state, make_tagged( buf, "s:STN1,g:1-2-11", 2, 1, 9, 'A', PART1, 0 ), 2 ) != 1)
+        || (reasm_vdm( &table, &state, make_tagged( buf, "s:STN2,g:1-2-22", 2, 1, 9, 'A', PART1, 0 ), 2 ) != 1)
+        || (reasm_vdm( &table, &state, make_tagged( buf, "g:2-2-22", 2, 2, 9, 'A', PART2, 2 ), 3 ) != 0)
+        || (strcmp( state.tag.source, "STN2" ) != 0)
+        || (reasm_vdm( &table, &state, make_tagged( buf, "g:2-2-11", 2, 2, 9, 'A', PART2, 2 ), 3 ) != 0)
+        || (strcmp( state.tag.source, "STN1" ) != 0) )
+    {
+        fprintf( stderr, "test_reasm_tag_first() 2: failed\n" );
+        return 0;
+    }
+
+    /* A later part with another station's s: doesn't belong */
+    if(    (reasm_vdm( &table, &state, make_tagged( buf, "s:STN1", 2, 1, 4, 'B', PART1, 0 ), 4 ) != 1)
+        || (reasm_vdm( &table, &state, make_tagged( buf, "s:STN2", 2, 2, 4, 'B', PART2, 2 ), 4 ) != 5)
+        || (reasm_vdm( &table, &state, make_tagged( buf, "s:STN1", 2, 2, 4, 'B', PART2, 2 ), 4 ) != 0) )
+    {
+        fprintf( stderr, "test_reasm_tag_first() 3: failed\n" );
+        return 0;
+    }
+
+    /* Each message keeps the timeout it was started with */
+    init_reasm( &table, 10 );
+    reasm_vdm( &table, &state, make_vdm( buf, 2, 1, 1, 'A', PART1, 0 ), 0 );
+    table.timeout = 100;
+    reasm_vdm( &table, &state, make_vdm( buf, 2, 1, 2, 'A', PART1, 0 ), 0 );
+    if(    (reasm_expire( &table, 50 ) != 1)
+        || (reasm_vdm( &table, &state, make_vdm( buf, 2, 2, 1, 'A', PART2, 2 ), 50 ) != 5)
+        || (reasm_vdm( &table, &state, make_vdm( buf, 2, 2, 2, 'A', PART2, 2 ), 50 ) != 0) )
+    {
+        fprintf( stderr, "test_reasm_tag_first() 4: failed\n" );
+        return 0;
+    }
+
+    fprintf( stderr, "test_reasm_tag_first(): Passed\n" );
+    return 1;
+}
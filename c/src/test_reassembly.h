@@ -0,0 +1,14 @@
+/* -----------------------------------------------------------------------
+   Multipart VDM reassembly Test functions
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com
+   All Rights Reserved
+   ----------------------------------------------------------------------- */
+
+/*! \file
+    \brief Header file for test_reassembly.c
+*/
+
+
+int test_reasm_interleaved( void );
+int test_reasm_lost( void );
+int test_reasm_tag_first( void );
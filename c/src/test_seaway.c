@@ -74,6 +74,7 @@ int test_seaway1_1( void )
 	char *t;
 	char msg[100];
 	sixbit seaway;
+	sixbit_view view;
 	seaway1_1 msg1_1;
 
 	p = test_msg1_1;
@@ -116,7 +117,9 @@ int test_seaway1_1( void )
         return 0;
 	}
 
-	parse_seaway1_1( &seaway, &msg1_1);
+	// The rest of the payload is parsed through a view
+	sixbit_view_init( &view, &seaway );
+	parse_seaway1_1( &view, &msg1_1);
 
 	// Check what the parser returned
 	if (msg1_1.report[0].utc_time.month != 5)
@@ -232,6 +235,7 @@ int test_seaway1_2( void )
 	char *t;
 	char msg[100];
 	sixbit seaway;
+	sixbit_view view;
 	seaway1_2 msg1_2;
 
 	p = test_msg1_2;
@@ -273,7 +277,9 @@ int test_seaway1_2( void )
         return 0;
 	}
 
-	parse_seaway1_2( &seaway, &msg1_2);
+	// The rest of the payload is parsed through a view
+	sixbit_view_init( &view, &seaway );
+	parse_seaway1_2( &view, &msg1_2);
 
 	// Check what the parser returned
 	if (msg1_2.report[0].utc_time.month != 5)
@@ -359,6 +365,7 @@ int test_seaway1_3( void )
 	char *t;
 	char msg[100];
 	sixbit seaway;
+	sixbit_view view;
 	seaway1_3 msg1_3;
 
 	p = test_msg1_3;
@@ -400,7 +407,9 @@ int test_seaway1_3( void )
         return 0;
 	}
 
-	parse_seaway1_3( &seaway, &msg1_3);
+	// The rest of the payload is parsed through a view
+	sixbit_view_init( &view, &seaway );
+	parse_seaway1_3( &view, &msg1_3);
 
 	// Check what the parser returned
 	if (msg1_3.report[0].utc_time.month != 5)
@@ -486,6 +495,7 @@ int test_seaway1_6( void )
 	char *t;
 	char msg[100];
 	sixbit seaway;
+	sixbit_view view;
 	seaway1_6 msg1_6;
 
 	p = test_msg1_6;
@@ -527,7 +537,9 @@ int test_seaway1_6( void )
         return 0;
 	}
 
-	parse_seaway1_6( &seaway, &msg1_6);
+	// The rest of the payload is parsed through a view
+	sixbit_view_init( &view, &seaway );
+	parse_seaway1_6( &view, &msg1_6);
 
 	// Check what the parser returned
 	if (msg1_6.report[0].utc_time.month != 5)
@@ -608,6 +620,7 @@ int test_seaway2_1( void )
 	char *t;
 	char msg[100];
 	sixbit seaway;
+	sixbit_view view;
 	seaway2_1 msg2_1;
 
 	p = test_msg2_1;
@@ -649,7 +662,9 @@ int test_seaway2_1( void )
         return 0;
 	}
 
-	parse_seaway2_1( &seaway, &msg2_1);
+	// The rest of the payload is parsed through a view
+	sixbit_view_init( &view, &seaway );
+	parse_seaway2_1( &view, &msg2_1);
 
 	// Check what the parser returned
 	if (msg2_1.utc_time.month != 5)
@@ -750,6 +765,7 @@ int test_seaway2_2( void )
 	char *t;
 	char msg[100];
 	sixbit seaway;
+	sixbit_view view;
 	seaway2_2 msg2_2;
 
 	p = test_msg2_2;
@@ -791,7 +807,9 @@ int test_seaway2_2( void )
         return 0;
 	}
 
-	parse_seaway2_2( &seaway, &msg2_2);
+	// The rest of the payload is parsed through a view
+	sixbit_view_init( &view, &seaway );
+	parse_seaway2_2( &view, &msg2_2);
 
 	// Check what the parser returned
 	if (msg2_2.utc_time.month != 5)
@@ -918,6 +936,7 @@ int test_seaway32_1( void )
 	char *t;
 	char msg[100];
 	sixbit seaway;
+	sixbit_view view;
 	int dac, fi, msgid;
 	seaway32_1 msg32_1;
 
@@ -960,7 +979,9 @@ int test_seaway32_1( void )
         return 0;
 	}
 
-	parse_seaway32_1( &seaway, &msg32_1);
+	// The rest of the payload is parsed through a view
+	sixbit_view_init( &view, &seaway );
+	parse_seaway32_1( &view, &msg32_1);
 
 	// Check what the parser returned
 	if (msg32_1.major != 4)
@@ -981,6 +1002,38 @@ int test_seaway32_1( void )
 
 
 
+int test_seaway_overrun( void )
+{
+    sixbit        six;
+    sixbit_view   view;
+    seaway32_1    msg32_1;
+
+    /* Major, minor and spare need 24 bits */
+    init_6bit( &six );
+    sixbit_append( &six, "0@80", 4, 0 );
+    sixbit_view_init( &view, &six );
+    if( (parse_seaway32_1( &view, &msg32_1 ) != 0) || (msg32_1.major != 1) || (msg32_1.minor != 2) )
+    {
+        fprintf( stderr, "test_seaway_overrun() 1: failed\n" );
+        return 0;
+    }
+
+    /* A truncated payload runs past the end of the view */
+    init_6bit( &six );
+    sixbit_append( &six, "0@", 2, 0 );
+    sixbit_view_init( &view, &six );
+    if( (parse_seaway32_1( &view, &msg32_1 ) != 2) || !view.overrun )
+    {
+        fprintf( stderr, "test_seaway_overrun() 2: failed\n" );
+        return 0;
+    }
+
+    fprintf( stderr, "test_seaway_overrun(): Passed\n" );
+    return 1;
+}
+
+
+
 /**
 */
 void test_seaway()
@@ -1003,6 +1056,7 @@ void old()
 	char *t;
 	char msg[100];
 	sixbit seaway;
+	sixbit_view view;
 	int dac, fi, spare, msgid;
 	seaway1_1 msg1_1;
 
@@ -1033,7 +1087,9 @@ void old()
 	printf( "Spare: 0x%02X (%d)\n", spare, spare );
 	printf( "msgid: 0x%02X (%d)\n", msgid, msgid );
 
-	parse_seaway1_1( &seaway, &msg1_1);
+	// The rest of the payload is parsed through a view
+	sixbit_view_init( &view, &seaway );
+	parse_seaway1_1( &view, &msg1_1);
 
 	short lat_dd, long_ddd;
 	double lat_min, long_min;
@@ -1081,16 +1137,15 @@ void test_seaway_msgs()
 		    }
 
 			// Get the seaway info from the payload of the message 8
-			sixbit seaway;
+			sixbit_view seaway;
 			int dac, fi, spare, msgid;
-			memset( &seaway, 0, sizeof( seaway ) );
 
 			dac = message.app_id >> 6;
 			fi = message.app_id & 0x3F;
 			seaway = message.data;
 
-			spare = (char) get_6bit( &seaway, 2);
-			msgid = (char) get_6bit( &seaway, 6);
+			spare = (char) sixbit_view_get( &seaway, 2);
+			msgid = (char) sixbit_view_get( &seaway, 6);
 
 			printf( "AppID: 0x%04X\n", message.app_id );
 			printf( "DAC  : 0x%03X (%d)\n", dac, dac );
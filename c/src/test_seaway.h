@@ -10,3 +10,4 @@
 */
 void test_seaway();
 void test_seaway_msgs();
+int test_seaway_overrun( void );
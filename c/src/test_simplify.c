@@ -0,0 +1,157 @@
+/* -----------------------------------------------------------------------
+   Trajectory simplification Test functions
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com
+   All Rights Reserved
+   ----------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "portable.h"
+#include "nmea.h"
+#include "sixbit.h"
+#include "vdm_parse.h"
+#include "simplify.h"
+#include "test_simplify.h"
+
+/*! \file
+    \brief Trajectory simplification Test functions
+    \author Brian C. Lane <bcl@brianlane.com>
+
+*/
+
+
+int test_ais_simplify( void )
+{
+    ais_simplify  simplify;
+    aismsg_any    msg;
+    long          lat, lon;
+    int           i;
+    int           left;
+
+    if( init_ais_simplify( &simplify, 100 ) != 0 )
+    {
+        fprintf( stderr, "test_ais_simplify() 1: failed\n" );
+        return 0;
+    }
+
+    /* North at 12 knots from the equator, 0.12 miles every 36 seconds,
+       with a little noise
+    */
+    memset( &msg, 0, sizeof( msg ) );
+    msg.msgid = 18;
+    msg.u.msg_18.userid = 366710810;
+    msg.u.msg_18.sog = 120;
+    msg.u.msg_18.cog = 0;
+    lat = lon = 0;
+    left = 0;
+    for( i = 0; i < 20; i++ )
+    {
+        msg.u.msg_18.latitude = lat + ((i & 1) ? 100 : -100);
+        msg.u.msg_18.longitude = lon + ((i & 2) ? 100 : -100);
+        left += ais_simplify_check_msg( &simplify, &msg, 1000 + i * 36 );
+        lat += 1200;
+    }
+    if( (left != 19) || (simplify.kept != 1) )
+    {
+        fprintf( stderr, "test_ais_simplify() 2: failed %d\n", left );
+        free_ais_simplify( &simplify );
+        return 0;
+    }
+
+    /* Turn east, only the first report after the turn is needed */
+    lat -= 1200;
+    for( i = 20; i < 30; i++ )
+    {
+        lon += 1200;
+        left += ais_simplify_check( &simplify, 366710810, lat, lon, 120, 900, 1000 + i * 36 );
+    }
+    if(    (left != 28) || (simplify.kept != 2) || (simplify.reports != 30)
+        || (ais_simplify_ratio( &simplify ) != 15.0) )
+    {
+        fprintf( stderr, "test_ais_simplify() 3: failed %d\n", left );
+        free_ais_simplify( &simplify );
+        return 0;
+    }
+
+    /* Slowing down shows up once it has gone far enough */
+    lon += 600;
+    if(    (ais_simplify_check( &simplify, 366710810, lat, lon, 60, 900, 1000 + 30 * 36 ) != 0)
+        || (ais_simplify_check( &simplify, 366710810, lat, lon + 600, 60, 900, 1000 + 31 * 36 ) != 1) )
+    {
+        fprintf( stderr, "test_ais_simplify() 4: failed\n" );
+        free_ais_simplify( &simplify );
+        return 0;
+    }
+    free_ais_simplify( &simplify );
+
+    fprintf( stderr, "test_ais_simplify(): Passed\n" );
+    return 1;
+}
+
+
+int test_ais_simplify_still( void )
+{
+    ais_simplify  simplify;
+    unsigned long i;
+
+    if( init_ais_simplify( &simplify, 12 ) != 0 )
+    {
+        fprintf( stderr, "test_ais_simplify_still() 1: failed\n" );
+        return 0;
+    }
+
+    /* Moored, no speed or course, with no position once */
+    if(    (ais_simplify_check( &simplify, 1, 28573000, -73430000, 1023, 3600, 1000 ) != 0)
+        || (ais_simplify_check( &simplify, 1, 28573100, -73430100, 1023, 3600, 1100 ) != 1)
+        || (ais_simplify_check( &simplify, 1, 54600000, 108600000, 1023, 3600, 1200 ) != 1)
+        || (simplify.reports != 2) )
+    {
+        fprintf( stderr, "test_ais_simplify_still() 2: failed\n" );
+        free_ais_simplify( &simplify );
+        return 0;
+    }
+
+    /* Kept now and then when max_interval is set */
+    simplify.max_interval = 600;
+    if(    (ais_simplify_check( &simplify, 1, 28573000, -73430000, 1023, 3600, 1500 ) != 1)
+        || (ais_simplify_check( &simplify, 1, 28573000, -73430000, 1023, 3600, 1600 ) != 0) )
+    {
+        fprintf( stderr, "test_ais_simplify_still() 3: failed\n" );
+        free_ais_simplify( &simplify );
+        return 0;
+    }
+
+    /* A full table keeps the reports of vessels it can't hold */
+    for( i = 2; i <= 20; i++ )
+        ais_simplify_check( &simplify, i * 1000003UL, 28573000, -73430000, 0, 0, 1000 + i );
+    if(    (simplify.count != 12) || (simplify.full != 8)
+        || (ais_simplify_check( &simplify, 20 * 1000003UL, 28573000, -73430000, 0, 0, 1100 ) != 0)
+        || (ais_simplify_check( &simplify, 12 * 1000003UL, 28573000, -73430000, 0, 0, 1100 ) != 1) )
+    {
+        fprintf( stderr, "test_ais_simplify_still() 4: failed %lu %lu\n", simplify.count, simplify.full );
+        free_ais_simplify( &simplify );
+        return 0;
+    }
+
+    /* The first 6 added after vessel 1 haven't had one kept for a while */
+    if( (ais_simplify_expire( &simplify, 1650, 642 ) != 6) || (simplify.count != 6) )
+    {
+        fprintf( stderr, "test_ais_simplify_still() 5: failed\n" );
+        free_ais_simplify( &simplify );
+        return 0;
+    }
+
+    /* An older report is left out and doesn't move the vessel back */
+    if(    (ais_simplify_check( &simplify, 8 * 1000003UL, 28600000, -73400000, 0, 0, 900 ) != 1)
+        || (ais_simplify_expire( &simplify, 1000, 10 ) != 0)
+        || (ais_simplify_expire( &simplify, 2000, 100 ) != 6) || (simplify.count != 0) )
+    {
+        fprintf( stderr, "test_ais_simplify_still() 6: failed %lu\n", simplify.count );
+        free_ais_simplify( &simplify );
+        return 0;
+    }
+    free_ais_simplify( &simplify );
+
+    fprintf( stderr, "test_ais_simplify_still(): Passed\n" );
+    return 1;
+}
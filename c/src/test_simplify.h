@@ -0,0 +1,13 @@
+/* -----------------------------------------------------------------------
+   Trajectory simplification Test functions
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com
+   All Rights Reserved
+   ----------------------------------------------------------------------- */
+
+/*! \file
+    \brief Header file for test_simplify.c
+*/
+
+
+int test_ais_simplify( void );
+int test_ais_simplify_still( void );
@@ -89,3 +89,299 @@ int test_get_6bit( void )
     fprintf( stderr, "get_sixbit(): Passed\n" );
     return 1;
 }
+
+
+int test_sixbit_pack( void )
+{
+    sixbit  state;
+    sixbit  packed;
+    short   sizes[] = { 6, 2, 30, 4, 8, 10, 1, 28, 27, 12, 9, 6, 4, 1, 1, 2, 3, 14 };
+    unsigned int i;
+
+    init_6bit( &state );
+    strcpy( state.bits, "15MqvC0Oh9G?qinK?VlPhA480@2n" );
+    init_6bit( &packed );
+    strcpy( packed.bits, "15MqvC0Oh9G?qinK?VlPhA480@2n" );
+
+    /* Start packing after a partial fetch */
+    get_6bit( &state, 6 );
+    get_6bit( &packed, 6 );
+    if( sixbit_pack( &packed ) != 0 )
+    {
+        fprintf( stderr, "sixbit_pack() 1: Failed\n" );
+        return 0;
+    }
+    if( (packed.num_bits != 168) || (packed.pos != 6) )
+    {
+        fprintf( stderr, "sixbit_pack() 2: Failed\n" );
+        return 0;
+    }
+
+    /* Both paths must return the same fields */
+    for( i = 1; i < sizeof(sizes) / sizeof(sizes[0]); i++ )
+    {
+        if( get_6bit( &state, sizes[i] ) != get_6bit( &packed, sizes[i] ) )
+        {
+            fprintf( stderr, "sixbit_pack() 3 - %d: Failed\n", i );
+            return 0;
+        }
+    }
+
+    /* Past the end returns 0 */
+    if( get_6bit( &packed, 6 ) != 0 )
+    {
+        fprintf( stderr, "sixbit_pack() 4: Failed\n" );
+        return 0;
+    }
+
+    fprintf( stderr, "sixbit_pack(): Passed\n" );
+    return 1;
+}
+
+
+int test_get_bits( void )
+{
+    sixbit  state;
+
+    init_6bit( &state );
+    strcpy( state.bits, "15MqvC0Oh9G?qinK?VlPhA480@2n" );
+
+    /* Random access, packs the state on first use */
+    if( get_bits( &state, 8, 30 ) != 366902860 )
+    {
+        fprintf( stderr, "get_bits() 1: Failed\n" );
+        return 0;
+    }
+    if( get_bits( &state, 0, 6 ) != 1 )
+    {
+        fprintf( stderr, "get_bits() 2: Failed\n" );
+        return 0;
+    }
+
+    /* Field straddling 2 words (bits 61-88) */
+    if( get_bits( &state, 61, 28 ) != 0xB9FCE3B )
+    {
+        fprintf( stderr, "get_bits() 3: Failed\n" );
+        return 0;
+    }
+
+    /* Does not move the get_6bit() position */
+    if( get_6bit( &state, 6 ) != 1 )
+    {
+        fprintf( stderr, "get_bits() 4: Failed\n" );
+        return 0;
+    }
+
+    if( get_bits( &state, 168, 6 ) != 0 )
+    {
+        fprintf( stderr, "get_bits() 5: Failed\n" );
+        return 0;
+    }
+
+    fprintf( stderr, "get_bits(): Passed\n" );
+    return 1;
+}
+
+
+int test_sixbit_dearmor( void )
+{
+    char          ascii[200];
+    unsigned char ref[160];
+    unsigned char buf[160];
+    sixbit        state;
+    unsigned int  i;
+    int           level;
+    int           bad[] = { 0, 17, 40, 150, 197 };
+
+    /* Every valid character, more than a few SIMD blocks worth */
+    for( i = 0; i < 198; i++ )
+        ascii[i] = binto6bit( (i * 7) & 0x3F );
+    ascii[i] = 0;
+
+    /* Reference from the character at a time path */
+    init_6bit( &state );
+    strcpy( state.bits, ascii );
+    memset( ref, 0, sizeof( ref ) );
+    for( i = 0; i < 198 * 6 / 8; i++ )
+        ref[i] = (unsigned char) get_6bit( &state, 8 );
+
+    for( level = 2; level >= 0; level-- )
+    {
+        sixbit_simd( level );
+        for( i = 1; i < 198; i += 13 )
+        {
+            memset( buf, 0xAA, sizeof( buf ) );
+            if( sixbit_dearmor( ascii, i, buf ) != 0 )
+            {
+                fprintf( stderr, "sixbit_dearmor() 1 - %d/%d: Failed\n", level, i );
+                return 0;
+            }
+            /* Compare the whole bytes, last byte is partially padding */
+            if( memcmp( buf, ref, (i * 6) / 8 ) != 0 )
+            {
+                fprintf( stderr, "sixbit_dearmor() 2 - %d/%d: Failed\n", level, i );
+                return 0;
+            }
+            /* Must not write past the end */
+            if( buf[(i * 6 + 7) / 8] != 0xAA )
+            {
+                fprintf( stderr, "sixbit_dearmor() 3 - %d/%d: Failed\n", level, i );
+                return 0;
+            }
+        }
+
+        /* Invalid characters anywhere in the string are caught */
+        for( i = 0; i < sizeof( bad ) / sizeof( bad[0] ); i++ )
+        {
+            ascii[bad[i]] = 'Z';
+            if( sixbit_dearmor( ascii, 198, buf ) != 2 )
+            {
+                fprintf( stderr, "sixbit_dearmor() 4 - %d/%d: Failed\n", level, bad[i] );
+                return 0;
+            }
+            ascii[bad[i]] = binto6bit( (bad[i] * 7) & 0x3F );
+        }
+    }
+    sixbit_simd( 2 );
+
+    /* A packed payload with a bad character is rejected */
+    init_6bit( &state );
+    strcpy( state.bits, "15MqvC0Oh9G?qinK?VlPhA48 @2n" );
+    if( sixbit_pack( &state ) != 2 )
+    {
+        fprintf( stderr, "sixbit_dearmor() 5: Failed\n" );
+        return 0;
+    }
+
+    fprintf( stderr, "sixbit_dearmor(): Passed\n" );
+    return 1;
+}
+
+
+int test_sixbit_append( void )
+{
+    sixbit  state;
+    char    buf[SIXBIT_LEN];
+    int     i;
+
+    /* Message 5 from two VDM parts, 2 fill bits on the last part */
+    init_6bit( &state );
+    if( sixbit_append( &state, "55Mf@6P00001MUS;7GQL4hh61L4hh6222222220t41H", 43, 0 ) != 0 )
+    {
+        fprintf( stderr, "sixbit_append() 1: Failed\n" );
+        return 0;
+    }
+    if( sixbit_append( &state, "==40HtI4i@E531H1QDTVH51DSCS0", 28, 2 ) != 0 )
+    {
+        fprintf( stderr, "sixbit_append() 2: Failed\n" );
+        return 0;
+    }
+    if( (state.len != 71) || (strlen( state.bits ) != 71) || (sixbit_size( &state ) != 424) )
+    {
+        fprintf( stderr, "sixbit_append() 3: Failed\n" );
+        return 0;
+    }
+
+    /* Remaining bits go down as fields are fetched, in both modes */
+    get_6bit( &state, 38 );
+    if( sixbit_length( &state ) != 386 )
+    {
+        fprintf( stderr, "sixbit_append() 4: Failed\n" );
+        return 0;
+    }
+    sixbit_pack( &state );
+    get_6bit( &state, 20 );
+    if( (sixbit_length( &state ) != 366) || (state.num_bits != 424) )
+    {
+        fprintf( stderr, "sixbit_append() 5: Failed\n" );
+        return 0;
+    }
+
+    /* Fetching into the fill bits is an overrun */
+    for( i = 0; i < 11; i++ )
+        get_6bit( &state, 32 );
+    get_6bit( &state, 14 );
+    if( (sixbit_length( &state ) != 0) || state.overrun )
+    {
+        fprintf( stderr, "sixbit_append() 6: Failed\n" );
+        return 0;
+    }
+    get_6bit( &state, 2 );
+    if( !state.overrun )
+    {
+        fprintf( stderr, "sixbit_append() 7: Failed\n" );
+        return 0;
+    }
+
+    /* The string path flags running off the end too */
+    init_6bit( &state );
+    strcpy( state.bits, "5678" );
+    get_6bit( &state, 24 );
+    if( (sixbit_size( &state ) != 24) || (sixbit_length( &state ) != 0) || state.overrun )
+    {
+        fprintf( stderr, "sixbit_append() 8: Failed\n" );
+        return 0;
+    }
+    get_6bit( &state, 1 );
+    if( !state.overrun )
+    {
+        fprintf( stderr, "sixbit_append() 9: Failed\n" );
+        return 0;
+    }
+
+    /* Too much data is refused */
+    init_6bit( &state );
+    memset( buf, '0', sizeof(buf) );
+    if( (sixbit_append( &state, buf, 200, 0 ) != 0)
+     || (sixbit_append( &state, buf, 55, 0 ) != 2)
+     || (sixbit_size( &state ) != 1200) )
+    {
+        fprintf( stderr, "sixbit_append() 10: Failed\n" );
+        return 0;
+    }
+
+    fprintf( stderr, "sixbit_append(): Passed\n" );
+    return 1;
+}
+
+
+int test_sixbit_view( void )
+{
+    sixbit      state;
+    sixbit_view view;
+
+    init_6bit( &state );
+    strcpy( state.bits, "15MqvC0Oh9G?qinK?VlPhA480@2n" );
+    get_6bit( &state, 6 );
+
+    /* Starts where get_6bit() left off */
+    if( (sixbit_view_init( &view, &state ) != 0) || (sixbit_view_length( &view ) != 162) )
+    {
+        fprintf( stderr, "sixbit_view 1: Failed\n" );
+        return 0;
+    }
+
+    sixbit_view_get( &view, 2 );
+    if( (sixbit_view_get( &view, 30 ) != 366902860) || (sixbit_view_length( &view ) != 130) )
+    {
+        fprintf( stderr, "sixbit_view 2: Failed\n" );
+        return 0;
+    }
+
+    /* Runs off the end of the view without touching the state */
+    sixbit_view_get( &view, 30 );
+    sixbit_view_get( &view, 30 );
+    sixbit_view_get( &view, 30 );
+    sixbit_view_get( &view, 30 );
+    sixbit_view_get( &view, 30 );
+    if(    (view.overrun != 1) || (sixbit_view_length( &view ) != 0)
+        || (state.overrun != 0) || (get_6bit( &state, 2 ) != 0)
+        || (get_6bit( &state, 30 ) != 366902860) )
+    {
+        fprintf( stderr, "sixbit_view 3: Failed\n" );
+        return 0;
+    }
+
+    fprintf( stderr, "sixbit_view(): Passed\n" );
+    return 1;
+}
@@ -13,3 +13,8 @@ int test_binto6bit( void );
 int test_binfrom6bit( void );
 int test_init_6bit( void );
 int test_get_6bit( void );
+int test_sixbit_pack( void );
+int test_get_bits( void );
+int test_sixbit_dearmor( void );
+int test_sixbit_append( void );
+int test_sixbit_view( void );
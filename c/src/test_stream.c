@@ -0,0 +1,131 @@
+/* -----------------------------------------------------------------------
+   Streaming parser Test functions
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com
+   All Rights Reserved
+   ----------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "portable.h"
+#include "nmea.h"
+#include "sixbit.h"
+#include "vdm_parse.h"
+#include "reassembly.h"
+#include "stream.h"
+#include "test_stream.h"
+
+/*! \file
+    \brief Streaming parser Test functions
+    \author Brian C. Lane <bcl@brianlane.com>
+
+*/
+
+static char test_data[] =
+    "!AIVDM,1,1,,B,19NS7Sp02wo?HETKA2K6mUM20<L=,0*27\r\n"
+    "$GPGGA,161229.487,3723.2475,N,12158.3416,W,1,07,1.0,9.0,M,,,,0000*18\r\n"
+    "\\s:2573345,c:1241544035*08\\!AIVDM,2,1,9,A,55Mf@6P00001MUS;7GQL4hh61L4hh6222222220t41H,0*49\r\n"
+    "!AIVDM,2,2,9,A,==40HtI4i@E531H1QDTVH51DSCS0,2*16\r\n"
+    "\r\n"
+    "!AIVDM,1,1,,B,19NS7Sp02wo?HETKA2K6mUM20<L=,0*28\r\n"
+    "!AIVDM,1,1,,A,H52IRsP518Tj0l59D0000000000,2*45\r\n";
+
+
+/* Record the message id and MMSI of each message */
+static unsigned long msgids[8];
+static unsigned long mmsis[8];
+static unsigned long times[8];
+static unsigned int  num_ids;
+
+static void __stdcall got_message( ais_state *state, void *data )
+{
+    if( num_ids < 8 )
+    {
+        msgids[num_ids] = get_bits( &state->six_state, 0, 6 );
+        mmsis[num_ids] = get_bits( &state->six_state, 8, 30 );
+        times[num_ids] = (state->tag.flags & NMEA_TAG_TIME) ? state->tag.time : 0;
+        num_ids++;
+    }
+    (*(int *) data)++;
+}
+
+
+int test_ais_stream_chunks( void )
+{
+    ais_stream  stream;
+    char        buf[sizeof(test_data)];
+    size_t      len;
+    size_t      chunk;
+    size_t      i;
+    int         called;
+    int         count;
+
+    len = strlen( test_data );
+    for( chunk = 1; chunk <= len; chunk += (chunk < 16) ? 1 : 37 )
+    {
+        strcpy( buf, test_data );
+        called = 0;
+        num_ids = 0;
+        init_ais_stream( &stream, got_message, &called );
+
+        count = 0;
+        for( i = 0; i < len; i += chunk )
+            count += ais_stream_feed( &stream, buf + i, (len - i < chunk) ? len - i : chunk );
+
+        if(    (count != 3) || (called != 3) || (stream.errors != 1)
+            || (msgids[0] != 1) || (msgids[1] != 5) || (msgids[2] != 24)
+            || (mmsis[0] != 636012431) || (mmsis[1] != 366710810)
+            || (times[0] != 0) || (times[1] != 1241544035) )
+        {
+            fprintf( stderr, "test_ais_stream_chunks() chunk %d: failed\n", (int) chunk );
+            return 0;
+        }
+
+        /* The buffer is put back the way it was */
+        if( strcmp( buf, test_data ) != 0 )
+        {
+            fprintf( stderr, "test_ais_stream_chunks() chunk %d: buffer changed\n", (int) chunk );
+            return 0;
+        }
+    }
+
+    fprintf( stderr, "test_ais_stream_chunks(): Passed\n" );
+    return 1;
+}
+
+
+int test_ais_stream_overflow( void )
+{
+    ais_stream  stream;
+    char        junk[400];
+    char        buf[] = "!AIVDM,1,1,,B,19NS7Sp02wo?HETKA2K6mUM20<L=,0*27\r\n";
+    int         called;
+
+    called = 0;
+    init_ais_stream( &stream, got_message, &called );
+
+    /* A runaway line split across chunks is dropped up to its '\n' */
+    memset( junk, 'x', sizeof(junk) );
+    ais_stream_feed( &stream, junk, 200 );
+    ais_stream_feed( &stream, junk, 200 );
+    ais_stream_feed( &stream, junk, 200 );
+    junk[10] = '\n';
+    ais_stream_feed( &stream, junk, 11 );
+    if( (ais_stream_feed( &stream, buf, strlen( buf ) ) != 1) || (stream.overflows != 1) )
+    {
+        fprintf( stderr, "test_ais_stream_overflow() 1: failed\n" );
+        return 0;
+    }
+
+    /* And in a single chunk */
+    junk[300] = '\n';
+    if(    (ais_stream_feed( &stream, junk + 11, 290 ) != 0)
+        || (ais_stream_feed( &stream, buf, strlen( buf ) ) != 1)
+        || (stream.overflows != 2) || (called != 2) )
+    {
+        fprintf( stderr, "test_ais_stream_overflow() 2: failed\n" );
+        return 0;
+    }
+
+    fprintf( stderr, "test_ais_stream_overflow(): Passed\n" );
+    return 1;
+}
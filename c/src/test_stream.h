@@ -0,0 +1,13 @@
+/* -----------------------------------------------------------------------
+   Streaming parser Test functions
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com
+   All Rights Reserved
+   ----------------------------------------------------------------------- */
+
+/*! \file
+    \brief Header file for test_stream.c
+*/
+
+
+int test_ais_stream_chunks( void );
+int test_ais_stream_overflow( void );
@@ -0,0 +1,160 @@
+/* -----------------------------------------------------------------------
+   Thinning Test functions
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com
+   All Rights Reserved
+   ----------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "portable.h"
+#include "nmea.h"
+#include "sixbit.h"
+#include "vdm_parse.h"
+#include "thin.h"
+#include "test_thin.h"
+
+/*! \file
+    \brief Thinning Test functions
+    \author Brian C. Lane <bcl@brianlane.com>
+
+*/
+
+
+int test_ais_thin( void )
+{
+    ais_thin      thin;
+    aismsg_any    msg;
+    unsigned long t;
+    unsigned int  passed;
+
+    if( init_ais_thin( &thin, 100 ) != 0 )
+    {
+        fprintf( stderr, "test_ais_thin() 1: failed\n" );
+        return 0;
+    }
+
+    /* Steady course and speed every 2 seconds, with a little noise */
+    memset( &msg, 0, sizeof( msg ) );
+    msg.msgid = 1;
+    msg.u.msg_1.userid = 366710810;
+    msg.u.msg_1.nav_status = 0;
+    passed = 0;
+    for( t = 1000; t < 1120; t += 2 )
+    {
+        msg.u.msg_1.sog = 120 + (t & 2);
+        msg.u.msg_1.cog = (t & 4) ? 3595 : 5;
+        if( ais_thin_check_msg( &thin, &msg, t ) == 0 )
+            passed++;
+    }
+    if( (passed != 4) || (thin.passed != 4) || (thin.dropped != 56) )
+    {
+        fprintf( stderr, "test_ais_thin() 2: failed %u\n", passed );
+        free_ais_thin( &thin );
+        return 0;
+    }
+
+    /* A turn is passed on once min_interval has gone by */
+    msg.u.msg_1.cog = 150;
+    if(    (ais_thin_check_msg( &thin, &msg, 1092 ) != 1)
+        || (ais_thin_check_msg( &thin, &msg, 1096 ) != 0)
+        || (ais_thin_check_msg( &thin, &msg, 1102 ) != 1) )
+    {
+        fprintf( stderr, "test_ais_thin() 3: failed\n" );
+        free_ais_thin( &thin );
+        return 0;
+    }
+
+    /* So is a speed or status change */
+    msg.u.msg_1.sog = 50;
+    if( ais_thin_check_msg( &thin, &msg, 1104 ) != 0 )
+    {
+        fprintf( stderr, "test_ais_thin() 4: failed\n" );
+        free_ais_thin( &thin );
+        return 0;
+    }
+    msg.u.msg_1.nav_status = 5;
+    if(    (ais_thin_check( &thin, 366710810, 50, 150, 1, 1110 ) != 0)
+        || (ais_thin_check( &thin, 366710810, 50, 150, 1, 1116 ) != 1) )
+    {
+        fprintf( stderr, "test_ais_thin() 5: failed\n" );
+        free_ais_thin( &thin );
+        return 0;
+    }
+
+    /* The course of a stopped vessel is ignored */
+    if(    (ais_thin_check( &thin, 1, 0, 100, 1, 1000 ) != 0)
+        || (ais_thin_check( &thin, 1, 1, 2700, 1, 1010 ) != 1)
+        || (ais_thin_check( &thin, 1, 1023, 3600, 1, 1020 ) != 0) )
+    {
+        fprintf( stderr, "test_ais_thin() 6: failed\n" );
+        free_ais_thin( &thin );
+        return 0;
+    }
+    free_ais_thin( &thin );
+
+    fprintf( stderr, "test_ais_thin(): Passed\n" );
+    return 1;
+}
+
+
+int test_ais_thin_table( void )
+{
+    ais_thin      thin;
+    unsigned long i;
+
+    if( init_ais_thin( &thin, 12 ) != 0 )
+    {
+        fprintf( stderr, "test_ais_thin_table() 1: failed\n" );
+        return 0;
+    }
+
+    /* 12 fit, the rest are passed on without being kept */
+    for( i = 1; i <= 20; i++ )
+        ais_thin_check( &thin, i * 1000003UL, 100, 900, 0, 1000 + i );
+    for( i = 1; i <= 20; i++ )
+    {
+        if( ais_thin_check( &thin, i * 1000003UL, 100, 900, 0, 1021 ) != (i <= 12) )
+        {
+            fprintf( stderr, "test_ais_thin_table() 2: failed on %lu\n", i );
+            free_ais_thin( &thin );
+            return 0;
+        }
+    }
+    if( (thin.count != 12) || (thin.full != 16) )
+    {
+        fprintf( stderr, "test_ais_thin_table() 3: failed %lu %lu\n", thin.count, thin.full );
+        free_ais_thin( &thin );
+        return 0;
+    }
+
+    /* Expire the first 6, the others must still be found */
+    if( ais_thin_expire( &thin, 1050, 43 ) != 6 )
+    {
+        fprintf( stderr, "test_ais_thin_table() 4: failed\n" );
+        free_ais_thin( &thin );
+        return 0;
+    }
+    for( i = 7; i <= 12; i++ )
+    {
+        if( ais_thin_check( &thin, i * 1000003UL, 100, 900, 0, 1022 ) != 1 )
+        {
+            fprintf( stderr, "test_ais_thin_table() 5: failed on %lu\n", i );
+            free_ais_thin( &thin );
+            return 0;
+        }
+    }
+
+    /* An older report is dropped and doesn't move the vessel back */
+    if(    (ais_thin_check( &thin, 7 * 1000003UL, 100, 900, 0, 900 ) != 1)
+        || (ais_thin_expire( &thin, 1000, 43 ) != 0)
+        || (ais_thin_expire( &thin, 1100, 43 ) != 6) || (thin.count != 0) )
+    {
+        fprintf( stderr, "test_ais_thin_table() 6: failed %lu\n", thin.count );
+        free_ais_thin( &thin );
+        return 0;
+    }
+    free_ais_thin( &thin );
+
+    fprintf( stderr, "test_ais_thin_table(): Passed\n" );
+    return 1;
+}
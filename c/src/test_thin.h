@@ -0,0 +1,13 @@
+/* -----------------------------------------------------------------------
+   Thinning Test functions
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com
+   All Rights Reserved
+   ----------------------------------------------------------------------- */
+
+/*! \file
+    \brief Header file for test_thin.c
+*/
+
+
+int test_ais_thin( void );
+int test_ais_thin_table( void );
@@ -0,0 +1,188 @@
+/* -----------------------------------------------------------------------
+   Track store Test functions
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com
+   All Rights Reserved
+   ----------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "portable.h"
+#include "nmea.h"
+#include "sixbit.h"
+#include "vdm_parse.h"
+#include "mmsi_index.h"
+#include "track.h"
+#include "test_track.h"
+
+/*! \file
+    \brief Track store Test functions
+    \author Brian C. Lane <bcl@brianlane.com>
+
+*/
+
+#define TEST_FIXES 1000
+
+static track_fix fixes[TEST_FIXES];
+
+
+/* A vessel at about 10 knots, reporting every 10 seconds */
+static void make_fixes( void )
+{
+    int i;
+
+    fixes[0].time = 1241544035;
+    fixes[0].latitude = 22000000;
+    fixes[0].longitude = -73000000;
+    fixes[0].sog = 100;
+    fixes[0].cog = 450;
+    for( i = 1; i < TEST_FIXES; i++ )
+    {
+        fixes[i] = fixes[i-1];
+        fixes[i].time += 10 + (i % 3);
+        fixes[i].latitude += 196 + (i % 7);
+        fixes[i].longitude += 210 - (i % 5);
+        fixes[i].sog = 95 + (i % 11);
+        fixes[i].cog = (i % 50 == 0) ? 3600 : 440 + (i % 21);
+    }
+}
+
+
+/* Compare a track with the last n test fixes */
+static int check_track( track_store *store, unsigned long userid, int n )
+{
+    track_iter iter;
+    int        i;
+
+    track_iter_init( store, track_find( store, userid ), &iter );
+    for( i = TEST_FIXES - n; track_iter_next( &iter ); i++ )
+    {
+        if( (i >= TEST_FIXES) || memcmp( &iter.fix, &fixes[i], sizeof( track_fix ) ) )
+            return 0;
+    }
+
+    return (i == TEST_FIXES);
+}
+
+
+int test_track_append( void )
+{
+    track_store   store;
+    ais_track     *track;
+    aismsg_pos    pos;
+    int           i;
+
+    make_fixes();
+
+    /* Room for all of them */
+    if( init_track_store( &store, 10, 8192 ) != 0 )
+    {
+        fprintf( stderr, "test_track_append() 1: failed\n" );
+        return 0;
+    }
+    for( i = 0; i < TEST_FIXES; i++ )
+        track_append( &store, 366710810, &fixes[i] );
+    track = track_find( &store, 366710810 );
+    if( !track || (track->count != TEST_FIXES) || !check_track( &store, 366710810, TEST_FIXES ) )
+    {
+        fprintf( stderr, "test_track_append() 2: failed\n" );
+        free_track_store( &store );
+        return 0;
+    }
+
+    /* Less than a tenth of an 80 byte struct per fix */
+    if( track->used > 8 * (TEST_FIXES - 1) )
+    {
+        fprintf( stderr, "test_track_append() 3: failed %u\n", track->used );
+        free_track_store( &store );
+        return 0;
+    }
+
+    /* Going back in time */
+    if( (track_append( &store, 366710810, &fixes[0] ) != 1) || (track->count != TEST_FIXES) )
+    {
+        fprintf( stderr, "test_track_append() 4: failed\n" );
+        free_track_store( &store );
+        return 0;
+    }
+    free_track_store( &store );
+
+    /* Old fixes are dropped when the ring is full */
+    init_track_store( &store, 2, 256 );
+    for( i = 0; i < TEST_FIXES; i++ )
+        track_append( &store, 636012431, &fixes[i] );
+    track = track_find( &store, 636012431 );
+    if( !track || (track->count < 30) || (track->used > 256)
+        || (store.dropped != TEST_FIXES - track->count) || !check_track( &store, 636012431, (int) track->count ) )
+    {
+        fprintf( stderr, "test_track_append() 5: failed\n" );
+        free_track_store( &store );
+        return 0;
+    }
+
+    /* From a position report, until it is full */
+    memset( &pos, 0, sizeof( pos ) );
+    pos.fields = AIS_FIELD_USERID | AIS_FIELD_POSITION;
+    pos.userid = 1;
+    pos.latitude = 100;
+    if(    (track_append_pos( &store, &pos, 5 ) != 0) || !(track = track_find( &store, 1 ))
+        || (track->first.latitude != 100) || (track->first.sog != 1023) || (track->first.cog != 3600) )
+    {
+        fprintf( stderr, "test_track_append() 6: failed\n" );
+        free_track_store( &store );
+        return 0;
+    }
+    pos.userid = 2;
+    if(    (track_append_pos( &store, &pos, 5 ) != 2) || (store.full != 1)
+        || (track_remove( &store, 1 ) != 0) || track_find( &store, 1 )
+        || (track_append_pos( &store, &pos, 5 ) != 0) || !check_track( &store, 636012431, (int) track_find( &store, 636012431 )->count ) )
+    {
+        fprintf( stderr, "test_track_append() 7: failed\n" );
+        free_track_store( &store );
+        return 0;
+    }
+    free_track_store( &store );
+
+    fprintf( stderr, "test_track_append(): Passed\n" );
+    return 1;
+}
+
+
+int test_track_max_age( void )
+{
+    track_store   store;
+    ais_track     *track;
+    track_fix     fix;
+    unsigned long t;
+
+    init_track_store( &store, 10, 1024 );
+    store.max_age = 100;
+
+    memset( &fix, 0, sizeof( fix ) );
+    for( t = 0; t <= 1000; t += 10 )
+    {
+        fix.time = t;
+        fix.latitude = (long) t;
+        track_append( &store, 1, &fix );
+    }
+    track = track_find( &store, 1 );
+    if( !track || (track->count != 11) || (track->first.time != 900) || (track->first.latitude != 900) )
+    {
+        fprintf( stderr, "test_track_max_age() 1: failed\n" );
+        free_track_store( &store );
+        return 0;
+    }
+
+    /* A long gap leaves only the newest */
+    fix.time = 5000;
+    track_append( &store, 1, &fix );
+    if( (track->count != 1) || (track->used != 0) || (track->first.time != 5000) )
+    {
+        fprintf( stderr, "test_track_max_age() 2: failed\n" );
+        free_track_store( &store );
+        return 0;
+    }
+    free_track_store( &store );
+
+    fprintf( stderr, "test_track_max_age(): Passed\n" );
+    return 1;
+}
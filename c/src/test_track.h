@@ -0,0 +1,13 @@
+/* -----------------------------------------------------------------------
+   Track store Test functions
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com
+   All Rights Reserved
+   ----------------------------------------------------------------------- */
+
+/*! \file
+    \brief Header file for test_track.c
+*/
+
+
+int test_track_append( void );
+int test_track_max_age( void );
@@ -442,6 +442,43 @@ int test_assemble_vdm( void )
 }
 
 
+
+int test_assemble_vdm_tag( void )
+{
+    ais_state state;
+    char *buf[3] = { "\\g:1-2-1234,s:r003669945,c:1241544035*0F\\!AIVDM,2,1,9,A,55Mf@6P00001MUS;7GQL4hh61L4hh6222222220t41H,0*49\r\n",
+                     "\\g:2-2-1234,n:42*27\\!AIVDM,2,2,9,A,==40HtI4i@E531H1QDTVH51DSCS0,2*16\r\n",
+                     "!AIVDM,1,1,,B,19NS7Sp02wo?HETKA2K6mUM20<L=,0*27\r\n"
+                   };
+
+    memset( &state, 0, sizeof(state) );
+
+    if( (assemble_vdm( &state, buf[0] ) != 1) || (assemble_vdm( &state, buf[1] ) != 0) )
+    {
+        fprintf( stderr, "test_assemble_vdm_tag() 1: failed\n" );
+        return 0;
+    }
+
+    /* Source and time from the first part, the line count from the second */
+    if(    (state.tag.flags != (NMEA_TAG_SOURCE | NMEA_TAG_TIME | NMEA_TAG_GROUP | NMEA_TAG_LINE))
+        || (strcmp( state.tag.source, "r003669945" ) != 0) || (state.tag.time != 1241544035)
+        || (state.tag.line != 42) || (state.tag.group_num != 1) || (state.tag.group_id != 1234) )
+    {
+        fprintf( stderr, "test_assemble_vdm_tag() 2: failed\n" );
+        return 0;
+    }
+
+    /* A message without a tag block has no tag */
+    if( (assemble_vdm( &state, buf[2] ) != 0) || (state.tag.flags != 0) )
+    {
+        fprintf( stderr, "test_assemble_vdm_tag() 3: failed\n" );
+        return 0;
+    }
+
+    fprintf( stderr, "test_assemble_vdm_tag(): Passed\n" );
+    return 1;
+}
+
 int test_ais_1( void )
 {
     ais_state state;
@@ -2112,3 +2149,239 @@ int test_ais_27( void )
    fprintf( stderr, "test_ais_27() passed\n");
    return 1;
  }
+
+
+int test_parse_ais_any( void )
+{
+    ais_state  state;
+    aismsg_any msg;
+    aismsg_any other;
+    char *buf[5] = { "!AIVDM,1,1,,B,19NS7Sp02wo?HETKA2K6mUM20<L=,0*27\r\n",
+                     "!AIVDM,2,1,9,A,55Mf@6P00001MUS;7GQL4hh61L4hh6222222220t41H,0*49\r\n",
+                     "!AIVDM,2,2,9,A,==40HtI4i@E531H1QDTVH51DSCS0,2*16\r\n",
+                     "!AIVDM,1,1,,A,H52IRsP518Tj0l59D0000000000,2*45\r\n",
+                     "!AIVDM,1,1,,A,H52IRsTU000000000000000@5120,0*76\r\n"
+                   };
+
+    memset( &state, 0, sizeof(state) );
+    memset( &msg, 0, sizeof(msg) );
+
+    if(    (assemble_vdm( &state, buf[0] ) != 0) || (parse_ais_any( &state, &msg ) != 0)
+        || (msg.msgid != 1) || (state.msgid != 1) || (msg.u.msg_1.userid != 636012431) )
+    {
+        fprintf( stderr, "test_parse_ais_any() 1: failed\n" );
+        return 0;
+    }
+
+    assemble_vdm( &state, buf[1] );
+    if(    (assemble_vdm( &state, buf[2] ) != 0) || (parse_ais_any( &state, &msg ) != 0)
+        || (msg.msgid != 5) || (msg.u.msg_5.userid != 366710810) )
+    {
+        fprintf( stderr, "test_parse_ais_any() 2: failed\n" );
+        return 0;
+    }
+
+    /* Both parts of a message 24 are put together, even in a result
+       that wasn't cleared and with another message parsed in between */
+    memset( &other, 0xFF, sizeof( other ) );
+    if(    (assemble_vdm( &state, buf[3] ) != 0) || (parse_ais_any( &state, &msg ) != 0)
+        || (msg.u.msg_24.flags != 1)
+        || (assemble_vdm( &state, buf[0] ) != 0) || (parse_ais_any( &state, &msg ) != 0)
+        || (assemble_vdm( &state, buf[4] ) != 0) || (parse_ais_any( &state, &other ) != 0)
+        || (other.u.msg_24.flags != 3) || (strcmp( other.u.msg_24.name, "APRIL MARU@@@@@@@@@@" ) != 0) )
+    {
+        fprintf( stderr, "test_parse_ais_any() 3: failed\n" );
+        return 0;
+    }
+
+    /* Message 25 is not supported */
+    init_6bit( &state.six_state );
+    strcpy( state.six_state.bits, "I00000000000" );
+    if( (parse_ais_any( &state, &msg ) != 4) || (msg.msgid != 25) )
+    {
+        fprintf( stderr, "test_parse_ais_any() 4: failed\n" );
+        return 0;
+    }
+
+    /* Errors from the parser are passed back */
+    init_6bit( &state.six_state );
+    strcpy( state.six_state.bits, "19NS7Sp02wo?HETKA2K6mUM20<L" );
+    if( parse_ais_any( &state, &msg ) != 2 )
+    {
+        fprintf( stderr, "test_parse_ais_any() 5: failed\n" );
+        return 0;
+    }
+
+    fprintf( stderr, "test_parse_ais_any(): Passed\n" );
+    return 1;
+}
+
+
+int test_parse_ais_position( void )
+{
+    ais_state  state;
+    aismsg_pos pos;
+    char buf[] = "!AIVDM,1,1,,B,19NS7Sp02wo?HETKA2K6mUM20<L=,0*27\r\n";
+
+    memset( &state, 0, sizeof(state) );
+
+    /* Message 1, everything */
+    if(    (assemble_vdm( &state, buf ) != 0)
+        || (parse_ais_position( &state, AIS_FIELD_ALL, &pos ) != 0) )
+    {
+        fprintf( stderr, "test_parse_ais_position() 1: failed\n" );
+        return 0;
+    }
+    if(    (pos.msgid != 1) || (pos.fields != AIS_FIELD_ALL)
+        || (pos.userid != 636012431) || (pos.nav_status != 8) || (pos.sog != 191)
+        || (pos.longitude != -73481550) || (pos.latitude != 28590700)
+        || (pos.cog != 1750) || (pos.true != 174) || (pos.utc_sec != 33) )
+    {
+        fprintf( stderr, "test_parse_ais_position() 1: failed\n" );
+        return 0;
+    }
+
+    /* Only the MMSI, the rest is left alone */
+    pos.latitude = 0;
+    if(    (parse_ais_position( &state, AIS_FIELD_USERID, &pos ) != 0)
+        || (pos.fields != AIS_FIELD_USERID) || (pos.userid != 636012431) || (pos.latitude != 0) )
+    {
+        fprintf( stderr, "test_parse_ais_position() 2: failed\n" );
+        return 0;
+    }
+
+    /* Message 18 has no navigational status */
+    init_6bit( &state.six_state );
+    strcpy( state.six_state.bits, "B52IRsP005=abWRnlQP03w`UkP06" );
+    if(    (parse_ais_position( &state, AIS_FIELD_ALL, &pos ) != 0)
+        || (pos.msgid != 18) || (pos.fields != (AIS_FIELD_ALL & ~AIS_FIELD_NAV_STATUS))
+        || (pos.userid != 338060014) || (pos.sog != 0) || (pos.pos_acc != 0)
+        || (pos.longitude != -93506225) || (pos.latitude != 11981336)
+        || (pos.cog != 0) || (pos.true != 511) || (pos.utc_sec != 17) )
+    {
+        fprintf( stderr, "test_parse_ais_position() 3: failed\n" );
+        return 0;
+    }
+
+    /* Message 27 is scaled to match */
+    init_6bit( &state.six_state );
+    strcpy( state.six_state.bits, "K3M@PpqK>Qkv=PEp" );
+    if(    (parse_ais_position( &state, AIS_FIELD_CORE | AIS_FIELD_NAV_STATUS, &pos ) != 0)
+        || (pos.msgid != 27) || (pos.fields != ((AIS_FIELD_CORE & ~AIS_FIELD_HEADING) | AIS_FIELD_NAV_STATUS))
+        || (pos.userid != 232005859) || (pos.nav_status != 5)
+        || (pos.longitude != -78201000) || (pos.latitude != 32539000)
+        || (pos.sog != 0) || (pos.cog != 3500) )
+    {
+        fprintf( stderr, "test_parse_ais_position() 4: failed\n" );
+        return 0;
+    }
+
+    /* Not a position report */
+    init_6bit( &state.six_state );
+    strcpy( state.six_state.bits, "H52IRsP518Tj0l59D0000000000" );
+    if( (parse_ais_position( &state, AIS_FIELD_CORE, &pos ) != 4) || (pos.fields != 0) )
+    {
+        fprintf( stderr, "test_parse_ais_position() 5: failed\n" );
+        return 0;
+    }
+
+    /* Short message */
+    init_6bit( &state.six_state );
+    strcpy( state.six_state.bits, "19NS7Sp02wo?HETKA2K6mUM20<L" );
+    if( parse_ais_position( &state, AIS_FIELD_CORE, &pos ) != 2 )
+    {
+        fprintf( stderr, "test_parse_ais_position() 6: failed\n" );
+        return 0;
+    }
+
+    fprintf( stderr, "test_parse_ais_position(): Passed\n" );
+    return 1;
+}
+
+
+int test_ais_peek( void )
+{
+    char *buf[5] = { "!AIVDM,1,1,,B,19NS7Sp02wo?HETKA2K6mUM20<L=,0*27\r\n",
+                     "\\s:2573345,c:1241544035*3A\\!BSVDM,2,1,9,A,55Mf@6P00001MUS;7GQL4hh61L4hh6222222220t41H,0*49\r\n",
+                     "!AIVDM,2,2,9,A,==40HtI4i@E531H1QDTVH51DSCS0,2*16\r\n",
+                     "$GPGGA,161229.487,3723.2475,N,12158.3416,W,1,07,1.0,9.0,M,,,,0000*18\r\n",
+                     "!AIVDM,1,1,,A,1,0*27\r\n"
+                   };
+
+    if( (ais_peek_msgid( buf[0] ) != 1) || (ais_peek_mmsi( buf[0] ) != 636012431) )
+    {
+        fprintf( stderr, "test_ais_peek() 1: failed\n" );
+        return 0;
+    }
+
+    /* First part after a tag block */
+    if( (ais_peek_msgid( buf[1] ) != 5) || (ais_peek_mmsi( buf[1] ) != 366710810) )
+    {
+        fprintf( stderr, "test_ais_peek() 2: failed\n" );
+        return 0;
+    }
+
+    /* Later parts, other sentences and short data can't be peeked */
+    if(    (ais_peek_msgid( buf[2] ) != -1) || (ais_peek_mmsi( buf[2] ) != -1)
+        || (ais_peek_msgid( buf[3] ) != -1) || (ais_peek_mmsi( buf[3] ) != -1)
+        || (ais_peek_msgid( buf[4] ) != 1)  || (ais_peek_mmsi( buf[4] ) != -1) )
+    {
+        fprintf( stderr, "test_ais_peek() 3: failed\n" );
+        return 0;
+    }
+
+    fprintf( stderr, "test_ais_peek(): Passed\n" );
+    return 1;
+}
+
+
+int test_assemble_vdm_filtered( void )
+{
+    ais_state     state;
+    ais_filter    filter;
+    unsigned long mmsi[2] = { 366710810, 636012431 };
+    char *buf[4] = { "!AIVDM,2,1,9,A,55Mf@6P00001MUS;7GQL4hh61L4hh6222222220t41H,0*49\r\n",
+                     "!AIVDM,2,2,9,A,==40HtI4i@E531H1QDTVH51DSCS0,2*16\r\n",
+                     "!AIVDM,1,1,,B,19NS7Sp02wo?HETKA2K6mUM20<L=,0*27\r\n",
+                     "!AIVDM,1,1,,A,H52IRsP518Tj0l59D0000000000,2*45\r\n"
+                   };
+
+    memset( &state, 0, sizeof(state) );
+    init_ais_filter( &filter );
+
+    /* Only message 1, both parts of the message 5 are dropped */
+    filter.msgids = AIS_MSGID( 1 );
+    if(    (assemble_vdm_filtered( &state, &filter, buf[0] ) != 7)
+        || (assemble_vdm_filtered( &state, &filter, buf[1] ) != 7)
+        || (assemble_vdm_filtered( &state, &filter, buf[2] ) != 0)
+        || (filter.accepted != 1) || (filter.rejected != 2) )
+    {
+        fprintf( stderr, "test_assemble_vdm_filtered() 1: failed\n" );
+        return 0;
+    }
+
+    /* The same sequence id is decided again by its next first part */
+    filter.msgids = AIS_MSGID( 5 );
+    if(    (assemble_vdm_filtered( &state, &filter, buf[0] ) != 1)
+        || (assemble_vdm_filtered( &state, &filter, buf[1] ) != 0)
+        || (get_6bit( &state.six_state, 6 ) != 5)
+        || (assemble_vdm_filtered( &state, &filter, buf[2] ) != 7) )
+    {
+        fprintf( stderr, "test_assemble_vdm_filtered() 2: failed\n" );
+        return 0;
+    }
+
+    /* MMSI allowlist */
+    filter.msgids = 0;
+    filter.mmsi = mmsi;
+    filter.num_mmsi = 2;
+    if(    (assemble_vdm_filtered( &state, &filter, buf[2] ) != 0)
+        || (assemble_vdm_filtered( &state, &filter, buf[3] ) != 7) )
+    {
+        fprintf( stderr, "test_assemble_vdm_filtered() 3: failed\n" );
+        return 0;
+    }
+
+    fprintf( stderr, "test_assemble_vdm_filtered(): Passed\n" );
+    return 1;
+}
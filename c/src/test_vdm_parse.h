@@ -14,6 +14,7 @@ int test_pos2dmm( void );
 int test_conv_pos( void );
 int test_conv_pos27();
 int test_assemble_vdm( void );
+int test_assemble_vdm_tag( void );
 int test_ais_1( void );
 int test_ais_2( void );
 int test_ais_3( void );
@@ -40,3 +41,7 @@ int test_ais_23( void );
 int test_ais_24A( void );
 int test_ais_24B( void );
 int test_ais_27( void );
+int test_parse_ais_any( void );
+int test_parse_ais_position( void );
+int test_ais_peek( void );
+int test_assemble_vdm_filtered( void );
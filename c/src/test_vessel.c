@@ -0,0 +1,202 @@
+/* -----------------------------------------------------------------------
+   Vessel table Test functions
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com
+   All Rights Reserved
+   ----------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "portable.h"
+#include "nmea.h"
+#include "sixbit.h"
+#include "vdm_parse.h"
+#include "vessel.h"
+#include "test_vessel.h"
+
+/*! \file
+    \brief Vessel table Test functions
+    \author Brian C. Lane <bcl@brianlane.com>
+
+*/
+
+
+/* Parse a single part sentence into msg */
+static int parse_sentence( char *str, aismsg_any *msg )
+{
+    ais_state state;
+    char      buf[100];
+
+    memset( &state, 0, sizeof( state ) );
+    strcpy( buf, str );
+    if( assemble_vdm( &state, buf ) != 0 )
+        return 1;
+    return parse_ais_any( &state, msg );
+}
+
+
+int test_vessel_update( void )
+{
+    vessel_table  table;
+    aismsg_any    msg;
+    ais_vessel    *v;
+    unsigned long pos;
+    int           n;
+
+    if( init_vessel_table( &table, 100 ) != 0 )
+    {
+        fprintf( stderr, "test_vessel_update() 1: failed\n" );
+        return 0;
+    }
+
+    /* 24A and 24B are merged */
+    parse_sentence( "!AIVDM,1,1,,A,H52IRsP518Tj0l59D0000000000,2*45\r\n", &msg );
+    if( (vessel_update( &table, &msg, 10 ) != 0) || !(v = vessel_find( &table, 338060014 ))
+        || (v->flags != AIS_VESSEL_NAME) || strcmp( v->name, "APRIL MARU@@@@@@@@@@" ) )
+    {
+        fprintf( stderr, "test_vessel_update() 2: failed\n" );
+        free_vessel_table( &table );
+        return 0;
+    }
+    parse_sentence( "!AIVDM,1,1,,A,H52IRsTU000000000000000@5120,0*76\r\n", &msg );
+    if(    (vessel_update( &table, &msg, 20 ) != 0) || !(v = vessel_find( &table, 338060014 ))
+        || (v->flags != (AIS_VESSEL_NAME | AIS_VESSEL_SHIP)) || strcmp( v->name, "APRIL MARU@@@@@@@@@@" )
+        || (v->ship_type != 37) || (v->dim_bow != 2) || (v->dim_stern != 5) || (v->dim_port != 1)
+        || (v->dim_starboard != 2) || (v->updated != 20) || (v->sog != 1023) || (table.count != 1) )
+    {
+        fprintf( stderr, "test_vessel_update() 3: failed\n" );
+        free_vessel_table( &table );
+        return 0;
+    }
+
+    /* A position report from another vessel */
+    parse_sentence( "!AIVDM,1,1,,B,19NS7Sp02wo?HETKA2K6mUM20<L=,0*27\r\n", &msg );
+    if(    (vessel_update( &table, &msg, 30 ) != 0) || !(v = vessel_find( &table, 636012431 ))
+        || (v->flags != AIS_VESSEL_POSITION) || (v->pos_msgid != 1) || (v->pos_time != 30)
+        || (v->latitude != msg.u.msg_1.latitude) || (v->longitude != msg.u.msg_1.longitude)
+        || (v->sog != msg.u.msg_1.sog) || (v->heading != msg.u.msg_1.true) )
+    {
+        fprintf( stderr, "test_vessel_update() 4: failed\n" );
+        free_vessel_table( &table );
+        return 0;
+    }
+
+    /* Message 27 is scaled to match */
+    memset( &msg, 0, sizeof( msg ) );
+    msg.msgid = 27;
+    msg.u.msg_27.userid = 636012431;
+    msg.u.msg_27.sog = 12;
+    msg.u.msg_27.cog = 511;
+    if(    (vessel_update( &table, &msg, 40 ) != 0) || (v->sog != 120) || (v->cog != 3600)
+        || (v->pos_msgid != 27) || (v->heading != 511) )
+    {
+        fprintf( stderr, "test_vessel_update() 5: failed\n" );
+        free_vessel_table( &table );
+        return 0;
+    }
+
+    /* Not used */
+    msg.msgid = 4;
+    if( (vessel_update( &table, &msg, 50 ) != 1) || vessel_find( &table, 1 ) || (table.updates != 4) )
+    {
+        fprintf( stderr, "test_vessel_update() 6: failed\n" );
+        free_vessel_table( &table );
+        return 0;
+    }
+
+    pos = 0;
+    n = 0;
+    while( vessel_next( &table, &pos ) )
+        n++;
+    if( n != 2 )
+    {
+        fprintf( stderr, "test_vessel_update() 7: failed\n" );
+        free_vessel_table( &table );
+        return 0;
+    }
+    free_vessel_table( &table );
+
+    fprintf( stderr, "test_vessel_update(): Passed\n" );
+    return 1;
+}
+
+
+int test_vessel_expire( void )
+{
+    vessel_table  table;
+    aismsg_any    msg;
+    ais_vessel    *v;
+    unsigned long i;
+
+    /* Fill it, so that there are long runs of collisions */
+    init_vessel_table( &table, 1000 );
+    memset( &msg, 0, sizeof( msg ) );
+    msg.msgid = 1;
+    for( i = 1; i <= 1100; i++ )
+    {
+        msg.u.msg_1.userid = 200000000 + i * 64;
+        if( vessel_update( &table, &msg, i ) != 0 )
+        {
+            fprintf( stderr, "test_vessel_expire() 1: failed %lu\n", i );
+            free_vessel_table( &table );
+            return 0;
+        }
+    }
+    if( (table.size != 2048) || (table.count != 1100) || (table.full != 0) )
+    {
+        fprintf( stderr, "test_vessel_expire() 2: failed %lu %lu\n", table.size, table.count );
+        free_vessel_table( &table );
+        return 0;
+    }
+
+    /* Odd ones are heard from again */
+    for( i = 1; i <= 1100; i += 2 )
+    {
+        msg.u.msg_1.userid = 200000000 + i * 64;
+        vessel_update( &table, &msg, 2000 );
+    }
+    if( (vessel_expire( &table, 2000, 100 ) != 550) || (table.count != 550) )
+    {
+        fprintf( stderr, "test_vessel_expire() 3: failed %lu\n", table.count );
+        free_vessel_table( &table );
+        return 0;
+    }
+
+    /* Everything left can still be found */
+    for( i = 1; i <= 1100; i++ )
+    {
+        v = vessel_find( &table, 200000000 + i * 64 );
+        if( (i & 1) ? (!v || (v->userid != 200000000 + i * 64)) : (v != NULL) )
+        {
+            fprintf( stderr, "test_vessel_expire() 4: failed %lu\n", i );
+            free_vessel_table( &table );
+            return 0;
+        }
+    }
+    free_vessel_table( &table );
+
+    /* New vessels are dropped once it is 3/4 full */
+    init_vessel_table( &table, 10 );
+    for( i = 1; i <= 12; i++ )
+    {
+        msg.u.msg_1.userid = i;
+        vessel_update( &table, &msg, 1 );
+    }
+    msg.u.msg_1.userid = 13;
+    if( (vessel_update( &table, &msg, 1 ) != 2) || (table.full != 1) || (table.count != 12) )
+    {
+        fprintf( stderr, "test_vessel_expire() 5: failed\n" );
+        free_vessel_table( &table );
+        return 0;
+    }
+    msg.u.msg_1.userid = 12;
+    if( vessel_update( &table, &msg, 2 ) != 0 )
+    {
+        fprintf( stderr, "test_vessel_expire() 6: failed\n" );
+        free_vessel_table( &table );
+        return 0;
+    }
+    free_vessel_table( &table );
+
+    fprintf( stderr, "test_vessel_expire(): Passed\n" );
+    return 1;
+}
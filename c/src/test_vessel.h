@@ -0,0 +1,13 @@
+/* -----------------------------------------------------------------------
+   Vessel table Test functions
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com
+   All Rights Reserved
+   ----------------------------------------------------------------------- */
+
+/*! \file
+    \brief Header file for test_vessel.c
+*/
+
+
+int test_vessel_update( void );
+int test_vessel_expire( void );
@@ -0,0 +1,334 @@
+/* -----------------------------------------------------------------------
+   Per vessel thinning of position reports
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>
+   All rights Reserved
+   ----------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "portable.h"
+#include "nmea.h"
+#include "sixbit.h"
+#include "vdm_parse.h"
+#include "mmsi_index.h"
+#include "thin.h"
+
+/*! \file
+    \brief Per vessel thinning of position reports
+    \author Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>, All Rights Reserved
+    \version 1.8
+
+    Class A vessels report every 2 to 10 seconds, more often than most
+    users of the positions need. An ais_thin keeps the last report it
+    passed on for each MMSI and drops the reports in between.
+
+    A report is passed on when:
+      - it is the vessel's first one
+      - interval seconds have gone by since the last one passed on
+      - min_interval seconds have gone by and the speed has changed by
+        sog_delta, the course by cog_delta, or the navigational status
+        has changed
+
+    Course changes are not looked at below cog_min_sog, the course of a
+    vessel that is stopped jumps around. Setting interval to 0 passes on
+    everything.
+
+    The state is a 16 byte record per vessel in a fixed size
+    mmsi_index hash. Call it where the reports are serialized, eg. in an
+    ais_pipeline callback, which is only called from one thread.
+
+    Example:
+    \code
+    void __stdcall got_record( ais_record *record, void *data )
+    {
+        if( ais_thin_check_msg( (ais_thin *) data, &record->msg, time( NULL ) ) )
+            return;
+        ... write it out
+    }
+
+    ais_thin thin;
+
+    init_ais_thin( &thin, 50000 );
+    thin.interval = 60;
+    init_ais_pipeline( &pipeline, got_record, &thin );
+    \endcode
+*/
+
+
+/* ----------------------------------------------------------------------- */
+/* The hash over the slots */
+/* ----------------------------------------------------------------------- */
+static void thin_index( ais_thin *thin, mmsi_index *index )
+{
+    init_mmsi_index( index, thin->slots, sizeof( thin_vessel ), sizeof( thin->slots->userid ), thin->size );
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Initialize thinning
+
+    \param thin pointer to the ais_thin
+    \param vessels number of vessels it must be able to hold
+
+    returns:
+      - 0 if no error
+      - 1 if there was an error with the parameters
+      - 2 if the slots could not be allocated
+
+    It is set up to pass on a report every 30 seconds, or after 5
+    seconds for a change of 1 knot, 10 degrees or the navigational
+    status. Change the settings afterwards.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall init_ais_thin( ais_thin *thin, unsigned long vessels )
+{
+    unsigned long size;
+
+    if( !thin || !vessels )
+        return 1;
+
+    memset( thin, 0, sizeof( ais_thin ) );
+
+    size = mmsi_index_size( vessels );
+    thin->slots = calloc( size, sizeof( thin_vessel ) );
+    if( !thin->slots )
+        return 2;
+    thin->size = size;
+
+    thin->interval = AIS_THIN_INTERVAL;
+    thin->min_interval = AIS_THIN_MIN_INTERVAL;
+    thin->sog_delta = 10;
+    thin->cog_delta = 100;
+    thin->cog_min_sog = 20;
+    thin->nav_status = 1;
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Free the slots of an ais_thin
+
+    \param thin pointer to the ais_thin
+*/
+/* ----------------------------------------------------------------------- */
+void __stdcall free_ais_thin( ais_thin *thin )
+{
+    if( !thin )
+        return;
+
+    free( thin->slots );
+    thin->slots = NULL;
+    thin->size = 0;
+    thin->count = 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Has the speed, course or status changed enough to pass it on */
+/* ----------------------------------------------------------------------- */
+static int thin_changed( ais_thin *thin, thin_vessel *v, int sog, int cog, int nav_status )
+{
+    int d;
+
+    if( thin->nav_status && (nav_status != v->nav_status) )
+        return 1;
+
+    if( thin->sog_delta )
+    {
+        if( (sog == 1023) != (v->sog == 1023) )
+            return 1;
+        d = sog - v->sog;
+        if( (sog != 1023) && ((d >= thin->sog_delta) || (-d >= thin->sog_delta)) )
+            return 1;
+    }
+
+    if( thin->cog_delta && (sog != 1023) && (sog >= thin->cog_min_sog) )
+    {
+        if( (cog >= 3600) != (v->cog >= 3600) )
+            return 1;
+        if( cog < 3600 )
+        {
+            /* The short way around */
+            d = (cog > v->cog) ? cog - v->cog : v->cog - cog;
+            if( d > 1800 )
+                d = 3600 - d;
+            if( d >= thin->cog_delta )
+                return 1;
+        }
+    }
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Check if a position report should be dropped
+
+    \param thin pointer to the ais_thin
+    \param userid MMSI of the vessel
+    \param sog speed over ground in 1/10 knot, 1023 = N/A
+    \param cog course over ground in 1/10 degree, 3600 = N/A
+    \param nav_status navigational status, 15 = N/A
+    \param now time of the report in seconds
+
+    returns:
+      - 1 if it should be dropped
+      - 0 if it should be passed on, or there was an error with the
+        parameters
+
+    Reports for new vessels are passed on when there is no room for
+    them. Reports older than the last one passed on for the vessel are
+    dropped.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall ais_thin_check( ais_thin *thin, unsigned long userid, int sog, int cog, int nav_status,
+                              unsigned long now )
+{
+    mmsi_index    index;
+    thin_vessel   *v;
+    int           elapsed;
+
+    if( !thin || !thin->slots || !userid )
+        return 0;
+
+    thin_index( thin, &index );
+    v = &thin->slots[mmsi_index_slot( &index, userid )];
+
+    if( v->userid )
+    {
+        /* Wraps around with the 32 bit time, negative for an older report */
+        elapsed = (int) ((unsigned int) now - v->time);
+        if(    (elapsed < 0)
+            || (   ((unsigned long) elapsed < thin->interval)
+                && (   ((unsigned long) elapsed < thin->min_interval)
+                    || !thin_changed( thin, v, sog, cog, nav_status ))) )
+        {
+            thin->dropped++;
+            return 1;
+        }
+    } else {
+        if( thin->count >= thin->size - thin->size / 4 )
+        {
+            thin->full++;
+            thin->passed++;
+            return 0;
+        }
+        v->userid = (unsigned int) userid;
+        thin->count++;
+    }
+
+    v->time = (unsigned int) now;
+    v->sog = (unsigned short) sog;
+    v->cog = (unsigned short) cog;
+    v->nav_status = (unsigned char) nav_status;
+    thin->passed++;
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Check if a position from parse_ais_position() should be dropped
+
+    \param thin pointer to the ais_thin
+    \param pos position report
+    \param now time of the report in seconds
+
+    Returns the same as ais_thin_check(). Fields that weren't parsed are
+    taken to be not available.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall ais_thin_check_pos( ais_thin *thin, aismsg_pos *pos, unsigned long now )
+{
+    if( !pos || !(pos->fields & AIS_FIELD_USERID) )
+        return 0;
+
+    return ais_thin_check( thin, pos->userid,
+                           (pos->fields & AIS_FIELD_SOG) ? pos->sog : 1023,
+                           (pos->fields & AIS_FIELD_COG) ? pos->cog : 3600,
+                           (pos->fields & AIS_FIELD_NAV_STATUS) ? pos->nav_status : 15, now );
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Check if a parsed message should be dropped
+
+    \param thin pointer to the ais_thin
+    \param msg message from parse_ais_any()
+    \param now time of the report in seconds
+
+    Returns the same as ais_thin_check(). Only messages 1, 2, 3, 18, 19
+    and 27 are thinned, 0 is returned for the others.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall ais_thin_check_msg( ais_thin *thin, aismsg_any *msg, unsigned long now )
+{
+    if( !msg )
+        return 0;
+
+    switch( msg->msgid )
+    {
+        case 1:
+            return ais_thin_check( thin, msg->u.msg_1.userid, msg->u.msg_1.sog, msg->u.msg_1.cog,
+                                   msg->u.msg_1.nav_status, now );
+        case 2:
+            return ais_thin_check( thin, msg->u.msg_2.userid, msg->u.msg_2.sog, msg->u.msg_2.cog,
+                                   msg->u.msg_2.nav_status, now );
+        case 3:
+            return ais_thin_check( thin, msg->u.msg_3.userid, msg->u.msg_3.sog, msg->u.msg_3.cog,
+                                   msg->u.msg_3.nav_status, now );
+        case 18:
+            return ais_thin_check( thin, msg->u.msg_18.userid, msg->u.msg_18.sog, msg->u.msg_18.cog,
+                                   15, now );
+        case 19:
+            return ais_thin_check( thin, msg->u.msg_19.userid, msg->u.msg_19.sog, msg->u.msg_19.cog,
+                                   15, now );
+        case 27:
+            return ais_thin_check( thin, msg->u.msg_27.userid, conv_sog27( msg->u.msg_27.sog ),
+                                   conv_cog27( msg->u.msg_27.cog ), msg->u.msg_27.nav_status, now );
+    }
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Has a vessel not had a report passed on for longer than age */
+/* ----------------------------------------------------------------------- */
+static int __stdcall thin_expired( void *slot, unsigned long now, unsigned long age )
+{
+    thin_vessel *v = (thin_vessel *) slot;
+    int         elapsed;
+
+    /* Wraps around with the 32 bit time, negative if updated after now */
+    elapsed = (int) ((unsigned int) now - v->time);
+    return (elapsed > 0) && ((unsigned long) elapsed > age);
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Forget vessels that haven't had a report passed on
+
+    \param thin pointer to the ais_thin
+    \param now current time
+    \param age time since the last report passed on
+
+    Returns the number of vessels removed. Their next report is passed
+    on.
+*/
+/* ----------------------------------------------------------------------- */
+unsigned long __stdcall ais_thin_expire( ais_thin *thin, unsigned long now, unsigned long age )
+{
+    mmsi_index    index;
+    unsigned long n;
+
+    if( !thin || !thin->slots )
+        return 0;
+
+    thin_index( thin, &index );
+    n = mmsi_index_expire( &index, now, age, thin_expired );
+    thin->count -= n;
+
+    return n;
+}
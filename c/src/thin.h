@@ -0,0 +1,56 @@
+/* -----------------------------------------------------------------------
+   Per vessel thinning of position reports
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>
+   All rights Reserved
+   ----------------------------------------------------------------------- */
+
+/*! \file
+    \brief Header file for thin.c
+
+    Requires nmea.h, sixbit.h and vdm_parse.h to be included first.
+*/
+
+/** Default longest time between reports passed on, in seconds */
+#define AIS_THIN_INTERVAL       30
+
+/** Default shortest time between reports passed on, in seconds */
+#define AIS_THIN_MIN_INTERVAL   5
+
+
+/** Last report passed on for one vessel, 16 bytes
+*/
+typedef struct {
+    unsigned int    userid;            //!< UserID / MMSI, 0 for an empty slot
+    unsigned int    time;              //!< Time it was passed on, low 32 bits
+    unsigned short  sog;               //!< Speed over ground in 1/10 knot, 1023 = N/A
+    unsigned short  cog;               //!< Course over ground in 1/10 degree, 3600 = N/A
+    unsigned char   nav_status;        //!< Navigational status, 15 = N/A
+} thin_vessel;
+
+
+/** Thinning settings and per vessel state, a fixed size hash keyed by MMSI
+*/
+typedef struct {
+    unsigned long   interval;          //!< Pass on a report at least this often, in seconds
+    unsigned long   min_interval;      //!< Never pass on reports closer together than this
+    int             sog_delta;         //!< Speed change in 1/10 knot that is passed on, 0 = off
+    int             cog_delta;         //!< Course change in 1/10 degree that is passed on, 0 = off
+    int             cog_min_sog;       //!< Course changes are ignored below this speed
+    unsigned char   nav_status;        //!< 1 to pass on navigational status changes
+    thin_vessel     *slots;            //!< size slots
+    unsigned long   size;              //!< Number of slots, a power of 2
+    unsigned long   count;             //!< Vessels in slots
+    unsigned long   passed;            //!< Reports passed on
+    unsigned long   dropped;           //!< Reports dropped
+    unsigned long   full;              //!< Reports passed on because slots was full
+} ais_thin;
+
+
+/* Prototypes */
+int __stdcall init_ais_thin( ais_thin *thin, unsigned long vessels );
+void __stdcall free_ais_thin( ais_thin *thin );
+int __stdcall ais_thin_check( ais_thin *thin, unsigned long userid, int sog, int cog, int nav_status,
+                              unsigned long now );
+int __stdcall ais_thin_check_pos( ais_thin *thin, aismsg_pos *pos, unsigned long now );
+int __stdcall ais_thin_check_msg( ais_thin *thin, aismsg_any *msg, unsigned long now );
+unsigned long __stdcall ais_thin_expire( ais_thin *thin, unsigned long now, unsigned long age );
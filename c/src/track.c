@@ -0,0 +1,464 @@
+/* -----------------------------------------------------------------------
+   Delta compressed vessel track history
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>
+   All rights Reserved
+   ----------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "portable.h"
+#include "nmea.h"
+#include "sixbit.h"
+#include "vdm_parse.h"
+#include "mmsi_index.h"
+#include "track.h"
+
+/*! \file
+    \brief Delta compressed vessel track history
+    \author Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>, All Rights Reserved
+    \version 1.8
+
+    A track_store keeps the recent track of each vessel for replay and
+    CPA. Keeping whole aismsg_1 structures costs around 80 bytes a fix,
+    here each fix after the first is stored as the difference from the
+    one before it: time, latitude, longitude, speed and course, each as
+    a zigzag encoded variable length integer of 7 bits per byte. A
+    vessel reporting every 10 seconds at 10 knots needs about 7 bytes a
+    fix.
+
+    Every vessel has a ring of track_store.ring_bytes bytes from one arena
+    allocated by init_track_store(). When a ring is full, or a fix is
+    older than track_store.max_age, the oldest fix is dropped by adding
+    its delta to the whole first fix kept in the track. The newest fix
+    is also kept whole so that appending doesn't need to read the ring.
+
+    track_iter_init() and track_iter_next() read a track from oldest to
+    newest.
+
+    Example:
+    \code
+    track_store store;
+    track_iter  iter;
+    aismsg_pos  pos;
+
+    init_track_store( &store, 10000, AIS_TRACK_BYTES );
+    store.max_age = 6 * 3600;
+    ...
+    if( parse_ais_position( &ais, AIS_FIELD_CORE, &pos ) == 0 )
+        track_append_pos( &store, &pos, time( NULL ) );
+    ...
+    track_iter_init( &store, track_find( &store, 366710810 ), &iter );
+    while( track_iter_next( &iter ) )
+        printf( "%lu %ld %ld\n", iter.fix.time, iter.fix.latitude, iter.fix.longitude );
+    \endcode
+*/
+
+
+/** Longest encoded delta, 5 values of up to 10 bytes */
+#define TRACK_DELTA_MAX  50
+
+
+/* ----------------------------------------------------------------------- */
+/* The hash from MMSI to track */
+/* ----------------------------------------------------------------------- */
+static void track_index( track_store *store, mmsi_index *index )
+{
+    init_mmsi_index( index, store->index, sizeof( mmsi_entry ), sizeof( store->index->userid ), store->index_size );
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Slot in the MMSI index of a vessel, or of the empty slot it would go in */
+/* ----------------------------------------------------------------------- */
+static unsigned long track_slot( track_store *store, unsigned long userid )
+{
+    mmsi_index index;
+
+    track_index( store, &index );
+
+    return mmsi_index_slot( &index, userid );
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Write a variable length unsigned value, returns the bytes used */
+/* ----------------------------------------------------------------------- */
+static unsigned int track_put( unsigned char *buf, unsigned long v )
+{
+    unsigned int n;
+
+    n = 0;
+    while( v >= 0x80 )
+    {
+        buf[n++] = (unsigned char) ((v & 0x7F) | 0x80);
+        v >>= 7;
+    }
+    buf[n++] = (unsigned char) v;
+
+    return n;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Write a signed value, small negative and positive values are short */
+/* ----------------------------------------------------------------------- */
+static unsigned int track_put_signed( unsigned char *buf, long v )
+{
+    return track_put( buf, (v < 0) ? ((unsigned long) (-(v + 1)) << 1) | 1 : (unsigned long) v << 1 );
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Read a variable length unsigned value from a ring */
+/* ----------------------------------------------------------------------- */
+static unsigned long track_get( const unsigned char *ring, unsigned int mask, unsigned int *pos )
+{
+    unsigned long v;
+    unsigned int  shift;
+    unsigned char c;
+
+    v = 0;
+    shift = 0;
+    do
+    {
+        c = ring[*pos & mask];
+        (*pos)++;
+        v |= (unsigned long) (c & 0x7F) << shift;
+        shift += 7;
+    } while( c & 0x80 );
+
+    return v;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Read a signed value from a ring */
+/* ----------------------------------------------------------------------- */
+static long track_get_signed( const unsigned char *ring, unsigned int mask, unsigned int *pos )
+{
+    unsigned long v;
+
+    v = track_get( ring, mask, pos );
+
+    return (v & 1) ? -(long) (v >> 1) - 1 : (long) (v >> 1);
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Add the delta at pos in a ring to fix, returns the offset after it */
+/* ----------------------------------------------------------------------- */
+static unsigned int track_apply( const unsigned char *ring, unsigned int mask, unsigned int pos, track_fix *fix )
+{
+    fix->time      += track_get( ring, mask, &pos );
+    fix->latitude  += track_get_signed( ring, mask, &pos );
+    fix->longitude += track_get_signed( ring, mask, &pos );
+    fix->sog       += (int) track_get_signed( ring, mask, &pos );
+    fix->cog       += (int) track_get_signed( ring, mask, &pos );
+
+    return pos;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Drop the oldest fix of a track, it must have more than one */
+/* ----------------------------------------------------------------------- */
+static void track_drop( track_store *store, ais_track *track )
+{
+    unsigned char *ring;
+    unsigned int  pos;
+
+    ring = store->arena + (track - store->tracks) * store->ring_bytes;
+    pos = track_apply( ring, store->ring_bytes - 1, track->tail, &track->first );
+
+    track->used -= pos - track->tail;
+    track->tail = pos & (store->ring_bytes - 1);
+    track->count--;
+    store->dropped++;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Initialize a track store
+
+    \param store pointer to the store
+    \param vessels number of vessels it must be able to hold
+    \param ring_bytes bytes of history per vessel, a power of 2 from 64
+                      to 65536, eg. #AIS_TRACK_BYTES
+
+    returns:
+      - 0 if no error
+      - 1 if there was an error with the parameters
+      - 2 if memory could not be allocated
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall init_track_store( track_store *store, unsigned long vessels, unsigned int ring_bytes )
+{
+    unsigned long i;
+
+    if(    !store || !vessels || (ring_bytes < 64) || (ring_bytes > 65536)
+        || (ring_bytes & (ring_bytes - 1)) )
+        return 1;
+
+    memset( store, 0, sizeof( track_store ) );
+    store->max = vessels;
+    store->ring_bytes = ring_bytes;
+
+    store->index_size = mmsi_index_size( vessels );
+
+    store->tracks = calloc( vessels, sizeof( ais_track ) );
+    store->arena = malloc( vessels * ring_bytes );
+    store->index = calloc( store->index_size, sizeof( mmsi_entry ) );
+    if( !store->tracks || !store->arena || !store->index )
+    {
+        free_track_store( store );
+        return 2;
+    }
+
+    for( i = 0; i < vessels; i++ )
+        store->tracks[i].next = (i + 1 < vessels) ? (long) (i + 1) : -1;
+    store->free = 0;
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Free the memory used by a track store
+
+    \param store pointer to the store
+*/
+/* ----------------------------------------------------------------------- */
+void __stdcall free_track_store( track_store *store )
+{
+    if( !store )
+        return;
+
+    free( store->tracks );
+    free( store->arena );
+    free( store->index );
+    store->tracks = NULL;
+    store->arena = NULL;
+    store->index = NULL;
+    store->count = 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Find the track of a vessel
+
+    \param store pointer to the store
+    \param userid MMSI of the vessel
+
+    Returns the vessel's track or NULL if it doesn't have one.
+*/
+/* ----------------------------------------------------------------------- */
+ais_track * __stdcall track_find( track_store *store, unsigned long userid )
+{
+    unsigned long i;
+
+    if( !store || !store->tracks || !userid )
+        return NULL;
+
+    i = track_slot( store, userid );
+
+    return store->index[i].userid ? &store->tracks[store->index[i].entry] : NULL;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Add a fix to the track of a vessel
+
+    \param store pointer to the store
+    \param userid MMSI of the vessel
+    \param fix the new position, speed and course
+
+    returns:
+      - 0 if no error
+      - 1 if there was an error with the parameters or the fix is older
+          than the newest one in the track
+      - 2 if it is a new vessel and the store is full
+
+    The vessel's oldest fixes are dropped to make room.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall track_append( track_store *store, unsigned long userid, track_fix *fix )
+{
+    ais_track     *track;
+    unsigned char delta[TRACK_DELTA_MAX];
+    unsigned char *ring;
+    unsigned long i;
+    unsigned int  len;
+    unsigned int  head;
+    unsigned int  n;
+    long          t;
+
+    if( !store || !store->tracks || !userid || !fix )
+        return 1;
+
+    i = track_slot( store, userid );
+    if( !store->index[i].userid )
+    {
+        if( store->free < 0 )
+        {
+            store->full++;
+            return 2;
+        }
+        t = store->free;
+        track = &store->tracks[t];
+        store->free = track->next;
+        store->index[i].userid = userid;
+        store->index[i].entry = t;
+        store->count++;
+
+        track->userid = userid;
+        track->first = *fix;
+        track->last = *fix;
+        track->count = 1;
+        track->tail = 0;
+        track->used = 0;
+        store->fixes++;
+        return 0;
+    }
+    t = store->index[i].entry;
+    track = &store->tracks[t];
+    if( fix->time < track->last.time )
+        return 1;
+
+    len  = track_put( delta, fix->time - track->last.time );
+    len += track_put_signed( delta + len, fix->latitude - track->last.latitude );
+    len += track_put_signed( delta + len, fix->longitude - track->last.longitude );
+    len += track_put_signed( delta + len, (long) (fix->sog - track->last.sog) );
+    len += track_put_signed( delta + len, (long) (fix->cog - track->last.cog) );
+
+    /* Make room */
+    while( (track->count > 1) && (track->used + len > store->ring_bytes) )
+        track_drop( store, track );
+
+    ring = store->arena + t * store->ring_bytes;
+    head = track->tail + track->used;
+    for( n = 0; n < len; n++ )
+        ring[(head + n) & (store->ring_bytes - 1)] = delta[n];
+    track->used += len;
+    track->last = *fix;
+    track->count++;
+    store->fixes++;
+
+    /* Drop anything too old */
+    while( store->max_age && (track->count > 1) && (fix->time - track->first.time > store->max_age) )
+        track_drop( store, track );
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Add a fix from a position report
+
+    \param store pointer to the store
+    \param pos result of parse_ais_position() with at least the
+               AIS_FIELD_USERID and AIS_FIELD_POSITION fields
+    \param now time the message was received
+
+    Returns the same as track_append(). Speed and course are N/A when pos
+    doesn't have them.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall track_append_pos( track_store *store, aismsg_pos *pos, unsigned long now )
+{
+    track_fix fix;
+
+    if( !pos || ((pos->fields & (AIS_FIELD_USERID | AIS_FIELD_POSITION)) != (AIS_FIELD_USERID | AIS_FIELD_POSITION)) )
+        return 1;
+
+    fix.time = now;
+    fix.latitude = pos->latitude;
+    fix.longitude = pos->longitude;
+    fix.sog = (pos->fields & AIS_FIELD_SOG) ? pos->sog : 1023;
+    fix.cog = (pos->fields & AIS_FIELD_COG) ? pos->cog : 3600;
+
+    return track_append( store, pos->userid, &fix );
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Remove the track of a vessel
+
+    \param store pointer to the store
+    \param userid MMSI of the vessel
+
+    returns:
+      - 0 if it was removed
+      - 1 if it didn't have a track
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall track_remove( track_store *store, unsigned long userid )
+{
+    mmsi_index    index;
+    unsigned long i;
+    long          t;
+
+    if( !store || !store->tracks || !userid )
+        return 1;
+
+    track_index( store, &index );
+    i = mmsi_index_slot( &index, userid );
+    if( !store->index[i].userid )
+        return 1;
+    t = store->index[i].entry;
+
+    store->tracks[t].userid = 0;
+    store->tracks[t].next = store->free;
+    store->free = t;
+    store->count--;
+
+    mmsi_index_remove( &index, i );
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Start reading a track
+
+    \param store pointer to the store
+    \param track track from track_find(), may be NULL
+    \param iter pointer to the position to set up
+
+    Call track_iter_next() to get each fix, starting with the oldest. The
+    track must not be changed while it is being read.
+*/
+/* ----------------------------------------------------------------------- */
+void __stdcall track_iter_init( track_store *store, ais_track *track, track_iter *iter )
+{
+    memset( iter, 0, sizeof( track_iter ) );
+    if( !store || !track || !track->userid )
+        return;
+
+    iter->ring = store->arena + (track - store->tracks) * store->ring_bytes;
+    iter->mask = store->ring_bytes - 1;
+    iter->pos = track->tail;
+    iter->count = track->count;
+    iter->left = track->count;
+    iter->fix = track->first;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Get the next fix of a track
+
+    \param iter pointer to a position from track_iter_init()
+
+    Returns 1 with the fix in iter->fix, or 0 when there are no more.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall track_iter_next( track_iter *iter )
+{
+    if( !iter->left )
+        return 0;
+
+    if( iter->left != iter->count )
+        iter->pos = track_apply( iter->ring, iter->mask, iter->pos, &iter->fix );
+    iter->left--;
+
+    return 1;
+}
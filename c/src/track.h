@@ -0,0 +1,83 @@
+/* -----------------------------------------------------------------------
+   Delta compressed vessel track history
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>
+   All rights Reserved
+   ----------------------------------------------------------------------- */
+
+/*! \file
+    \brief Header file for track.c
+
+    Requires nmea.h, sixbit.h, vdm_parse.h and mmsi_index.h to be included
+    first.
+*/
+
+/** Default number of bytes of history kept per vessel */
+#define AIS_TRACK_BYTES   1024
+
+
+/** One position fix, uncompressed
+*/
+typedef struct {
+    unsigned long   time;              //!< Time of the fix, in the caller's units
+    long            longitude;         //!< Longitude in 1/10000 minute
+    long            latitude;          //!< Latitude in 1/10000 minute
+    int             sog;               //!< Speed over ground in 1/10 knot, 1023 = N/A
+    int             cog;               //!< Course over ground in 1/10 degree, 3600 = N/A
+} track_fix;
+
+
+/** Track of one vessel
+
+    The oldest and newest fixes are kept whole, the ones after the
+    oldest are stored as deltas in the vessel's ring of the arena.
+*/
+typedef struct {
+    unsigned long   userid;            //!< UserID / MMSI, 0 for an unused track
+    track_fix       first;             //!< Oldest fix in the track
+    track_fix       last;              //!< Newest fix in the track
+    unsigned long   count;             //!< Number of fixes, including first
+    unsigned int    tail;              //!< Ring offset of the oldest delta
+    unsigned int    used;              //!< Bytes of the ring in use
+    long            next;              //!< Next unused track
+} ais_track;
+
+
+/** All of the tracks and the arena their rings are in
+*/
+typedef struct {
+    ais_track       *tracks;           //!< max tracks
+    unsigned char   *arena;            //!< max * ring_bytes bytes of deltas
+    unsigned long   max;               //!< Most vessels it can hold
+    unsigned int    ring_bytes;        //!< Bytes per vessel, a power of 2
+    unsigned long   max_age;           //!< Fixes older than this are dropped, 0 = only when the ring is full
+    unsigned long   count;             //!< Vessels with a track
+    long            free;              //!< First unused track, -1 when full
+    mmsi_entry      *index;            //!< MMSI to track hash
+    unsigned long   index_size;        //!< A power of 2
+    unsigned long   fixes;             //!< Fixes appended
+    unsigned long   dropped;           //!< Old fixes dropped to make room
+    unsigned long   full;              //!< New vessels dropped because it was full
+} track_store;
+
+
+/** Position in a track, for reading it from oldest to newest
+*/
+typedef struct {
+    const unsigned char *ring;         //!< The track's ring
+    unsigned int    mask;              //!< ring_bytes - 1
+    unsigned int    pos;               //!< Offset of the next delta
+    unsigned long   count;             //!< Fixes in the track
+    unsigned long   left;              //!< Fixes not read yet
+    track_fix       fix;               //!< The current fix
+} track_iter;
+
+
+/* Prototypes */
+int __stdcall init_track_store( track_store *store, unsigned long vessels, unsigned int ring_bytes );
+void __stdcall free_track_store( track_store *store );
+int __stdcall track_append( track_store *store, unsigned long userid, track_fix *fix );
+int __stdcall track_append_pos( track_store *store, aismsg_pos *pos, unsigned long now );
+ais_track * __stdcall track_find( track_store *store, unsigned long userid );
+int __stdcall track_remove( track_store *store, unsigned long userid );
+void __stdcall track_iter_init( track_store *store, ais_track *track, track_iter *iter );
+int __stdcall track_iter_next( track_iter *iter );
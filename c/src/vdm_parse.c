@@ -157,7 +157,7 @@
       - return 2 if there are < 20 bits to parse
 */
 /* ----------------------------------------------------------------------- */
-int __stdcall get_timetag( sixbit *state, timetag *datetime )
+int __stdcall get_timetag( sixbit_view *state, timetag *datetime )
 {
 	int	length;
 
@@ -166,14 +166,14 @@ int __stdcall get_timetag( sixbit *state, timetag *datetime )
     if ( !datetime )
         return 1;
 
-	length = sixbit_length(state);
+	length = sixbit_view_length(state);
     if ( length < 20 )
         return 2;
 
-	datetime->month   = (char) get_6bit( state, 4 );
-	datetime->day     = (char) get_6bit( state, 5 );
-	datetime->hours   = (char) get_6bit( state, 5 );
-	datetime->minutes = (char) get_6bit( state, 6 );
+	datetime->month   = (char) sixbit_view_get( state, 4 );
+	datetime->day     = (char) sixbit_view_get( state, 5 );
+	datetime->hours   = (char) sixbit_view_get( state, 5 );
+	datetime->minutes = (char) sixbit_view_get( state, 6 );
 
 	return 0;
 }
@@ -347,6 +347,54 @@ int __stdcall conv_pos27( long *latitude, long *longitude )
 }
 
 
+/* ----------------------------------------------------------------------- */
+/** Convert a Type 27 speed in whole knots to 1/10 knot
+
+    \param sog speed over ground from a message 27, 63 = N/A
+
+    Returns the speed in the units of message 1, 1023 = N/A.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall conv_sog27( int sog )
+{
+    return (sog == 63) ? 1023 : sog * 10;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Convert a Type 27 course in whole degrees to 1/10 degree
+
+    \param cog course over ground from a message 27, 511 = N/A
+
+    Returns the course in the units of message 1, 3600 = N/A.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall conv_cog27( int cog )
+{
+    return (cog == 511) ? 3600 : cog * 10;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Check the address field of a tokenized sentence for VDM or VDO
+
+    \param nmea pointer to a nmea_state filled in by nmea_tokenize()
+
+    return:
+      - 1 if it is an AIVDM/AIVDO sentence, from any device
+      - 0 if it is not
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall is_vdm( nmea_state *nmea )
+{
+    if( (nmea->num_fields == 0) || (nmea->field_len[0] < 5) )
+        return 0;
+
+    return (strncmp( nmea->field[0]+2, "VDM", 3 ) == 0)
+        || (strncmp( nmea->field[0]+2, "VDO", 3 ) == 0);
+}
+
+
 /* ----------------------------------------------------------------------- */
 /** Assemble AIVDM/VDO sentences
 
@@ -357,7 +405,12 @@ int __stdcall conv_pos27( long *latitude, long *longitude )
     some AIS messages, such as message 5, are output as a multipart VDM
     messages.
     This routine collects the 6-bit encoded data from these parts and
-    returns a 0 when all pieces have been reassembled.
+    returns a 0 when all pieces have been reassembled. The sentence is
+    split up by nmea_tokenize(), which also checks the checksum, and the
+    fields are handed to assemble_vdm_tokens(). The complete
+    payload is de-armored with sixbit_pack() before returning, a payload
+    with characters outside the 6-bit alphabet is rejected. The NMEA 4.0
+    tag blocks of the parts, if there are any, are combined in state->tag.
 
     It expects the sentences to:
       - Be in order, part 1, part 2, etc.
@@ -372,8 +425,9 @@ int __stdcall conv_pos27( long *latitude, long *longitude )
         - 1 Incomplete packet
         - 2 NMEA 0183 checksum failed
         - 3 Not an AIS message
-        - 4 Error with nmea_next_field
+        - 4 Error with the fields of the sentence
         - 5 Out of sequence packet
+        - 6 Invalid character in the 6-bit data
 
     Example:
     \code
@@ -400,62 +454,72 @@ int __stdcall conv_pos27( long *latitude, long *longitude )
 /* ----------------------------------------------------------------------- */
 int __stdcall assemble_vdm( ais_state *state, char *str )
 {
-    unsigned int  total;
-    unsigned int  num;
-    unsigned int  sequence;
-    unsigned int  *fields[3] = { &total, &num, &sequence };
-    char *p;
-    char *d;
-    unsigned char checksum;
-    unsigned int  i;
-    unsigned int length;
+    nmea_state  nmea;
+    int         rv;
 
+    rv = nmea_tokenize( &nmea, str );
 
     /* Is the string an AIS message? Allow any start character and any
        device pair.
     */
-    if ( (p = find_nmea_start( str )) == NULL )
-        return 3;
-    if (   (strncmp( p+3, "VDM", 3 ) != 0)
-        && (strncmp( p+3, "VDO", 3 ) != 0) )
-    {
-        /* Not an AIS message */
+    if( !is_vdm( &nmea ) )
         return 3;
-    }
 
     /* Check the string's checksum */
-    if (check_nmea_checksum( p, &checksum ) != 0 )
+    if( rv != 0 )
     {
         /* Checksum failed */
         return 2;
     }
 
-    /* Get the 3 message info values from the packet */
-    for (i=0; i<3; i++)
-    {
-        if ( (p = nmea_next_field( p )) == NULL )
-        {
-            /* Error with the string */
-            return 4;
-        }
-        /* Get an integer from the string */
-        *fields[i] = nmea_uint(p);
-    }
+    return assemble_vdm_tokens( state, &nmea );
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Assemble an AIVDM/VDO sentence that has already been tokenized
+
+    \param state pointer to ais_state
+    \param nmea pointer to a nmea_state filled in by nmea_tokenize()
+
+    This does the work of assemble_vdm(), using the fields found by
+    nmea_tokenize() instead of searching the sentence for them. The
+    checksum is not checked again, only pass sentences where
+    nmea_tokenize() returned 0. The return values are the same as for
+    assemble_vdm().
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall assemble_vdm_tokens( ais_state *state, nmea_state *nmea )
+{
+    unsigned int  total;
+    unsigned int  num;
+    unsigned int  sequence;
+    unsigned int  fill;
+    char          channel;
+
+    if( !is_vdm( nmea ) )
+        return 3;
 
-    /* Get the channel character */
-    if ( (p = nmea_next_field( p )) == NULL )
+    /* Need everything up to the 6-bit data */
+    if( nmea->num_fields < 6 )
     {
         /* Error with the string */
         return 4;
     }
 
+    /* Get the 3 message info values and the channel character */
+    total    = nmea_uint( nmea->field[1] );
+    num      = nmea_uint( nmea->field[2] );
+    sequence = nmea_uint( nmea->field[3] );
+    channel  = *nmea->field[4];
+
     /* Are we looking for more parts? */
     if (state->total > 0)
     {
         /* If the sequence doesn't match, or the number is not in
            order, or the channel doesn't match: reset and exit
         */
-        if( (state->sequence != sequence) || (state->num != num-1) || (state->channel != *p) )
+        if( (state->sequence != sequence) || (state->num != num-1) || (state->channel != channel) )
         {
             state->total = 0;
             state->sequence =0;
@@ -474,27 +538,24 @@ int __stdcall assemble_vdm( ais_state *state, char *str )
         state->total = total;
         state->num = num;
         state->sequence = sequence;
-        state->channel = *p;
+        state->channel = channel;
+        state->tag.flags = 0;
         init_6bit( &state->six_state );
     }
+    nmea_merge_tag( &state->tag, &nmea->tag );
 
-    /* Point to the 6-bit data */
-    if ( (p = nmea_next_field( p )) == NULL )
-    {
-        /* Error with the string */
-        return 4;
-    }
+    /* The fill bits come after the 6-bit data */
+    fill = (nmea->num_fields > 6) ? nmea_uint( nmea->field[6] ) : 0;
 
-    /* Copy the 6-bit ASCII field over to the sixbit_state buffer */
-    d = state->six_state.bits;
-    length = 0;
-    /* Find the end of the current string and count the number of bytes */
-    while( d && (*d != 0))
+    /* Append the 6-bit ASCII field to the sixbit_state buffer */
+    if( sixbit_append( &state->six_state, nmea->field[5], nmea->field_len[5], fill ) != 0 )
     {
-        length++;
-        d++;
+        /* Too much data, reset and exit */
+        state->total = 0;
+        state->sequence = 0;
+        state->num = 0;
+        return 4;
     }
-    nmea_copy_field( d, p, SIXBIT_LEN - length );
 
     /* Is this the last part of the sequence? */
     if ((total==0) || (state->total == num))
@@ -503,6 +564,13 @@ int __stdcall assemble_vdm( ais_state *state, char *str )
         state->num      = 0;
         state->sequence = 0;
 
+        /* De-armor the complete payload for fast field extraction */
+        if( sixbit_pack( &state->six_state ) != 0 )
+        {
+            /* Corrupt 6-bit data */
+            return 6;
+        }
+
         /* Found a complete packet */
         return 0;
     }
@@ -510,6 +578,318 @@ int __stdcall assemble_vdm( ais_state *state, char *str )
     return 1;
 }
 
+/* ----------------------------------------------------------------------- */
+/** Find the 6-bit data of a raw AIVDM/AIVDO sentence
+
+    \param str pointer to the NMEA 0183 sentence
+    \param total set to the total number of parts
+    \param num set to the part number
+    \param seq set to the sequence id, -1 if there isn't one
+    \param channel set to the channel character, 0 if there isn't one
+
+    returns:
+      - pointer to the first character of the 6-bit data
+      - NULL if it isn't a VDM/VDO sentence
+
+    Only the fields up to the 6-bit data are looked at and the checksum
+    is not checked.
+*/
+/* ----------------------------------------------------------------------- */
+static const char *vdm_peek_payload( const char *str, unsigned int *total, unsigned int *num, int *seq, char *channel )
+{
+    const char *p;
+
+    /* Skip a tag block and anything else before the start of the sentence */
+    p = str;
+    if( *p == '\\' )
+    {
+        p = strchr( p + 1, '\\' );
+        if( !p )
+            return NULL;
+    }
+    while( *p && (*p != '!') && (*p != '$') )
+        p++;
+    if( !*p )
+        return NULL;
+
+    /* Allow any start character and any device pair */
+    if( !p[1] || !p[2] )
+        return NULL;
+    if( (strncmp( p + 3, "VDM,", 4 ) != 0) && (strncmp( p + 3, "VDO,", 4 ) != 0) )
+        return NULL;
+    p += 7;
+
+    *total = 0;
+    while( (*p >= '0') && (*p <= '9') )
+        *total = *total * 10 + (*p++ - '0');
+    if( *p++ != ',' )
+        return NULL;
+
+    *num = 0;
+    while( (*p >= '0') && (*p <= '9') )
+        *num = *num * 10 + (*p++ - '0');
+    if( *p++ != ',' )
+        return NULL;
+
+    *seq = -1;
+    if( (*p >= '0') && (*p <= '9') )
+        *seq = *p++ - '0';
+    if( *p++ != ',' )
+        return NULL;
+
+    *channel = 0;
+    if( *p && (*p != ',') )
+        *channel = *p++;
+    if( *p++ != ',' )
+        return NULL;
+
+    return p;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Convert the start of the 6-bit data in a raw sentence to binary
+
+    \param payload pointer to the 6-bit data
+    \param len number of characters to convert
+    \param bits set to the bits, first character in the top bits
+
+    returns:
+      - 0 if no error
+      - 1 if the data is shorter than len or has an invalid character
+*/
+/* ----------------------------------------------------------------------- */
+static int vdm_peek_bits( const char *payload, unsigned int len, sixbit_word *bits )
+{
+    unsigned int   i;
+    unsigned char  c;
+
+    *bits = 0;
+    for( i = 0; i < len; i++ )
+    {
+        /* The ',' at the end of the data is not a valid character */
+        c = (unsigned char) binfrom6bit( payload[i] );
+        if( c > 0x3F )
+            return 1;
+        *bits = (*bits << 6) | c;
+    }
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Get the message id from a raw AIVDM/AIVDO sentence
+
+    \param str pointer to the NMEA 0183 sentence
+
+    returns:
+      - message id 0-63
+      - -1 if it isn't the first part of a VDM/VDO sentence
+
+    The message id is the first character of the 6-bit data, it is read
+    straight from the sentence without calling assemble_vdm(). Only the
+    first part of a multipart message has it. The checksum is not
+    checked.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall ais_peek_msgid( const char *str )
+{
+    const char    *payload;
+    unsigned int  total;
+    unsigned int  num;
+    int           seq;
+    char          channel;
+    sixbit_word   bits;
+
+    payload = vdm_peek_payload( str, &total, &num, &seq, &channel );
+    if( !payload || (num != 1) )
+        return -1;
+    if( vdm_peek_bits( payload, 1, &bits ) )
+        return -1;
+
+    return (int) bits;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Get the MMSI from a raw AIVDM/AIVDO sentence
+
+    \param str pointer to the NMEA 0183 sentence
+
+    returns:
+      - MMSI/userid of the message
+      - -1 if it isn't the first part of a VDM/VDO sentence
+
+    The userid is bits 8-37 of every AIS message, the first 7 characters
+    of the 6-bit data. They are read straight from the sentence without
+    calling assemble_vdm(). Only the first part of a multipart message has
+    them. The checksum is not checked.
+*/
+/* ----------------------------------------------------------------------- */
+long __stdcall ais_peek_mmsi( const char *str )
+{
+    const char    *payload;
+    unsigned int  total;
+    unsigned int  num;
+    int           seq;
+    char          channel;
+    sixbit_word   bits;
+
+    payload = vdm_peek_payload( str, &total, &num, &seq, &channel );
+    if( !payload || (num != 1) )
+        return -1;
+    if( vdm_peek_bits( payload, 7, &bits ) )
+        return -1;
+
+    /* 42 bits fetched, drop the 4 after the userid */
+    return (long) ((bits >> 4) & 0x3FFFFFFF);
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Initialize an ais_filter to accept everything
+
+    \param filter pointer to the filter
+
+    returns:
+      - 0 if no error
+      - 1 if there was an error
+
+    Set filter->msgids with AIS_MSGID() and point filter->mmsi at a sorted
+    list of MMSIs afterwards to limit what is accepted.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall init_ais_filter( ais_filter *filter )
+{
+    if( !filter )
+        return 1;
+
+    memset( filter, 0, sizeof( ais_filter ) );
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Check the 6-bit data of a first part against a filter
+
+    \param filter pointer to the filter
+    \param payload pointer to the 6-bit data
+
+    returns:
+      - 1 to keep the message
+      - 0 to drop it
+
+    Data too short to tell is kept so that assemble_vdm() can report it.
+*/
+/* ----------------------------------------------------------------------- */
+static int ais_filter_keep( ais_filter *filter, const char *payload )
+{
+    sixbit_word    bits;
+    unsigned long  mmsi;
+    unsigned int   lo;
+    unsigned int   hi;
+    unsigned int   mid;
+
+    if( filter->msgids )
+    {
+        if( vdm_peek_bits( payload, 1, &bits ) )
+            return 1;
+        if( !(filter->msgids & AIS_MSGID( (unsigned int) bits )) )
+            return 0;
+    }
+
+    if( filter->mmsi )
+    {
+        if( vdm_peek_bits( payload, 7, &bits ) )
+            return 1;
+        mmsi = (unsigned long) ((bits >> 4) & 0x3FFFFFFF);
+
+        /* Binary search of the sorted list */
+        lo = 0;
+        hi = filter->num_mmsi;
+        while( lo < hi )
+        {
+            mid = (lo + hi) / 2;
+            if( filter->mmsi[mid] < mmsi )
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        if( (lo == filter->num_mmsi) || (filter->mmsi[lo] != mmsi) )
+            return 0;
+    }
+
+    return 1;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Assemble AIVDM/VDO sentences that pass a filter
+
+    \param state pointer to ais_state
+    \param filter pointer to the filter
+    \param str pointer to the NMEA 0183 sentence
+
+    Returns the same values as assemble_vdm() and
+        - 7 Sentence dropped by the filter
+
+    The message id and MMSI of the first part of a message are checked
+    against the filter straight from the sentence, see ais_peek_msgid().
+    When the message is dropped nothing is copied into state. The
+    decision is remembered by channel and sequence id, and the remaining
+    parts of the message are dropped without looking at them.
+
+    Sentences that are passed on are checked by assemble_vdm() as usual.
+    The checksum of a dropped sentence is never checked.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall assemble_vdm_filtered( ais_state *state, ais_filter *filter, char *str )
+{
+    const char    *payload;
+    unsigned int  total;
+    unsigned int  num;
+    int           seq;
+    char          channel;
+    unsigned char *skip;
+
+    if( !filter )
+        return assemble_vdm( state, str );
+
+    /* Not a VDM/VDO sentence, let assemble_vdm() say so */
+    payload = vdm_peek_payload( str, &total, &num, &seq, &channel );
+    if( !payload )
+        return assemble_vdm( state, str );
+
+    skip = NULL;
+    if( (total > 1) && (seq >= 0) )
+        skip = &filter->skip[(channel == 'B') || (channel == '2')][seq];
+
+    if( num == 1 )
+    {
+        /* The first part decides for the whole message */
+        if( ais_filter_keep( filter, payload ) )
+        {
+            if( skip )
+                *skip = 0;
+        } else {
+            if( skip )
+                *skip = 1;
+            filter->rejected++;
+            return 7;
+        }
+    } else if( skip && *skip ) {
+        if( num >= total )
+            *skip = 0;
+        filter->rejected++;
+        return 7;
+    }
+
+    filter->accepted++;
+    return assemble_vdm( state, str );
+}
+
 
 /* ----------------------------------------------------------------------- */
 /** Parse an AIS message 1 into an aismsg_1 structure
@@ -535,7 +915,7 @@ int __stdcall parse_ais_1( ais_state *state, aismsg_1 *result )
     if( !result )
         return 1;
 
-    if (strlen(state->six_state.bits) != 28 )
+    if (sixbit_size( &state->six_state ) != 168)
     {
         return 2;
     }
@@ -597,7 +977,7 @@ int __stdcall parse_ais_2( ais_state *state, aismsg_2 *result )
     if( !result )
         return 1;
 
-    length = strlen(state->six_state.bits) * 6;
+    length = sixbit_size( &state->six_state );
     if( length != 168 )
         return 2;
 
@@ -656,7 +1036,7 @@ int __stdcall  parse_ais_3( ais_state *state, aismsg_3 *result )
     if( !result )
         return 1;
 
-    if (strlen(state->six_state.bits) != 28 )
+    if (sixbit_size( &state->six_state ) != 168)
         return 2;
 
     /* Clear out the structure first */
@@ -715,7 +1095,7 @@ int __stdcall  parse_ais_4( ais_state *state, aismsg_4 *result )
     if( !result )
         return 1;
 
-    if (strlen(state->six_state.bits) != 28)
+    if (sixbit_size( &state->six_state ) != 168)
         return 2;
 
     /* Clear out the structure first */
@@ -769,13 +1149,16 @@ int __stdcall  parse_ais_4( ais_state *state, aismsg_4 *result )
 int __stdcall  parse_ais_5( ais_state *state, aismsg_5 *result )
 {
     unsigned int i;
+    unsigned int length;
 
     if( !state )
         return 1;
     if( !result )
         return 1;
 
-    if (strlen(state->six_state.bits) != 71)
+    /* 424 bits, with or without the 2 fill bits */
+    length = sixbit_size( &state->six_state );
+    if( (length < 424) || (length > 426) )
         return 2;
 
     /* Clear out the structure first */
@@ -845,9 +1228,9 @@ int __stdcall  parse_ais_5( ais_state *state, aismsg_5 *result )
       - 1 if there is an error
       - 2 if there is a packet length error
 
-    Note: the binary payload of the message is left in its 6-bit ASCII
-          form when stored into result->data. This allows the data to
-          be passed to the sixbit module for parsing.
+    Note: result->data is a view of the binary payload of the message,
+          it is not copied. It can be passed to the Seaway and IMO
+          parsers until the next message is assembled into state.
 */
 /* ----------------------------------------------------------------------- */
 int __stdcall  parse_ais_6( ais_state *state, aismsg_6 *result )
@@ -859,7 +1242,7 @@ int __stdcall  parse_ais_6( ais_state *state, aismsg_6 *result )
     if( !result )
         return 1;
 
-    length = strlen(state->six_state.bits) * 6;
+    length = sixbit_size( &state->six_state );
     if( (length < 88) || (length > 1008) )
         return 2;
 
@@ -877,8 +1260,9 @@ int __stdcall  parse_ais_6( ais_state *state, aismsg_6 *result )
     result->spare        = (char)           get_6bit( &state->six_state, 1 );
     result->app_id       = (unsigned int)   get_6bit( &state->six_state, 16 );
 
-    /* Store the remaining payload of the packet for further processing */
-	result->data = state->six_state;
+    /* Keep a view of the remaining payload for further processing */
+    if( sixbit_view_init( &result->data, &state->six_state ) )
+        return 1;
 
     return 0;
 }
@@ -911,7 +1295,7 @@ int __stdcall  parse_ais_7( ais_state *state, aismsg_7 *result )
         return 1;
 
     /* Check the length of the packet */
-    length = strlen( state->six_state.bits ) * 6;
+    length = sixbit_size( &state->six_state );
     if( (length < 72) || (length > 168) )
         return 2;
 
@@ -964,9 +1348,9 @@ int __stdcall  parse_ais_7( ais_state *state, aismsg_7 *result )
      - 1 if there is an error
      - 2 if there is a packet length error
 
-    Note: the binary payload of the message is left in its 6-bit ASCII
-          form when stored into result->data. This allows the data to
-          be passed to the sixbit module for parsing.
+    Note: result->data is a view of the binary payload of the message,
+          it is not copied. It can be passed to the Seaway and IMO
+          parsers until the next message is assembled into state.
 */
 /* ----------------------------------------------------------------------- */
 int __stdcall  parse_ais_8( ais_state *state, aismsg_8 *result )
@@ -978,7 +1362,7 @@ int __stdcall  parse_ais_8( ais_state *state, aismsg_8 *result )
     if( !result )
         return 1;
 
-    length = strlen(state->six_state.bits) * 6;
+    length = sixbit_size( &state->six_state );
     if( (length < 56) || (length > 1008) )
         return 2;
 
@@ -993,8 +1377,9 @@ int __stdcall  parse_ais_8( ais_state *state, aismsg_8 *result )
     result->spare        = (char)           get_6bit( &state->six_state, 2 );
     result->app_id       = (unsigned int)   get_6bit( &state->six_state, 16 );
 
-    /* Store the remaining payload of the packet for further processing */
-	result->data = state->six_state;
+    /* Keep a view of the remaining payload for further processing */
+    if( sixbit_view_init( &result->data, &state->six_state ) )
+        return 1;
 
     return 0;
 }
@@ -1024,7 +1409,7 @@ int __stdcall  parse_ais_9( ais_state *state, aismsg_9 *result )
     if( !result )
         return 1;
 
-    if (strlen(state->six_state.bits) != 28)
+    if (sixbit_size( &state->six_state ) != 168)
         return 2;
 
     /* Clear out the structure first */
@@ -1089,7 +1474,7 @@ int __stdcall  parse_ais_10( ais_state *state, aismsg_10 *result )
     if( !result )
         return 1;
 
-    if (strlen(state->six_state.bits) != 12)
+    if (sixbit_size( &state->six_state ) != 72)
         return 2;
 
     /* Clear out the structure first */
@@ -1129,7 +1514,7 @@ int __stdcall  parse_ais_11( ais_state *state, aismsg_11 *result )
     if( !result )
         return 1;
 
-    if (strlen(state->six_state.bits) != 28)
+    if (sixbit_size( &state->six_state ) != 168)
         return 2;
 
     /* Clear out the structure first */
@@ -1191,7 +1576,7 @@ int __stdcall  parse_ais_12( ais_state *state, aismsg_12 *result )
     if( !result )
         return 1;
 
-    length = strlen(state->six_state.bits) * 6;
+    length = sixbit_size( &state->six_state );
     if( (length < 72) || (length > 1008) )
         return 2;
 
@@ -1249,7 +1634,7 @@ int __stdcall  parse_ais_13( ais_state *state, aismsg_13 *result )
         return 1;
 
     /* Check the length of the packet */
-    length = strlen( state->six_state.bits ) * 6;
+    length = sixbit_size( &state->six_state );
     if( (length < 72) || (length > 168) )
         return 2;
 
@@ -1316,7 +1701,7 @@ int __stdcall  parse_ais_14( ais_state *state, aismsg_14 *result )
     if( !result )
         return 1;
 
-    length = strlen(state->six_state.bits) * 6;
+    length = sixbit_size( &state->six_state );
     if( (length < 40) || (length > 1008) )
         return 2;
 
@@ -1370,7 +1755,7 @@ int __stdcall  parse_ais_15( ais_state *state, aismsg_15 *result )
         return 1;
 
     /* Check the length of the packet */
-    length = strlen( state->six_state.bits ) * 6;
+    length = sixbit_size( &state->six_state );
     if( (length < 88) || (length > 162) )
         return 2;
 
@@ -1388,14 +1773,14 @@ int __stdcall  parse_ais_15( ais_state *state, aismsg_15 *result )
     result->offset1_1    = (int)            get_6bit( &state->six_state, 12 );
     result->num_reqs     = 1;
 
-    if( length > 88 )
+    if( length >= 108 )
     {
         result->spare2    = (char)  get_6bit( &state->six_state, 2 );
         result->msgid1_2  = (char)  get_6bit( &state->six_state, 6  );
         result->offset1_2 = (int)   get_6bit( &state->six_state, 12 );
         result->num_reqs  = 2;
     }
-    if( length == 160 )
+    if( length >= 160 )
     {
         result->spare3    = (char)          get_6bit( &state->six_state, 2  );
         result->destid2   = (unsigned long) get_6bit( &state->six_state, 30 );
@@ -1436,7 +1821,7 @@ int __stdcall  parse_ais_16( ais_state *state, aismsg_16 *result )
         return 1;
 
     /* Check the length of the packet */
-    length = strlen( state->six_state.bits ) * 6;
+    length = sixbit_size( &state->six_state );
     if( (length != 96) && (length != 144) )
         return 2;
 
@@ -1480,9 +1865,9 @@ int __stdcall  parse_ais_16( ais_state *state, aismsg_16 *result )
       - 1 if there is an error
       - 2 if there is a packet length error
 
-    Note: the binary payload of the message is left in its 6-bit ASCII
-          form when stored into result->data. This allows the data to
-          be passed to the sixbit module for parsing.
+    Note: result->data is a view of the binary payload of the message,
+          it is not copied. It can be passed to the Seaway and IMO
+          parsers until the next message is assembled into state.
 */
 /* ----------------------------------------------------------------------- */
 int __stdcall  parse_ais_17( ais_state *state, aismsg_17 *result )
@@ -1494,7 +1879,7 @@ int __stdcall  parse_ais_17( ais_state *state, aismsg_17 *result )
     if( !result )
         return 1;
 
-    length = strlen(state->six_state.bits) * 6;
+    length = sixbit_size( &state->six_state );
     if( (length < 80) || (length > 816) )
         return 2;
 
@@ -1517,8 +1902,9 @@ int __stdcall  parse_ais_17( ais_state *state, aismsg_17 *result )
     result->num_words    = (char)           get_6bit( &state->six_state, 5  );
     result->health       = (char)           get_6bit( &state->six_state, 3  );
 
-    /* Store the remaining payload of the packet for further processing */
-	result->data = state->six_state;
+    /* Keep a view of the remaining payload for further processing */
+    if( sixbit_view_init( &result->data, &state->six_state ) )
+        return 1;
 
     /* Convert the position to signed value */
     conv_pos( &result->latitude, &result->longitude);
@@ -1551,7 +1937,7 @@ int __stdcall  parse_ais_18( ais_state *state, aismsg_18 *result )
     if( !result )
         return 1;
 
-    if (strlen(state->six_state.bits) != 28)
+    if (sixbit_size( &state->six_state ) != 168)
         return 2;
 
     /* Clear out the structure first */
@@ -1626,7 +2012,7 @@ int __stdcall  parse_ais_19( ais_state *state, aismsg_19 *result )
     if( !result )
         return 1;
 
-    if (strlen(state->six_state.bits) != 52)
+    if (sixbit_size( &state->six_state ) != 312)
         return 2;
 
     /* Clear out the structure first */
@@ -1699,7 +2085,7 @@ int __stdcall  parse_ais_20( ais_state *state, aismsg_20 *result )
     if( !result )
         return 1;
 
-    length = strlen(state->six_state.bits) * 6;
+    length = sixbit_size( &state->six_state );
     if( (length < 72) || (length > 162) )
         return 2;
 
@@ -1777,7 +2163,7 @@ int __stdcall  parse_ais_21( ais_state *state, aismsg_21 *result )
     if( !result )
         return 1;
 
-    length = strlen(state->six_state.bits) * 6;
+    length = sixbit_size( &state->six_state );
     if( (length < 272) || (length > 360) )
         return 2;
 
@@ -1863,7 +2249,7 @@ int __stdcall  parse_ais_22( ais_state *state, aismsg_22 *result )
     if( !result )
         return 1;
 
-    if (strlen(state->six_state.bits) != 28)
+    if (sixbit_size( &state->six_state ) != 168)
         return 2;
 
     /* Clear out the structure first */
@@ -1937,7 +2323,7 @@ int __stdcall  parse_ais_23( ais_state *state, aismsg_23 *result )
     if( !result )
         return 1;
 
-    if (strlen(state->six_state.bits) != 28)
+    if (sixbit_size( &state->six_state ) != 168)
         return 2;
 
     /* Clear out the structure first */
@@ -2020,8 +2406,9 @@ int __stdcall  parse_ais_24( ais_state *state, aismsg_24 *result )
     if( !result )
         return 1;
 
-    length = strlen(state->six_state.bits) * 6;
-    if( (length != 162) && (length != 168) )
+    /* Part A is 160 bits, with or without the 2 fill bits */
+    length = sixbit_size( &state->six_state );
+    if( (length != 160) && (length != 162) && (length != 168) )
         return 2;
 
     result->msgid = state->msgid;
@@ -2101,7 +2488,7 @@ int __stdcall parse_ais_27( ais_state *state, aismsg_27 *result )
     int length;
     //Length according to ITU-1374 is 96 bits. However, in the wild these are sometimes transmitted with 168 bits (a full slot).
     //Robust decoders should warn when this occurs but decode the first 96 bits.
-    length = strlen(state->six_state.bits) * 6;
+    length = sixbit_size( &state->six_state );
     if( (length < 96) || (length > 168) )
             return 2;
 
@@ -2130,3 +2517,280 @@ int __stdcall parse_ais_27( ais_state *state, aismsg_27 *result )
 
     return 0;
 }
+
+
+/* ----------------------------------------------------------------------- */
+/* Wrappers so that every parser can be called through the same table */
+/* ----------------------------------------------------------------------- */
+#define ANY_PARSER(n) \
+static int __stdcall parse_any_##n( ais_state *state, aismsg_any *result ) \
+{ \
+    return parse_ais_##n( state, &result->u.msg_##n ); \
+}
+
+ANY_PARSER(1)  ANY_PARSER(2)  ANY_PARSER(3)  ANY_PARSER(4)  ANY_PARSER(5)
+ANY_PARSER(6)  ANY_PARSER(7)  ANY_PARSER(8)  ANY_PARSER(9)  ANY_PARSER(10)
+ANY_PARSER(11) ANY_PARSER(12) ANY_PARSER(13) ANY_PARSER(14) ANY_PARSER(15)
+ANY_PARSER(16) ANY_PARSER(17) ANY_PARSER(18) ANY_PARSER(19) ANY_PARSER(20)
+ANY_PARSER(21) ANY_PARSER(22) ANY_PARSER(23) ANY_PARSER(27)
+
+/* The parts of a message 24 are put together in the state */
+static int __stdcall parse_any_24( ais_state *state, aismsg_any *result )
+{
+    int rv;
+
+    /* Start a new message 24 unless this is the other part */
+    if( state->msg_24.userid != get_bits( &state->six_state, 8, 30 ) )
+        memset( &state->msg_24, 0, sizeof( aismsg_24 ) );
+
+    rv = parse_ais_24( state, &state->msg_24 );
+    result->u.msg_24 = state->msg_24;
+
+    return rv;
+}
+
+/** Parser for each message id, NULL if it isn't supported */
+static int (__stdcall *any_parsers[64])( ais_state *, aismsg_any * ) = {
+    NULL,         parse_any_1,  parse_any_2,  parse_any_3,
+    parse_any_4,  parse_any_5,  parse_any_6,  parse_any_7,
+    parse_any_8,  parse_any_9,  parse_any_10, parse_any_11,
+    parse_any_12, parse_any_13, parse_any_14, parse_any_15,
+    parse_any_16, parse_any_17, parse_any_18, parse_any_19,
+    parse_any_20, parse_any_21, parse_any_22, parse_any_23,
+    parse_any_24, NULL,         NULL,         parse_any_27
+};
+
+
+/* ----------------------------------------------------------------------- */
+/** Parse any AIS message into an aismsg_any structure
+
+    \param state    pointer to ais_state
+    \param result   pointer to the result structure to be filled
+
+    return:
+      - 0 if no errors
+      - 1 if there is an error
+      - 2 if there is a packet length error
+      - 3 if a message 24 has an unknown part number
+      - 4 if the message id is not supported
+
+    Call this right after assemble_vdm() returns 0, it fetches the message
+    id itself and stores it in state->msgid and result->msgid. The
+    message is then parsed into the matching member of result->u by the
+    parse_ais_N() function for that id, found with a table lookup.
+
+    The parts of a message 24 are combined in state->msg_24 as long as
+    they are for the same MMSI, and copied to result->u.msg_24. result
+    doesn't need to be cleared first, and the parts don't need to be
+    parsed into the same result.
+
+    Example:
+    \code
+    ais_state  state;
+    aismsg_any msg;
+
+    memset( &state, 0, sizeof( state ) );
+    if( (assemble_vdm( &state, buf ) == 0) && (parse_ais_any( &state, &msg ) == 0) )
+    {
+        switch( msg.msgid )
+        {
+            case 1:
+                printf( "%ld\n", msg.u.msg_1.userid );
+                break;
+            ...
+        }
+    }
+    \endcode
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall parse_ais_any( ais_state *state, aismsg_any *result )
+{
+    unsigned char msgid;
+
+    if( !state )
+        return 1;
+    if( !result )
+        return 1;
+
+    msgid = (unsigned char) get_6bit( &state->six_state, 6 );
+    state->msgid = msgid;
+
+    if( !any_parsers[msgid] )
+    {
+        result->msgid = msgid;
+        return 4;
+    }
+
+    result->msgid = msgid;
+
+    return any_parsers[msgid]( state, result );
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Where the fields of each position report are, for parse_ais_position()
+   A bits of 0 means the message doesn't have that field.
+*/
+/* ----------------------------------------------------------------------- */
+typedef struct {
+    unsigned char   offset;            //!< Bit offset from start of the payload
+    unsigned char   bits;              //!< Size of the field in bits
+} pos_field;
+
+typedef struct {
+    unsigned short  min_len;           //!< Smallest payload in bits, 0 if not a position report
+    unsigned short  max_len;           //!< Largest payload in bits
+    pos_field       nav_status;
+    pos_field       sog;
+    pos_field       pos_acc;
+    pos_field       longitude;
+    pos_field       latitude;
+    pos_field       cog;
+    pos_field       true;
+    pos_field       utc_sec;
+} pos_layout;
+
+#define POS_NONE        { 0, 0, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0} }
+#define POS_CLASS_A     { 168, 168, {38,4}, {50,10}, {60,1}, {61,28}, {89,27}, {116,12}, {128,9}, {137,6} }
+#define POS_CLASS_B(n)  { n, n, {0,0}, {46,10}, {56,1}, {57,28}, {85,27}, {112,12}, {124,9}, {133,6} }
+#define POS_LONG_RANGE  { 96, 168, {40,4}, {79,6}, {38,1}, {44,18}, {62,17}, {85,9}, {0,0}, {0,0} }
+
+/** Layout of each message id, the same as parse_ais_1(), 2, 3, 18, 19 and 27 */
+static const pos_layout pos_layouts[28] = {
+    POS_NONE,     POS_CLASS_A,  POS_CLASS_A,  POS_CLASS_A,
+    POS_NONE,     POS_NONE,     POS_NONE,     POS_NONE,
+    POS_NONE,     POS_NONE,     POS_NONE,     POS_NONE,
+    POS_NONE,     POS_NONE,     POS_NONE,     POS_NONE,
+    POS_NONE,     POS_NONE,     POS_CLASS_B(168), POS_CLASS_B(312),
+    POS_NONE,     POS_NONE,     POS_NONE,     POS_NONE,
+    POS_NONE,     POS_NONE,     POS_NONE,     POS_LONG_RANGE
+};
+
+
+/* ----------------------------------------------------------------------- */
+/** Parse selected fields of a position report into an aismsg_pos structure
+
+    \param state    pointer to ais_state
+    \param fields   AIS_FIELD_* flags of the fields to fetch
+    \param result   pointer to the result structure to be filled
+
+    return:
+      - 0 if no errors
+      - 1 if there is an error
+      - 2 if there is a packet length error
+      - 4 if the message is not a position report
+
+    This is a faster way to get at the position of messages 1, 2, 3, 18,
+    19 and 27 than calling their parse_ais_N() functions. Only the
+    requested fields are fetched, each one straight from its offset in
+    the packed payload with get_bits(), and the rest of the message is
+    skipped. The message id is fetched too, so it doesn't matter if
+    get_6bit() has already been used on the message.
+
+    result->fields is set to the requested fields that the message has,
+    message 27 has no heading or UTC seconds and only messages 1, 2, 3
+    and 27 have a navigational status. The latitude and longitude are
+    converted to signed values. Message 27's position, speed and course
+    are scaled to the same units as the other messages.
+
+    Example:
+    \code
+    ais_state  state;
+    aismsg_pos pos;
+
+    if(    (assemble_vdm( &state, buf ) == 0)
+        && (parse_ais_position( &state, AIS_FIELD_CORE, &pos ) == 0) )
+    {
+        pos2ddd( pos.latitude, pos.longitude, &lat_dd, &long_ddd );
+        ...
+    }
+    \endcode
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall parse_ais_position( ais_state *state, unsigned int fields, aismsg_pos *result )
+{
+    const pos_layout *layout;
+    sixbit           *six;
+    unsigned int     length;
+    unsigned char    msgid;
+
+    if( !state )
+        return 1;
+    if( !result )
+        return 1;
+
+    six = &state->six_state;
+    msgid = (unsigned char) get_bits( six, 0, 6 );
+    state->msgid = msgid;
+    result->msgid = msgid;
+    result->fields = 0;
+
+    if( (msgid >= 28) || !pos_layouts[msgid].min_len )
+        return 4;
+    layout = &pos_layouts[msgid];
+
+    length = sixbit_size( six );
+    if( (length < layout->min_len) || (length > layout->max_len) )
+        return 2;
+
+    if( fields & AIS_FIELD_USERID )
+    {
+        result->userid = get_bits( six, 8, 30 );
+        result->fields |= AIS_FIELD_USERID;
+    }
+
+    if( fields & AIS_FIELD_POSITION )
+    {
+        result->longitude = (long) get_bits( six, layout->longitude.offset, layout->longitude.bits );
+        result->latitude  = (long) get_bits( six, layout->latitude.offset, layout->latitude.bits );
+        if( msgid == 27 )
+            conv_pos27( &result->latitude, &result->longitude );
+        else
+            conv_pos( &result->latitude, &result->longitude );
+        result->fields |= AIS_FIELD_POSITION;
+    }
+
+    if( fields & AIS_FIELD_SOG )
+    {
+        result->sog = (int) get_bits( six, layout->sog.offset, layout->sog.bits );
+
+        if( msgid == 27 )
+            result->sog = conv_sog27( result->sog );
+        result->fields |= AIS_FIELD_SOG;
+    }
+
+    if( fields & AIS_FIELD_COG )
+    {
+        result->cog = (int) get_bits( six, layout->cog.offset, layout->cog.bits );
+
+        if( msgid == 27 )
+            result->cog = conv_cog27( result->cog );
+        result->fields |= AIS_FIELD_COG;
+    }
+
+    if( (fields & AIS_FIELD_HEADING) && layout->true.bits )
+    {
+        result->true = (int) get_bits( six, layout->true.offset, layout->true.bits );
+        result->fields |= AIS_FIELD_HEADING;
+    }
+
+    if( (fields & AIS_FIELD_NAV_STATUS) && layout->nav_status.bits )
+    {
+        result->nav_status = (char) get_bits( six, layout->nav_status.offset, layout->nav_status.bits );
+        result->fields |= AIS_FIELD_NAV_STATUS;
+    }
+
+    if( fields & AIS_FIELD_POS_ACC )
+    {
+        result->pos_acc = (char) get_bits( six, layout->pos_acc.offset, layout->pos_acc.bits );
+        result->fields |= AIS_FIELD_POS_ACC;
+    }
+
+    if( (fields & AIS_FIELD_UTC_SEC) && layout->utc_sec.bits )
+    {
+        result->utc_sec = (char) get_bits( six, layout->utc_sec.offset, layout->utc_sec.bits );
+        result->fields |= AIS_FIELD_UTC_SEC;
+    }
+
+    return 0;
+}
@@ -151,7 +151,7 @@ typedef struct {
     char            retransmit;        //!< 1 bit    : Retransmit
     char            spare;             //!< 1 bit    : Spare
     unsigned int    app_id;            //!< 16 bits  : Application ID
-    sixbit          data;              //!< 960 bits : Data payload
+    sixbit_view     data;              //!< 960 bits : Data payload, a view into ais_state.six_state
 } aismsg_6 ;
 
 
@@ -182,7 +182,7 @@ typedef struct {
     unsigned long   userid;            //!< 30 bits  : UserID / MMSI
     char            spare;             //!< 2 bits   : Spare
     unsigned int    app_id;            //!< 16 bits  : Application ID
-    sixbit          data;              //!< 952 bits : Data payload
+    sixbit_view     data;              //!< 952 bits : Data payload, a view into ais_state.six_state
 } aismsg_8;
 
 
@@ -355,7 +355,7 @@ typedef struct {
     char            seq_num;           //!< 3 bits   : Sequence Number
     char            num_words;         //!< 5 bits   : Number of Data Words
     char            health;            //!< 3 bits   : Reference Station Health from M.823
-    sixbit          data;              //!< 0-696 bits  : Data payload
+    sixbit_view     data;              //!< 0-696 bits  : Data payload, a view into ais_state.six_state
 } aismsg_17;
 
 
@@ -584,6 +584,79 @@ typedef struct {
 } aismsg_27;
 
 
+/** Any AIS message
+
+    Filled in by parse_ais_any(), msgid says which member of u holds the
+    message.
+*/
+typedef struct {
+    unsigned char   msgid;             //!< Message ID of the message in u
+    union {
+        aismsg_1   msg_1;     //!< Message 1
+        aismsg_2   msg_2;     //!< Message 2
+        aismsg_3   msg_3;     //!< Message 3
+        aismsg_4   msg_4;     //!< Message 4
+        aismsg_5   msg_5;     //!< Message 5
+        aismsg_6   msg_6;     //!< Message 6
+        aismsg_7   msg_7;     //!< Message 7
+        aismsg_8   msg_8;     //!< Message 8
+        aismsg_9   msg_9;     //!< Message 9
+        aismsg_10  msg_10;    //!< Message 10
+        aismsg_11  msg_11;    //!< Message 11
+        aismsg_12  msg_12;    //!< Message 12
+        aismsg_13  msg_13;    //!< Message 13
+        aismsg_14  msg_14;    //!< Message 14
+        aismsg_15  msg_15;    //!< Message 15
+        aismsg_16  msg_16;    //!< Message 16
+        aismsg_17  msg_17;    //!< Message 17
+        aismsg_18  msg_18;    //!< Message 18
+        aismsg_19  msg_19;    //!< Message 19
+        aismsg_20  msg_20;    //!< Message 20
+        aismsg_21  msg_21;    //!< Message 21
+        aismsg_22  msg_22;    //!< Message 22
+        aismsg_23  msg_23;    //!< Message 23
+        aismsg_24  msg_24;    //!< Message 24
+        aismsg_27  msg_27;    //!< Message 27
+    } u;
+} aismsg_any;
+
+
+/** Fields of a position report, for parse_ais_position() */
+#define AIS_FIELD_USERID        0x0001  //!< userid
+#define AIS_FIELD_POSITION      0x0002  //!< latitude and longitude
+#define AIS_FIELD_SOG           0x0004  //!< sog
+#define AIS_FIELD_COG           0x0008  //!< cog
+#define AIS_FIELD_HEADING       0x0010  //!< true
+#define AIS_FIELD_NAV_STATUS    0x0020  //!< nav_status
+#define AIS_FIELD_POS_ACC       0x0040  //!< pos_acc
+#define AIS_FIELD_UTC_SEC       0x0080  //!< utc_sec
+
+/** The fields most tracking applications need */
+#define AIS_FIELD_CORE          (AIS_FIELD_USERID | AIS_FIELD_POSITION | AIS_FIELD_SOG | AIS_FIELD_COG | AIS_FIELD_HEADING)
+#define AIS_FIELD_ALL           0x00FF
+
+
+/** Position core of messages 1, 2, 3, 18, 19 and 27
+
+    Filled in by parse_ais_position(). Only the fields flagged in
+    fields have been set, the rest are left as they were. Message 27
+    values are scaled to match the other messages.
+*/
+typedef struct {
+    char            msgid;             //!< Message ID
+    unsigned int    fields;            //!< AIS_FIELD_* flags of the fields that were set
+    unsigned long   userid;            //!< UserID / MMSI
+    long            longitude;         //!< Longitude in 1/10000 minute
+    long            latitude;          //!< Latitude in 1/10000 minute
+    int             sog;               //!< Speed Over Ground in 1/10 knot, 1023 = N/A
+    int             cog;               //!< Course over Ground in 1/10 degree, 3600 = N/A
+    int             true;              //!< True Heading, 511 = N/A
+    char            nav_status;        //!< Navigational Status
+    char            pos_acc;           //!< Position Accuracy
+    char            utc_sec;           //!< UTC Seconds
+} aismsg_pos;
+
+
 /** ETA, Seaway and IMO UTC Timetag
 */
 typedef struct {
@@ -608,10 +681,33 @@ typedef struct {
     unsigned int  total;               //!< Total # of parts for the message
     unsigned int  num;                 //!< Number of the last part stored
     char          channel;             //!< AIS Channel character
+    nmea_tag      tag;                 //!< Tag block metadata from all the parts
     sixbit        six_state;           //!< sixbit parser state
+    aismsg_24     msg_24;              //!< Parts of the last message 24 from parse_ais_any()
 } ais_state;
 
 
+/** Bit for a message id in ais_filter.msgids */
+#define AIS_MSGID(n)    ((sixbit_word) 1 << (n))
+
+/* ------------------------------------------------------------------------ */
+/** ais_filter decides which sentences assemble_vdm_filtered() passes on
+
+    A message is kept if its id is in msgids and its MMSI is in mmsi.
+    Leave either one 0 to accept all of them. The first part of a
+    multipart message decides for the rest of its parts.
+*/
+/* ------------------------------------------------------------------------ */
+typedef struct {
+    sixbit_word         msgids;        //!< AIS_MSGID() of each id to keep, 0 = all
+    const unsigned long *mmsi;         //!< Sorted MMSIs to keep, NULL = all
+    unsigned int        num_mmsi;      //!< Number of MMSIs in mmsi
+    unsigned char       skip[2][10];   //!< Multipart messages being dropped, by channel and sequence id
+    unsigned long       accepted;      //!< Sentences passed on to assemble_vdm()
+    unsigned long       rejected;      //!< Sentences dropped
+} ais_filter;
+
+
 /* ------------------------------------------------------------------------ */
 /** binary_state the state for the Seaway/IMO Message Parser
 
@@ -629,14 +725,22 @@ typedef struct {
 
 
 /* Prototypes */
-int __stdcall get_timetag( sixbit *state, timetag *datetime );
+int __stdcall get_timetag( sixbit_view *state, timetag *datetime );
 void __stdcall conv_sign( unsigned int sign_bit, int *value );
 char __stdcall ais2ascii( char value );
 int __stdcall pos2ddd( long latitude, long longitude, double *lat_dd, double *long_ddd );
 int __stdcall pos2dmm( long latitude, long longitude, short *lat_dd, double *lat_min, short *long_ddd, double *long_min );
 int __stdcall conv_pos( long *latitude, long *longitude );
 int __stdcall conv_pos27( long *latitude, long *longitude );
+int __stdcall conv_sog27( int sog );
+int __stdcall conv_cog27( int cog );
+int __stdcall is_vdm( nmea_state *nmea );
 int __stdcall assemble_vdm( ais_state *state, char *str );
+int __stdcall assemble_vdm_tokens( ais_state *state, nmea_state *nmea );
+int __stdcall ais_peek_msgid( const char *str );
+long __stdcall ais_peek_mmsi( const char *str );
+int __stdcall init_ais_filter( ais_filter *filter );
+int __stdcall assemble_vdm_filtered( ais_state *state, ais_filter *filter, char *str );
 int __stdcall parse_ais_1( ais_state *state, aismsg_1 *result );
 int __stdcall parse_ais_2( ais_state *state, aismsg_2 *result );
 int __stdcall parse_ais_3( ais_state *state, aismsg_3 *result );
@@ -662,3 +766,5 @@ int __stdcall parse_ais_22( ais_state *state, aismsg_22 *result );
 int __stdcall parse_ais_23( ais_state *state, aismsg_23 *result );
 int __stdcall parse_ais_24( ais_state *state, aismsg_24 *result );
 int __stdcall parse_ais_27( ais_state *state, aismsg_27 *result );
+int __stdcall parse_ais_any( ais_state *state, aismsg_any *result );
+int __stdcall parse_ais_position( ais_state *state, unsigned int fields, aismsg_pos *result );
@@ -0,0 +1,386 @@
+/* -----------------------------------------------------------------------
+   MMSI keyed table of vessel state
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>
+   All rights Reserved
+   ----------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "portable.h"
+#include "nmea.h"
+#include "sixbit.h"
+#include "vdm_parse.h"
+#include "mmsi_index.h"
+#include "vessel.h"
+
+/*! \file
+    \brief MMSI keyed table of vessel state
+    \author Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>, All Rights Reserved
+    \version 1.8
+
+    A vessel_table holds the current picture of every vessel heard: the
+    latest position from messages 1, 2, 3, 18, 19 and 27 and the static
+    data from messages 5, 19, 24A and 24B, merged into one ais_vessel
+    per MMSI. Parts A and B of message 24 arrive separately and fill in
+    different fields of the same record.
+
+    The table is one array of records hashed by mmsi_index, so a lookup
+    usually touches a single cache line or two. It is allocated once by
+    init_vessel_table() and nothing is allocated while running. It is
+    never more than 3/4 full, new vessels are dropped and counted when it
+    is. vessel_expire() removes vessels that have not been heard from.
+
+    Time is supplied by the caller as the now parameter, in any unit.
+
+    Example:
+    \code
+    vessel_table table;
+    aismsg_any   msg;
+    ais_vessel   *v;
+    unsigned long pos;
+
+    init_vessel_table( &table, 10000 );
+    ...
+    if( parse_ais_any( &ais, &msg ) == 0 )
+        vessel_update( &table, &msg, time( NULL ) );
+    ...
+    pos = 0;
+    while( (v = vessel_next( &table, &pos )) != NULL )
+        printf( "%09lu %s\n", v->userid, v->name );
+    \endcode
+*/
+
+
+/* ----------------------------------------------------------------------- */
+/* The hash over a table's slots */
+/* ----------------------------------------------------------------------- */
+static void vessel_index( vessel_table *table, mmsi_index *index )
+{
+    init_mmsi_index( index, table->slots, sizeof( ais_vessel ), sizeof( table->slots->userid ), table->size );
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Initialize a vessel table
+
+    \param table pointer to the table
+    \param vessels number of vessels it must be able to hold
+
+    returns:
+      - 0 if no error
+      - 1 if there was an error with the parameters
+      - 2 if the slots could not be allocated
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall init_vessel_table( vessel_table *table, unsigned long vessels )
+{
+    unsigned long size;
+
+    if( !table || !vessels )
+        return 1;
+
+    memset( table, 0, sizeof( vessel_table ) );
+
+    size = mmsi_index_size( vessels );
+
+    table->slots = calloc( size, sizeof( ais_vessel ) );
+    if( !table->slots )
+        return 2;
+    table->size = size;
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Free the slots of a vessel table
+
+    \param table pointer to the table
+*/
+/* ----------------------------------------------------------------------- */
+void __stdcall free_vessel_table( vessel_table *table )
+{
+    if( !table )
+        return;
+
+    free( table->slots );
+    table->slots = NULL;
+    table->size = 0;
+    table->count = 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Find a vessel
+
+    \param table pointer to the table
+    \param userid MMSI of the vessel
+
+    Returns a pointer to the vessel's record or NULL if it isn't in the
+    table. The pointer is good until the next vessel_update() of a new
+    vessel or vessel_expire().
+*/
+/* ----------------------------------------------------------------------- */
+ais_vessel * __stdcall vessel_find( vessel_table *table, unsigned long userid )
+{
+    mmsi_index    index;
+    unsigned long i;
+
+    if( !table || !table->size || !userid )
+        return NULL;
+
+    vessel_index( table, &index );
+    i = mmsi_index_slot( &index, userid );
+
+    return table->slots[i].userid ? &table->slots[i] : NULL;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Find a vessel, adding it if it isn't there
+   Returns NULL if it isn't there and the table is full
+*/
+/* ----------------------------------------------------------------------- */
+static ais_vessel *vessel_add( vessel_table *table, unsigned long userid )
+{
+    mmsi_index    index;
+    ais_vessel    *v;
+    unsigned long i;
+
+    vessel_index( table, &index );
+    i = mmsi_index_slot( &index, userid );
+    if( table->slots[i].userid )
+        return &table->slots[i];
+
+    if( table->count >= table->size - table->size / 4 )
+        return NULL;
+
+    v = &table->slots[i];
+    memset( v, 0, sizeof( ais_vessel ) );
+    v->userid = userid;
+    v->longitude = 108600000;
+    v->latitude = 54600000;
+    v->sog = 1023;
+    v->cog = 3600;
+    v->heading = 511;
+    v->nav_status = 15;
+    table->count++;
+
+    return v;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Copy a position report into a vessel */
+/* ----------------------------------------------------------------------- */
+static void vessel_position( ais_vessel *v, unsigned char msgid, long longitude, long latitude,
+                             int sog, int cog, int heading, char pos_acc, unsigned long now )
+{
+    v->longitude = longitude;
+    v->latitude = latitude;
+    v->sog = (unsigned short) sog;
+    v->cog = (unsigned short) cog;
+    v->heading = (unsigned short) heading;
+    v->pos_acc = (unsigned char) pos_acc;
+    v->pos_msgid = msgid;
+    v->pos_time = now;
+    v->flags |= AIS_VESSEL_POSITION;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Copy the ship type and dimensions into a vessel */
+/* ----------------------------------------------------------------------- */
+static void vessel_ship( ais_vessel *v, unsigned char ship_type, int dim_bow, int dim_stern,
+                         char dim_port, char dim_starboard )
+{
+    v->ship_type = ship_type;
+    v->dim_bow = (unsigned short) dim_bow;
+    v->dim_stern = (unsigned short) dim_stern;
+    v->dim_port = (unsigned char) dim_port;
+    v->dim_starboard = (unsigned char) dim_starboard;
+    v->flags |= AIS_VESSEL_SHIP;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Update a vessel from a parsed message
+
+    \param table pointer to the table
+    \param msg message from parse_ais_any()
+    \param now time the message was received
+
+    returns:
+      - 0 if the vessel was updated
+      - 1 if the message isn't a position or static data report
+      - 2 if it is a new vessel and the table is full
+
+    The vessel is added if it isn't in the table yet. Only the fields the
+    message carries are changed, so a message 24B adds the callsign and
+    dimensions to the name from an earlier 24A.
+*/
+/* ----------------------------------------------------------------------- */
+int __stdcall vessel_update( vessel_table *table, aismsg_any *msg, unsigned long now )
+{
+    ais_vessel    *v;
+    unsigned long userid;
+
+    if( !table || !table->size || !msg )
+        return 1;
+
+    switch( msg->msgid )
+    {
+        case 1: case 2: case 3: case 5: case 18: case 19: case 24: case 27:
+            break;
+        default:
+            return 1;
+    }
+
+    /* userid is in the same place in all of them */
+    userid = msg->u.msg_1.userid;
+    if( !userid )
+        return 1;
+
+    v = vessel_add( table, userid );
+    if( !v )
+    {
+        table->full++;
+        return 2;
+    }
+    v->updated = now;
+    table->updates++;
+
+    switch( msg->msgid )
+    {
+        case 1:
+            vessel_position( v, 1, msg->u.msg_1.longitude, msg->u.msg_1.latitude, msg->u.msg_1.sog,
+                             msg->u.msg_1.cog, msg->u.msg_1.true, msg->u.msg_1.pos_acc, now );
+            v->nav_status = (unsigned char) msg->u.msg_1.nav_status;
+            break;
+
+        case 2:
+            vessel_position( v, 2, msg->u.msg_2.longitude, msg->u.msg_2.latitude, msg->u.msg_2.sog,
+                             msg->u.msg_2.cog, msg->u.msg_2.true, msg->u.msg_2.pos_acc, now );
+            v->nav_status = (unsigned char) msg->u.msg_2.nav_status;
+            break;
+
+        case 3:
+            vessel_position( v, 3, msg->u.msg_3.longitude, msg->u.msg_3.latitude, msg->u.msg_3.sog,
+                             msg->u.msg_3.cog, msg->u.msg_3.true, msg->u.msg_3.pos_acc, now );
+            v->nav_status = (unsigned char) msg->u.msg_3.nav_status;
+            break;
+
+        case 5:
+            strcpy( v->name, msg->u.msg_5.name );
+            strcpy( v->callsign, msg->u.msg_5.callsign );
+            strcpy( v->dest, msg->u.msg_5.dest );
+            vessel_ship( v, msg->u.msg_5.ship_type, msg->u.msg_5.dim_bow, msg->u.msg_5.dim_stern,
+                         msg->u.msg_5.dim_port, msg->u.msg_5.dim_starboard );
+            v->imo = msg->u.msg_5.imo;
+            v->eta = msg->u.msg_5.eta;
+            v->draught = msg->u.msg_5.draught;
+            v->flags |= AIS_VESSEL_NAME | AIS_VESSEL_VOYAGE;
+            break;
+
+        case 18:
+            vessel_position( v, 18, msg->u.msg_18.longitude, msg->u.msg_18.latitude, msg->u.msg_18.sog,
+                             msg->u.msg_18.cog, msg->u.msg_18.true, msg->u.msg_18.pos_acc, now );
+            break;
+
+        case 19:
+            vessel_position( v, 19, msg->u.msg_19.longitude, msg->u.msg_19.latitude, msg->u.msg_19.sog,
+                             msg->u.msg_19.cog, msg->u.msg_19.true, msg->u.msg_19.pos_acc, now );
+            strcpy( v->name, msg->u.msg_19.name );
+            vessel_ship( v, msg->u.msg_19.ship_type, msg->u.msg_19.dim_bow, msg->u.msg_19.dim_stern,
+                         msg->u.msg_19.dim_port, msg->u.msg_19.dim_starboard );
+            v->flags |= AIS_VESSEL_NAME;
+            break;
+
+        case 24:
+            /* Only the part in this message, not msg_24.flags */
+            if( msg->u.msg_24.part_number == 0 )
+            {
+                strcpy( v->name, msg->u.msg_24.name );
+                v->flags |= AIS_VESSEL_NAME;
+            } else {
+                strcpy( v->callsign, msg->u.msg_24.callsign );
+                strcpy( v->vendor_id, msg->u.msg_24.vendor_id );
+                vessel_ship( v, msg->u.msg_24.ship_type, msg->u.msg_24.dim_bow, msg->u.msg_24.dim_stern,
+                             msg->u.msg_24.dim_port, msg->u.msg_24.dim_starboard );
+            }
+            break;
+
+        case 27:
+            vessel_position( v, 27, msg->u.msg_27.longitude, msg->u.msg_27.latitude,
+                             conv_sog27( msg->u.msg_27.sog ), conv_cog27( msg->u.msg_27.cog ), 511,
+                             msg->u.msg_27.pos_acc, now );
+            v->nav_status = (unsigned char) msg->u.msg_27.nav_status;
+            break;
+    }
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Iterate over the vessels
+
+    \param table pointer to the table
+    \param pos position in the table, set to 0 before the first call
+
+    Returns the next vessel or NULL when there are no more. The order is
+    the order of the slots, not of the MMSIs.
+*/
+/* ----------------------------------------------------------------------- */
+ais_vessel * __stdcall vessel_next( vessel_table *table, unsigned long *pos )
+{
+    if( !table || !pos )
+        return NULL;
+
+    while( *pos < table->size )
+    {
+        if( table->slots[(*pos)++].userid )
+            return &table->slots[*pos - 1];
+    }
+
+    return NULL;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Has a vessel not been heard from for longer than age */
+/* ----------------------------------------------------------------------- */
+static int __stdcall vessel_expired( void *slot, unsigned long now, unsigned long age )
+{
+    ais_vessel *v = (ais_vessel *) slot;
+
+    return (now > v->updated) && (now - v->updated > age);
+}
+
+
+/* ----------------------------------------------------------------------- */
+/** Remove vessels that haven't been heard from
+
+    \param table pointer to the table
+    \param now current time
+    \param age time since the last report of any kind
+
+    Returns the number of vessels removed. Vessels updated after now are
+    kept. Pointers to vessels are not valid after this.
+*/
+/* ----------------------------------------------------------------------- */
+unsigned long __stdcall vessel_expire( vessel_table *table, unsigned long now, unsigned long age )
+{
+    mmsi_index    index;
+    unsigned long n;
+
+    if( !table || !table->size )
+        return 0;
+
+    vessel_index( table, &index );
+    n = mmsi_index_expire( &index, now, age, vessel_expired );
+    table->count -= n;
+    table->expired += n;
+
+    return n;
+}
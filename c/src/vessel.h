@@ -0,0 +1,72 @@
+/* -----------------------------------------------------------------------
+   MMSI keyed table of vessel state
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>
+   All rights Reserved
+   ----------------------------------------------------------------------- */
+
+/*! \file
+    \brief Header file for vessel.c
+
+    Requires nmea.h, sixbit.h and vdm_parse.h to be included first.
+*/
+
+/** ais_vessel.flags, which parts of the record have been filled in */
+#define AIS_VESSEL_POSITION  0x01      //!< Position report, msg 1, 2, 3, 18, 19 or 27
+#define AIS_VESSEL_NAME      0x02      //!< Ship name, msg 5, 19 or 24A
+#define AIS_VESSEL_SHIP      0x04      //!< Type, callsign and dimensions, msg 5, 19 or 24B
+#define AIS_VESSEL_VOYAGE    0x08      //!< IMO, draught, ETA and destination, msg 5
+
+
+/** Current state of one vessel
+
+    Positions are in 1/10000 minute, speed in 1/10 knot and course in
+    1/10 degree for all message types, with the not available values
+    used by message 1.
+*/
+typedef struct {
+    unsigned long   userid;            //!< UserID / MMSI, 0 for an empty slot
+    unsigned long   updated;           //!< Time of the last report of any kind
+    unsigned long   pos_time;          //!< Time of the last position report
+    long            longitude;         //!< Longitude in 1/10000 minute
+    long            latitude;          //!< Latitude in 1/10000 minute
+    unsigned short  sog;               //!< Speed over ground, 1023 = N/A
+    unsigned short  cog;               //!< Course over ground, 3600 = N/A
+    unsigned short  heading;           //!< True heading, 511 = N/A
+    unsigned char   nav_status;        //!< Navigational status, 15 = N/A
+    unsigned char   pos_acc;           //!< Position accuracy
+    unsigned char   pos_msgid;         //!< Message the position came from
+    unsigned char   flags;             //!< AIS_VESSEL_* parts that are known
+    unsigned char   ship_type;         //!< Type of ship and cargo
+    unsigned char   draught;           //!< Maximum present static draught
+    unsigned short  dim_bow;           //!< GPS Ant. Distance from Bow
+    unsigned short  dim_stern;         //!< GPS Ant. Distance from Stern
+    unsigned char   dim_port;          //!< GPS Ant. Distance from Port
+    unsigned char   dim_starboard;     //!< GPS Ant. Distance from Starboard
+    unsigned long   imo;               //!< IMO Number
+    unsigned long   eta;               //!< Estimated Time of Arrival MMDDHHMM
+    char            callsign[8];       //!< Callsign in ASCII
+    char            vendor_id[8];      //!< Vendor ID in ASCII, msg 24B only
+    char            name[21];          //!< Ship Name in ASCII
+    char            dest[21];          //!< Destination in ASCII
+} ais_vessel;
+
+
+/** Open addressing hash table of vessels, keyed by MMSI
+*/
+typedef struct {
+    ais_vessel      *slots;            //!< size vessels
+    unsigned long   size;              //!< Number of slots, a power of 2
+    unsigned long   count;             //!< Vessels in the table
+    unsigned long   updates;           //!< Messages used to update the table
+    unsigned long   full;              //!< New vessels dropped because the table was full
+    unsigned long   expired;           //!< Vessels removed by vessel_expire()
+} vessel_table;
+
+
+/* Prototypes */
+int __stdcall init_vessel_table( vessel_table *table, unsigned long vessels );
+void __stdcall free_vessel_table( vessel_table *table );
+int __stdcall vessel_update( vessel_table *table, aismsg_any *msg, unsigned long now );
+ais_vessel * __stdcall vessel_find( vessel_table *table, unsigned long userid );
+ais_vessel * __stdcall vessel_next( vessel_table *table, unsigned long *pos );
+unsigned long __stdcall vessel_expire( vessel_table *table, unsigned long now, unsigned long age );
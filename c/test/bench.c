@@ -0,0 +1,1071 @@
+/* -----------------------------------------------------------------------
+   Benchmarks for the AIS Parser SDK
+   Copyright 2006-2008 by Brian C. Lane <bcl@brianlane.com>
+   All Rights Reserved
+   ----------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_TSC
+#endif
+#include "portable.h"
+#include "nmea.h"
+#include "sixbit.h"
+#include "vdm_parse.h"
+#include "seaway.h"
+#include "imo.h"
+
+/*! \file
+    \brief Benchmarks for each layer of the parser
+
+    Each case times one layer on its own: NMEA checksums, tokenizing,
+    VDM assembly, de-armoring, decoding of each message type and the
+    Seaway and IMO binary messages. The kernel layers are run once for
+    each SIMD level the CPU supports.
+
+    The sentences are read from the logs in ../data, or from the -d
+    directory. If none can be read a few built-in sentences are used.
+    The messages decoded are the ones assembled from those sentences,
+    up to BENCH_SAMPLES of each type.
+
+    Each case is calibrated to run for about -t milliseconds, run -w
+    times to warm up and then timed -r times. The median, 10th and 90th
+    percentile, min and max time per operation are reported, with the
+    median TSC ticks per operation on x86. An operation is one sentence
+    for checksum, tokenize and assemble, one payload for dearmor and
+    one message for the others. checksum times nmea_xor() on the part of
+    each sentence between the ! or $ and the *.
+
+    With -m the logs are replayed instead, end to end: each line is read
+    with fgets(), assembled, and the complete messages are decoded by
+    parse_ais_any(). The logs are read over and over, keeping the
+    assembly state, until -m megabytes have been read, or just once for
+    -m 0. The throughput is reported with the messages of each type and
+    the rate of each assemble_vdm() return value. The logs are read once
+    first, untimed, so that they come from the page cache.
+
+    Usage:
+    \code
+    aisparse_bench [-r reps] [-w warmup] [-t ms] [-s level] [-f text|csv|json] [-d dir] [name ...]
+    aisparse_bench -m mb [-r reps] [-f text|csv|json] [-d dir]
+    \endcode
+
+    Only cases whose names start with one of the names are run, eg.
+    "decode" or "checksum/scalar".
+*/
+
+
+/** Most messages of each type kept for decoding */
+#define BENCH_SAMPLES    64
+
+/** Most sentences read from the logs */
+#define BENCH_LINES      100000
+
+/** assemble_vdm() return values counted by the replay */
+#define BENCH_RV         8
+
+#define BENCH_TEXT       0
+#define BENCH_CSV        1
+#define BENCH_JSON       2
+
+
+/** Settings from the command line */
+typedef struct {
+    unsigned int    reps;              //!< Timed repetitions of each case
+    unsigned int    warmup;            //!< Untimed repetitions before them
+    unsigned long   target_ns;         //!< Time each repetition should take
+    int             simd;              //!< Only run the kernels at this level, -1 for all
+    int             format;            //!< BENCH_TEXT, BENCH_CSV or BENCH_JSON
+    const char      *dir;              //!< Directory with the logs
+    double          replay;            //!< Bytes to replay, 0 for one pass, < 0 to run the cases
+    char            **names;           //!< Prefixes of the cases to run
+    int             num_names;         //!< Number of names
+} bench_opts;
+
+
+/** Seaway and IMO parsers, called through one type */
+typedef int (__stdcall *bench_parse)( sixbit_view *view, void *result );
+
+
+/** One case, run() does a pass over its inputs and returns the number of operations */
+typedef struct bench_case_s {
+    char            name[32];          //!< Name reported
+    int             simd;              //!< SIMD level it needs, -1 if it doesn't use the kernels
+    unsigned long   (*run)( struct bench_case_s *bc );
+    unsigned long   bytes;             //!< Bytes of input handled by each pass, 0 if not counted
+    ais_state       **states;          //!< Messages for the decode cases
+    unsigned int    num_states;        //!< Number of states
+    sixbit_view     view;              //!< Payload for the Seaway and IMO cases
+    bench_parse     parse;             //!< Parser for the Seaway and IMO cases
+} bench_case;
+
+
+/** Results of one case, per operation */
+typedef struct {
+    unsigned long   ops;               //!< Operations per pass
+    unsigned long   passes;            //!< Passes per repetition
+    double          median;            //!< Median ns
+    double          p10;               //!< 10th percentile ns
+    double          p90;               //!< 90th percentile ns
+    double          min;               //!< Fastest ns
+    double          max;               //!< Slowest ns
+    double          cycles;            //!< Median TSC ticks, 0 if not available
+} bench_result;
+
+
+/** Counts from one replay of the logs */
+typedef struct {
+    double          bytes;             //!< Bytes read
+    unsigned long   sentences;         //!< Lines read
+    unsigned long   messages;          //!< Complete messages
+    unsigned long   bad;               //!< Messages parse_ais_any() returned an error for
+    unsigned long   loops;             //!< Passes through the logs
+    unsigned long   rv[BENCH_RV];      //!< Count of each assemble_vdm() return value
+    unsigned long   msgid[64];         //!< Complete messages of each type
+    unsigned long   msgid_bad[64];     //!< Errors decoding each type
+    double          ns;                //!< Time taken
+    double          ticks;             //!< TSC ticks taken, 0 if not available
+} bench_replay;
+
+
+/* Inputs shared by the cases */
+static char          **lines;
+static unsigned int  num_lines;
+static unsigned long line_bytes;
+static unsigned int  *sum_start;
+static unsigned int  *sum_len;
+static unsigned long sum_bytes;
+static const char    **payloads;
+static unsigned int  *payload_len;
+static unsigned int  num_payloads;
+static unsigned long payload_bytes;
+static ais_state     *states;
+static unsigned int  num_states;
+
+/* Results are stored here so that the work is not optimized away */
+static volatile unsigned long bench_sink;
+
+static const char *simd_names[] = { "scalar", "sse2", "avx2" };
+
+/* Logs in c/data */
+static const char *data_files[] = { "SAR.log", "seattle.log", "tidemsg8.log", "unknown.log" };
+
+/* What assemble_vdm() returns */
+static const char *rv_names[BENCH_RV] = { "complete", "incomplete", "checksum", "not_ais",
+                                          "fields", "sequence", "sixbit", "other" };
+
+/* Used when the logs can't be read */
+static char *builtin_lines[] = {
+    "!AIVDM,1,1,,B,15MqvC0Oh9G?qinK?VlPhA480@2n,0*1F,123,14",
+    "!AIVDM,1,1,,B,15Mf@6P001G?v68K??4SejL<00Sl,0*71",
+    "!AIVDM,1,1,,B,15Mn4kPP01G?qNvK>:grkOv<0<11,0*55",
+    "!AIVDM,1,1,,B,15O1Pv0022o?GeNKB3f7QV2>00SP,0*26",
+    "!AIVDM,1,1,,B,15MqvC0Oh:G?qj0K?Vp@di4B0@5>,0*44",
+    "!AIVDM,1,1,,B,15NcRf0P3wG?Wq>o=RP?vB0<1J,0*7B",
+    "$BSVDM,1,1,,B,15MqvC0Oh:G?qj0K?Vp@di4B0@5>,0*5D",
+    "!BSVDM,1,1,,B,15NcRf0P3wG?Wq>o=RP?vB0<1J,0*02,142,aass,12311",
+    "!AIVDM,2,1,6,B,55ArUT02:nkG<I8GB20nuJ0p5HTu>0hT9860TV16000006420BDi@E53,0*33",
+    "!AIVDM,2,2,6,B,1KUDhH888888880,2*6A",
+    "!AIVDM,2,1,7,B,55N6RQ000001L@?WWC4h5=B0l4pLv2222222220U1@6335oA0543lU83,0*14",
+    "!AIVDM,2,2,7,B,5A33mp888888880,2*49",
+    "!AIVDM,2,1,8,B,55N0=SP00001Lt??;OL<PTDJ1<D5A@hF2222220k2@>2640005h00000,0*70",
+    "!AIVDM,2,2,8,B,000000000000000,2*2F",
+    "!AIVDM,2,1,9,B,55Mj3MP00001LgO73N0dh4PuMT61M<J22222220t3iJ??40Ht<Uli`51,0*57",
+    "!AIVDM,2,2,9,B,DSBCPC888888880,2*2B",
+    "!AIVDM,2,1,1,B,55Mj2u01o97qMU;?C;5M<J0dUA<522222222220t2Q@>:40Ht<Uli`51,0*16",
+    "!AIVDM,2,2,1,B,DSBCPC888888880,2*23",
+    "!AIVDM,2,1,2,B,54QKkL01uDfUM@k;SO918v1=E9HETu800000000010e2:40000000000,0*20",
+    "!AIVDM,2,2,2,B,000000000000000,2*25",
+    "!AIVDM,2,1,5,B,54eGL:00543h=WWG7V0`u<F0p59H4Eb22222220l10A5262k0<S0APDQ,0*62",
+    "!AIVDM,2,2,5,B,iH4i@E531H88880,2*24"
+};
+
+
+/* ----------------------------------------------------------------------- */
+/* Monotonic time in ns */
+/* ----------------------------------------------------------------------- */
+static double bench_now( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Time stamp counter, 0 where there isn't one */
+/* ----------------------------------------------------------------------- */
+static double bench_ticks( void )
+{
+#ifdef BENCH_TSC
+    return (double) __rdtsc();
+#else
+    return 0.0;
+#endif
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Add a sentence, without its line ending */
+/* ----------------------------------------------------------------------- */
+static int add_line( const char *buf )
+{
+    size_t len;
+    size_t start;
+    char   *p;
+
+    len = strcspn( buf, "\r\n" );
+    if( !len )
+        return 0;
+
+    p = malloc( len + 1 );
+    if( !p )
+        return 2;
+    memcpy( p, buf, len );
+    p[len] = 0;
+
+    /* The part the checksum covers, after the ! or $ and up to the * */
+    start = strcspn( p, "!$" );
+    if( start < len )
+        start++;
+    sum_start[num_lines] = (unsigned int) start;
+    sum_len[num_lines] = (unsigned int) strcspn( p + start, "*" );
+    sum_bytes += sum_len[num_lines];
+
+    lines[num_lines++] = p;
+    line_bytes += len;
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Read the sentences, falling back to the built-in ones */
+/* ----------------------------------------------------------------------- */
+static int load_lines( const char *dir )
+{
+    char         path[1024];
+    char         buf[MAX_NMEA_LENGTH];
+    FILE         *fp;
+    unsigned int i;
+
+    lines = calloc( BENCH_LINES, sizeof( char * ) );
+    sum_start = calloc( BENCH_LINES, sizeof( unsigned int ) );
+    sum_len = calloc( BENCH_LINES, sizeof( unsigned int ) );
+    if( !lines || !sum_start || !sum_len )
+        return 2;
+
+    for( i = 0; i < sizeof( data_files ) / sizeof( data_files[0] ); i++ )
+    {
+        snprintf( path, sizeof( path ), "%s/%s", dir, data_files[i] );
+        if( (fp = fopen( path, "r" )) == NULL )
+            continue;
+        while( (num_lines < BENCH_LINES) && fgets( buf, sizeof( buf ), fp ) )
+        {
+            if( add_line( buf ) )
+            {
+                fclose( fp );
+                return 2;
+            }
+        }
+        fclose( fp );
+    }
+
+    if( !num_lines )
+    {
+        fprintf( stderr, "No logs in %s, using the built-in sentences\n", dir );
+        for( i = 0; i < sizeof( builtin_lines ) / sizeof( builtin_lines[0] ); i++ )
+        {
+            if( add_line( builtin_lines[i] ) )
+                return 2;
+        }
+    }
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Find the VDM payloads and assemble the messages once for decoding */
+/* ----------------------------------------------------------------------- */
+static int load_messages( void )
+{
+    nmea_state   nmea;
+    ais_state    ais;
+    aismsg_any   msg;
+    unsigned int i;
+
+    payloads = calloc( num_lines, sizeof( char * ) );
+    payload_len = calloc( num_lines, sizeof( unsigned int ) );
+    states = calloc( num_lines, sizeof( ais_state ) );
+    if( !payloads || !payload_len || !states )
+        return 2;
+
+    memset( &ais, 0, sizeof( ais_state ) );
+    for( i = 0; i < num_lines; i++ )
+    {
+        memset( &nmea, 0, sizeof( nmea_state ) );
+        if( (nmea_tokenize( &nmea, lines[i] ) == 0) && is_vdm( &nmea ) && (nmea.num_fields > 5) )
+        {
+            payloads[num_payloads] = nmea.field[5];
+            payload_len[num_payloads] = nmea.field_len[5];
+            payload_bytes += nmea.field_len[5];
+            num_payloads++;
+        }
+
+        if( assemble_vdm( &ais, lines[i] ) != 0 )
+            continue;
+
+        /* Keep the ones that decode, packed so they can be decoded again */
+        states[num_states] = ais;
+        if( !states[num_states].six_state.packed && sixbit_pack( &states[num_states].six_state ) )
+            continue;
+        states[num_states].six_state.pos = 0;
+        states[num_states].six_state.overrun = 0;
+        if( parse_ais_any( &states[num_states], &msg ) == 0 )
+        {
+            states[num_states].msgid = (unsigned char) msg.msgid;
+            num_states++;
+        }
+    }
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* The cases */
+/* ----------------------------------------------------------------------- */
+static unsigned long run_checksum( bench_case *bc )
+{
+    unsigned long n;
+    unsigned int  i;
+
+    n = 0;
+    for( i = 0; i < num_lines; i++ )
+        n += nmea_xor( lines[i] + sum_start[i], sum_len[i] );
+    bench_sink += n;
+
+    return num_lines;
+}
+
+
+static unsigned long run_tokenize( bench_case *bc )
+{
+    static nmea_state nmea;
+    unsigned long     n;
+    unsigned int      i;
+
+    n = 0;
+    for( i = 0; i < num_lines; i++ )
+        n += nmea_tokenize( &nmea, lines[i] ) + nmea.num_fields;
+    bench_sink += n;
+
+    return num_lines;
+}
+
+
+static unsigned long run_assemble( bench_case *bc )
+{
+    static ais_state ais;
+    unsigned long    n;
+    unsigned int     i;
+
+    n = 0;
+    for( i = 0; i < num_lines; i++ )
+        n += assemble_vdm( &ais, lines[i] );
+    bench_sink += n;
+
+    return num_lines;
+}
+
+
+static unsigned long run_dearmor( bench_case *bc )
+{
+    unsigned char buf[(MAX_NMEA_LENGTH * 6 + 7) / 8];
+    unsigned long n;
+    unsigned int  i;
+
+    n = 0;
+    for( i = 0; i < num_payloads; i++ )
+        n += sixbit_dearmor( payloads[i], payload_len[i], buf ) + buf[0];
+    bench_sink += n;
+
+    return num_payloads;
+}
+
+
+static unsigned long run_decode( bench_case *bc )
+{
+    static aismsg_any msg;
+    ais_state         *ais;
+    unsigned long     n;
+    unsigned int      i;
+
+    n = 0;
+    for( i = 0; i < bc->num_states; i++ )
+    {
+        ais = bc->states[i];
+        ais->six_state.pos = 0;
+        ais->six_state.overrun = 0;
+        n += parse_ais_any( ais, &msg ) + msg.msgid;
+    }
+    bench_sink += n;
+
+    return bc->num_states;
+}
+
+
+static unsigned long run_binary( bench_case *bc )
+{
+    /* Big enough for any of the Seaway and IMO results */
+    static union {
+        seaway1_1 s1_1; seaway1_2 s1_2; seaway1_3 s1_3; seaway1_6 s1_6;
+        seaway2_1 s2_1; seaway2_2 s2_2; seaway32_1 s32_1;
+        imo1_11 i1_11; imo1_12 i1_12; imo1_13 i1_13; imo1_14 i1_14;
+        imo1_15 i1_15; imo1_16 i1_16; imo1_17 i1_17;
+    } result;
+    sixbit_view view;
+
+    view = bc->view;
+    bench_sink += bc->parse( &view, &result );
+
+    return 1;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Seaway and IMO payloads, the binary data of message 8 from the DAC on.
+   The IMO ones are filled in with pseudo-random bits
+*/
+/* ----------------------------------------------------------------------- */
+typedef struct {
+    const char  *name;
+    const char  *payload;
+    bench_parse parse;
+} bench_binary;
+
+static bench_binary binary_cases[] = {
+    { "seaway1_1",  "Ch41G`8U1Dm<H80iUm09Ce0@1A9Ii3wgl2@t", (bench_parse) parse_seaway1_1 },
+    { "seaway1_2",  "Ch42G`8U1Dm<H80iUm09Ce0@1A9@", (bench_parse) parse_seaway1_2 },
+    { "seaway1_3",  "Ch43G`8U1Dm<H80iUm09Ce008400", (bench_parse) parse_seaway1_3 },
+    { "seaway1_6",  "Ch46G`8U1Dm<H80iUm09Ce400000", (bench_parse) parse_seaway1_6 },
+    { "seaway2_1",  "Ch81G`8U1Dm<H80iUm09Ce00=9<;IPCD1BPPPPPcl4@0", (bench_parse) parse_seaway2_1 },
+    { "seaway2_2",  "Ch82Gc7SBC2nH4m0D`88884k4ok<<Erl1<i=tk39NeNC<CO<hkGcP4k4ok<<@", (bench_parse) parse_seaway2_2 },
+    { "seaway32_1", "Cj011000", (bench_parse) parse_seaway32_1 },
+    { "imo1_11",    NULL, (bench_parse) parse_imo1_11 },
+    { "imo1_12",    NULL, (bench_parse) parse_imo1_12 },
+    { "imo1_13",    NULL, (bench_parse) parse_imo1_13 },
+    { "imo1_14",    NULL, (bench_parse) parse_imo1_14 },
+    { "imo1_15",    NULL, (bench_parse) parse_imo1_15 },
+    { "imo1_16",    NULL, (bench_parse) parse_imo1_16 },
+    { "imo1_17",    NULL, (bench_parse) parse_imo1_17 },
+};
+
+/* The payloads the views are over */
+static sixbit binary_six[sizeof( binary_cases ) / sizeof( binary_cases[0] )];
+
+
+/* ----------------------------------------------------------------------- */
+/* Set up the view for a Seaway or IMO case, after the DAC, FI, spare and
+   message id
+*/
+/* ----------------------------------------------------------------------- */
+static int init_binary( bench_case *bc, unsigned int n )
+{
+    char          buf[169];
+    unsigned long seed;
+    unsigned int  i;
+    sixbit        *six;
+
+    six = &binary_six[n];
+    init_6bit( six );
+    if( binary_cases[n].payload )
+    {
+        if( sixbit_append( six, binary_cases[n].payload, strlen( binary_cases[n].payload ), 0 ) )
+            return 1;
+    } else {
+        /* 1008 bits, the most a message 8 can hold after its header */
+        seed = 12345 + n;
+        for( i = 0; i < sizeof( buf ) - 1; i++ )
+        {
+            seed = (seed * 1103515245UL + 12345UL) & 0x7FFFFFFFUL;
+            buf[i] = binto6bit( (char) ((seed >> 16) & 0x3F) );
+        }
+        buf[i] = 0;
+        if( sixbit_append( six, buf, sizeof( buf ) - 1, 0 ) )
+            return 1;
+    }
+    if( sixbit_pack( six ) )
+        return 1;
+
+    get_6bit( six, 10 );
+    get_6bit( six, 6 );
+    get_6bit( six, 2 );
+    get_6bit( six, 6 );
+    if( sixbit_view_init( &bc->view, six ) )
+        return 1;
+
+    bc->parse = binary_cases[n].parse;
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Does a case match the names on the command line */
+/* ----------------------------------------------------------------------- */
+static int wanted( bench_opts *opts, const char *name )
+{
+    int i;
+
+    if( !opts->num_names )
+        return 1;
+    for( i = 0; i < opts->num_names; i++ )
+    {
+        if( strncmp( name, opts->names[i], strlen( opts->names[i] ) ) == 0 )
+            return 1;
+    }
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Time passes of a case, returns ns and sets *ticks */
+/* ----------------------------------------------------------------------- */
+static double time_case( bench_case *bc, unsigned long passes, double *ticks )
+{
+    double        t0;
+    double        c0;
+    unsigned long i;
+
+    c0 = bench_ticks();
+    t0 = bench_now();
+    for( i = 0; i < passes; i++ )
+        bc->run( bc );
+    *ticks = bench_ticks() - c0;
+
+    return bench_now() - t0;
+}
+
+
+static int cmp_double( const void *a, const void *b )
+{
+    double x = *(const double *) a;
+    double y = *(const double *) b;
+
+    return (x > y) - (x < y);
+}
+
+
+/* Nearest rank percentile of sorted values */
+static double percentile( double *v, unsigned int n, double p )
+{
+    return v[(unsigned int) (p * (n - 1) + 0.5)];
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Calibrate, warm up and time a case */
+/* ----------------------------------------------------------------------- */
+static int measure( bench_opts *opts, bench_case *bc, bench_result *res )
+{
+    double        *ns;
+    double        *cyc;
+    double        t;
+    double        ticks;
+    unsigned long passes;
+    unsigned int  i;
+
+    memset( res, 0, sizeof( bench_result ) );
+    res->ops = bc->run( bc );
+    if( !res->ops )
+        return 1;
+
+    /* Double the passes until a repetition takes long enough */
+    passes = 1;
+    while( (t = time_case( bc, passes, &ticks )) < opts->target_ns / 4 )
+        passes *= 2;
+    if( t < opts->target_ns )
+        passes = (unsigned long) (passes * (opts->target_ns / (t > 1.0 ? t : 1.0))) + 1;
+    res->passes = passes;
+
+    for( i = 0; i < opts->warmup; i++ )
+        time_case( bc, passes, &ticks );
+
+    ns = calloc( opts->reps, sizeof( double ) );
+    cyc = calloc( opts->reps, sizeof( double ) );
+    if( !ns || !cyc )
+    {
+        free( ns );
+        free( cyc );
+        return 2;
+    }
+    for( i = 0; i < opts->reps; i++ )
+    {
+        ns[i] = time_case( bc, passes, &ticks ) / ((double) passes * res->ops);
+        cyc[i] = ticks / ((double) passes * res->ops);
+    }
+    qsort( ns, opts->reps, sizeof( double ), cmp_double );
+    qsort( cyc, opts->reps, sizeof( double ), cmp_double );
+
+    res->median = percentile( ns, opts->reps, 0.5 );
+    res->p10 = percentile( ns, opts->reps, 0.1 );
+    res->p90 = percentile( ns, opts->reps, 0.9 );
+    res->min = ns[0];
+    res->max = ns[opts->reps - 1];
+    res->cycles = percentile( cyc, opts->reps, 0.5 );
+
+    free( ns );
+    free( cyc );
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Print one result */
+/* ----------------------------------------------------------------------- */
+static void report( bench_opts *opts, bench_case *bc, bench_result *res )
+{
+    double mops;
+    double mbps;
+    char   cycles[32];
+    char   mb[32];
+
+    mops = 1e3 / res->median;
+    mbps = bc->bytes ? (bc->bytes * 1e3) / (res->median * res->ops) : 0.0;
+
+    switch( opts->format )
+    {
+        case BENCH_CSV:
+            printf( "%s,%s,%lu,%u,%.2f,%.2f,%.2f,%.2f,%.2f,", bc->name,
+                    (bc->simd < 0) ? "" : simd_names[bc->simd], res->ops, opts->reps,
+                    res->median, res->p10, res->p90, res->min, res->max );
+            if( res->cycles > 0.0 ) printf( "%.1f", res->cycles );
+            printf( ",%.3f,", mops );
+            if( bc->bytes ) printf( "%.1f", mbps );
+            printf( "\n" );
+            break;
+
+        case BENCH_JSON:
+            printf( "{\"name\":\"%s\",\"simd\":", bc->name );
+            if( bc->simd < 0 ) printf( "null" ); else printf( "\"%s\"", simd_names[bc->simd] );
+            printf( ",\"ops\":%lu,\"reps\":%u,\"median_ns\":%.2f,\"p10_ns\":%.2f,\"p90_ns\":%.2f,"
+                    "\"min_ns\":%.2f,\"max_ns\":%.2f,\"cycles\":",
+                    res->ops, opts->reps, res->median, res->p10, res->p90, res->min, res->max );
+            if( res->cycles > 0.0 ) printf( "%.1f", res->cycles ); else printf( "null" );
+            printf( ",\"mops\":%.3f,\"mbps\":", mops );
+            if( bc->bytes ) printf( "%.1f", mbps ); else printf( "null" );
+            printf( "}\n" );
+            break;
+
+        default:
+            strcpy( cycles, "-" );
+            if( res->cycles > 0.0 )
+                snprintf( cycles, sizeof( cycles ), "%.1f", res->cycles );
+            strcpy( mb, "-" );
+            if( bc->bytes )
+                snprintf( mb, sizeof( mb ), "%.1f", mbps );
+            printf( "%-18s %7lu %10.2f %10.2f %10.2f %10.2f %10.2f %9s %9.3f %8s\n", bc->name,
+                    res->ops, res->median, res->p10, res->p90, res->min, res->max, cycles, mops, mb );
+            break;
+    }
+    fflush( stdout );
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Run a case if it was asked for */
+/* ----------------------------------------------------------------------- */
+static int run_case( bench_opts *opts, bench_case *bc )
+{
+    bench_result res;
+
+    if( !wanted( opts, bc->name ) )
+        return 0;
+
+    /* Kernel layers run at one level, the rest at the best one */
+    if( bc->simd >= 0 )
+    {
+        if( (nmea_simd( bc->simd ) != bc->simd) || (sixbit_simd( bc->simd ) != bc->simd) )
+            return 0;
+    } else {
+        nmea_simd( 2 );
+        sixbit_simd( 2 );
+    }
+
+    if( measure( opts, bc, &res ) == 0 )
+        report( opts, bc, &res );
+
+    return 0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Read, assemble and decode the logs until limit bytes have been read */
+/* ----------------------------------------------------------------------- */
+static int replay_logs( bench_opts *opts, double limit, bench_replay *rp )
+{
+    static ais_state  ais;
+    static aismsg_any msg;
+    char              path[1024];
+    char              buf[1024];
+    FILE              *fp;
+    unsigned int      i;
+    int               rv;
+    double            t0;
+    double            c0;
+
+    memset( rp, 0, sizeof( bench_replay ) );
+    memset( &ais, 0, sizeof( ais_state ) );
+    memset( &msg, 0, sizeof( aismsg_any ) );
+
+    c0 = bench_ticks();
+    t0 = bench_now();
+    do {
+        for( i = 0; i < sizeof( data_files ) / sizeof( data_files[0] ); i++ )
+        {
+            snprintf( path, sizeof( path ), "%s/%s", opts->dir, data_files[i] );
+            if( (fp = fopen( path, "r" )) == NULL )
+                continue;
+            while( fgets( buf, sizeof( buf ), fp ) )
+            {
+                rp->bytes += strlen( buf );
+                rp->sentences++;
+
+                rv = assemble_vdm( &ais, buf );
+                rp->rv[(rv >= 0) && (rv < BENCH_RV - 1) ? rv : BENCH_RV - 1]++;
+                if( rv != 0 )
+                    continue;
+
+                rp->messages++;
+                if( parse_ais_any( &ais, &msg ) != 0 )
+                {
+                    rp->bad++;
+                    rp->msgid_bad[ais.msgid & 0x3F]++;
+                }
+                rp->msgid[ais.msgid & 0x3F]++;
+            }
+            fclose( fp );
+        }
+        rp->loops++;
+    } while( rp->sentences && (rp->bytes < limit) );
+    rp->ticks = bench_ticks() - c0;
+    rp->ns = bench_now() - t0;
+
+    return rp->sentences ? 0 : 1;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Print a rate as a percentage of all */
+/* ----------------------------------------------------------------------- */
+static double percent( unsigned long n, unsigned long all )
+{
+    return all ? (100.0 * n) / all : 0.0;
+}
+
+
+/* ----------------------------------------------------------------------- */
+/* Replay the logs reps times and report the median */
+/* ----------------------------------------------------------------------- */
+static int replay( bench_opts *opts )
+{
+    bench_replay *rp;
+    bench_replay *med;
+    double       *ns;
+    double       mbps;
+    double       mps;
+    const char   *sep;
+    unsigned int i;
+
+    rp = calloc( opts->reps, sizeof( bench_replay ) );
+    ns = calloc( opts->reps, sizeof( double ) );
+    if( !rp || !ns )
+    {
+        free( rp );
+        free( ns );
+        fprintf( stderr, "Out of memory\n" );
+        return 2;
+    }
+
+    /* Once through to get the logs into the page cache */
+    if( opts->warmup && replay_logs( opts, 0.0, &rp[0] ) )
+    {
+        fprintf( stderr, "No logs in %s\n", opts->dir );
+        free( rp );
+        free( ns );
+        return 1;
+    }
+
+    for( i = 0; i < opts->reps; i++ )
+    {
+        if( replay_logs( opts, opts->replay, &rp[i] ) )
+        {
+            fprintf( stderr, "No logs in %s\n", opts->dir );
+            free( rp );
+            free( ns );
+            return 1;
+        }
+        ns[i] = rp[i].ns;
+    }
+    qsort( ns, opts->reps, sizeof( double ), cmp_double );
+
+    /* The counts are the same each time, report the median run */
+    med = &rp[0];
+    for( i = 0; i < opts->reps; i++ )
+    {
+        if( rp[i].ns == percentile( ns, opts->reps, 0.5 ) )
+            med = &rp[i];
+    }
+    mbps = med->bytes * 1e3 / med->ns;
+    mps = med->messages * 1e9 / med->ns;
+
+    switch( opts->format )
+    {
+        case BENCH_CSV:
+            printf( "name,value\n" );
+            printf( "loops,%lu\nbytes,%.0f\nsentences,%lu\nmessages,%lu\ndecode_errors,%lu\n",
+                    med->loops, med->bytes, med->sentences, med->messages, med->bad );
+            printf( "seconds,%.6f\nmin_seconds,%.6f\nmax_seconds,%.6f\n", med->ns / 1e9,
+                    ns[0] / 1e9, ns[opts->reps - 1] / 1e9 );
+            printf( "mbps,%.2f\nsentences_per_sec,%.0f\nmessages_per_sec,%.0f\nns_per_message,%.2f\n",
+                    mbps, med->sentences * 1e9 / med->ns, mps, 1e9 / mps );
+            if( med->ticks > 0.0 )
+                printf( "cycles_per_message,%.1f\n", med->ticks / med->messages );
+            for( i = 0; i < BENCH_RV; i++ )
+                printf( "assemble.%s,%lu\n", rv_names[i], med->rv[i] );
+            for( i = 0; i < 64; i++ )
+            {
+                if( med->msgid[i] )
+                    printf( "msgid.%u,%lu\nmsgid.%u.errors,%lu\n", i, med->msgid[i], i, med->msgid_bad[i] );
+            }
+            break;
+
+        case BENCH_JSON:
+            printf( "{\"loops\":%lu,\"bytes\":%.0f,\"sentences\":%lu,\"messages\":%lu,\"decode_errors\":%lu,",
+                    med->loops, med->bytes, med->sentences, med->messages, med->bad );
+            printf( "\"seconds\":%.6f,\"min_seconds\":%.6f,\"max_seconds\":%.6f,", med->ns / 1e9,
+                    ns[0] / 1e9, ns[opts->reps - 1] / 1e9 );
+            printf( "\"mbps\":%.2f,\"sentences_per_sec\":%.0f,\"messages_per_sec\":%.0f,\"ns_per_message\":%.2f,",
+                    mbps, med->sentences * 1e9 / med->ns, mps, 1e9 / mps );
+            printf( "\"cycles_per_message\":" );
+            if( med->ticks > 0.0 ) printf( "%.1f", med->ticks / med->messages ); else printf( "null" );
+            printf( ",\"assemble\":{" );
+            for( i = 0; i < BENCH_RV; i++ )
+                printf( "%s\"%s\":%lu", i ? "," : "", rv_names[i], med->rv[i] );
+            printf( "},\"msgid\":{" );
+            sep = "";
+            for( i = 0; i < 64; i++ )
+            {
+                if( !med->msgid[i] )
+                    continue;
+                printf( "%s\"%u\":{\"count\":%lu,\"errors\":%lu}", sep, i, med->msgid[i], med->msgid_bad[i] );
+                sep = ",";
+            }
+            printf( "}}\n" );
+            break;
+
+        default:
+            printf( "# replay of %s, %lu loops, median of %u reps\n", opts->dir, med->loops, opts->reps );
+            printf( "bytes              %15.0f\n", med->bytes );
+            printf( "sentences          %15lu\n", med->sentences );
+            printf( "messages           %15lu\n", med->messages );
+            printf( "decode errors      %15lu\n", med->bad );
+            printf( "seconds            %15.4f  (%.4f - %.4f)\n", med->ns / 1e9, ns[0] / 1e9,
+                    ns[opts->reps - 1] / 1e9 );
+            printf( "MB/s               %15.2f\n", mbps );
+            printf( "sentences/s        %15.0f\n", med->sentences * 1e9 / med->ns );
+            printf( "messages/s         %15.0f\n", mps );
+            printf( "ns/message         %15.2f\n", 1e9 / mps );
+            if( med->ticks > 0.0 )
+                printf( "cycles/message     %15.1f\n", med->ticks / med->messages );
+            printf( "\n# assemble_vdm()     sentences        %%\n" );
+            for( i = 0; i < BENCH_RV; i++ )
+                printf( "%u %-16s %12lu %8.3f\n", i, rv_names[i], med->rv[i],
+                        percent( med->rv[i], med->sentences ) );
+            printf( "\n# msgid  messages        %%   errors\n" );
+            for( i = 0; i < 64; i++ )
+            {
+                if( med->msgid[i] )
+                    printf( "%7u %9lu %8.3f %8lu\n", i, med->msgid[i],
+                            percent( med->msgid[i], med->messages ), med->msgid_bad[i] );
+            }
+            break;
+    }
+
+    free( rp );
+    free( ns );
+
+    return 0;
+}
+
+
+static void usage( void )
+{
+    fprintf( stderr, "Usage: aisparse_bench [-r reps] [-w warmup] [-t ms] [-s level] [-f text|csv|json] [-d dir] [name ...]\n" );
+    fprintf( stderr, "       aisparse_bench -m mb [-r reps] [-f text|csv|json] [-d dir]\n" );
+    fprintf( stderr, "  -r reps    timed repetitions of each case (11)\n" );
+    fprintf( stderr, "  -w warmup  untimed repetitions first (3)\n" );
+    fprintf( stderr, "  -t ms      time per repetition (20)\n" );
+    fprintf( stderr, "  -s level   only run the kernels at 0 = scalar, 1 = SSE2 or 2 = AVX2\n" );
+    fprintf( stderr, "  -f format  text, csv or json lines (text)\n" );
+    fprintf( stderr, "  -d dir     directory with the logs (../data)\n" );
+    fprintf( stderr, "  -m mb      replay the logs end to end until mb megabytes are read, 0 = once\n" );
+    fprintf( stderr, "  name       only run the cases starting with name\n" );
+}
+
+
+int main( int argc, char *argv[] )
+{
+    static bench_case bc;
+    bench_opts        opts;
+    ais_state         **bucket;
+    unsigned int      msgid;
+    unsigned int      i;
+    int               level;
+    int               a;
+    static const struct {
+        const char    *name;
+        unsigned long (*run)( bench_case *bc );
+        unsigned long *bytes;
+    } layers[] = {
+        { "checksum", run_checksum, &sum_bytes },
+        { "tokenize", run_tokenize, &line_bytes },
+        { "assemble", run_assemble, &line_bytes },
+        { "dearmor",  run_dearmor,  &payload_bytes },
+    };
+
+    memset( &opts, 0, sizeof( opts ) );
+    opts.reps = 11;
+    opts.warmup = 3;
+    opts.target_ns = 20 * 1000000UL;
+    opts.simd = -1;
+    opts.dir = "../data";
+    opts.replay = -1.0;
+
+    for( a = 1; a < argc; a++ )
+    {
+        if( (argv[a][0] == '-') && argv[a][1] && !argv[a][2] && (a + 1 < argc) )
+        {
+            switch( argv[a][1] )
+            {
+                case 'r': opts.reps = (unsigned int) atoi( argv[++a] ); break;
+                case 'w': opts.warmup = (unsigned int) atoi( argv[++a] ); break;
+                case 't': opts.target_ns = (unsigned long) atol( argv[++a] ) * 1000000UL; break;
+                case 's': opts.simd = atoi( argv[++a] ); break;
+                case 'd': opts.dir = argv[++a]; break;
+                case 'm': opts.replay = atof( argv[++a] ) * 1e6; break;
+                case 'f':
+                    a++;
+                    if( strcmp( argv[a], "csv" ) == 0 )
+                        opts.format = BENCH_CSV;
+                    else if( strcmp( argv[a], "json" ) == 0 )
+                        opts.format = BENCH_JSON;
+                    else if( strcmp( argv[a], "text" ) == 0 )
+                        opts.format = BENCH_TEXT;
+                    else {
+                        usage();
+                        return 1;
+                    }
+                    break;
+                default:
+                    usage();
+                    return 1;
+            }
+        } else if( argv[a][0] == '-' ) {
+            usage();
+            return 1;
+        } else {
+            opts.names = &argv[a];
+            opts.num_names = argc - a;
+            break;
+        }
+    }
+    if( !opts.reps || (opts.simd > 2) )
+    {
+        usage();
+        return 1;
+    }
+
+    if( opts.replay >= 0.0 )
+        return replay( &opts );
+
+    if( load_lines( opts.dir ) || load_messages() )
+    {
+        fprintf( stderr, "Out of memory\n" );
+        return 2;
+    }
+
+    switch( opts.format )
+    {
+        case BENCH_CSV:
+            printf( "name,simd,ops,reps,median_ns,p10_ns,p90_ns,min_ns,max_ns,cycles,mops,mbps\n" );
+            break;
+        case BENCH_JSON:
+            break;
+        default:
+            printf( "# %u sentences, %u payloads, %u messages, %u reps of %lu ms after %u warmup\n",
+                    num_lines, num_payloads, num_states, opts.reps, opts.target_ns / 1000000UL, opts.warmup );
+            printf( "%-18s %7s %10s %10s %10s %10s %10s %9s %9s %8s\n", "# name", "ops", "median_ns",
+                    "p10_ns", "p90_ns", "min_ns", "max_ns", "cycles", "Mops/s", "MB/s" );
+            break;
+    }
+
+    /* NMEA and 6-bit layers at each SIMD level */
+    for( i = 0; i < sizeof( layers ) / sizeof( layers[0] ); i++ )
+    {
+        for( level = 0; level <= 2; level++ )
+        {
+            if( (opts.simd >= 0) && (level != opts.simd) )
+                continue;
+            memset( &bc, 0, sizeof( bc ) );
+            snprintf( bc.name, sizeof( bc.name ), "%s/%s", layers[i].name, simd_names[level] );
+            bc.simd = level;
+            bc.run = layers[i].run;
+            bc.bytes = *layers[i].bytes;
+            run_case( &opts, &bc );
+        }
+    }
+
+    /* Decoding, a case for each message type */
+    bucket = calloc( BENCH_SAMPLES, sizeof( ais_state * ) );
+    if( !bucket )
+        return 2;
+    for( msgid = 0; msgid < 32; msgid++ )
+    {
+        memset( &bc, 0, sizeof( bc ) );
+        snprintf( bc.name, sizeof( bc.name ), "decode.%u", msgid );
+        bc.simd = -1;
+        bc.run = run_decode;
+        bc.states = bucket;
+        for( i = 0; (i < num_states) && (bc.num_states < BENCH_SAMPLES); i++ )
+        {
+            if( states[i].msgid == msgid )
+                bucket[bc.num_states++] = &states[i];
+        }
+        if( bc.num_states )
+            run_case( &opts, &bc );
+    }
+    free( bucket );
+
+    /* Seaway and IMO binary messages */
+    for( i = 0; i < sizeof( binary_cases ) / sizeof( binary_cases[0] ); i++ )
+    {
+        memset( &bc, 0, sizeof( bc ) );
+        strcpy( bc.name, binary_cases[i].name );
+        bc.simd = -1;
+        bc.run = run_binary;
+        if( init_binary( &bc, i ) == 0 )
+            run_case( &opts, &bc );
+    }
+
+    return 0;
+}
@@ -10,10 +10,39 @@
 #include "nmea.h"
 #include "sixbit.h"
 #include "vdm_parse.h"
+#include "reassembly.h"
+#include "batch.h"
+#include "stream.h"
+#include "archive.h"
+#include "pipeline.h"
+#include "mmsi_index.h"
+#include "vessel.h"
+#include "grid.h"
+#include "track.h"
+#include "cpa.h"
+#include "geofence.h"
+#include "dedupe.h"
+#include "thin.h"
+#include "simplify.h"
 #include "test_nmea.h"
 #include "test_sixbit.h"
 #include "test_vdm_parse.h"
+#include "test_reassembly.h"
+#include "test_batch.h"
+#include "test_stream.h"
+#include "test_archive.h"
+#include "test_pipeline.h"
+#include "test_mmsi_index.h"
+#include "test_vessel.h"
+#include "test_grid.h"
+#include "test_track.h"
+#include "test_cpa.h"
+#include "test_geofence.h"
+#include "test_dedupe.h"
+#include "test_thin.h"
+#include "test_simplify.h"
 #include "test_seaway.h"
+#include "test_imo.h"
 #include "test_access.h"
 
 
@@ -94,6 +123,22 @@ int main( int argc, char *argv[] )
     {
         exit(-1);
     }
+    if (test_nmea_xor() != 1)
+    {
+        exit(-1);
+    }
+    if (test_nmea_delim_mask() != 1)
+    {
+        exit(-1);
+    }
+    if (test_nmea_tokenize() != 1)
+    {
+        exit(-1);
+    }
+    if (test_nmea_parse_tag() != 1)
+    {
+        exit(-1);
+    }
 
     if (test_binfrom6bit() != 1)
     {
@@ -107,6 +152,26 @@ int main( int argc, char *argv[] )
     {
         exit(-1);
     }
+    if (test_sixbit_pack() != 1)
+    {
+        exit(-1);
+    }
+    if (test_get_bits() != 1)
+    {
+        exit(-1);
+    }
+    if (test_sixbit_dearmor() != 1)
+    {
+        exit(-1);
+    }
+    if (test_sixbit_append() != 1)
+    {
+        exit(-1);
+    }
+    if (test_sixbit_view() != 1)
+    {
+        exit(-1);
+    }
     if (test_ais2ascii() != 1)
     {
         exit(-1);
@@ -131,6 +196,134 @@ int main( int argc, char *argv[] )
     {
         exit(-1);
     }
+    if (test_assemble_vdm_tag() != 1)
+    {
+        exit(-1);
+    }
+    if (test_ais_peek() != 1)
+    {
+        exit(-1);
+    }
+    if (test_assemble_vdm_filtered() != 1)
+    {
+        exit(-1);
+    }
+    if (test_reasm_interleaved() != 1)
+    {
+        exit(-1);
+    }
+    if (test_reasm_lost() != 1)
+    {
+        exit(-1);
+    }
+    if (test_reasm_tag_first() != 1)
+    {
+        exit(-1);
+    }
+    if (test_ais_decode_batch() != 1)
+    {
+        exit(-1);
+    }
+    if (test_ais_stream_chunks() != 1)
+    {
+        exit(-1);
+    }
+    if (test_ais_stream_overflow() != 1)
+    {
+        exit(-1);
+    }
+    if (test_ais_decode_archive() != 1)
+    {
+        exit(-1);
+    }
+    if (test_ais_decode_archive_threads() != 1)
+    {
+        exit(-1);
+    }
+    if (test_ais_ring() != 1)
+    {
+        exit(-1);
+    }
+    if (test_ais_pipeline() != 1)
+    {
+        exit(-1);
+    }
+    if (test_ais_pipeline_route() != 1)
+    {
+        exit(-1);
+    }
+    if (test_mmsi_index() != 1)
+    {
+        exit(-1);
+    }
+    if (test_vessel_update() != 1)
+    {
+        exit(-1);
+    }
+    if (test_vessel_expire() != 1)
+    {
+        exit(-1);
+    }
+    if (test_grid_bbox() != 1)
+    {
+        exit(-1);
+    }
+    if (test_grid_radius() != 1)
+    {
+        exit(-1);
+    }
+    if (test_track_append() != 1)
+    {
+        exit(-1);
+    }
+    if (test_track_max_age() != 1)
+    {
+        exit(-1);
+    }
+    if (test_cpa_update() != 1)
+    {
+        exit(-1);
+    }
+    if (test_geofence_find() != 1)
+    {
+        exit(-1);
+    }
+    if (test_geofence_update() != 1)
+    {
+        exit(-1);
+    }
+    if (test_ais_dedupe() != 1)
+    {
+        exit(-1);
+    }
+    if (test_ais_dedupe_window() != 1)
+    {
+        exit(-1);
+    }
+    if (test_ais_thin() != 1)
+    {
+        exit(-1);
+    }
+    if (test_ais_thin_table() != 1)
+    {
+        exit(-1);
+    }
+    if (test_ais_simplify() != 1)
+    {
+        exit(-1);
+    }
+    if (test_ais_simplify_still() != 1)
+    {
+        exit(-1);
+    }
+    if (test_seaway_overrun() != 1)
+    {
+        exit(-1);
+    }
+    if (test_imo_overrun() != 1)
+    {
+        exit(-1);
+    }
     if( test_ais_1() != 1 )
     {
         exit(-1);
@@ -187,6 +380,15 @@ int main( int argc, char *argv[] )
     {
         exit(-1);
     }
+    if( test_parse_ais_any() != 1 )
+    {
+        exit(-1);
+    }
+
+    if( test_parse_ais_position() != 1 )
+    {
+        exit(-1);
+    }
 
     printf("Testing test_msgs\n");
 
@@ -93,8 +93,8 @@ for p in s:
 	    print "fi        : %d" % (fi)
 
 	    sixbit = msg.data
-	    spare = aisparser.get_6bit( sixbit, 2 )
-	    msgid = aisparser.get_6bit( sixbit, 6 )
+	    spare = aisparser.sixbit_view_get( sixbit, 2 )
+	    msgid = aisparser.sixbit_view_get( sixbit, 6 )
 	    print "msgid     : %d" % (msgid)
 
 	    if fi==1 and msgid==3: